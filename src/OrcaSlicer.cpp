@@ -6,6 +6,7 @@
     #define NOMINMAX
     #include <Windows.h>
     #include <wchar.h>
+    #include <io.h>
     #ifdef SLIC3R_GUI
     extern "C"
     {
@@ -19,7 +20,11 @@
 
 #include <cstdio>
 #include <string>
+#ifndef WIN32
+#include <unistd.h>
+#endif
 #include <cstring>
+#include <cerrno>
 #include <iostream>
 #include <math.h>
 
@@ -34,6 +39,7 @@ using namespace nlohmann;
 #endif
 
 #include <boost/algorithm/string/predicate.hpp>
+#include <boost/algorithm/string/join.hpp>
 #include <boost/filesystem.hpp>
 #include <boost/nowide/args.hpp>
 #include <boost/nowide/cenv.hpp>
@@ -43,6 +49,16 @@ using namespace nlohmann;
 #include <boost/dll/runtime_symbol_info.hpp>
 #include <boost/log/trivial.hpp>
 
+#include <tbb/task_arena.h>
+#include <tbb/version.h>
+#if TBB_VERSION_MAJOR >= 2021
+    #include <tbb/parallel_pipeline.h>
+    using slic3r_tbb_filtermode = tbb::filter_mode;
+#else
+    #include <tbb/pipeline.h>
+    using slic3r_tbb_filtermode = tbb::filter;
+#endif
+
 #include "unix/fhs.hpp"  // Generated by CMake from ../platform/unix/fhs.hpp.in
 
 #include "libslic3r/libslic3r.h"
@@ -63,6 +79,7 @@ using namespace nlohmann;
 #include "libslic3r/Utils.hpp"
 #include "libslic3r/Time.hpp"
 #include "libslic3r/Thread.hpp"
+#include "libslic3r/Trace.hpp"
 #include "libslic3r/BlacklistedLibraryCheck.hpp"
 #include "libslic3r/FlushVolCalc.hpp"
 
@@ -165,6 +182,8 @@ typedef struct _sliced_info {
     std::vector<std::string> downward_machines;
 }sliced_info_t;
 std::vector<PrintBase::SlicingStatus> g_slicing_warnings;
+// G-code files of the plates exported into the output directory, reported by the slicing daemon.
+std::vector<std::string> g_exported_gcode_files;
 
 #if defined(__linux__) || defined(__LINUX__)
 #define PIPE_BUFFER_SIZE 512
@@ -524,6 +543,61 @@ static int load_key_values_from_json(const std::string &file, std::map<std::stri
     return 0;
 }
 
+// Setting files loaded by the slicing daemon together with their inherited system presets, keyed by path.
+// The daemon runs many jobs with the same settings, a file is parsed again only if it was modified since.
+// The modification time has a resolution of one second, thus the file size is compared as well.
+struct LoadedSettingFile
+{
+    std::time_t                         last_write_time { 0 };
+    boost::uintmax_t                    file_size { 0 };
+    DynamicPrintConfig                  config;
+    std::map<std::string, std::string>  key_values;
+    // Substitutions performed when the file was parsed, logged again when the file is reused.
+    ConfigSubstitutions                 config_substitutions;
+};
+static std::map<std::string, LoadedSettingFile> g_loaded_setting_files;
+static bool                                      g_cache_setting_files = false;
+
+static ConfigSubstitutions clone_config_substitutions(const ConfigSubstitutions &config_substitutions)
+{
+    ConfigSubstitutions out;
+    out.reserve(config_substitutions.size());
+    for (const ConfigSubstitution &subst : config_substitutions)
+        out.push_back({ subst.opt_def, subst.old_value, ConfigOptionUniquePtr(subst.new_value->clone()) });
+    return out;
+}
+
+static bool load_cached_setting_file(const std::string &file, DynamicPrintConfig &config, std::map<std::string, std::string> &key_values, ConfigSubstitutions &config_substitutions)
+{
+    if (! g_cache_setting_files)
+        return false;
+    auto it = g_loaded_setting_files.find(file);
+    if (it == g_loaded_setting_files.end())
+        return false;
+    boost::system::error_code ec;
+    if (it->second.last_write_time != boost::filesystem::last_write_time(file, ec) || ec ||
+        it->second.file_size != boost::filesystem::file_size(file, ec) || ec)
+        return false;
+    config               = it->second.config;
+    key_values           = it->second.key_values;
+    config_substitutions = clone_config_substitutions(it->second.config_substitutions);
+    BOOST_LOG_TRIVIAL(info) << __FUNCTION__ << ": reuse the loaded setting file " << file;
+    return true;
+}
+
+static void cache_setting_file(const std::string &file, const DynamicPrintConfig &config, const std::map<std::string, std::string> &key_values, const ConfigSubstitutions &config_substitutions)
+{
+    if (! g_cache_setting_files)
+        return;
+    boost::system::error_code ec;
+    std::time_t last_write_time = boost::filesystem::last_write_time(file, ec);
+    if (ec)
+        return;
+    boost::uintmax_t file_size = boost::filesystem::file_size(file, ec);
+    if (! ec)
+        g_loaded_setting_files[file] = { last_write_time, file_size, config, key_values, clone_config_substitutions(config_substitutions) };
+}
+
 static std::set<std::string> gcodes_key_set =  {"filament_end_gcode", "filament_start_gcode", "change_filament_gcode", "layer_change_gcode", "machine_end_gcode", "machine_pause_gcode", "machine_start_gcode",
             "template_custom_gcode", "printing_by_object_gcode", "before_layer_change_gcode", "time_lapse_gcode"};
 
@@ -1078,6 +1152,13 @@ int CLI::run(int argc, char **argv)
     std::string temp_path = wxFileName::GetTempDir().utf8_str().data();
     set_temporary_dir(temp_path);
 
+    const ConfigOptionBool *opt_daemon = m_config.opt<ConfigOptionBool>("daemon");
+    if (opt_daemon && opt_daemon->value) {
+        const ConfigOptionInt *opt_loglevel = m_config.opt<ConfigOptionInt>("debug");
+        set_logging_level(opt_loglevel ? opt_loglevel->value : 2);
+        return this->run_daemon();
+    }
+
     m_extra_config.apply(m_config, true);
     m_extra_config.normalize_fdm();
 
@@ -1184,6 +1265,11 @@ int CLI::run(int argc, char **argv)
         }
     }
 
+    // Record the spans of the slicing pipeline, they are exported as a Chrome trace once all the plates are processed.
+    const std::string trace_file = m_config.opt_string("trace_file", true);
+    if (! trace_file.empty())
+        Trace::enable(true);
+
     global_begin_time = (long long)Slic3r::Utils::get_current_time_utc();
     BOOST_LOG_TRIVIAL(warning) << boost::format("cli mode, Current OrcaSlicer Version %1%")%SLIC3R_VERSION;
 
@@ -1679,10 +1765,13 @@ int CLI::run(int argc, char **argv)
             std::map<std::string, std::string> key_values;
             std::string reason;
 
-            config_substitutions = config.load_from_json(file, config_substitution_rule, key_values, reason);
-            if (!reason.empty()) {
-                BOOST_LOG_TRIVIAL(error) <<__FUNCTION__<<  ":Can not load config from file "<<file<<"\n";
-                return CLI_CONFIG_FILE_ERROR;
+            if (! load_cached_setting_file(file, config, key_values, config_substitutions)) {
+                config_substitutions = config.load_from_json(file, config_substitution_rule, key_values, reason);
+                if (!reason.empty()) {
+                    BOOST_LOG_TRIVIAL(error) <<__FUNCTION__<<  ":Can not load config from file "<<file<<"\n";
+                    return CLI_CONFIG_FILE_ERROR;
+                }
+                cache_setting_file(file, config, key_values, config_substitutions);
             }
 
             config_name = key_values[BBL_JSON_KEY_NAME];
@@ -4615,7 +4704,7 @@ int CLI::run(int argc, char **argv)
     }
 
     // loop through action options
-    bool export_to_3mf = false, load_slicedata = false, export_slicedata = false, export_slicedata_error = false;
+    bool export_to_3mf = false, load_slicedata = false, export_slicedata = false;
     bool no_check = false;
     std::string export_3mf_file, load_slice_data_dir, export_slice_data_dir, export_stls_dir;
     std::vector<ThumbnailData*> calibration_thumbnails;
@@ -4723,6 +4812,8 @@ int CLI::run(int argc, char **argv)
             //BBS: slice 0 means all plates, i means plate i;
             plate_to_slice = m_config.option<ConfigOptionInt>("slice")->value;
             sliced_plate = plate_to_slice;
+            const ConfigOptionInt *opt_parallel_plates = m_config.opt<ConfigOptionInt>("parallel_plates");
+            const int parallel_plates = opt_parallel_plates ? std::max(opt_parallel_plates->value, 1) : 1;
             bool pre_check = (plate_to_slice == 0)?true:false;
             bool finished = false;
 
@@ -4754,10 +4845,211 @@ int CLI::run(int argc, char **argv)
                 // honored when printing (they will be only centered, unless --dont-arrange
                 // is supplied); if any object has no instances, it will get a default one
                 // and all instances will be rearranged (unless --dont-arrange is supplied).
-                std::string outfile;
                 //Print       fff_print;
                 std::vector<size_t> plate_triangle_counts(partplate_list.get_plate_count(), 0);
 
+                // Each plate is applied, processed and its G-code exported before the next plate is applied.
+                // With --parallel_plates the model is applied to the Prints of all the plates first, then the plates are processed
+                // concurrently. The results and errors are still reported in the order of the plates.
+                struct PlateSlicingJob
+                {
+                    int                                     index { 0 };
+                    PrintBase                              *print { nullptr };
+                    Slic3r::GUI::GCodeResult               *gcode_result { nullptr };
+                    Slic3r::GUI::PartPlate                 *part_plate { nullptr };
+                    // Warning reported by Print::validate().
+                    std::string                             warning;
+                    long long                               start_time { 0 };
+                    long long                               time_using_cache { 0 };
+                    sliced_plate_info_t                     sliced_plate_info;
+                    // Warnings of a plate processed in parallel, otherwise they are collected into g_slicing_warnings.
+                    std::vector<PrintBase::SlicingStatus>   slicing_warnings;
+                    // Exit code of the first failure, 0 if the plate was sliced and exported successfully.
+                    int                                     error { 0 };
+                    // Store sliced_plate_info into the result before reporting the error.
+                    bool                                    error_with_plate_info { false };
+                    std::string                             exception_text;
+                    // G-code exported into the output directory.
+                    std::string                             gcode_file;
+                };
+                std::vector<PlateSlicingJob> plate_jobs;
+                const bool slice_in_parallel = parallel_plates > 1 && plate_to_slice == 0 && partplate_list.get_plate_count() > 1;
+
+                // Process a single plate and export its G-code. Errors are not reported here, but stored into the job,
+                // as the plate may be processed by a worker thread.
+                auto slice_plate = [&](PlateSlicingJob &job) {
+                    const int            index             = job.index;
+                    PrintBase           *print             = job.print;
+                    Print               *print_fff         = dynamic_cast<Print*>(print);
+                    long long           &time_using_cache  = job.time_using_cache;
+                    sliced_plate_info_t &sliced_plate_info = job.sliced_plate_info;
+                    std::vector<PrintBase::SlicingStatus> &slicing_warnings = slice_in_parallel ? job.slicing_warnings : g_slicing_warnings;
+                    try {
+                        std::string outfile;
+                        long long   end_time = 0, temp_time = 0;
+                        BOOST_LOG_TRIVIAL(info) << "start Print::process for partplate "<<index+1 << std::endl;
+#if defined(__linux__) || defined(__LINUX__)
+                        if (! slice_in_parallel && g_cli_callback_mgr.is_started()) {
+                            g_cli_callback_mgr.set_plate_info(index+1, (plate_to_slice== 0)?partplate_list.get_plate_count():1);
+                            if (!job.warning.empty()) {
+                                PrintBase::SlicingStatus slicing_status{4, job.warning, 0, 0};
+                                cli_status_callback(slicing_status);
+                            }
+                            else {
+                                PrintBase::SlicingStatus slicing_status{4, "Slicing begins"};
+                                cli_status_callback(slicing_status);
+                            }
+                        }
+#endif
+                        if (load_slicedata) {
+                            std::string plate_dir = load_slice_data_dir+"/"+std::to_string(index+1);
+                            int ret = print->load_cached_data(plate_dir);
+                            if (ret) {
+                                BOOST_LOG_TRIVIAL(warning) << "plate "<< index+1<< ": load Slicing data error, ret=" << ret;
+                                BOOST_LOG_TRIVIAL(warning) << "plate "<< index+1<< ": switch normal slicing";
+                                print->process();
+                            }
+                            else {
+                                BOOST_LOG_TRIVIAL(info) << "plate "<< index+1<< ": load cached data success, go on.";
+#if defined(__linux__) || defined(__LINUX__)
+                                if (! slice_in_parallel && g_cli_callback_mgr.is_started()) {
+                                    PrintBase::SlicingStatus slicing_status{69, "Cache data loaded"};
+                                    cli_status_callback(slicing_status);
+                                }
+#endif
+                                print->process(nullptr, true);
+                                BOOST_LOG_TRIVIAL(info) << "plate "<< index+1<< ": finished print::process.";
+                            }
+                        }
+                        else {
+                            print->process(&time_using_cache);
+                            BOOST_LOG_TRIVIAL(info) << "print::process: first time_using_cache is " << time_using_cache << " secs.";
+                        }
+                        if (printer_technology == ptFFF) {
+                            std::string conflict_result = print_fff->get_conflict_string();
+                            if (!conflict_result.empty()) {
+                                BOOST_LOG_TRIVIAL(error) << "plate "<< index+1<< ": found slicing result conflict!"<< std::endl;
+                                job.error = CLI_GCODE_PATH_CONFLICTS;
+                                return;
+                            }
+
+                            //check the warnings
+                            if (!slicing_warnings.empty())
+                            {
+                                for (unsigned int i = 0; i < slicing_warnings.size(); i++)
+                                {
+                                    PrintBase::SlicingStatus& status = slicing_warnings[i];
+                                    if ((status.warning_step != -1) && (status.message_type != PrintStateBase::SlicingDefaultNotification))
+                                    {
+                                        sliced_plate_info.warning_message = status.text;
+
+                                        if (status.warning_level == PrintStateBase::WarningLevel::NON_CRITICAL) {
+                                            BOOST_LOG_TRIVIAL(warning) << "plate "<< index+1<< ": found NON_CRITICAL slicing warnings: "<<status.text <<std::endl;
+                                        }
+                                        else {
+                                            BOOST_LOG_TRIVIAL(warning) << boost::format("plate %1%: found slicing warnings: %2%, no_check=%3%")%(index+1) %status.text %no_check;
+                                            if (!no_check) {
+                                                //only following message will be reported under import mode
+                                                if (status.message_type == PrintStateBase::SlicingEmptyGcodeLayers
+                                                    || status.message_type == PrintStateBase::SlicingGcodeOverlap)
+                                                {
+                                                    job.error = CLI_SLICING_ERROR;
+                                                    job.error_with_plate_info = true;
+                                                    return;
+                                                }
+                                            }
+                                        }
+                                    }
+                                }
+                                slicing_warnings.clear();
+                            }
+                            sliced_plate_info.triangle_count = plate_triangle_counts[index];
+
+                            // The outfile is processed by a PlaceholderParser.
+                            //outfile = part_plate->get_tmp_gcode_path();
+                            if (outfile_dir.empty()) {
+                                outfile = job.part_plate->get_tmp_gcode_path();
+                            }
+                            else {
+                                outfile = outfile_dir + "/plate_" + std::to_string(index + 1) + ".gcode";
+                                job.part_plate->set_tmp_gcode_path(outfile);
+                            }
+                            BOOST_LOG_TRIVIAL(info) << "process finished, will export gcode temporily to " << outfile << std::endl;
+                            temp_time = (long long)Slic3r::Utils::get_current_time_utc();
+                            outfile = print_fff->export_gcode(outfile, job.gcode_result, nullptr);
+                            if (! outfile_dir.empty())
+                                job.gcode_file = outfile;
+                            time_using_cache = time_using_cache + ((long long)Slic3r::Utils::get_current_time_utc() - temp_time);
+                            BOOST_LOG_TRIVIAL(info) << "export_gcode finished: time_using_cache update to " << time_using_cache << " secs.";
+                        }
+                        // Run the post-processing scripts if defined.
+                        //run_post_process_scripts(outfile, print->full_print_config());
+                        BOOST_LOG_TRIVIAL(info) << "Slicing result exported to " << outfile << std::endl;
+                        job.part_plate->update_slice_result_valid_state(true);
+#if defined(__linux__) || defined(__LINUX__)
+                        if (! slice_in_parallel && g_cli_callback_mgr.is_started()) {
+                            PrintBase::SlicingStatus slicing_status{100, "Slicing finished"};
+                            cli_status_callback(slicing_status);
+                        }
+#endif
+                        if (export_slicedata) {
+                            BOOST_LOG_TRIVIAL(info) << "plate "<< index+1<< ":will export Slicing data to " << export_slice_data_dir;
+                            std::string plate_dir = export_slice_data_dir+"/"+std::to_string(index+1);
+                            bool with_space = (get_logging_level() >= 4)?true:false;
+                            int ret = print->export_cached_data(plate_dir, with_space);
+                            if (ret) {
+                                BOOST_LOG_TRIVIAL(error) << "plate "<< index+1<< ": export Slicing data error, ret=" << ret;
+                                if (fs::exists(plate_dir))
+                                    fs::remove_all(plate_dir);
+                                job.error = ret;
+                                return;
+                            }
+                        }
+                        end_time = (long long)Slic3r::Utils::get_current_time_utc();
+                        sliced_plate_info.sliced_time = end_time - job.start_time;
+                        sliced_plate_info.sliced_time_with_cache = time_using_cache;
+
+                        if (max_slicing_time_per_plate != 0) {
+                            long long time_cost = end_time - job.start_time;
+                            if (time_cost > max_slicing_time_per_plate) {
+                                sliced_plate_info.warning_message = (boost::format("plate %1%'s slice time %2% exceeds the limit %3%, return error.")%(index+1) %time_cost %max_slicing_time_per_plate).str();
+                                BOOST_LOG_TRIVIAL(error) << sliced_plate_info.warning_message;
+                                job.error = CLI_SLICING_TIME_EXCEEDS_LIMIT;
+                                job.error_with_plate_info = true;
+                                return;
+                            }
+                        }
+                    } catch (const std::exception &ex) {
+                        job.error          = CLI_SLICING_ERROR;
+                        job.exception_text = ex.what();
+                    }
+                };
+
+                // Report the result of a sliced plate, returns the exit code of the plate, 0 on success.
+                auto report_plate = [&](PlateSlicingJob &job) -> int {
+                    if (job.error != 0) {
+                        if (! job.exception_text.empty()) {
+                            BOOST_LOG_TRIVIAL(error) << "found slicing or export error for partplate "<<job.index+1 << std::endl;
+                            boost::nowide::cerr << job.exception_text << std::endl;
+                        }
+                        if (job.error_with_plate_info)
+                            sliced_info.sliced_plates.push_back(job.sliced_plate_info);
+                        record_exit_reson(outfile_dir, job.error, job.index+1, cli_errors[job.error], sliced_info);
+                        return job.error;
+                    }
+#if defined(__linux__) || defined(__LINUX__)
+                    if (slice_in_parallel && g_cli_callback_mgr.is_started()) {
+                        g_cli_callback_mgr.set_plate_info(job.index+1, partplate_list.get_plate_count());
+                        PrintBase::SlicingStatus slicing_status{100, "Slicing finished"};
+                        cli_status_callback(slicing_status);
+                    }
+#endif
+                    sliced_info.sliced_plates.push_back(job.sliced_plate_info);
+                    if (! job.gcode_file.empty())
+                        g_exported_gcode_files.push_back(job.gcode_file);
+                    return 0;
+                };
+
                 while(!finished)
                 {
                     //BBS: slice every partplate one by one
@@ -4777,7 +5069,7 @@ int CLI::run(int argc, char **argv)
 
                         model.curr_plate_index = index;
                         BOOST_LOG_TRIVIAL(info) << boost::format("Plate %1%: pre_check %2%, start")%(index+1)%pre_check;
-                        long long start_time = 0, end_time = 0, temp_time = 0, time_using_cache = 0;
+                        long long start_time = 0;
                         start_time = (long long)Slic3r::Utils::get_current_time_utc();
                         //get the current partplate
                         Slic3r::GUI::PartPlate* part_plate = partplate_list.get_plate(index);
@@ -4945,23 +5237,31 @@ int CLI::run(int argc, char **argv)
                         else {
                             if (pre_check && (partplate_list.get_plate_count() > 1)) //continue to next plate directly
                                 continue;
-                            try {
-                                std::string outfile_final;
-                                BOOST_LOG_TRIVIAL(info) << "start Print::process for partplate "<<index+1 << std::endl;
+                            PlateSlicingJob &job = plate_jobs.emplace_back();
+                            job.index             = index;
+                            job.print             = print;
+                            job.gcode_result      = gcode_result;
+                            job.part_plate        = part_plate;
+                            job.warning           = warning.string;
+                            job.start_time        = start_time;
+                            job.sliced_plate_info = sliced_plate_info;
+                            if (slice_in_parallel) {
+                                // The plates are processed concurrently, collect the warnings of each plate separately.
+                                BOOST_LOG_TRIVIAL(info) << "set print's callback to collect the warnings of partplate " << index+1;
+                                print->set_status_callback([&plate_jobs, job_idx = plate_jobs.size() - 1](const PrintBase::SlicingStatus& slicing_status) {
+                                    PlateSlicingJob &job = plate_jobs[job_idx];
+                                    if (slicing_status.warning_step != -1)
+                                        job.slicing_warnings.push_back(slicing_status);
+                                    BOOST_LOG_TRIVIAL(debug) << boost::format("plate %1%: percent=%2%, warning_step=%3%, message=%4%, message_type=%5%")
+                                        %(job.index+1) %slicing_status.percent %slicing_status.warning_step %slicing_status.text %(int)(slicing_status.message_type);
+                                });
+                            }
+                            else {
 #if defined(__linux__) || defined(__LINUX__)
                                 BOOST_LOG_TRIVIAL(info) << "cli callback mgr started:  "<<g_cli_callback_mgr.m_started << std::endl;
                                 if (g_cli_callback_mgr.is_started()) {
                                     BOOST_LOG_TRIVIAL(info) << "set print's callback to cli_status_callback.";
                                     print->set_status_callback(cli_status_callback);
-                                    g_cli_callback_mgr.set_plate_info(index+1, (plate_to_slice== 0)?partplate_list.get_plate_count():1);
-                                    if (!warning.string.empty()) {
-                                        PrintBase::SlicingStatus slicing_status{4, warning.string, 0, 0};
-                                        cli_status_callback(slicing_status);
-                                    }
-                                    else {
-                                        PrintBase::SlicingStatus slicing_status{4, "Slicing begins"};
-                                        cli_status_callback(slicing_status);
-                                    }
                                 }
                                 else {
                                     BOOST_LOG_TRIVIAL(info) << "set print's callback to default_status_callback.";
@@ -4971,170 +5271,78 @@ int CLI::run(int argc, char **argv)
                                 BOOST_LOG_TRIVIAL(info) << "set print's callback to default_status_callback.";
                                 print->set_status_callback(default_status_callback);
 #endif
-                                //check whether it is bbl printer
-                                std::string& printer_model_string = new_print_config.opt_string("printer_model", true);
-                                bool is_bbl_vendor_preset = false;
-
-                                if (!printer_model_string.empty()) {
-                                    is_bbl_vendor_preset = (printer_model_string.compare(0, 9, "Bambu Lab") == 0);
-                                    BOOST_LOG_TRIVIAL(info) << boost::format("printer_model_string: %1%, is_bbl_vendor_preset %2%")%printer_model_string %is_bbl_vendor_preset;
-                                }
-                                else {
-                                    if (!new_printer_name.empty())
-                                        is_bbl_vendor_preset = (new_printer_name.compare(0, 9, "Bambu Lab") == 0);
-                                    else if (!current_printer_system_name.empty())
-                                        is_bbl_vendor_preset = (current_printer_system_name.compare(0, 9, "Bambu Lab") == 0);
-                                    BOOST_LOG_TRIVIAL(info) << boost::format("new_printer_name: %1%, current_printer_system_name %2%, is_bbl_vendor_preset %3%")%new_printer_name %current_printer_system_name %is_bbl_vendor_preset;
-                                }
-                                (dynamic_cast<Print*>(print))->is_BBL_printer() = is_bbl_vendor_preset;
-
-                                //update information for brim
-                                const PrintConfig& print_config = print_fff->config();
-                                Model::setExtruderParams(m_print_config, filament_count);
-                                Model::setPrintSpeedTable(m_print_config, print_config);
-                                if (load_slicedata) {
-                                    std::string plate_dir = load_slice_data_dir+"/"+std::to_string(index+1);
-                                    int ret = print->load_cached_data(plate_dir);
-                                    if (ret) {
-                                        BOOST_LOG_TRIVIAL(warning) << "plate "<< index+1<< ": load Slicing data error, ret=" << ret;
-                                        BOOST_LOG_TRIVIAL(warning) << "plate "<< index+1<< ": switch normal slicing";
-                                        print->process();
-                                    }
-                                    else {
-                                        BOOST_LOG_TRIVIAL(info) << "plate "<< index+1<< ": load cached data success, go on.";
-#if defined(__linux__) || defined(__LINUX__)
-                                        if (g_cli_callback_mgr.is_started()) {
-                                            PrintBase::SlicingStatus slicing_status{69, "Cache data loaded"};
-                                            cli_status_callback(slicing_status);
-                                        }
-#endif
-                                        print->process(nullptr, true);
-                                        BOOST_LOG_TRIVIAL(info) << "plate "<< index+1<< ": finished print::process.";
-                                    }
-                                }
-                                else {
-                                    print->process(&time_using_cache);
-                                    BOOST_LOG_TRIVIAL(info) << "print::process: first time_using_cache is " << time_using_cache << " secs.";
-                                }
-                                if (printer_technology == ptFFF) {
-                                    std::string conflict_result = print_fff->get_conflict_string();
-                                    if (!conflict_result.empty()) {
-                                       BOOST_LOG_TRIVIAL(error) << "plate "<< index+1<< ": found slicing result conflict!"<< std::endl;
-                                       record_exit_reson(outfile_dir, CLI_GCODE_PATH_CONFLICTS, index+1, cli_errors[CLI_GCODE_PATH_CONFLICTS], sliced_info);
-                                       flush_and_exit(CLI_GCODE_PATH_CONFLICTS);
-                                    }
-
-                                    //check the warnings
-                                    if (!g_slicing_warnings.empty())
-                                    {
-                                        for (unsigned int i = 0; i < g_slicing_warnings.size(); i++)
-                                        {
-                                            PrintBase::SlicingStatus& status = g_slicing_warnings[i];
-                                            if ((status.warning_step != -1) && (status.message_type != PrintStateBase::SlicingDefaultNotification))
-                                            {
-                                                sliced_plate_info.warning_message = status.text;
-
-                                                if (status.warning_level == PrintStateBase::WarningLevel::NON_CRITICAL) {
-                                                    BOOST_LOG_TRIVIAL(warning) << "plate "<< index+1<< ": found NON_CRITICAL slicing warnings: "<<status.text <<std::endl;
-                                                }
-                                                else {
-                                                    BOOST_LOG_TRIVIAL(warning) << boost::format("plate %1%: found slicing warnings: %2%, no_check=%3%")%(index+1) %status.text %no_check;
-                                                    if (!no_check) {
-                                                        //only following message will be reported under import mode
-                                                        if (status.message_type == PrintStateBase::SlicingEmptyGcodeLayers
-                                                            || status.message_type == PrintStateBase::SlicingGcodeOverlap)
-                                                        {
-                                                            sliced_info.sliced_plates.push_back(sliced_plate_info);
-                                                            record_exit_reson(outfile_dir, CLI_SLICING_ERROR, index+1, cli_errors[CLI_SLICING_ERROR], sliced_info);
-                                                            flush_and_exit(CLI_SLICING_ERROR);
-                                                        }
-                                                    }
-                                                }
-                                            }
-                                        }
-                                        g_slicing_warnings.clear();
-                                    }
-                                    sliced_plate_info.triangle_count = plate_triangle_counts[index];
+                            }
+                            //check whether it is bbl printer
+                            std::string& printer_model_string = new_print_config.opt_string("printer_model", true);
+                            bool is_bbl_vendor_preset = false;
 
-                                    // The outfile is processed by a PlaceholderParser.
-                                    //outfile = part_plate->get_tmp_gcode_path();
-                                    if (outfile_dir.empty()) {
-                                        outfile = part_plate->get_tmp_gcode_path();
-                                    }
-                                    else {
-                                        outfile = outfile_dir + "/plate_" + std::to_string(index + 1) + ".gcode";
-                                        part_plate->set_tmp_gcode_path(outfile);
-                                    }
-                                    BOOST_LOG_TRIVIAL(info) << "process finished, will export gcode temporily to " << outfile << std::endl;
-                                    temp_time = (long long)Slic3r::Utils::get_current_time_utc();
-                                    outfile = print_fff->export_gcode(outfile, gcode_result, nullptr);
-                                    time_using_cache = time_using_cache + ((long long)Slic3r::Utils::get_current_time_utc() - temp_time);
-                                    BOOST_LOG_TRIVIAL(info) << "export_gcode finished: time_using_cache update to " << time_using_cache << " secs.";
-
-                                    //outfile_final = (dynamic_cast<Print*>(print))->print_statistics().finalize_output_path(outfile);
-                                    //m_fff_print->export_gcode(m_temp_output_path, m_gcode_result, [this](const ThumbnailsParams& params) { return this->render_thumbnails(params); });
-                                }/* else {
-                                    outfile = sla_print.output_filepath(outfile);
-                                    // We need to finalize the filename beforehand because the export function sets the filename inside the zip metadata
-                                    outfile_final = sla_print.print_statistics().finalize_output_path(outfile);
-                                    sla_archive.export_print(outfile_final, sla_print);
-                                }*/
-                                /*if (outfile != outfile_final) {
-                                    if (Slic3r::rename_file(outfile, outfile_final)) {
-                                        boost::nowide::cerr << "Renaming file " << outfile << " to " << outfile_final << " failed" << std::endl;
-                                        record_exit_reson(outfile_dir, 1, index+1, cli_errors[1], sliced_info);
-                                        flush_and_exit(1);
-                                    }
-                                    outfile = outfile_final;
-                                }*/
-                                // Run the post-processing scripts if defined.
-                                //run_post_process_scripts(outfile, print->full_print_config());
-                                BOOST_LOG_TRIVIAL(info) << "Slicing result exported to " << outfile << std::endl;
-                                part_plate->update_slice_result_valid_state(true);
-#if defined(__linux__) || defined(__LINUX__)
-                                if (g_cli_callback_mgr.is_started()) {
-                                    PrintBase::SlicingStatus slicing_status{100, "Slicing finished"};
-                                    cli_status_callback(slicing_status);
-                                }
-#endif
-                                if (export_slicedata) {
-                                    BOOST_LOG_TRIVIAL(info) << "plate "<< index+1<< ":will export Slicing data to " << export_slice_data_dir;
-                                    std::string plate_dir = export_slice_data_dir+"/"+std::to_string(index+1);
-                                    bool with_space = (get_logging_level() >= 4)?true:false;
-                                    int ret = print->export_cached_data(plate_dir, with_space);
-                                    if (ret) {
-                                        BOOST_LOG_TRIVIAL(error) << "plate "<< index+1<< ": export Slicing data error, ret=" << ret;
-                                        export_slicedata_error = true;
-                                        if (fs::exists(plate_dir))
-                                            fs::remove_all(plate_dir);
-                                        record_exit_reson(outfile_dir, ret, index+1, cli_errors[ret], sliced_info);
-                                        flush_and_exit(ret);
-                                    }
-                                }
-                                end_time = (long long)Slic3r::Utils::get_current_time_utc();
-                                sliced_plate_info.sliced_time = end_time - start_time;
-                                sliced_plate_info.sliced_time_with_cache = time_using_cache;
-
-                                if (max_slicing_time_per_plate != 0) {
-                                    long long time_cost = end_time - start_time;
-                                    if (time_cost > max_slicing_time_per_plate) {
-                                        sliced_plate_info.warning_message = (boost::format("plate %1%'s slice time %2% exceeds the limit %3%, return error.")%(index+1) %time_cost %max_slicing_time_per_plate).str();
-                                        BOOST_LOG_TRIVIAL(error) << sliced_plate_info.warning_message;
-                                        sliced_info.sliced_plates.push_back(sliced_plate_info);
-                                        record_exit_reson(outfile_dir, CLI_SLICING_TIME_EXCEEDS_LIMIT, index+1, cli_errors[CLI_SLICING_TIME_EXCEEDS_LIMIT], sliced_info);
-                                        flush_and_exit(CLI_SLICING_TIME_EXCEEDS_LIMIT);
-                                    }
-                                }
-                                sliced_info.sliced_plates.push_back(sliced_plate_info);
-                            } catch (const std::exception &ex) {
-                                BOOST_LOG_TRIVIAL(error) << "found slicing or export error for partplate "<<index+1 << std::endl;
-                                boost::nowide::cerr << ex.what() << std::endl;
-                                //continue;
-                                record_exit_reson(outfile_dir, CLI_SLICING_ERROR, index+1, cli_errors[CLI_SLICING_ERROR], sliced_info);
-                                flush_and_exit(CLI_SLICING_ERROR);
+                            if (!printer_model_string.empty()) {
+                                is_bbl_vendor_preset = (printer_model_string.compare(0, 9, "Bambu Lab") == 0);
+                                BOOST_LOG_TRIVIAL(info) << boost::format("printer_model_string: %1%, is_bbl_vendor_preset %2%")%printer_model_string %is_bbl_vendor_preset;
+                            }
+                            else {
+                                if (!new_printer_name.empty())
+                                    is_bbl_vendor_preset = (new_printer_name.compare(0, 9, "Bambu Lab") == 0);
+                                else if (!current_printer_system_name.empty())
+                                    is_bbl_vendor_preset = (current_printer_system_name.compare(0, 9, "Bambu Lab") == 0);
+                                BOOST_LOG_TRIVIAL(info) << boost::format("new_printer_name: %1%, current_printer_system_name %2%, is_bbl_vendor_preset %3%")%new_printer_name %current_printer_system_name %is_bbl_vendor_preset;
+                            }
+                            (dynamic_cast<Print*>(print))->is_BBL_printer() = is_bbl_vendor_preset;
+                            print_fff->set_slicing_result_cache_dir(m_config.opt_string("slicing_cache_dir", true));
+                            if (const ConfigOptionInt *opt_pipeline_tokens = m_config.opt<ConfigOptionInt>("gcode_pipeline_tokens"))
+                                print_fff->set_gcode_pipeline_max_tokens(size_t(std::max(opt_pipeline_tokens->value, 0)));
+                            if (const ConfigOptionInt *opt_pipeline_memory = m_config.opt<ConfigOptionInt>("gcode_pipeline_memory"))
+                                print_fff->set_gcode_pipeline_max_memory(size_t(std::max(opt_pipeline_memory->value, 0)) << 20);
+                            // Each object is sliced just once from the command line, don't keep the volume slices around.
+                            PrintObject::retain_volume_slices = false;
+
+                            //update information for brim
+                            const PrintConfig& print_config = print_fff->config();
+                            Model::setExtruderParams(m_print_config, filament_count);
+                            Model::setPrintSpeedTable(m_print_config, print_config);
+
+                            if (! slice_in_parallel) {
+                                // Slice and export the plate before the next plate is applied, thus the plates sliced
+                                // before a failing plate keep their G-code and their entries in the result JSON.
+                                slice_plate(job);
+                                int ret = report_plate(job);
+                                plate_jobs.clear();
+                                if (ret != 0)
+                                    flush_and_exit(ret);
                             }
                         }
                     }
+
+                    if (slice_in_parallel && ! plate_jobs.empty()) {
+                        // Slice up to parallel_plates plates at once. The plates are processed inside a single task arena,
+                        // thus the parallel loops of all the Prints share one pool of worker threads.
+                        BOOST_LOG_TRIVIAL(info) << "slicing " << plate_jobs.size() << " partplates, " << parallel_plates << " of them in parallel";
+                        // All the plates are sliced for the same printer, set the printer type before the plates are exported concurrently.
+                        GCodeProcessor::s_IsBBLPrinter = dynamic_cast<Print*>(plate_jobs.front().print)->is_BBL_printer();
+                        tbb::task_arena arena;
+                        arena.execute([&plate_jobs, &slice_plate, parallel_plates]() {
+                            size_t next_job = 0;
+                            tbb::parallel_pipeline(size_t(parallel_plates),
+                                tbb::make_filter<void, PlateSlicingJob*>(slic3r_tbb_filtermode::serial_in_order,
+                                    [&plate_jobs, &next_job](tbb::flow_control &fc) -> PlateSlicingJob* {
+                                        if (next_job == plate_jobs.size()) {
+                                            fc.stop();
+                                            return nullptr;
+                                        }
+                                        return &plate_jobs[next_job ++];
+                                    }) &
+                                tbb::make_filter<PlateSlicingJob*, void>(slic3r_tbb_filtermode::parallel,
+                                    [&slice_plate](PlateSlicingJob *job) { slice_plate(*job); }));
+                        });
+                        // The callbacks collecting the warnings refer to plate_jobs.
+                        for (PlateSlicingJob &job : plate_jobs)
+                            job.print->set_status_callback(default_status_callback);
+                        // Report the results in the order of the plates, the result JSON is the same as if sliced one by one.
+                        for (PlateSlicingJob &job : plate_jobs)
+                            if (int ret = report_plate(job); ret != 0)
+                                flush_and_exit(ret);
+                        plate_jobs.clear();
+                    }
                     if (pre_check&& (partplate_list.get_plate_count() > 1))
                         pre_check = false;
                     else
@@ -5921,6 +6129,8 @@ int CLI::run(int argc, char **argv)
     for (Model &model : m_models) {
 	model.remove_backup_path_if_exist();
     }
+    if (! trace_file.empty())
+        Trace::export_chrome_trace(trace_file);
     //BBS: flush logs
     BOOST_LOG_TRIVIAL(info) << __FUNCTION__ << ", Finished" << std::endl;
     global_current_time = (long long)Slic3r::Utils::get_current_time_utc();
@@ -5942,6 +6152,139 @@ int CLI::run(int argc, char **argv)
     return 0;
 }
 
+// Slicing daemon: the jobs are read from stdin, one JSON object per line, for example
+//   {"id": 1, "files": ["/tmp/model.3mf"], "outputdir": "/tmp/out", "slice": 0,
+//    "load_settings": ["machine.json", "process.json"], "load_filaments": ["filament.json"],
+//    "overrides": {"layer_height": 0.16}, "args": ["--min_save"]}
+// Each job is executed as if OrcaSlicer was started with the equivalent command line, but the process stays alive,
+// thus the configuration definitions, the TBB worker threads and the loaded setting files (including the inherited
+// system presets) are reused by the following jobs. A single line with a JSON object is written to stdout for each job:
+//   {"id": 1, "return_code": 0, "elapsed_time": 1.25, "gcode_files": ["/tmp/out/plate_1.gcode"], "result": {...}}
+// where "gcode_files" are the plates exported into the output directory and "result" is the content of result.json
+// written by the job. Nothing else is written to stdout, the other output of the process is redirected to stderr.
+// {"command": "exit"} or end of the input stops the daemon.
+int CLI::run_daemon()
+{
+    BOOST_LOG_TRIVIAL(warning) << boost::format("slicing daemon started, Current OrcaSlicer Version %1%")%SLIC3R_VERSION;
+    g_cache_setting_files = true;
+
+    // Keep stdout for the responses only, the jobs print their progress and errors to stdout.
+    boost::nowide::cout.flush();
+    fflush(stdout);
+#ifdef WIN32
+    int   response_fd = _dup(_fileno(stdout));
+    FILE *responses   = response_fd == -1 || _dup2(_fileno(stderr), _fileno(stdout)) == -1 ? nullptr : _fdopen(response_fd, "w");
+#else
+    int   response_fd = dup(STDOUT_FILENO);
+    FILE *responses   = response_fd == -1 || dup2(STDERR_FILENO, STDOUT_FILENO) == -1 ? nullptr : fdopen(response_fd, "w");
+#endif
+    if (responses == nullptr) {
+        BOOST_LOG_TRIVIAL(error) << "slicing daemon: can not redirect stdout, reason = " << std::strerror(errno);
+        return CLI_ENVIRONMENT_ERROR;
+    }
+
+    auto write_response = [responses](const json &response) {
+        std::string line = response.dump();
+        line += '\n';
+        fwrite(line.data(), 1, line.size(), responses);
+        fflush(responses);
+    };
+
+    std::string line;
+    while (std::getline(boost::nowide::cin, line)) {
+        if (line.find_first_not_of(" \t\r") == std::string::npos)
+            continue;
+        json request;
+        json response;
+        std::vector<std::string> args { "orca-slicer" };
+        std::string outputdir;
+        try {
+            request = json::parse(line);
+            if (request.contains("id"))
+                response["id"] = request["id"];
+            if (request.value("command", std::string("slice")) == "exit")
+                break;
+            outputdir = request.value("outputdir", std::string());
+            args.emplace_back("--slice=" + std::to_string(request.value("slice", 0)));
+            if (! outputdir.empty())
+                args.emplace_back("--outputdir=" + outputdir);
+            for (const char *key : { "load_settings", "load_filaments" })
+                if (request.contains(key))
+                    args.emplace_back(std::string("--") + key + "=" + boost::algorithm::join(request[key].get<std::vector<std::string>>(), ";"));
+            if (request.contains("overrides"))
+                for (auto &item : request["overrides"].items()) {
+                    const json &value = item.value();
+                    args.emplace_back("--" + item.key() + "=" +
+                        (value.is_string() ? value.get<std::string>() : value.is_boolean() ? std::string(value.get<bool>() ? "1" : "0") : value.dump()));
+                }
+            if (request.contains("args"))
+                for (const std::string &arg : request["args"].get<std::vector<std::string>>())
+                    args.emplace_back(arg);
+            if (request.contains("file"))
+                args.emplace_back(request["file"].get<std::string>());
+            if (request.contains("files"))
+                for (const std::string &file : request["files"].get<std::vector<std::string>>())
+                    args.emplace_back(file);
+            // A job runs in this process, it can not start another daemon.
+            for (const std::string &arg : args) {
+                size_t start = arg.find_first_not_of('-');
+                if (start != 0 && start != std::string::npos && arg.substr(start, arg.find('=') - start) == "daemon")
+                    throw std::invalid_argument("--daemon is not allowed in a job");
+            }
+        } catch (const std::exception &ex) {
+            BOOST_LOG_TRIVIAL(error) << "slicing daemon: invalid job " << line << ", reason = " << ex.what();
+            response["return_code"]  = CLI_INVALID_PARAMS;
+            response["error_string"] = ex.what();
+            write_response(response);
+            continue;
+        }
+
+        BOOST_LOG_TRIVIAL(info) << "slicing daemon: start job " << line;
+        std::vector<char*> argv;
+        for (std::string &arg : args)
+            argv.emplace_back(arg.data());
+        argv.emplace_back(nullptr);
+        g_slicing_warnings.clear();
+        g_exported_gcode_files.clear();
+        // Remove the result of the previous job, so that a job failing before writing its result does not report a stale one.
+        const boost::filesystem::path dir = outputdir.empty() ? boost::filesystem::current_path() : boost::filesystem::path(outputdir);
+        const boost::filesystem::path result_file = dir / "result.json";
+        boost::system::error_code ec;
+        boost::filesystem::remove(result_file, ec);
+        if (ec)
+            BOOST_LOG_TRIVIAL(error) << "slicing daemon: can not remove " << result_file.string() << ", reason = " << ec.message();
+        const auto  start_time = std::chrono::steady_clock::now();
+        int         ret;
+        try {
+            ret = CLI().run(int(args.size()), argv.data());
+        } catch (const std::exception &ex) {
+            BOOST_LOG_TRIVIAL(error) << "slicing daemon: job failed, reason = " << ex.what();
+            ret = CLI_SLICING_ERROR;
+            response["error_string"] = ex.what();
+        }
+        // The spans are exported by the job itself if it was asked to.
+        Trace::enable(false);
+        Trace::clear();
+        response["return_code"]  = ret;
+        response["elapsed_time"] = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+        response["gcode_files"]  = g_exported_gcode_files;
+
+        if (boost::filesystem::exists(result_file, ec)) {
+            try {
+                boost::nowide::ifstream ifs(result_file.string());
+                response["result"] = json::parse(ifs);
+            } catch (const std::exception &ex) {
+                BOOST_LOG_TRIVIAL(error) << "slicing daemon: can not parse " << result_file.string() << ", reason = " << ex.what();
+            }
+        }
+        write_response(response);
+        BOOST_LOG_TRIVIAL(info) << "slicing daemon: finished job, return code " << ret;
+    }
+    fclose(responses);
+    BOOST_LOG_TRIVIAL(warning) << "slicing daemon stopped";
+    return 0;
+}
+
 bool CLI::setup(int argc, char **argv)
 {
     // Detect the operating system flavor after SLIC3R_LOGLEVEL is set.
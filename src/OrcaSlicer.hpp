@@ -111,6 +111,8 @@ private:
     std::vector<Model>          m_models;
 
     bool setup(int argc, char **argv);
+    /// Runs the slicing jobs read from stdin until the end of the input, see the definition for the protocol.
+    int run_daemon();
 
     /// Prints usage of the CLI.
     void print_help(bool include_print_options = false, PrinterTechnology printer_technology = ptAny) const;
@@ -252,6 +252,9 @@ struct indexed_triangle_set
 };
 
 extern bool stl_open(stl_file *stl, const char *file, ImportstlProgressFn stlFn = nullptr,int custom_header_length = 80);
+// Read an STL file into an indexed triangle set without the stl_file facets, thus without any repair.
+// Vertices with the same coordinates are merged.
+extern bool its_read_stl(indexed_triangle_set &its, const char *file, ImportstlProgressFn stlFn = nullptr, int custom_header_length = 80);
 extern void stl_stats_out(stl_file *stl, FILE *file, char *input_file);
 extern bool stl_print_neighbors(stl_file *stl, char *file);
 extern bool stl_write_ascii(stl_file *stl, const char *file, const char *label);
@@ -26,10 +26,20 @@
 #include <math.h>
 #include <assert.h>
 
+#include <algorithm>
+#include <limits>
+
+#include <boost/filesystem/path.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
 #include <boost/log/trivial.hpp>
 #include <boost/nowide/cstdio.hpp>
 #include <boost/predef/other/endian.h>
 
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_reduce.h>
+#include <tbb/parallel_sort.h>
+
 #include "stl.h"
 #include "libslic3r/Format/STL.hpp"
 
@@ -148,18 +158,12 @@ static FILE *stl_open_count_facets(stl_file *stl, const char *file, unsigned int
   	return fp;
 }
 
-/* Reads the contents of the file pointed to by fp into the stl structure,
+/* Reads the contents of the ASCII file pointed to by fp into the stl structure,
    starting at facet first_facet.  The second argument says if it's our first
    time running this for the stl and therefore we should reset our max and min stats. */
-static bool stl_read(stl_file *stl, FILE *fp, int first_facet, bool first, ImportstlProgressFn stlFn, int custom_header_length)
+static bool stl_read(stl_file *stl, FILE *fp, int first_facet, bool first, ImportstlProgressFn stlFn)
 {
-    if (stl->stats.type == binary) {
-        int header_size = custom_header_length + NUM_FACET_SIZE;
-        fseek(fp, header_size, SEEK_SET);
-        model_id = "";
-        country_code = "";
-    }
-	else {
+	{
         rewind(fp);
         try{
             char solid_name[256];
@@ -212,19 +216,7 @@ static bool stl_read(stl_file *stl, FILE *fp, int first_facet, bool first, Impor
 
   	  	stl_facet facet;
 
-    	if (stl->stats.type == binary) {
-  
-
-      		// Read a single facet from a binary .STL file. We assume little-endian architecture!
-      		if (fread(&facet, 1, SIZEOF_STL_FACET, fp) != SIZEOF_STL_FACET)
-      			return false;
-
-
-#if BOOST_ENDIAN_BIG_BYTE
-      		// Convert the loaded little endian data to big endian.
-      		stl_internal_reverse_quads((char*)&facet, 48);
-#endif /* BOOST_ENDIAN_BIG_BYTE */
-    	} else {
+    	{
 			// Read a single facet from an ASCII .STL file
 			// skip solid/endsolid
 			// (in this order, otherwise it won't work when they are paired in the middle of a file)
@@ -302,6 +294,120 @@ static bool stl_read(stl_file *stl, FILE *fp, int first_facet, bool first, Impor
   	return true;
 }
 
+static bool stl_map_file(boost::iostreams::mapped_file_source &mapped, const char *file)
+{
+    try {
+        mapped.open(boost::filesystem::path(file));
+    } catch (const std::exception &ex) {
+        BOOST_LOG_TRIVIAL(error) << "stl_map_file: Couldn't map " << file << " into memory: " << ex.what();
+        return false;
+    }
+    return true;
+}
+
+// Read a single facet from a binary .STL file. Returns false if any of the vertices is NAN.
+static inline bool stl_read_binary_facet(const char *data, stl_facet &facet)
+{
+    memcpy(&facet, data, SIZEOF_STL_FACET);
+#if BOOST_ENDIAN_BIG_BYTE
+    // Convert the loaded little endian data to big endian.
+    stl_internal_reverse_quads((char*)&facet, 48);
+#endif /* BOOST_ENDIAN_BIG_BYTE */
+    for (const stl_vertex &v : facet.vertex)
+        if (isnan(v(0)) || isnan(v(1)) || isnan(v(2)))
+            return false;
+    return true;
+}
+
+// Process the facets in LOAD_STL_UNIT_NUM steps, the progress is reported before each step.
+// Returns false if the loading was canceled.
+template<typename StepFn>
+static bool stl_for_each_load_step(uint32_t facets_num, ImportstlProgressFn stlFn, StepFn step)
+{
+    uint32_t unit = facets_num / LOAD_STL_UNIT_NUM + 1;
+    for (uint32_t begin = 0; begin < facets_num; begin += unit) {
+        if (stlFn) {
+            bool cb_cancel = false;
+            stlFn(begin, facets_num, cb_cancel, model_id, country_code);
+            if (cb_cancel)
+                return false;
+        }
+        step(tbb::blocked_range<uint32_t>(begin, std::min(facets_num, begin + unit)));
+    }
+    return true;
+}
+
+// Reads the facets of a binary file into the stl structure. The file is memory mapped and the facets are converted in parallel.
+static bool stl_read_binary(stl_file *stl, const char *file, ImportstlProgressFn stlFn, int custom_header_length)
+{
+    model_id = "";
+    country_code = "";
+
+    boost::iostreams::mapped_file_source mapped;
+    if (! stl_map_file(mapped, file))
+        return false;
+    const char *data = mapped.data() + custom_header_length + NUM_FACET_SIZE;
+
+    // Bounding box of the facets read, the shortest edge statistics is taken from the first facet as stl_facet_stats() does.
+    struct FacetStats {
+        uint32_t   first_facet { std::numeric_limits<uint32_t>::max() };
+        stl_vertex min;
+        stl_vertex max;
+
+        bool empty() const { return first_facet == std::numeric_limits<uint32_t>::max(); }
+        void add(uint32_t facet_idx, const stl_facet &facet) {
+            if (this->empty()) {
+                first_facet = facet_idx;
+                min = max = facet.vertex[0];
+            }
+            for (const stl_vertex &v : facet.vertex) {
+                min = min.cwiseMin(v);
+                max = max.cwiseMax(v);
+            }
+        }
+        void merge(const FacetStats &rhs) {
+            if (rhs.empty())
+                return;
+            if (this->empty())
+                *this = rhs;
+            else {
+                first_facet = std::min(first_facet, rhs.first_facet);
+                min = min.cwiseMin(rhs.min);
+                max = max.cwiseMax(rhs.max);
+            }
+        }
+    };
+
+    FacetStats stats;
+    if (! stl_for_each_load_step(stl->stats.number_of_facets, stlFn, [stl, data, &stats](const tbb::blocked_range<uint32_t> &step) {
+            stats.merge(tbb::parallel_reduce(step, FacetStats(),
+                [stl, data](const tbb::blocked_range<uint32_t> &range, FacetStats stats) {
+                    for (uint32_t i = range.begin(); i < range.end(); ++ i) {
+                        stl_facet facet;
+                        // Write the facet into memory if none of facet vertices is NAN.
+                        if (stl_read_binary_facet(data + size_t(i) * SIZEOF_STL_FACET, facet)) {
+                            stl->facet_start[i] = facet;
+                            stats.add(i, facet);
+                        }
+                    }
+                    return stats;
+                },
+                [](FacetStats lhs, const FacetStats &rhs) { lhs.merge(rhs); return lhs; }));
+        }))
+        return false;
+
+    if (! stats.empty()) {
+        const stl_facet &first = stl->facet_start[stats.first_facet];
+        stl_vertex       diff  = (first.vertex[1] - first.vertex[0]).cwiseAbs();
+        stl->stats.shortest_edge = std::max(diff(0), std::max(diff(1), diff(2)));
+        stl->stats.min = stats.min;
+        stl->stats.max = stats.max;
+    }
+  	stl->stats.size = stl->stats.max - stl->stats.min;
+  	stl->stats.bounding_diameter = stl->stats.size.norm();
+  	return true;
+}
+
 bool stl_open(stl_file *stl, const char *file, ImportstlProgressFn stlFn, int custom_header_length)
 {
     if (custom_header_length < LABEL_SIZE) { 
@@ -314,11 +420,97 @@ bool stl_open(stl_file *stl, const char *file, ImportstlProgressFn stlFn, int cu
 	if (fp == nullptr)
 		return false;
 	stl_allocate(stl);
-    bool result = stl_read(stl, fp, 0, true, stlFn, custom_header_length);
-  	fclose(fp);
+    bool result;
+    if (stl->stats.type == binary) {
+        fclose(fp);
+        result = stl_read_binary(stl, file, stlFn, custom_header_length);
+    } else {
+        result = stl_read(stl, fp, 0, true, stlFn);
+        fclose(fp);
+    }
   	return result;
 }
 
+bool its_read_stl(indexed_triangle_set &its, const char *file, ImportstlProgressFn stlFn, int custom_header_length)
+{
+    if (custom_header_length < LABEL_SIZE)
+        custom_header_length = LABEL_SIZE;
+    Slic3r::CNumericLocalesSetter locales_setter;
+    stl_file stl;
+    stl.stats.reset_header(custom_header_length);
+    FILE *fp = stl_open_count_facets(&stl, file, custom_header_length);
+    if (fp == nullptr)
+        return false;
+
+    // Vertices of the facets, three per facet. Facets with NAN vertices are left zero as stl_open() does.
+    struct Corner {
+        stl_vertex vertex;
+        uint32_t   idx;
+    };
+    const uint32_t      facets_num = stl.stats.number_of_facets;
+    std::vector<Corner> corners(size_t(facets_num) * 3);
+    auto                set_facet = [&corners](uint32_t facet_idx, const stl_vertex *vertices) {
+        for (uint32_t j = 0; j < 3; ++ j)
+            corners[size_t(facet_idx) * 3 + j] = { vertices[j], facet_idx * 3 + j };
+    };
+    if (stl.stats.type == binary) {
+        fclose(fp);
+        model_id = "";
+        country_code = "";
+        boost::iostreams::mapped_file_source mapped;
+        if (! stl_map_file(mapped, file))
+            return false;
+        const char *data = mapped.data() + custom_header_length + NUM_FACET_SIZE;
+        if (! stl_for_each_load_step(facets_num, stlFn, [data, &set_facet](const tbb::blocked_range<uint32_t> &step) {
+                tbb::parallel_for(step, [data, &set_facet](const tbb::blocked_range<uint32_t> &range) {
+                    const stl_vertex zero[3] = { stl_vertex::Zero(), stl_vertex::Zero(), stl_vertex::Zero() };
+                    for (uint32_t i = range.begin(); i < range.end(); ++ i) {
+                        stl_facet facet;
+                        set_facet(i, stl_read_binary_facet(data + size_t(i) * SIZEOF_STL_FACET, facet) ? facet.vertex : zero);
+                    }
+                });
+            }))
+            return false;
+    } else {
+        stl_allocate(&stl);
+        bool result = stl_read(&stl, fp, 0, true, stlFn);
+        fclose(fp);
+        if (! result)
+            return false;
+        for (uint32_t i = 0; i < facets_num; ++ i)
+            set_facet(i, stl.facet_start[i].vertex);
+        stl.clear();
+    }
+
+    // Sort the corners by their coordinates, thus the corners to be merged into a single vertex are consecutive.
+    tbb::parallel_sort(corners.begin(), corners.end(), [](const Corner &l, const Corner &r) {
+        return l.vertex.x() < r.vertex.x() || (l.vertex.x() == r.vertex.x() &&
+              (l.vertex.y() < r.vertex.y() || (l.vertex.y() == r.vertex.y() && l.vertex.z() < r.vertex.z())));
+    });
+    std::vector<stl_vertex> unique_vertices;
+    std::vector<uint32_t>   corner_vertex(corners.size());
+    for (size_t i = 0; i < corners.size(); ++ i) {
+        if (i == 0 || corners[i].vertex != corners[i - 1].vertex)
+            unique_vertices.emplace_back(corners[i].vertex);
+        corner_vertex[corners[i].idx] = uint32_t(unique_vertices.size() - 1);
+    }
+    corners = std::vector<Corner>();
+    // Number the shared vertices in the order of their first use.
+    std::vector<int> vertex_idx(unique_vertices.size(), -1);
+    its.vertices.clear();
+    its.vertices.reserve(unique_vertices.size());
+    its.indices.assign(facets_num, stl_triangle_vertex_indices(-1, -1, -1));
+    for (size_t i = 0; i < corner_vertex.size(); ++ i) {
+        int &idx = vertex_idx[corner_vertex[i]];
+        if (idx == -1) {
+            idx = int(its.vertices.size());
+            its.vertices.emplace_back(unique_vertices[corner_vertex[i]]);
+        }
+        its.indices[i / 3][i % 3] = idx;
+    }
+    return true;
+}
+
 void stl_allocate(stl_file *stl)
 {
   	//  Allocate memory for the entire .STL file.
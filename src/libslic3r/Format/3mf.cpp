@@ -12,6 +12,7 @@
 #include "../I18N.hpp"
 
 #include "3mf.hpp"
+#include "3mf_mesh_parser.hpp"
 
 #include <limits>
 #include <stdexcept>
@@ -526,6 +527,8 @@ ModelVolumeType type_from_string(const std::string &s)
         unsigned int m_mm_painting_version           = 0;
 
         XML_Parser m_xml_parser;
+        // Parses the vertices and triangles of the model file bypassing the expat callbacks.
+        MeshXMLStreamParser m_mesh_parser;
         // Error code returned by the application side of the parser. In that case the expat may not reliably deliver the error state
         // after returning from XML_Parse() function, thus we keep the error state here.
         bool m_parse_error { false };
@@ -970,6 +973,7 @@ ModelVolumeType type_from_string(const std::string &s)
         XML_SetUserData(m_xml_parser, (void*)this);
         XML_SetElementHandler(m_xml_parser, _3MF_Importer::_handle_start_model_xml_element, _3MF_Importer::_handle_end_model_xml_element);
         XML_SetCharacterDataHandler(m_xml_parser, _3MF_Importer::_handle_model_xml_characters);
+        m_mesh_parser.reset(m_xml_parser);
 
         struct CallbackData
         {
@@ -988,7 +992,7 @@ ModelVolumeType type_from_string(const std::string &s)
         {
             res = mz_zip_reader_extract_file_to_callback(&archive, stat.m_filename, [](void* pOpaque, mz_uint64 file_ofs, const void* pBuf, size_t n)->size_t {
                 CallbackData* data = (CallbackData*)pOpaque;
-                if (!XML_Parse(data->parser, (const char*)pBuf, (int)n, (file_ofs + n == data->stat.m_uncomp_size) ? 1 : 0) || data->importer.parse_error()) {
+                if (!data->importer.m_mesh_parser.parse((const char*)pBuf, n, file_ofs + n == data->stat.m_uncomp_size) || data->importer.parse_error()) {
                     char error_buf[1024];
                     ::sprintf(error_buf, "Error (%s) while parsing '%s' at line %d", data->importer.parse_error_message(), data->stat.m_filename, (int)XML_GetCurrentLineNumber(data->parser));
                     throw Slic3r::FileIOError(error_buf);
@@ -1682,6 +1686,7 @@ ModelVolumeType type_from_string(const std::string &s)
     {
         // reset current vertices
         m_curr_object.geometry.vertices.clear();
+        m_mesh_parser.parse_vertices(m_curr_object.geometry.vertices, m_unit_factor);
         return true;
     }
 
@@ -1712,6 +1717,10 @@ ModelVolumeType type_from_string(const std::string &s)
     {
         // reset current triangles
         m_curr_object.geometry.triangles.clear();
+        m_mesh_parser.parse_triangles(m_curr_object.geometry.triangles, {
+            { CUSTOM_SUPPORTS_ATTR,  &m_curr_object.geometry.custom_supports },
+            { CUSTOM_SEAM_ATTR,      &m_curr_object.geometry.custom_seam },
+            { MMU_SEGMENTATION_ATTR, &m_curr_object.geometry.mmu_segmentation } });
         return true;
     }
 
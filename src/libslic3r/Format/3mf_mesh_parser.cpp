@@ -0,0 +1,278 @@
+#include "3mf_mesh_parser.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <optional>
+#include <type_traits>
+
+#include <fast_float/fast_float.h>
+
+namespace Slic3r {
+
+namespace {
+
+static constexpr const std::string_view VERTICES_START  = "<vertices";
+static constexpr const std::string_view TRIANGLES_START = "<triangles";
+static constexpr const std::string_view VERTEX_START    = "<vertex";
+static constexpr const std::string_view TRIANGLE_START  = "<triangle";
+
+inline bool is_space(char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; }
+
+inline const char* skip_spaces(const char *ptr, const char *end)
+{
+    while (ptr != end && is_space(*ptr))
+        ++ ptr;
+    return ptr;
+}
+
+// Does [begin, end) start with the tag name followed by a space or the end of the tag?
+// Returns nullopt if there is not enough data to decide.
+inline std::optional<bool> starts_with_tag(const char *begin, const char *end, const std::string_view tag)
+{
+    if (size_t(end - begin) <= tag.size())
+        return std::string_view(begin, end - begin) == tag.substr(0, end - begin) ? std::nullopt : std::make_optional(false);
+    const char c = begin[tag.size()];
+    return std::string_view(begin, tag.size()) == tag && (is_space(c) || c == '>' || c == '/');
+}
+
+// Attribute values to be converted by expat: entity and character references, white space normalized to spaces.
+inline bool needs_normalization(const char *begin, const char *end)
+{
+    for (const char *c = begin; c != end; ++ c)
+        if (*c == '&' || *c == '<' || *c == '\t' || *c == '\n' || *c == '\r')
+            return true;
+    return false;
+}
+
+template<typename T>
+inline bool parse_number(const char *begin, const char *end, T &value)
+{
+    if constexpr (std::is_floating_point_v<T>) {
+        auto [ptr, ec] = fast_float::from_chars(begin, end, value);
+        return ec == std::errc() && ptr == end;
+    } else {
+        auto [ptr, ec] = std::from_chars(begin, end, value);
+        return ec == std::errc() && ptr == end;
+    }
+}
+
+} // anonymous namespace
+
+void MeshXMLStreamParser::reset(XML_Parser parser)
+{
+    m_parser  = parser;
+    m_failed  = false;
+    m_section = Section::None;
+    m_fed_bytes = 0;
+    m_armed_tag = -1;
+    m_pending.clear();
+    m_vertices  = nullptr;
+    m_triangles = nullptr;
+    m_triangle_attributes.clear();
+}
+
+void MeshXMLStreamParser::parse_vertices(std::vector<Vec3f> &vertices, float unit_factor)
+{
+    if (! this->armed())
+        return;
+    m_section     = Section::Vertices;
+    m_vertices    = &vertices;
+    m_unit_factor = unit_factor;
+}
+
+void MeshXMLStreamParser::parse_triangles(std::vector<Vec3i32> &triangles, std::vector<TriangleAttribute> attributes)
+{
+    if (! this->armed())
+        return;
+    m_section             = Section::Triangles;
+    m_triangles           = &triangles;
+    m_triangle_attributes = std::move(attributes);
+    m_attribute_values.assign(m_triangle_attributes.size(), std::string_view());
+}
+
+bool MeshXMLStreamParser::armed() const
+{
+    // Expat may report a start tag later than it was fed (reparse deferral since expat 2.6), at which point the stream
+    // is no longer positioned right after the tag.
+    return m_armed_tag >= 0 && XML_GetCurrentByteIndex(m_parser) == m_armed_tag;
+}
+
+bool MeshXMLStreamParser::feed(const char *begin, const char *end, bool is_final)
+{
+    if (! m_failed && (begin != end || is_final)) {
+        if (XML_Parse(m_parser, begin, int(end - begin), is_final ? 1 : 0) == XML_STATUS_ERROR)
+            m_failed = true;
+        m_fed_bytes += XML_Index(end - begin);
+    }
+    return ! m_failed;
+}
+
+bool MeshXMLStreamParser::parse(const char *data, size_t size, bool is_final)
+{
+    const bool  use_pending = ! m_pending.empty();
+    if (use_pending)
+        m_pending.append(data, size);
+    const char *begin = use_pending ? m_pending.data() : data;
+    const char *end   = begin + (use_pending ? m_pending.size() : size);
+    const char *ptr   = begin;
+    while (! m_failed) {
+        const Section section = m_section;
+        const char   *next    = section == Section::None ? this->parse_xml(ptr, end, is_final) : this->parse_section(ptr, end, is_final);
+        if (next == ptr && m_section == section)
+            // More data is needed.
+            break;
+        ptr = next;
+    }
+
+    if (is_final) {
+        // Anything left is an incomplete element, let expat report it.
+        this->feed(ptr, end, true);
+        m_pending.clear();
+    } else if (use_pending)
+        m_pending.erase(0, ptr - begin);
+    else
+        m_pending.assign(ptr, end);
+    return ! m_failed;
+}
+
+const char* MeshXMLStreamParser::parse_xml(const char *begin, const char *end, bool is_final)
+{
+    for (const char *ptr = begin; ptr != end;) {
+        const char *tag = static_cast<const char*>(std::memchr(ptr, '<', end - ptr));
+        if (tag == nullptr)
+            break;
+        std::optional<bool> vertices  = starts_with_tag(tag, end, VERTICES_START);
+        std::optional<bool> triangles = starts_with_tag(tag, end, TRIANGLES_START);
+        if ((! vertices || ! triangles) && ! is_final) {
+            // Cannot decide yet whether this is a start of a section, wait for more data.
+            this->feed(begin, tag, false);
+            return tag;
+        }
+        if (vertices.value_or(false) || triangles.value_or(false)) {
+            const char *tag_end = static_cast<const char*>(std::memchr(tag, '>', end - tag));
+            if (tag_end == nullptr) {
+                if (is_final)
+                    break;
+                this->feed(begin, tag, false);
+                return tag;
+            }
+            ptr = tag_end + 1;
+            if (tag_end[-1] != '/') {
+                // The start element handler of the importer may ask to parse the section directly,
+                // but only while expat reports this very tag.
+                m_armed_tag = m_fed_bytes + XML_Index(tag - begin);
+                this->feed(begin, ptr, false);
+                m_armed_tag = -1;
+                return ptr;
+            }
+        } else
+            ptr = tag + 1;
+    }
+    this->feed(begin, end, false);
+    return end;
+}
+
+const char* MeshXMLStreamParser::parse_section(const char *begin, const char *end, bool is_final)
+{
+    const char *ptr = begin;
+    for (;;) {
+        // White space between the elements is not of any interest to the importer.
+        ptr = skip_spaces(ptr, end);
+        if (ptr == end)
+            return ptr;
+        const char *next = this->parse_element(ptr, end);
+        if (next == nullptr && ! is_final)
+            // Incomplete element.
+            return ptr;
+        if (next == nullptr || next == ptr) {
+            // End of the section or content to be parsed by expat.
+            m_section = Section::None;
+            return ptr;
+        }
+        ptr = next;
+    }
+}
+
+const char* MeshXMLStreamParser::parse_element(const char *begin, const char *end)
+{
+    const std::string_view element = m_section == Section::Vertices ? VERTEX_START : TRIANGLE_START;
+    std::optional<bool> is_element = starts_with_tag(begin, end, element);
+    if (! is_element)
+        return nullptr;
+    if (! *is_element)
+        return begin;
+
+    float   coords[3]  = { 0.f, 0.f, 0.f };
+    int32_t indices[3] = { 0, 0, 0 };
+    std::fill(m_attribute_values.begin(), m_attribute_values.end(), std::string_view());
+    for (const char *ptr = begin + element.size();;) {
+        ptr = skip_spaces(ptr, end);
+        if (ptr == end)
+            return nullptr;
+        if (*ptr == '/') {
+            if (ptr + 1 == end)
+                return nullptr;
+            if (ptr[1] != '>')
+                return begin;
+            // Complete empty element.
+            if (m_section == Section::Vertices)
+                m_vertices->emplace_back(m_unit_factor * coords[0], m_unit_factor * coords[1], m_unit_factor * coords[2]);
+            else {
+                m_triangles->emplace_back(indices[0], indices[1], indices[2]);
+                for (size_t i = 0; i < m_triangle_attributes.size(); ++ i)
+                    m_triangle_attributes[i].second->emplace_back(m_attribute_values[i]);
+            }
+            return ptr + 2;
+        }
+        // Element with content.
+        if (*ptr == '>')
+            return begin;
+
+        // name = "value"
+        const char *name_begin = ptr;
+        while (ptr != end && *ptr != '=' && *ptr != '/' && *ptr != '>' && ! is_space(*ptr))
+            ++ ptr;
+        const std::string_view name(name_begin, ptr - name_begin);
+        ptr = skip_spaces(ptr, end);
+        if (ptr == end)
+            return nullptr;
+        if (*ptr != '=')
+            return begin;
+        ptr = skip_spaces(ptr + 1, end);
+        if (ptr == end)
+            return nullptr;
+        if (*ptr != '"' && *ptr != '\'')
+            return begin;
+        const char *value_begin = ptr + 1;
+        const char *value_end   = static_cast<const char*>(std::memchr(value_begin, *ptr, end - value_begin));
+        if (value_end == nullptr)
+            return nullptr;
+        ptr = value_end + 1;
+        // Attributes have to be separated by white space.
+        if (ptr == end)
+            return nullptr;
+        if (*ptr != '/' && *ptr != '>' && ! is_space(*ptr))
+            return begin;
+        if (needs_normalization(value_begin, value_end))
+            return begin;
+
+        if (m_section == Section::Vertices) {
+            if (name.size() == 1 && name[0] >= 'x' && name[0] <= 'z') {
+                if (! parse_number(value_begin, value_end, coords[name[0] - 'x']))
+                    return begin;
+            }
+        } else if (name.size() == 2 && name[0] == 'v' && name[1] >= '1' && name[1] <= '3') {
+            if (! parse_number(value_begin, value_end, indices[name[1] - '1']))
+                return begin;
+        } else {
+            for (size_t i = 0; i < m_triangle_attributes.size(); ++ i)
+                if (name == m_triangle_attributes[i].first) {
+                    m_attribute_values[i] = std::string_view(value_begin, value_end - value_begin);
+                    break;
+                }
+        }
+    }
+}
+
+} // namespace Slic3r
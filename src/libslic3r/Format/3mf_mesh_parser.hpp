@@ -0,0 +1,77 @@
+#ifndef slic3r_Format_3mf_mesh_parser_hpp_
+#define slic3r_Format_3mf_mesh_parser_hpp_
+
+#include "../Point.hpp"
+
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <expat.h>
+
+namespace Slic3r {
+
+// Feeds the XML stream of a 3MF model file into an expat parser, except for the content of the <vertices> and <triangles>
+// elements, which is parsed directly from the stream. Expat would deliver each <vertex> and <triangle> through the element
+// callbacks with the attributes copied into null terminated strings, which dominates loading of meshes with millions of triangles.
+// A section is only parsed directly if the start element handler of the importer asked for it by calling parse_vertices()
+// or parse_triangles() while expat reports the non-empty start tag that was just fed to it. Calls for any other start tag
+// (an empty <vertices/>, a start tag reported late by expat) are ignored and expat parses the section. Anything not expected inside the section (comments, character references, elements with content...)
+// hands the rest of the section over to expat, thus the importer receives the same data as if expat parsed the whole file.
+class MeshXMLStreamParser
+{
+public:
+    // Name of a string attribute of the triangles and the vector to collect it into, missing attributes are stored as empty strings.
+    using TriangleAttribute = std::pair<const char*, std::vector<std::string>*>;
+
+    // Start parsing a new XML stream with the expat parser.
+    void reset(XML_Parser parser);
+    // Parse the next block of the stream, the last block with is_final set. Returns false if expat failed, see XML_GetErrorCode().
+    bool parse(const char *data, size_t size, bool is_final);
+
+    // To be called from the start element handler of <vertices>: the coordinates of the following <vertex> elements
+    // are scaled by unit_factor and appended to vertices.
+    void parse_vertices(std::vector<Vec3f> &vertices, float unit_factor);
+    // To be called from the start element handler of <triangles>: the indices of the following <triangle> elements
+    // are appended to triangles, their string attributes to the vectors of attributes.
+    void parse_triangles(std::vector<Vec3i32> &triangles, std::vector<TriangleAttribute> attributes);
+
+private:
+    enum class Section {
+        None,
+        Vertices,
+        Triangles,
+    };
+
+    // Feed expat up to the start tag of the next section, returns the first byte not consumed.
+    const char* parse_xml(const char *begin, const char *end, bool is_final);
+    // Parse the elements of the current section, returns the first byte not consumed.
+    const char* parse_section(const char *begin, const char *end, bool is_final);
+    // Parse a single element, returns nullptr if the element is not complete yet, begin if it has to be parsed by expat.
+    const char* parse_element(const char *begin, const char *end);
+    bool        feed(const char *begin, const char *end, bool is_final);
+    // Is the start element handler called for the section start tag just fed to expat?
+    bool        armed() const;
+
+    XML_Parser                      m_parser { nullptr };
+    bool                            m_failed { false };
+    Section                         m_section { Section::None };
+    // Number of bytes fed to expat so far.
+    XML_Index                       m_fed_bytes { 0 };
+    // Stream offset of the section start tag being fed to expat, -1 if none. The start element handler has to report this tag
+    // for the section to be parsed directly.
+    XML_Index                       m_armed_tag { -1 };
+    // Unparsed tail of the previous block.
+    std::string                     m_pending;
+
+    std::vector<Vec3f>             *m_vertices { nullptr };
+    float                           m_unit_factor { 1.f };
+    std::vector<Vec3i32>           *m_triangles { nullptr };
+    std::vector<TriangleAttribute>  m_triangle_attributes;
+    std::vector<std::string_view>   m_attribute_values;
+};
+
+} // namespace Slic3r
+
+#endif /* slic3r_Format_3mf_mesh_parser_hpp_ */
@@ -4,6 +4,10 @@
 
 #include "STEP.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <future>
 #include <string>
 #include <boost/nowide/cstdio.hpp>
 #include <boost/nowide/iostream.hpp>
@@ -33,9 +37,15 @@
 #include "TopExp_Explorer.hxx"
 #include "TopExp_Explorer.hxx"
 #include "BRep_Tool.hxx"
+#include "BRepBndLib.hxx"
+#include "Bnd_Box.hxx"
 
 const double STEP_TRANS_CHORD_ERROR = 0.003;
 const double STEP_TRANS_ANGLE_RES = 0.5;
+//BBS: chord error of a shape relative to its size, limited by STEP_TRANS_CHORD_ERROR to keep small parts detailed
+// and by STEP_TRANS_CHORD_ERROR_MAX to keep large parts accurate enough for printing.
+const double STEP_TRANS_CHORD_ERROR_RELATIVE = 0.0001;
+const double STEP_TRANS_CHORD_ERROR_MAX = 0.05;
 
 
 namespace Slic3r {
@@ -219,6 +229,90 @@ static void getNamedSolids(const TopLoc_Location& location, const std::string& p
     }
 }
 
+static double step_chord_error(const TopoDS_Shape &solid)
+{
+    Bnd_Box box;
+    BRepBndLib::Add(solid, box);
+    if (box.IsVoid())
+        return STEP_TRANS_CHORD_ERROR;
+    return std::clamp(STEP_TRANS_CHORD_ERROR_RELATIVE * std::sqrt(box.SquareExtent()), STEP_TRANS_CHORD_ERROR, STEP_TRANS_CHORD_ERROR_MAX);
+}
+
+//BBS: tessellate a solid into stl, which is left empty if the solid has no triangulation.
+static void tessellate_solid(const TopoDS_Shape &solid, stl_file &stl)
+{
+    BRepMesh_IncrementalMesh mesh(solid, step_chord_error(solid), false, STEP_TRANS_ANGLE_RES, true);
+    // BBS: calculate total number of the nodes and triangles
+    int aNbNodes     = 0;
+    int aNbTriangles = 0;
+    for (TopExp_Explorer anExpSF(solid, TopAbs_FACE); anExpSF.More(); anExpSF.Next()) {
+        TopLoc_Location aLoc;
+        Handle(Poly_Triangulation) aTriangulation = BRep_Tool::Triangulation(TopoDS::Face(anExpSF.Current()), aLoc);
+        if (!aTriangulation.IsNull()) {
+            aNbNodes += aTriangulation->NbNodes();
+            aNbTriangles += aTriangulation->NbTriangles();
+        }
+    }
+
+    if (aNbTriangles == 0 || aNbNodes == 0)
+        // BBS: No triangulation on the shape.
+        return;
+
+    stl.stats.type                = inmemory;
+    stl.stats.number_of_facets    = (uint32_t) aNbTriangles;
+    stl.stats.original_num_facets = stl.stats.number_of_facets;
+    stl_allocate(&stl);
+
+    std::vector<Vec3f> points;
+    points.reserve(aNbNodes);
+    // BBS: count faces missing triangulation
+    Standard_Integer aNbFacesNoTri = 0;
+    // BBS: fill temporary triangulation
+    Standard_Integer aNodeOffset    = 0;
+    Standard_Integer aTriangleOffet = 0;
+    for (TopExp_Explorer anExpSF(solid, TopAbs_FACE); anExpSF.More(); anExpSF.Next()) {
+        const TopoDS_Shape &aFace = anExpSF.Current();
+        TopLoc_Location     aLoc;
+        Handle(Poly_Triangulation) aTriangulation = BRep_Tool::Triangulation(TopoDS::Face(aFace), aLoc);
+        if (aTriangulation.IsNull()) {
+            ++aNbFacesNoTri;
+            continue;
+        }
+        // BBS: copy nodes
+        gp_Trsf aTrsf = aLoc.Transformation();
+        for (Standard_Integer aNodeIter = 1; aNodeIter <= aTriangulation->NbNodes(); ++aNodeIter) {
+            gp_Pnt aPnt = aTriangulation->Node(aNodeIter);
+            aPnt.Transform(aTrsf);
+            points.emplace_back(std::move(Vec3f(aPnt.X(), aPnt.Y(), aPnt.Z())));
+        }
+        // BBS: copy triangles
+        const TopAbs_Orientation anOrientation = anExpSF.Current().Orientation();
+        Standard_Integer anId[3];
+        for (Standard_Integer aTriIter = 1; aTriIter <= aTriangulation->NbTriangles(); ++aTriIter) {
+            Poly_Triangle aTri = aTriangulation->Triangle(aTriIter);
+
+            aTri.Get(anId[0], anId[1], anId[2]);
+            if (anOrientation == TopAbs_REVERSED)
+                std::swap(anId[1], anId[2]);
+            // BBS: save triangles facets
+            stl_facet facet;
+            facet.vertex[0] = points[anId[0] + aNodeOffset - 1].cast<float>();
+            facet.vertex[1] = points[anId[1] + aNodeOffset - 1].cast<float>();
+            facet.vertex[2] = points[anId[2] + aNodeOffset - 1].cast<float>();
+            facet.extra[0]  = 0;
+            facet.extra[1]  = 0;
+            stl_normal normal;
+            stl_calculate_normal(normal, &facet);
+            stl_normalize_vector(normal);
+            facet.normal                                      = normal;
+            stl.facet_start[aTriangleOffet + aTriIter - 1] = facet;
+        }
+
+        aNodeOffset += aTriangulation->NbNodes();
+        aTriangleOffet += aTriangulation->NbTriangles();
+    }
+}
+
 bool load_step(const char *path, Model *model, bool& is_cancel, ImportStepProgressFn stepFn, StepIsUtf8Fn isUtf8Fn)
 {
     bool cb_cancel = false;
@@ -270,108 +364,54 @@ bool load_step(const char *path, Model *model, bool& is_cancel, ImportStepProgre
         getNamedSolids(TopLoc_Location{}, "", id, shapeTool, topLevelShapes.Value(iLabel), namedSolids);
     }
 
-    std::vector<stl_file> stl;
-    stl.resize(namedSolids.size());
-    tbb::parallel_for(tbb::blocked_range<size_t>(0, namedSolids.size()), [&](const tbb::blocked_range<size_t> &range) {
-        for (size_t i = range.begin(); i < range.end(); i++) {
-            BRepMesh_IncrementalMesh mesh(namedSolids[i].solid, STEP_TRANS_CHORD_ERROR, false, STEP_TRANS_ANGLE_RES, true);
-            // BBS: calculate total number of the nodes and triangles
-            int aNbNodes     = 0;
-            int aNbTriangles = 0;
-            for (TopExp_Explorer anExpSF(namedSolids[i].solid, TopAbs_FACE); anExpSF.More(); anExpSF.Next()) {
-                TopLoc_Location aLoc;
-                Handle(Poly_Triangulation) aTriangulation = BRep_Tool::Triangulation(TopoDS::Face(anExpSF.Current()), aLoc);
-                if (!aTriangulation.IsNull()) {
-                    aNbNodes += aTriangulation->NbNodes();
-                    aNbTriangles += aTriangulation->NbTriangles();
-                }
-            }
-
-            if (aNbTriangles == 0 || aNbNodes == 0)
-                // BBS: No triangulation on the shape.
-                continue;
-
-            stl[i].stats.type                = inmemory;
-            stl[i].stats.number_of_facets    = (uint32_t) aNbTriangles;
-            stl[i].stats.original_num_facets = stl[i].stats.number_of_facets;
-            stl_allocate(&stl[i]);
-
-            std::vector<Vec3f> points;
-            points.reserve(aNbNodes);
-            // BBS: count faces missing triangulation
-            Standard_Integer aNbFacesNoTri = 0;
-            // BBS: fill temporary triangulation
-            Standard_Integer aNodeOffset    = 0;
-            Standard_Integer aTriangleOffet = 0;
-            for (TopExp_Explorer anExpSF(namedSolids[i].solid, TopAbs_FACE); anExpSF.More(); anExpSF.Next()) {
-                const TopoDS_Shape &aFace = anExpSF.Current();
-                TopLoc_Location     aLoc;
-                Handle(Poly_Triangulation) aTriangulation = BRep_Tool::Triangulation(TopoDS::Face(aFace), aLoc);
-                if (aTriangulation.IsNull()) {
-                    ++aNbFacesNoTri;
-                    continue;
-                }
-                // BBS: copy nodes
-                gp_Trsf aTrsf = aLoc.Transformation();
-                for (Standard_Integer aNodeIter = 1; aNodeIter <= aTriangulation->NbNodes(); ++aNodeIter) {
-                    gp_Pnt aPnt = aTriangulation->Node(aNodeIter);
-                    aPnt.Transform(aTrsf);
-                    points.emplace_back(std::move(Vec3f(aPnt.X(), aPnt.Y(), aPnt.Z())));
-                }
-                // BBS: copy triangles
-                const TopAbs_Orientation anOrientation = anExpSF.Current().Orientation();
-                Standard_Integer anId[3];
-                for (Standard_Integer aTriIter = 1; aTriIter <= aTriangulation->NbTriangles(); ++aTriIter) {
-                    Poly_Triangle aTri = aTriangulation->Triangle(aTriIter);
-
-                    aTri.Get(anId[0], anId[1], anId[2]);
-                    if (anOrientation == TopAbs_REVERSED)
-                        std::swap(anId[1], anId[2]);
-                    // BBS: save triangles facets
-                    stl_facet facet;
-                    facet.vertex[0] = points[anId[0] + aNodeOffset - 1].cast<float>();
-                    facet.vertex[1] = points[anId[1] + aNodeOffset - 1].cast<float>();
-                    facet.vertex[2] = points[anId[2] + aNodeOffset - 1].cast<float>();
-                    facet.extra[0]  = 0;
-                    facet.extra[1]  = 0;
-                    stl_normal normal;
-                    stl_calculate_normal(normal, &facet);
-                    stl_normalize_vector(normal);
-                    facet.normal                                      = normal;
-                    stl[i].facet_start[aTriangleOffet + aTriIter - 1] = facet;
-                }
-
-                aNodeOffset += aTriangulation->NbNodes();
-                aTriangleOffet += aTriangulation->NbTriangles();
+    //BBS: tessellate and repair the solids in a background thread, so that the progress is reported and cancellation
+    // is polled from the calling thread, where the progress callback may update the GUI. The model is assembled
+    // once all the solids are meshed.
+    std::vector<TriangleMesh> meshes(namedSolids.size());
+    std::atomic<bool>         meshing_canceled { false };
+    std::atomic<int>          num_meshed { 0 };
+    std::future<void>         meshing = std::async(std::launch::async, [&namedSolids, &meshes, &meshing_canceled, &num_meshed]() {
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, namedSolids.size(), 1), [&](const tbb::blocked_range<size_t> &range) {
+            for (size_t i = range.begin(); i < range.end() && ! meshing_canceled; ++ i) {
+                stl_file stl;
+                tessellate_solid(namedSolids[i].solid, stl);
+                if (stl.stats.number_of_facets > 0)
+                    meshes[i].from_stl(stl);
+                ++ num_meshed;
             }
-        }
+        });
     });
+    for (bool done = false; ! done;) {
+        done = meshing.wait_for(std::chrono::milliseconds(100)) == std::future_status::ready;
+        if (stepFn && ! meshing_canceled) {
+            stepFn(LOAD_STEP_STAGE_GET_MESH, num_meshed, (int)namedSolids.size(), cb_cancel);
+            is_cancel = cb_cancel;
+            if (cb_cancel)
+                meshing_canceled = true;
+        }
+    }
+    try {
+        meshing.get();
+    } catch (...) {
+        shapeTool.reset(nullptr);
+        application->Close(document);
+        throw;
+    }
+    if (meshing_canceled) {
+        shapeTool.reset(nullptr);
+        application->Close(document);
+        return false;
+    }
 
     ModelObject *new_object = model->add_object();
     const char * last_slash = strrchr(path, DIR_SEPARATOR);
     new_object->name.assign((last_slash == nullptr) ? path : last_slash + 1);
     new_object->input_file = path;
 
-    auto stage_unit3 = stl.size() / LOAD_STEP_STAGE_UNIT_NUM + 1;
-    for (size_t i = 0; i < stl.size(); i++) {
-        if (stepFn) {
-            if ((i % stage_unit3) == 0) {
-                stepFn(LOAD_STEP_STAGE_GET_MESH, i, stl.size(), cb_cancel);
-                is_cancel = cb_cancel;
-            }
-            if (cb_cancel) {
-                model->delete_object(new_object);
-                shapeTool.reset(nullptr);
-                application->Close(document);
-                return false;
-            }
-        }
-
+    for (size_t i = 0; i < meshes.size(); i++) {
         //BBS: maybe mesh is empty from step file. Don't add
-        if (stl[i].stats.number_of_facets > 0) {
-            TriangleMesh triangle_mesh;
-            triangle_mesh.from_stl(stl[i]);
-            ModelVolume* new_volume = new_object->add_volume(std::move(triangle_mesh));
+        if (! meshes[i].empty()) {
+            ModelVolume* new_volume = new_object->add_volume(std::move(meshes[i]));
             new_volume->name = namedSolids[i].name;
             new_volume->source.input_file = path;
             new_volume->source.object_idx = (int)model->objects.size() - 1;
@@ -13,7 +13,9 @@
 #include "../I18N.hpp"
 
 #include "bbs_3mf.hpp"
+#include "3mf_mesh_parser.hpp"
 
+#include <atomic>
 #include <limits>
 #include <stdexcept>
 #include <iomanip>
@@ -823,6 +825,8 @@ void PlateData::parse_filament_info(GCodeProcessorResult *result)
             std::string zip_path;
             _BBS_3MF_Importer *top_importer{nullptr};
             XML_Parser object_xml_parser;
+            // Parses the vertices and triangles of the object file bypassing the expat callbacks.
+            MeshXMLStreamParser object_mesh_parser;
             bool obj_parse_error { false };
             std::string obj_parse_error_message;
 
@@ -984,6 +988,8 @@ void PlateData::parse_filament_info(GCodeProcessorResult *result)
         std::string  m_profile_user_name;
 
         XML_Parser m_xml_parser;
+        // Parses the vertices and triangles of the model file bypassing the expat callbacks.
+        MeshXMLStreamParser m_mesh_parser;
         // Error code returned by the application side of the parser. In that case the expat may not reliably deliver the error state
         // after returning from XML_Parse() function, thus we keep the error state here.
         bool m_parse_error { false };
@@ -2343,6 +2349,7 @@ void PlateData::parse_filament_info(GCodeProcessorResult *result)
         XML_SetUserData(m_xml_parser, (void*)this);
         XML_SetElementHandler(m_xml_parser, _BBS_3MF_Importer::_handle_start_model_xml_element, _BBS_3MF_Importer::_handle_end_model_xml_element);
         XML_SetCharacterDataHandler(m_xml_parser, _BBS_3MF_Importer::_handle_xml_characters);
+        m_mesh_parser.reset(m_xml_parser);
 
         struct CallbackData
         {
@@ -2361,7 +2368,7 @@ void PlateData::parse_filament_info(GCodeProcessorResult *result)
         {
             mz_file_write_func callback = [](void* pOpaque, mz_uint64 file_ofs, const void* pBuf, size_t n)->size_t {
                 CallbackData* data = (CallbackData*)pOpaque;
-                if (!XML_Parse(data->parser, (const char*)pBuf, (int)n, (file_ofs + n == data->stat.m_uncomp_size) ? 1 : 0) || data->importer.parse_error()) {
+                if (!data->importer.m_mesh_parser.parse((const char*)pBuf, n, file_ofs + n == data->stat.m_uncomp_size) || data->importer.parse_error()) {
                     char error_buf[1024];
                     ::snprintf(error_buf, 1024, "Error (%s) while parsing '%s' at line %d", data->importer.parse_error_message(), data->stat.m_filename, (int)XML_GetCurrentLineNumber(data->parser));
                     throw Slic3r::FileIOError(error_buf);
@@ -3453,8 +3460,10 @@ void PlateData::parse_filament_info(GCodeProcessorResult *result)
     bool _BBS_3MF_Importer::_handle_start_vertices(const char** attributes, unsigned int num_attributes)
     {
         // reset current vertices
-        if (m_curr_object)
+        if (m_curr_object) {
             m_curr_object->geometry.vertices.clear();
+            m_mesh_parser.parse_vertices(m_curr_object->geometry.vertices, m_unit_factor);
+        }
         return true;
     }
 
@@ -3485,8 +3494,14 @@ void PlateData::parse_filament_info(GCodeProcessorResult *result)
     bool _BBS_3MF_Importer::_handle_start_triangles(const char** attributes, unsigned int num_attributes)
     {
         // reset current triangles
-        if (m_curr_object)
+        if (m_curr_object) {
             m_curr_object->geometry.triangles.clear();
+            m_mesh_parser.parse_triangles(m_curr_object->geometry.triangles, {
+                { CUSTOM_SUPPORTS_ATTR,  &m_curr_object->geometry.custom_supports },
+                { CUSTOM_SEAM_ATTR,      &m_curr_object->geometry.custom_seam },
+                { MMU_SEGMENTATION_ATTR, &m_curr_object->geometry.mmu_segmentation },
+                { FACE_PROPERTY_ATTR,    &m_curr_object->geometry.face_properties } });
+        }
         return true;
     }
 
@@ -5088,8 +5103,10 @@ void PlateData::parse_filament_info(GCodeProcessorResult *result)
     bool _BBS_3MF_Importer::ObjectImporter::_handle_object_start_vertices(const char** attributes, unsigned int num_attributes)
     {
         // reset current vertices
-        if (current_object)
+        if (current_object) {
             current_object->geometry.vertices.clear();
+            object_mesh_parser.parse_vertices(current_object->geometry.vertices, object_unit_factor);
+        }
         return true;
     }
 
@@ -5120,8 +5137,14 @@ void PlateData::parse_filament_info(GCodeProcessorResult *result)
     bool _BBS_3MF_Importer::ObjectImporter::_handle_object_start_triangles(const char** attributes, unsigned int num_attributes)
     {
         // reset current triangles
-        if (current_object)
+        if (current_object) {
             current_object->geometry.triangles.clear();
+            object_mesh_parser.parse_triangles(current_object->geometry.triangles, {
+                { CUSTOM_SUPPORTS_ATTR,  &current_object->geometry.custom_supports },
+                { CUSTOM_SEAM_ATTR,      &current_object->geometry.custom_seam },
+                { MMU_SEGMENTATION_ATTR, &current_object->geometry.mmu_segmentation },
+                { FACE_PROPERTY_ATTR,    &current_object->geometry.face_properties } });
+        }
         return true;
     }
 
@@ -5344,6 +5367,7 @@ void PlateData::parse_filament_info(GCodeProcessorResult *result)
         XML_SetUserData(object_xml_parser, (void*)this);
         XML_SetElementHandler(object_xml_parser, _BBS_3MF_Importer::ObjectImporter::_handle_object_start_model_xml_element, _BBS_3MF_Importer::ObjectImporter::_handle_object_end_model_xml_element);
         XML_SetCharacterDataHandler(object_xml_parser, _BBS_3MF_Importer::ObjectImporter::_handle_object_xml_characters);
+        object_mesh_parser.reset(object_xml_parser);
 
         struct CallbackData
         {
@@ -5362,7 +5386,7 @@ void PlateData::parse_filament_info(GCodeProcessorResult *result)
         {
             mz_file_write_func callback = [](void* pOpaque, mz_uint64 file_ofs, const void* pBuf, size_t n)->size_t {
                 CallbackData* data = (CallbackData*)pOpaque;
-                if (!XML_Parse(data->parser, (const char*)pBuf, (int)n, (file_ofs + n == data->stat.m_uncomp_size) ? 1 : 0) || data->importer.object_parse_error()) {
+                if (!data->importer.object_mesh_parser.parse((const char*)pBuf, n, file_ofs + n == data->stat.m_uncomp_size) || data->importer.object_parse_error()) {
                     char error_buf[1024];
                     ::snprintf(error_buf, 1024, "Error (%s) while parsing '%s' at line %d", data->importer.object_parse_error_message(), data->stat.m_filename, (int)XML_GetCurrentLineNumber(data->parser));
                     throw Slic3r::FileIOError(error_buf);
@@ -5394,6 +5418,109 @@ void PlateData::parse_filament_info(GCodeProcessorResult *result)
     }
 
 
+    // Raw deflate data of a part of a file stored into the 3MF archive. The parts of a file are compressed independently
+    // (thus in parallel), each of them is terminated by a sync flush to end on a byte boundary, therefore the parts
+    // may be concatenated into a single deflate stream, which is then closed by an empty final block.
+    struct DeflatedPart
+    {
+        std::string data;
+        mz_uint32   crc32 { MZ_CRC32_INIT };
+        // Size of the uncompressed data.
+        size_t      size { 0 };
+    };
+
+    // Deflate level of the model files of the backups, see set_backup_compression_level().
+    static std::atomic<int> s_backup_compression_level { MZ_BEST_SPEED };
+
+    class PartDeflater
+    {
+    public:
+        PartDeflater(DeflatedPart &part, int level) : m_part(part), m_compressor(std::make_unique<tdefl_compressor>()) {
+            // Negative window bits: raw deflate stream without the zlib header.
+            tdefl_init(m_compressor.get(), &PartDeflater::put_buf, &m_part, tdefl_create_comp_flags_from_zip_params(level, -MZ_DEFAULT_WINDOW_BITS, MZ_DEFAULT_STRATEGY));
+        }
+
+        bool add(const std::string &buf) {
+            m_part.crc32 = (mz_uint32) mz_crc32(m_part.crc32, (const unsigned char *) buf.data(), buf.size());
+            m_part.size += buf.size();
+            return tdefl_compress_buffer(m_compressor.get(), buf.data(), buf.size(), TDEFL_NO_FLUSH) == TDEFL_STATUS_OKAY;
+        }
+        bool finish() { return tdefl_compress_buffer(m_compressor.get(), nullptr, 0, TDEFL_SYNC_FLUSH) == TDEFL_STATUS_OKAY; }
+
+    private:
+        static mz_bool put_buf(const void *buf, int len, void *user) {
+            static_cast<DeflatedPart*>(user)->data.append(static_cast<const char*>(buf), size_t(len));
+            return MZ_TRUE;
+        }
+
+        DeflatedPart                        &m_part;
+        std::unique_ptr<tdefl_compressor>    m_compressor;
+    };
+
+    // CRC32 of the concatenation of two blocks of data from their CRC32s, see crc32_combine() of zlib.
+    static mz_uint32 crc32_combine(mz_uint32 crc1, mz_uint32 crc2, uint64_t len2)
+    {
+        auto gf2_matrix_times = [](const mz_uint32 *mat, mz_uint32 vec) {
+            mz_uint32 sum = 0;
+            for (; vec; vec >>= 1, ++ mat)
+                if (vec & 1)
+                    sum ^= *mat;
+            return sum;
+        };
+        auto gf2_matrix_square = [&gf2_matrix_times](mz_uint32 *square, const mz_uint32 *mat) {
+            for (int n = 0; n < 32; ++ n)
+                square[n] = gf2_matrix_times(mat, mat[n]);
+        };
+
+        if (len2 == 0)
+            return crc1;
+        mz_uint32 even[32];
+        mz_uint32 odd[32];
+        // Operator for one zero bit in odd.
+        odd[0] = 0xedb88320u;
+        for (mz_uint32 n = 1, row = 1; n < 32; ++ n, row <<= 1)
+            odd[n] = row;
+        // Operators for two and four zero bits.
+        gf2_matrix_square(even, odd);
+        gf2_matrix_square(odd, even);
+        // Apply len2 zeros to crc1, the first square puts the operator for one zero byte (eight zero bits) into even.
+        do {
+            gf2_matrix_square(even, odd);
+            if (len2 & 1)
+                crc1 = gf2_matrix_times(even, crc1);
+            len2 >>= 1;
+            if (len2 == 0)
+                break;
+            gf2_matrix_square(odd, even);
+            if (len2 & 1)
+                crc1 = gf2_matrix_times(odd, crc1);
+            len2 >>= 1;
+        } while (len2 != 0);
+        return crc1 ^ crc2;
+    }
+
+    // Store a file assembled from separately deflated parts into the archive.
+    static bool add_deflated_parts_to_archive(mz_zip_archive &archive, const std::string &filename, const std::vector<DeflatedPart> &parts)
+    {
+        // Empty final block with fixed Huffman codes.
+        static constexpr const char final_block[] = { 0x03, 0x00 };
+        size_t    compressed_size = sizeof(final_block);
+        for (const DeflatedPart &part : parts)
+            compressed_size += part.data.size();
+        std::string data;
+        data.reserve(compressed_size);
+        mz_uint32 crc32 = MZ_CRC32_INIT;
+        uint64_t  size  = 0;
+        for (const DeflatedPart &part : parts) {
+            data += part.data;
+            crc32 = crc32_combine(crc32, part.crc32, part.size);
+            size += part.size;
+        }
+        data.append(final_block, sizeof(final_block));
+        return mz_zip_writer_add_mem_ex_v2(&archive, filename.c_str(), data.data(), data.size(), nullptr, 0, MZ_ZIP_FLAG_COMPRESSED_DATA, size, crc32,
+            nullptr, nullptr, 0, nullptr, 0);
+    }
+
     class _BBS_3MF_Exporter : public _BBS_3MF_Base
     {
         struct BuildItem
@@ -5454,6 +5581,7 @@ void PlateData::parse_filament_info(GCodeProcessorResult *result)
         bool m_skip_auxiliary { false };    // skip normal axuiliary files
         bool m_use_loaded_id { false };        // whether to use loaded id for identify_id
         bool m_share_mesh { false };        // whether to share mesh between objects
+        int  m_compression_level { MZ_DEFAULT_LEVEL }; // deflate level of the model files
         std::string m_thumbnail_middle = PRINTER_THUMBNAIL_MIDDLE_FILE;
         std::string m_thumbnail_small  = PRINTER_THUMBNAIL_SMALL_FILE;
         std::map<void const *, std::pair<ObjectData*, ModelVolume const *>> m_shared_meshes;
@@ -5502,7 +5630,10 @@ void PlateData::parse_filament_info(GCodeProcessorResult *result)
         bool _add_object_to_model_stream(mz_zip_writer_staged_context &context, ObjectData const &object_data) const;
         void _add_object_components_to_stream(std::stringstream &stream, ObjectData const &object_data) const;
         //BBS: change volume to seperate objects
-        bool _add_mesh_to_object_stream(std::function<bool(std::string &, bool)> const &flush, ObjectData const &object_data) const;
+        // If error is not null, the error is returned there instead of being added to the errors, so that the meshes
+        // of several objects may be written in parallel and their errors reported in the order of the objects.
+        bool _add_mesh_to_object_stream(std::function<bool(std::string &, bool)> const &flush, ObjectData const &object_data, std::string *error = nullptr) const;
+        bool _add_deflated_model_file_to_archive(mz_zip_archive& archive, const std::string& header, std::vector<ObjectData const*> const &objects, const std::string& footer) const;
         bool _add_build_to_model_stream(std::stringstream& stream, const BuildItemsList& build_items) const;
         bool _add_cut_information_file_to_archive(mz_zip_archive& archive, Model& model);
         bool _add_layer_height_profile_file_to_archive(mz_zip_archive& archive, Model& model);
@@ -5549,6 +5680,7 @@ void PlateData::parse_filament_info(GCodeProcessorResult *result)
         m_skip_auxiliary = store_params.strategy & SaveStrategy::SkipAuxiliary;
         m_share_mesh       = store_params.strategy & SaveStrategy::ShareMesh;
         m_from_backup_save = store_params.strategy & SaveStrategy::Backup;
+        m_compression_level = m_from_backup_save ? s_backup_compression_level.load() : MZ_DEFAULT_LEVEL;
 
         m_use_loaded_id = store_params.strategy & SaveStrategy::UseLoadedId;
 
@@ -5584,6 +5716,7 @@ void PlateData::parse_filament_info(GCodeProcessorResult *result)
     {
         m_production_ext = true;
         m_from_backup_save = true;
+        m_compression_level = s_backup_compression_level.load();
         Model const & model = *object.get_model();
 
         mz_zip_archive archive;
@@ -6347,8 +6480,12 @@ void PlateData::parse_filament_info(GCodeProcessorResult *result)
         std::string zip_filename = encode_path(filename.c_str());
         std::string extra = sub_model ? ZipUnicodePathExtraField::encode(filename, zip_filename) : "";
 #endif
+        // The meshes of all the objects stored into a single model file are generated and compressed in parallel.
+        const bool deflate_in_parallel = write_object && ! sub_model && ! m_skip_model && model.objects.size() > 1;
+        std::string                    model_header;
+        std::vector<ObjectData const*> objects_to_deflate;
         mz_zip_writer_staged_context context;
-        if (!mz_zip_writer_add_staged_open(&archive, &context, sub_model ? zip_filename.c_str() : MODEL_FILE.c_str(),
+        if (! deflate_in_parallel && !mz_zip_writer_add_staged_open(&archive, &context, sub_model ? zip_filename.c_str() : MODEL_FILE.c_str(),
             m_zip64 ?
                 // Maximum expected and allowed 3MF file size is 16GiB.
                 // This switches the ZIP file to a 64bit mode, which adds a tiny bit of overhead to file records.
@@ -6357,9 +6494,9 @@ void PlateData::parse_filament_info(GCodeProcessorResult *result)
                 // GH issue #6193.
                 (uint64_t(1) << 32) - 1,
 #if WRITE_ZIP_LANGUAGE_ENCODING
-            nullptr, nullptr, 0, MZ_DEFAULT_LEVEL, nullptr, 0, nullptr, 0)) {
+            nullptr, nullptr, 0, mz_uint(m_compression_level), nullptr, 0, nullptr, 0)) {
 #else
-            nullptr, nullptr, 0, MZ_DEFAULT_COMPRESSION, extra.c_str(), extra.length(), extra.c_str(), extra.length())) {
+            nullptr, nullptr, 0, mz_uint(m_compression_level), extra.c_str(), extra.length(), extra.c_str(), extra.length())) {
 #endif
             add_error("Unable to add model file to archive");
             BOOST_LOG_TRIVIAL(error) << __FUNCTION__ << ":" << __LINE__ << boost::format(", Unable to add model file to archive\n");
@@ -6466,7 +6603,9 @@ void PlateData::parse_filament_info(GCodeProcessorResult *result)
 
             stream << " <" << RESOURCES_TAG << ">\n";
             std::string buf = stream.str();
-            if (! buf.empty() && ! mz_zip_writer_add_staged_data(&context, buf.data(), buf.size())) {
+            if (deflate_in_parallel)
+                model_header = std::move(buf);
+            else if (! buf.empty() && ! mz_zip_writer_add_staged_data(&context, buf.data(), buf.size())) {
                 add_error("Unable to add model file to archive");
                 BOOST_LOG_TRIVIAL(error) << __FUNCTION__ << ":" << __LINE__ << boost::format(", Unable to add model file to archive\n");
                 return false;
@@ -6553,7 +6692,9 @@ void PlateData::parse_filament_info(GCodeProcessorResult *result)
                     // Store geometry of all ModelVolumes contained in a single ModelObject into a single 3MF indexed triangle set object.
                     // object_it->second.volumes_objectID will contain the offsets of the ModelVolumes in that single indexed triangle set.
                     // object_id will be increased to point to the 1st instance of the next ModelObject.
-                    if (!_add_object_to_model_stream(context, object_it->second)) {
+                    if (deflate_in_parallel)
+                        objects_to_deflate.emplace_back(&object_it->second);
+                    else if (!_add_object_to_model_stream(context, object_it->second)) {
                         add_error("Unable to add object to archive");
                         BOOST_LOG_TRIVIAL(error) << __FUNCTION__ << ":" << __LINE__ << boost::format(", Unable to add object to archive\n");
                         return false;
@@ -6599,7 +6740,11 @@ void PlateData::parse_filament_info(GCodeProcessorResult *result)
 
             std::string buf = stream.str();
 
-            if ((! buf.empty() && ! mz_zip_writer_add_staged_data(&context, buf.data(), buf.size())) ||
+            if (deflate_in_parallel) {
+                if (! _add_deflated_model_file_to_archive(archive, model_header, objects_to_deflate, buf))
+                    return false;
+            }
+            else if ((! buf.empty() && ! mz_zip_writer_add_staged_data(&context, buf.data(), buf.size())) ||
                 ! mz_zip_writer_add_staged_finish(&context)) {
                 add_error("Unable to add model file to archive");
                 BOOST_LOG_TRIVIAL(error) << __FUNCTION__ << ":" << __LINE__ << boost::format(", Unable to add model file to archive\n");
@@ -6613,36 +6758,89 @@ void PlateData::parse_filament_info(GCodeProcessorResult *result)
         _add_relationships_file_to_archive(archive, MODEL_RELS_FILE, object_paths, {"http://schemas.microsoft.com/3dmanufacturing/2013/01/3dmodel"});
 
         if (!m_from_backup_save) {
-            boost::mutex mutex;
-            tbb::parallel_for(tbb::blocked_range<size_t>(0, objects_data.size(), 1), [this, &mutex, &model, objects = model.objects, &objects_data, &object_paths, main = &archive, project](const tbb::blocked_range<size_t>& range) {
+            // The model files of the objects are generated and compressed in parallel into in-memory archives,
+            // then the compressed files are copied into the main archive in the order of the objects.
+            std::vector<std::pair<void*, size_t>> object_archives(objects_data.size(), { nullptr, 0 });
+            tbb::parallel_for(tbb::blocked_range<size_t>(0, objects_data.size(), 1), [this, &model, objects = model.objects, &objects_data, &object_paths, &object_archives, project](const tbb::blocked_range<size_t>& range) {
                 for (size_t i = range.begin(); i < range.end(); ++i) {
                     auto iter = objects_data.find(objects[i]);
                     ObjectToObjectDataMap objects_data2;
                     objects_data2.insert(*iter);
-                    auto & object = *iter->second.object;
                     mz_zip_archive archive;
                     mz_zip_zero_struct(&archive);
                     mz_zip_writer_init_heap(&archive, 0, 1024 * 1024);
                     CNumericLocalesSetter locales_setter;
-                    _add_model_file_to_archive(object_paths[i], archive, model, objects_data2, nullptr, project);
+                    bool added = _add_model_file_to_archive(object_paths[i], archive, model, objects_data2, nullptr, project);
                     iter->second = objects_data2.begin()->second;
-                    void *ppBuf; size_t pSize;
-                    mz_zip_writer_finalize_heap_archive(&archive, &ppBuf, &pSize);
+                    void *ppBuf = nullptr; size_t pSize = 0;
+                    if (mz_zip_writer_finalize_heap_archive(&archive, &ppBuf, &pSize) && added)
+                        object_archives[i] = { ppBuf, pSize };
+                    else
+                        mz_free(ppBuf);
                     mz_zip_writer_end(&archive);
-                    mz_zip_zero_struct(&archive);
-                    mz_zip_reader_init_mem(&archive, ppBuf, pSize, 0);
-                    {
-                        boost::unique_lock l(mutex);
-                        mz_zip_writer_add_from_zip_reader(main, &archive, 0);
-                    }
-                    mz_zip_reader_end(&archive);
                 }
             });
+            bool result = true;
+            for (auto &[buffer, size] : object_archives) {
+                mz_zip_archive object_archive;
+                mz_zip_zero_struct(&object_archive);
+                if (result && (buffer == nullptr || ! mz_zip_reader_init_mem(&object_archive, buffer, size, 0) ||
+                               ! mz_zip_writer_add_from_zip_reader(&archive, &object_archive, 0))) {
+                    add_error("Unable to add object model file to archive");
+                    BOOST_LOG_TRIVIAL(error) << __FUNCTION__ << ":" << __LINE__ << boost::format(", Unable to add object model file to archive\n");
+                    result = false;
+                }
+                mz_zip_reader_end(&object_archive);
+                mz_free(buffer);
+            }
+            return result;
         }
 
         return true;
     }
 
+    bool _BBS_3MF_Exporter::_add_deflated_model_file_to_archive(mz_zip_archive& archive, const std::string& header, std::vector<ObjectData const*> const &objects, const std::string& footer) const
+    {
+        // Header, meshes of the objects, footer.
+        std::vector<DeflatedPart> parts(objects.size() + 2);
+        auto deflate = [this](const std::string &buf, DeflatedPart &part) {
+            PartDeflater deflater(part, m_compression_level);
+            return deflater.add(buf) && deflater.finish();
+        };
+        std::atomic<bool> deflated { deflate(header, parts.front()) && deflate(footer, parts.back()) };
+        // Errors of the objects, reported once all the objects are processed.
+        std::vector<std::string> errors(objects.size());
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, objects.size(), 1), [this, &objects, &parts, &deflated, &errors](const tbb::blocked_range<size_t>& range) {
+            CNumericLocalesSetter locales_setter;
+            for (size_t i = range.begin(); i < range.end() && deflated; ++ i) {
+                PartDeflater deflater(parts[i + 1], m_compression_level);
+                std::string &error = errors[i];
+                auto flush = [&deflater, &error](std::string &buf, bool force) {
+                    if ((force && !buf.empty()) || buf.size() >= 65536 * 16) {
+                        if (!deflater.add(buf)) {
+                            error = "Error during writing or compression";
+                            BOOST_LOG_TRIVIAL(error) << __FUNCTION__ << ":" << __LINE__ << boost::format(", Error during writing or compression\n");
+                            return false;
+                        }
+                        buf.clear();
+                    }
+                    return true;
+                };
+                if (!_add_mesh_to_object_stream(flush, *objects[i], &error) || !deflater.finish())
+                    deflated = false;
+            }
+        });
+        for (const std::string &error : errors)
+            if (!error.empty())
+                add_error(error);
+        if (!deflated || !add_deflated_parts_to_archive(archive, MODEL_FILE, parts)) {
+            add_error("Unable to add model file to archive");
+            BOOST_LOG_TRIVIAL(error) << __FUNCTION__ << ":" << __LINE__ << boost::format(", Unable to add model file to archive\n");
+            return false;
+        }
+        return true;
+    }
+
     bool _BBS_3MF_Exporter::_add_object_to_model_stream(mz_zip_writer_staged_context &context, ObjectData const &object_data) const
     {
         // backup: make _add_mesh_to_object_stream() reusable
@@ -6735,7 +6933,7 @@ void PlateData::parse_filament_info(GCodeProcessorResult *result)
 #endif // EXPORT_3MF_USE_SPIRIT_KARMA_FP
 
     //BBS: change volume to seperate objects
-    bool _BBS_3MF_Exporter::_add_mesh_to_object_stream(std::function<bool(std::string &, bool)> const &flush, ObjectData const &object_data) const
+    bool _BBS_3MF_Exporter::_add_mesh_to_object_stream(std::function<bool(std::string &, bool)> const &flush, ObjectData const &object_data, std::string *error) const
     {
         std::string output_buffer;
 
@@ -6808,7 +7006,10 @@ void PlateData::parse_filament_info(GCodeProcessorResult *result)
 
             const indexed_triangle_set &its = volume->mesh().its;
             if (its.vertices.empty()) {
-                add_error("Found invalid mesh");
+                if (error)
+                    *error = "Found invalid mesh";
+                else
+                    add_error("Found invalid mesh");
                 BOOST_LOG_TRIVIAL(error) << __FUNCTION__ << ":" << __LINE__ << boost::format(", Found invalid mesh\n");
                 return false;
             }
@@ -8370,6 +8571,11 @@ void set_backup_interval(long interval)
     _BBS_Backup_Manager::get().set_interval(interval);
 }
 
+void set_backup_compression_level(int level)
+{
+    s_backup_compression_level = std::clamp(level, int(MZ_BEST_SPEED), int(MZ_UBER_COMPRESSION));
+}
+
 void set_backup_callback(std::function<void(int)> callback)
 {
     _BBS_Backup_Manager::get().set_post_callback(callback);
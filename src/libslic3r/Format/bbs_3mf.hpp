@@ -275,6 +275,9 @@ extern void remove_backup(Model& model, bool removeAll);
 
 extern void set_backup_interval(long interval);
 
+// Deflate level (1 fastest - 10 best compression) of the meshes stored by the backup.
+extern void set_backup_compression_level(int level);
+
 extern void set_backup_callback(std::function<void(int)> callback);
 
 extern void run_backup_ui_tasks();
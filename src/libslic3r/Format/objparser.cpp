@@ -1,20 +1,78 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include <algorithm>
+#include <charconv>
+
+#include <boost/filesystem/operations.hpp>
 #include <boost/log/trivial.hpp>
 #include <boost/nowide/cstdio.hpp>
 
+#include <tbb/parallel_for.h>
+
+#include <fast_float/fast_float.h>
+
 #include "objparser.hpp"
 
 #include "libslic3r/LocalesUtils.hpp"
 
 namespace ObjParser {
 #define EATWS()  while (*line == ' ' || *line == '\t') ++line
-static bool obj_parseline(const char *line, ObjData &data)
+
+namespace {
+
+// Lines of an OBJ file parsed by obj_parseline(). Blocks of lines of a file are parsed in parallel, then appended
+// to ObjData in the order of the file by obj_append_block(), which resolves the references to the preceding blocks.
+struct ObjBlock
+{
+	ObjData				data;
+	// Faces preceding the first usemtl of the block extend the last material of the preceding blocks.
+	int					leading_faces { 0 };
+	// Last vertexIdxEnd assigned to the last material of the preceding blocks, -1 if none.
+	int					leading_vertex_end { -1 };
+	// Indices into data.vertices of the references relative to the end of the vertex lists (negative indices in the file).
+	std::vector<int>	relative_coords;
+	std::vector<int>	relative_texture_coords;
+	std::vector<int>	relative_normals;
+};
+
+// Replacement of strtod() / strtol() with the same treatment of leading white space, sign and of a failed conversion
+// (endptr set to str), but independent of the locale and much faster on the millions of numbers of large OBJ files.
+template<typename T>
+inline T obj_strto(const char *str, char **endptr)
+{
+	const char *begin = str;
+	while (*begin == ' ' || *begin == '\t')
+		++ begin;
+	if (*begin == '+' && begin[1] != '-')
+		++ begin;
+	// Numbers are short, the end of the string is only searched for the characters which may form a number.
+	const char *end = begin;
+	while ((*end >= '0' && *end <= '9') || *end == '.' || *end == '-' || *end == '+' || *end == 'e' || *end == 'E' ||
+		(std::is_floating_point_v<T> && ((*end >= 'a' && *end <= 'z') || (*end >= 'A' && *end <= 'Z'))))
+		++ end;
+	T value = 0;
+	std::from_chars_result result;
+	if constexpr (std::is_floating_point_v<T>) {
+		auto [ptr, ec] = fast_float::from_chars(begin, end, value);
+		result = { ptr, ec };
+	} else
+		result = std::from_chars(begin, end, value);
+	if (result.ec != std::errc()) {
+		*endptr = const_cast<char*>(str);
+		return T(0);
+	}
+	*endptr = const_cast<char*>(result.ptr);
+	return value;
+}
+
+} // anonymous namespace
+
+static bool obj_parseline(const char *line, ObjBlock &block)
 {
 	if (*line == 0)
 		return true;
-    assert(Slic3r::is_decimal_separator_point());
+	ObjData &data = block.data;
 	// Ignore whitespaces at the beginning of the line.
 	//FIXME is this a good idea?
 	EATWS();
@@ -38,14 +96,14 @@ static bool obj_parseline(const char *line, ObjData &data)
 				return false;
 			EATWS();
 			char *endptr = 0;
-			double u = strtod(line, &endptr);
+			double u = obj_strto<double>(line, &endptr);
 			if (endptr == 0 || (*endptr != ' ' && *endptr != '\t'))
 				return false;
 			line = endptr;
 			EATWS();
 			double v = 0;
 			if (*line != 0) {
-				v = strtod(line, &endptr);
+				v = obj_strto<double>(line, &endptr);
 				if (endptr == 0 || (*endptr != ' ' && *endptr != '\t' && *endptr != 0))
 					return false;
 				line = endptr;
@@ -53,7 +111,7 @@ static bool obj_parseline(const char *line, ObjData &data)
 			}
 			/*double w = 0;
 			if (*line != 0) {
-				w = strtod(line, &endptr);
+				w = obj_strto<double>(line, &endptr);
 				if (endptr == 0 || (*endptr != ' ' && *endptr != '\t' && *endptr != 0))
 					return false;
 				line = endptr;
@@ -75,17 +133,17 @@ static bool obj_parseline(const char *line, ObjData &data)
 				return false;
 			EATWS();
 			char *endptr = 0;
-			double x = strtod(line, &endptr);
+			double x = obj_strto<double>(line, &endptr);
 			if (endptr == 0 || (*endptr != ' ' && *endptr != '\t'))
 				return false;
 			line = endptr;
 			EATWS();
-			double y = strtod(line, &endptr);
+			double y = obj_strto<double>(line, &endptr);
 			if (endptr == 0 || (*endptr != ' ' && *endptr != '\t'))
 				return false;
 			line = endptr;
 			EATWS();
-			double z = strtod(line, &endptr);
+			double z = obj_strto<double>(line, &endptr);
 			if (endptr == 0 || (*endptr != ' ' && *endptr != '\t' && *endptr != 0))
 				return false;
 			line = endptr;
@@ -105,19 +163,19 @@ static bool obj_parseline(const char *line, ObjData &data)
 				return false;
 			EATWS();
 			char *endptr = 0;
-			double u = strtod(line, &endptr);
+			double u = obj_strto<double>(line, &endptr);
 			if (endptr == 0 || (*endptr != ' ' && *endptr != '\t' && *endptr != 0))
 				return false;
 			line = endptr;
 			EATWS();
-			double v = strtod(line, &endptr);
+			double v = obj_strto<double>(line, &endptr);
 			if (endptr == 0 || (*endptr != ' ' && *endptr != '\t' && *endptr != 0))
 				return false;
 			line = endptr;
 			EATWS();
 			double w = 0;
 			if (*line != 0) {
-				w = strtod(line, &endptr);
+				w = obj_strto<double>(line, &endptr);
 				if (endptr == 0 || (*endptr != ' ' && *endptr != '\t' && *endptr != 0))
 					return false;
 				line = endptr;
@@ -137,17 +195,17 @@ static bool obj_parseline(const char *line, ObjData &data)
 				return false;
 			EATWS();
 			char *endptr = 0;
-			double x = strtod(line, &endptr);
+			double x = obj_strto<double>(line, &endptr);
 			if (endptr == 0 || (*endptr != ' ' && *endptr != '\t'))
 				return false;
 			line = endptr;
 			EATWS();
-			double y = strtod(line, &endptr);
+			double y = obj_strto<double>(line, &endptr);
 			if (endptr == 0 || (*endptr != ' ' && *endptr != '\t'))
 				return false;
 			line = endptr;
 			EATWS();
-			double z = strtod(line, &endptr);
+			double z = obj_strto<double>(line, &endptr);
 			if (endptr == 0 || (*endptr != ' ' && *endptr != '\t' && *endptr != 0))
 				return false;
 			line = endptr;
@@ -157,24 +215,24 @@ static bool obj_parseline(const char *line, ObjData &data)
                 if (!data.has_vertex_color) {
                     data.has_vertex_color = true;
                 }
-                color_x = strtod(line, &endptr);
+                color_x = obj_strto<double>(line, &endptr);
                 if (endptr == 0 || (*endptr != ' ' && *endptr != '\t' && *endptr != 0))
                     return false;
                 line = endptr;
                 EATWS();
-                color_y = strtod(line, &endptr);
+                color_y = obj_strto<double>(line, &endptr);
                 if (endptr == 0 || (*endptr != ' ' && *endptr != '\t' && *endptr != 0))
                      return false;
                 line = endptr;
                 EATWS();
-                color_z = strtod(line, &endptr);
+                color_z = obj_strto<double>(line, &endptr);
                 if (endptr == 0 || (*endptr != ' ' && *endptr != '\t' && *endptr != 0))
                     return false;
                 line = endptr;
                 EATWS();
                 color_w = 1.0;//default define alpha = 1.0
                 if (*line != 0) {
-                    color_w = strtod(line, &endptr);
+                    color_w = obj_strto<double>(line, &endptr);
                     if (endptr == 0 || (*endptr != ' ' && *endptr != '\t' && *endptr != 0)) return false;
                     line = endptr;
                     EATWS();
@@ -207,12 +265,13 @@ static bool obj_parseline(const char *line, ObjData &data)
 		// current vertex to be parsed
 		ObjVertex vertex;
 		char *endptr = 0;
+		int face_index_count = 0;
 		while (*line != 0) {
 			// Parse a single vertex reference.
 			vertex.coordIdx			= 0;
 			vertex.normalIdx		= 0;
 			vertex.textureCoordIdx	= 0;
-			vertex.coordIdx = strtol(line, &endptr, 10);
+			vertex.coordIdx = obj_strto<int>(line, &endptr);
 			// Coordinate has to be defined
 			if (endptr == 0 || (*endptr != ' ' && *endptr != '\t' && *endptr != '/' && *endptr != 0))
 				return false;
@@ -222,7 +281,7 @@ static bool obj_parseline(const char *line, ObjData &data)
 				// Texture coordinate index may be missing after a 1st slash, but then the normal index has to be present.
 				if (*line != '/') {
 					// Parse the texture coordinate index.
-					vertex.textureCoordIdx = strtol(line, &endptr, 10);
+					vertex.textureCoordIdx = obj_strto<int>(line, &endptr);
 					if (endptr == 0 || (*endptr != ' ' && *endptr != '\t' && *endptr != '/' && *endptr != 0))
 						return false;
 					line = endptr;
@@ -230,44 +289,41 @@ static bool obj_parseline(const char *line, ObjData &data)
 				if (*line == '/') {
 					// Parse normal index.
 					++ line;
-					vertex.normalIdx = strtol(line, &endptr, 10);
+					vertex.normalIdx = obj_strto<int>(line, &endptr);
 					if (endptr == 0 || (*endptr != ' ' && *endptr != '\t' && *endptr != 0))
 						return false;
 					line = endptr;
 				}
 			}
-			if (vertex.coordIdx < 0)
+			// Relative indices are resolved against this block, the preceding blocks are accounted for by obj_append_block().
+			if (vertex.coordIdx < 0) {
                 vertex.coordIdx += (int) data.coordinates.size() / OBJ_VERTEX_LENGTH;
-            else
+                block.relative_coords.push_back((int) data.vertices.size());
+            } else
 				-- vertex.coordIdx;
-			if (vertex.normalIdx < 0)
+			if (vertex.normalIdx < 0) {
                 vertex.normalIdx += (int)data.normals.size() / 3;
-            else
+                block.relative_normals.push_back((int) data.vertices.size());
+            } else
 				-- vertex.normalIdx;
-			if (vertex.textureCoordIdx < 0)
-                vertex.textureCoordIdx += (int)data.textureCoordinates.size() / 3;
-            else
+			if (vertex.textureCoordIdx < 0) {
+                // u, v are stored per texture coordinate.
+                vertex.textureCoordIdx += (int)data.textureCoordinates.size() / 2;
+                block.relative_texture_coords.push_back((int) data.vertices.size());
+            } else
 				-- vertex.textureCoordIdx;
 			data.vertices.push_back(vertex);
+			++ face_index_count;
 			EATWS();
 		}
+        // Triangles count as a single face, quads as two.
+        const int num_faces = face_index_count == 3 ? 1 : face_index_count == 4 ? 2 : 0;
         if (data.usemtls.size() > 0) {
 			data.usemtls.back().vertexIdxEnd = (int) data.vertices.size();
-		}
-        if (data.usemtls.size() > 0) {
-            int face_index_count = 0;
-            for (int i = data.vertices.size() - 1; i >= 0; i--) {
-                if (data.vertices[i].coordIdx == -1) {
-					break;
-				}
-                face_index_count++;
-            }
-            if (face_index_count == 3) {//tri
-                data.usemtls.back().face_end++;
-			} else if (face_index_count == 4) {//quad
-                data.usemtls.back().face_end++;
-                data.usemtls.back().face_end++;
-			}
+            data.usemtls.back().face_end += num_faces;
+        } else {
+            block.leading_vertex_end = (int) data.vertices.size();
+            block.leading_faces     += num_faces;
         }
 		vertex.coordIdx			= -1;
 		vertex.normalIdx		= -1;
@@ -302,7 +358,8 @@ static bool obj_parseline(const char *line, ObjData &data)
 		EATWS();
         if (data.usemtls.size()>0) {
 			data.usemtls.back().vertexIdxEnd = (int) data.vertices.size();
-		}
+		} else
+			block.leading_vertex_end = (int) data.vertices.size();
 		ObjUseMtl usemtl;
         usemtl.vertexIdxFirst = (int)data.vertices.size();
         usemtl.name = line;
@@ -353,7 +410,7 @@ static bool obj_parseline(const char *line, ObjData &data)
 			return false;
 		EATWS();
 		char *endptr = 0;
-		long g = strtol(line, &endptr, 10);
+		long g = obj_strto<int>(line, &endptr);
 		if (endptr == 0 || (*endptr != ' ' && *endptr != '\t' && *endptr != 0))
 			return false;
 		line = endptr;
@@ -373,6 +430,85 @@ static bool obj_parseline(const char *line, ObjData &data)
 
 	return true;
 }
+template<typename T>
+static void append_vector(std::vector<T> &dst, std::vector<T> &&src)
+{
+	// Steal the source only if the destination was not reserved, so that the reserved space is not lost.
+	if (dst.capacity() == 0)
+		dst = std::move(src);
+	else
+		dst.insert(dst.end(), std::make_move_iterator(src.begin()), std::make_move_iterator(src.end()));
+	src = std::vector<T>();
+}
+
+// Append the block to data, offsetting the references of the block by the data of the preceding blocks.
+static void obj_append_block(ObjData &data, ObjBlock &block)
+{
+	ObjData   &src            = block.data;
+	const int  coord_offset   = (int) data.coordinates.size() / OBJ_VERTEX_LENGTH;
+	const int  texture_offset = (int) data.textureCoordinates.size() / 2;
+	const int  normal_offset  = (int) data.normals.size() / 3;
+	const int  vertex_offset  = (int) data.vertices.size();
+
+	for (int i : block.relative_coords)
+		src.vertices[i].coordIdx += coord_offset;
+	for (int i : block.relative_texture_coords)
+		src.vertices[i].textureCoordIdx += texture_offset;
+	for (int i : block.relative_normals)
+		src.vertices[i].normalIdx += normal_offset;
+
+	if (! data.usemtls.empty()) {
+		ObjUseMtl &last = data.usemtls.back();
+		if (block.leading_vertex_end != -1)
+			last.vertexIdxEnd = block.leading_vertex_end + vertex_offset;
+		last.face_end += block.leading_faces;
+	}
+	// Faces of the materials of this block are numbered from zero.
+	const int face_offset = data.usemtls.empty() ? 0 : data.usemtls.back().face_end + 1;
+	for (ObjUseMtl &usemtl : src.usemtls) {
+		usemtl.vertexIdxFirst += vertex_offset;
+		if (usemtl.vertexIdxEnd != -1)
+			usemtl.vertexIdxEnd += vertex_offset;
+		usemtl.face_start += face_offset;
+		usemtl.face_end   += face_offset;
+	}
+	for (ObjObject &object : src.objects)
+		object.vertexIdxFirst += vertex_offset;
+	for (ObjGroup &group : src.groups)
+		group.vertexIdxFirst += vertex_offset;
+	for (ObjSmoothingGroup &group : src.smoothingGroups)
+		group.vertexIdxFirst += vertex_offset;
+
+	data.has_vertex_color = data.has_vertex_color || src.has_vertex_color;
+	append_vector(data.coordinates,			std::move(src.coordinates));
+	append_vector(data.textureCoordinates,	std::move(src.textureCoordinates));
+	append_vector(data.normals,				std::move(src.normals));
+	append_vector(data.parameters,			std::move(src.parameters));
+	append_vector(data.mtllibs,				std::move(src.mtllibs));
+	append_vector(data.usemtls,				std::move(src.usemtls));
+	append_vector(data.objects,				std::move(src.objects));
+	append_vector(data.groups,				std::move(src.groups));
+	append_vector(data.smoothingGroups,		std::move(src.smoothingGroups));
+	append_vector(data.vertices,			std::move(src.vertices));
+}
+
+// Parse the lines of [begin, end), which are terminated in place. *end has to be writable.
+static void obj_parse_block(char *begin, char *end, ObjBlock &block)
+{
+	for (char *line = begin; line < end;) {
+		char *eol = line;
+		while (eol != end && *eol != '\r' && *eol != '\n')
+			++ eol;
+		*eol = 0;
+		while (*line == ' ' || *line == '\t')
+			++ line;
+		//FIXME check the return value and exit on error?
+		// Will it break parsing of some obj files?
+		obj_parseline(line, block);
+		line = eol + 1;
+	}
+}
+
 static std::string cur_mtl_name = "";
 static bool        mtl_parseline(const char *line, MtlData &data)
 {
@@ -567,43 +703,73 @@ static bool        mtl_parseline(const char *line, MtlData &data)
 
 bool objparse(const char *path, ObjData &data)
 {
-    Slic3r::CNumericLocalesSetter locales_setter;
+	return objparse(path, data, 4 * 1024 * 1024);
+}
 
-	FILE *pFile = boost::nowide::fopen(path, "rt");
+bool objparse(const char *path, ObjData &data, size_t block_size)
+{
+	FILE *pFile = boost::nowide::fopen(path, "rb");
 	if (pFile == 0)
 		return false;
 
 	try {
-		char buf[65536 * 2];
-		size_t len = 0;
-		size_t lenPrev = 0;
-		while ((len = ::fread(buf + lenPrev, 1, 65536, pFile)) != 0) {
-			len += lenPrev;
-			size_t lastLine = 0;
-			for (size_t i = 0; i < len; ++ i)
-				if (buf[i] == '\r' || buf[i] == '\n') {
-					buf[i] = 0;
-					char *c = buf + lastLine;
-					while (*c == ' ' || *c == '\t')
-						++ c;
-					//FIXME check the return value and exit on error?
-					// Will it break parsing of some obj files?
-					obj_parseline(c, data);
-					lastLine = i + 1;
-				}
-			lenPrev = len - lastLine;
-			if (lenPrev > 65536) {
-		    	BOOST_LOG_TRIVIAL(error) << "ObjParser: Excessive line length";
-				::fclose(pFile);
-				return false;
+		// Read the whole file, its lines are terminated in place. Line ends are recognized by the parser,
+		// thus the file is read in binary mode.
+		std::vector<char> buf;
+		boost::system::error_code ec;
+		if (uintmax_t size = boost::filesystem::file_size(boost::filesystem::path(path), ec); ! ec)
+			// Space for the whole file to be read at once, for the attempt to read past its end and for the terminating zero.
+			buf.reserve(size_t(size) + 65536 + 1);
+		for (size_t len = 0;;) {
+			buf.resize(std::max(len + 65536, buf.capacity() ? buf.capacity() - 1 : 0));
+			size_t read = ::fread(buf.data() + len, 1, buf.size() - len, pFile);
+			len += read;
+			if (read == 0 || len < buf.size()) {
+				buf.resize(len);
+				break;
 			}
-			memmove(buf, buf + lastLine, lenPrev);
 		}
-    }
-    catch (std::bad_alloc&) {
-    	BOOST_LOG_TRIVIAL(error) << "ObjParser: Out of memory";
+		::fclose(pFile);
+		pFile = nullptr;
+		// Terminate the last line.
+		buf.push_back(0);
+		const size_t len = buf.size() - 1;
+
+		// Split the file into blocks at line ends, parse the blocks in parallel and append them in the order of the file.
+		std::vector<size_t> block_starts { 0 };
+		while (len - block_starts.back() > block_size) {
+			auto it = std::find_if(buf.begin() + block_starts.back() + block_size, buf.begin() + len, [](char c) { return c == '\r' || c == '\n'; });
+			if (it == buf.begin() + len)
+				break;
+			block_starts.emplace_back(it - buf.begin() + 1);
+		}
+		block_starts.emplace_back(len);
+
+		std::vector<ObjBlock> blocks(block_starts.size() - 1);
+		tbb::parallel_for(tbb::blocked_range<size_t>(0, blocks.size(), 1), [&buf, &block_starts, &blocks](const tbb::blocked_range<size_t> &range) {
+			for (size_t i = range.begin(); i < range.end(); ++ i)
+				obj_parse_block(buf.data() + block_starts[i], buf.data() + block_starts[i + 1], blocks[i]);
+		});
+
+		auto reserve = [&blocks](auto &vec, auto member) {
+			size_t size = vec.size();
+			for (const ObjBlock &block : blocks)
+				size += (block.data.*member).size();
+			vec.reserve(size);
+		};
+		reserve(data.coordinates,			&ObjData::coordinates);
+		reserve(data.textureCoordinates,	&ObjData::textureCoordinates);
+		reserve(data.normals,				&ObjData::normals);
+		reserve(data.vertices,				&ObjData::vertices);
+		for (ObjBlock &block : blocks)
+			obj_append_block(data, block);
+	}
+	catch (std::bad_alloc&) {
+		if (pFile)
+			::fclose(pFile);
+		BOOST_LOG_TRIVIAL(error) << "ObjParser: Out of memory";
+		return false;
 	}
-	::fclose(pFile);
 	return true;
 }
 
@@ -648,9 +814,8 @@ bool mtlparse(const char *path, MtlData &data)
 
 bool objparse(std::istream &stream, ObjData &data)
 {
-    Slic3r::CNumericLocalesSetter locales_setter;
-
     try {
+        ObjBlock block;
         char buf[65536 * 2];
         size_t len = 0;
         size_t lenPrev = 0;
@@ -663,12 +828,25 @@ bool objparse(std::istream &stream, ObjData &data)
                     char *c = buf + lastLine;
                     while (*c == ' ' || *c == '\t')
                         ++ c;
-                    obj_parseline(c, data);
+                    obj_parseline(c, block);
                     lastLine = i + 1;
                 }
             lenPrev = len - lastLine;
+            if (lenPrev > 65536) {
+                BOOST_LOG_TRIVIAL(error) << "ObjParser: Excessive line length";
+                return false;
+            }
             memmove(buf, buf + lastLine, lenPrev);
         }
+        if (lenPrev > 0) {
+            // The last line is not terminated by a line end.
+            buf[lenPrev] = 0;
+            char *c = buf;
+            while (*c == ' ' || *c == '\t')
+                ++ c;
+            obj_parseline(c, block);
+        }
+        obj_append_block(data, block);
     }
     catch (std::bad_alloc&) {
     	BOOST_LOG_TRIVIAL(error) << "ObjParser: Out of memory";
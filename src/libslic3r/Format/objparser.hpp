@@ -124,6 +124,9 @@ struct MtlData
     std::unordered_map<std::string, std::shared_ptr<ObjNewMtl>> new_mtl_unmap;
 };
 extern bool objparse(const char *path, ObjData &data);
+// The file is split into blocks of about block_size bytes, which are parsed in parallel. The overload above uses blocks of 4MB,
+// this one is exposed for testing.
+extern bool objparse(const char *path, ObjData &data, size_t block_size);
 extern bool mtlparse(const char *path, MtlData &data);
 extern bool objparse(std::istream &stream, ObjData &data);
 
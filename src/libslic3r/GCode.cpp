@@ -20,12 +20,16 @@
 #include "LocalesUtils.hpp"
 #include "libslic3r/format.hpp"
 #include "Time.hpp"
+#include "Trace.hpp"
 #include "GCode/ExtrusionProcessor.hpp"
 #include <algorithm>
 #include <cmath>
 #include <cstdlib>
 #include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <iostream>
+#include <mutex>
 #include <math.h>
 #include <stdlib.h>
 #include <string>
@@ -47,6 +51,7 @@
 #include "SVG.hpp"
 
 #include <tbb/parallel_for.h>
+#include <tbb/task_arena.h>
 #include "calib.hpp"
 // Intel redesigned some TBB interface considerably when merging TBB with their oneAPI set of libraries, see GH #7332.
 // We are using quite an old TBB 2017 U7. Before we update our build servers, let's use the old API, which is deprecated in up to date TBB.
@@ -1469,9 +1474,23 @@ void GCode::do_export(Print* print, const char* path, GCodeProcessorResult* resu
     std::string path_tmp(path);
     path_tmp += ".tmp";
 
-    m_processor.initialize(path_tmp);
+    // The G-code is post-processed twice (time estimates, M73 and placeholders), each pass reading and rewriting the whole file.
+    // If the destination is not the temporary directory (possibly a network share), spool the G-code into the temporary
+    // directory and let the last post-processing pass write the destination file.
+    std::string path_spool = path_tmp;
+    if (! temporary_dir().empty()) {
+        boost::system::error_code ec;
+        if (fs::is_directory(temporary_dir(), ec) && ! fs::equivalent(folder, temporary_dir(), ec) && ! ec)
+            path_spool = (fs::path(temporary_dir()) / fs::unique_path(file_path.filename().string() + ".%%%%-%%%%.tmp")).string();
+    }
+    // Don't leave the spool file behind if the export or the post-processing throws.
+    ScopeGuard spool_guard;
+    if (path_spool != path_tmp)
+        spool_guard = ScopeGuard([&path_spool]() { boost::nowide::remove(path_spool.c_str()); });
+
+    m_processor.initialize(path_spool);
     m_processor.set_print(print);
-    GCodeOutputStream file(boost::nowide::fopen(path_tmp.c_str(), "wb"), m_processor);
+    GCodeOutputStream file(boost::nowide::fopen(path_spool.c_str(), "wb"), m_processor);
     if (! file.is_open()) {
         BOOST_LOG_TRIVIAL(error) << std::string("G-code export to ") + path + " failed.\nCannot open the file for writing.\n" << std::endl;
         if (!fs::exists(folder)) {
@@ -1486,14 +1505,14 @@ void GCode::do_export(Print* print, const char* path, GCodeProcessorResult* resu
         file.flush();
         if (file.is_error()) {
             file.close();
-            boost::nowide::remove(path_tmp.c_str());
+            boost::nowide::remove(path_spool.c_str());
             throw Slic3r::RuntimeError(std::string("G-code export to ") + path + " failed\nIs the disk full?\n");
         }
     } catch (std::exception & /* ex */) {
         // Rethrow on any exception. std::runtime_exception and CanceledException are expected to be thrown.
         // Close and remove the file.
         file.close();
-        boost::nowide::remove(path_tmp.c_str());
+        boost::nowide::remove(path_spool.c_str());
         throw;
     }
     file.close();
@@ -1557,7 +1576,11 @@ void GCode::do_export(Print* print, const char* path, GCodeProcessorResult* resu
         }
     }
 
+    if (path_spool != path_tmp)
+        m_processor.set_post_process_output(path_tmp);
     m_processor.finalize(true);
+    // The last post-processing pass deleted the spool file.
+    spool_guard.reset();
 //    DoExport::update_print_estimated_times_stats(m_processor, print->m_print_statistics);
     DoExport::update_print_estimated_stats(m_processor, m_writer.extruders(), print->m_print_statistics, print->config());
     if (result != nullptr) {
@@ -2369,7 +2392,7 @@ void GCode::_do_export(Print& print, GCodeOutputStream &file, ThumbnailsGenerato
 
     //flush FanMover buffer to avoid modifying the start gcode if it's manual.
     if (!machine_start_gcode.empty() && this->m_fan_mover.get() != nullptr)
-        file.write(this->m_fan_mover.get()->process_gcode("", true));
+        file.write(this->m_fan_mover.get()->process_gcode(GCodeLines(), true).gcode());
 
     // Process filament-specific gcode.
    /* if (has_wipe_tower) {
@@ -2728,9 +2751,68 @@ void GCode::check_placeholder_parser_failed()
     }
 }
 
+namespace {
+
+// Soft limit of the memory held by the G-code of the layers between the tokenizer and the output of the export pipeline.
+// The layer selector waits for the output to catch up once the limit is exceeded. The wait is bounded, so that the pipelines
+// of several plates sharing the worker threads do not deadlock.
+class PipelineMemoryBudget
+{
+public:
+    explicit PipelineMemoryBudget(size_t limit) : m_limit(limit) {}
+
+    // Called by the layer selector before a new layer enters the pipeline.
+    void wait()
+    {
+        // With a single worker thread the output cannot run while the layer selector waits.
+        if (m_limit == 0 || tbb::this_task_arena::max_concurrency() == 1)
+            return;
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cond.wait_for(lock, std::chrono::milliseconds(100), [this]() { return m_used <= m_limit || m_acquired.empty(); });
+    }
+    // Called by the tokenizer for each layer in order, including the NOP layers.
+    void acquire(size_t bytes)
+    {
+        if (m_limit == 0)
+            return;
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_acquired.emplace_back(bytes);
+        m_used += bytes;
+    }
+    // Called by the output for each layer in order.
+    void release()
+    {
+        if (m_limit == 0)
+            return;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (! m_acquired.empty()) {
+                m_used -= m_acquired.front();
+                m_acquired.pop_front();
+            }
+        }
+        m_cond.notify_one();
+    }
+
+private:
+    const size_t            m_limit;
+    size_t                  m_used { 0 };
+    std::deque<size_t>      m_acquired;
+    std::mutex              m_mutex;
+    std::condition_variable m_cond;
+};
+
+} // namespace
+
+size_t GCode::pipeline_max_tokens() const
+{
+    // Keep enough layers in flight for the parallel grouping stage to keep the worker threads busy.
+    return m_pipeline_max_tokens > 0 ? m_pipeline_max_tokens : std::max<size_t>(12, 2 * size_t(tbb::this_task_arena::max_concurrency()));
+}
+
 // Process all layers of all objects (non-sequential mode) with a parallel pipeline:
-// Generate G-code, run the filters (vase mode, cooling buffer), run the G-code analyser
-// and export G-code into file.
+// Generate G-code, tokenize it, run the filters (vase mode, cooling buffer) over the tokenized lines,
+// run the G-code analyser and export G-code into file.
 void GCode::process_layers(
     const Print                                                         &print,
     const ToolOrdering                                                  &tool_ordering,
@@ -2739,29 +2821,56 @@ void GCode::process_layers(
     GCodeOutputStream                                                   &output_stream)
 {
     // The pipeline is variable: The vase mode filter is optional.
+    // Extrusions of the layers are grouped by extruders in parallel, the G-code of the layers is generated sequentially
+    // as it depends on the state of the G-code generator left by the previous layer.
+    struct LayerToProcess {
+        // Index into layers_to_print, size_t(-1) for a NOP layer.
+        size_t            idx { size_t(-1) };
+        ObjectsByExtruder by_extruder;
+        std::vector<std::shared_ptr<AvoidCrossingPerimeters::LayerBoundaries>> avoid_crossing_perimeters;
+    };
     size_t layer_to_print_idx = 0;
-    const auto generator = tbb::make_filter<void, LayerResult>(slic3r_tbb_filtermode::serial_in_order,
-        [this, &print, &tool_ordering, &print_object_instances_ordering, &layers_to_print, &layer_to_print_idx](tbb::flow_control& fc) -> LayerResult {
+    PipelineMemoryBudget memory_budget(m_pipeline_max_memory);
+    const auto layer_selector = tbb::make_filter<void, LayerToProcess>(slic3r_tbb_filtermode::serial_in_order,
+        [this, &layers_to_print, &layer_to_print_idx, &memory_budget](tbb::flow_control& fc) -> LayerToProcess {
+            memory_budget.wait();
             if (layer_to_print_idx >= layers_to_print.size()) {
-                if (layer_to_print_idx == layers_to_print.size() + (m_pressure_equalizer ? 1 : 0)) {
+                if (layer_to_print_idx == layers_to_print.size() + (m_pressure_equalizer ? 1 : 0))
                     fc.stop();
-                    return {};
-                } else {
+                else
                     // Pressure equalizer need insert empty input. Because it returns one layer back.
-                    // Insert NOP (no operation) layer;
                     ++layer_to_print_idx;
-                    return LayerResult::make_nop_layer_result();
-                }
+                return {};
+            }
+            return { layer_to_print_idx ++, {}, {} };
+        });
+    const auto grouping = tbb::make_filter<LayerToProcess, LayerToProcess>(slic3r_tbb_filtermode::parallel,
+        [&print, &tool_ordering, &layers_to_print](LayerToProcess in) -> LayerToProcess {
+            Trace::Span span("grouping", "gcode");
+            if (in.idx != size_t(-1)) {
+                const std::pair<coordf_t, std::vector<LayerToPrint>>& layer = layers_to_print[in.idx];
+                in.by_extruder = group_extrusions_by_extruder(print, layer.second, tool_ordering.tools_for_layer(layer.first));
+                in.avoid_crossing_perimeters = prepare_avoid_crossing_perimeters(print, layer.second);
+            }
+            return in;
+        });
+    const auto generator = tbb::make_filter<LayerToProcess, LayerResult>(slic3r_tbb_filtermode::serial_in_order,
+        [this, &print, &tool_ordering, &print_object_instances_ordering, &layers_to_print](LayerToProcess in) -> LayerResult {
+            Trace::Span span("generator", "gcode");
+            if (in.idx == size_t(-1)) {
+                // Insert NOP (no operation) layer;
+                return LayerResult::make_nop_layer_result();
             } else {
-                const std::pair<coordf_t, std::vector<LayerToPrint>>& layer = layers_to_print[layer_to_print_idx++];
+                const std::pair<coordf_t, std::vector<LayerToPrint>>& layer = layers_to_print[in.idx];
                 const LayerTools& layer_tools = tool_ordering.tools_for_layer(layer.first);
-                print.set_status(80, Slic3r::format(_(L("Generating G-code: layer %1%")), std::to_string(layer_to_print_idx)));
+                print.set_status(80, Slic3r::format(_(L("Generating G-code: layer %1%")), std::to_string(in.idx + 1)));
                 if (m_wipe_tower && layer_tools.has_wipe_tower)
                     m_wipe_tower->next_layer();
                 //BBS
                 check_placeholder_parser_failed();
                 print.throw_if_canceled();
-                return this->process_layer(print, layer.second, layer_tools, &layer == &layers_to_print.back(), &print_object_instances_ordering, size_t(-1));
+                m_avoid_crossing_perimeters.set_prepared_layers(std::move(in.avoid_crossing_perimeters));
+                return this->process_layer(print, layer.second, layer_tools, &layer == &layers_to_print.back(), &print_object_instances_ordering, size_t(-1), false, &in.by_extruder);
             }
         });
     if (m_spiral_vase) {
@@ -2771,6 +2880,7 @@ void GCode::process_layers(
     }
     const auto spiral_mode = tbb::make_filter<LayerResult, LayerResult>(slic3r_tbb_filtermode::serial_in_order,
         [&spiral_mode = *this->m_spiral_vase.get(), &layers_to_print](LayerResult in) -> LayerResult {
+            Trace::Span span("spiral_mode", "gcode");
         	if (in.nop_layer_result)
                 return in;
                 
@@ -2780,27 +2890,43 @@ void GCode::process_layers(
         });
     const auto pressure_equalizer = tbb::make_filter<LayerResult, LayerResult>(slic3r_tbb_filtermode::serial_in_order,
         [pressure_equalizer = this->m_pressure_equalizer.get()](LayerResult in) -> LayerResult {
+            Trace::Span span("pressure_equalizer", "gcode");
             return pressure_equalizer->process_layer(std::move(in));
         });
-    const auto cooling = tbb::make_filter<LayerResult, std::string>(slic3r_tbb_filtermode::serial_in_order,
-        [&cooling_buffer = *this->m_cooling_buffer.get()](LayerResult in) -> std::string {
+    // The G-code of a layer is tokenized once, the following filters share the records of the lines.
+    const auto tokenizer = tbb::make_filter<LayerResult, LayerResult>(slic3r_tbb_filtermode::serial_in_order,
+        [&memory_budget](LayerResult in) -> LayerResult {
+            Trace::Span span("tokenizer", "gcode");
+            in.lines.append(in.gcode);
+            in.gcode = std::string();
+            memory_budget.acquire(in.lines.memory_used());
+            return in;
+        });
+    const auto cooling = tbb::make_filter<LayerResult, GCodeLines>(slic3r_tbb_filtermode::serial_in_order,
+        [&cooling_buffer = *this->m_cooling_buffer.get()](LayerResult in) -> GCodeLines {
+            Trace::Span span("cooling", "gcode");
         	if (in.nop_layer_result)
-                return in.gcode;
-            return cooling_buffer.process_layer(std::move(in.gcode), in.layer_id, in.cooling_buffer_flush);
+                return std::move(in.lines);
+            return cooling_buffer.process_layer(std::move(in.lines), in.layer_id, in.cooling_buffer_flush);
         });
-    const auto pa_processor_filter = tbb::make_filter<std::string, std::string>(slic3r_tbb_filtermode::serial_in_order,
-            [&pa_processor = *this->m_pa_processor](std::string in) -> std::string {
+    const auto pa_processor_filter = tbb::make_filter<GCodeLines, GCodeLines>(slic3r_tbb_filtermode::serial_in_order,
+            [&pa_processor = *this->m_pa_processor](GCodeLines in) -> GCodeLines {
+                Trace::Span span("pa_processor", "gcode");
                 return pa_processor.process_layer(std::move(in));
             }
         );
     
-    const auto output = tbb::make_filter<std::string, void>(slic3r_tbb_filtermode::serial_in_order,
-        [&output_stream](std::string s) { output_stream.write(s); }
+    const auto output = tbb::make_filter<GCodeLines, void>(slic3r_tbb_filtermode::serial_in_order,
+        [&output_stream, &memory_budget](GCodeLines lines) {
+            Trace::Span span("output", "gcode");
+            output_stream.write(lines.gcode());
+            memory_budget.release();
+        }
     );
 
-    const auto fan_mover = tbb::make_filter<std::string, std::string>(slic3r_tbb_filtermode::serial_in_order,
-            [&fan_mover = this->m_fan_mover, &config = this->config(), &writer = this->m_writer](std::string in)->std::string {
-
+    const auto fan_mover = tbb::make_filter<GCodeLines, GCodeLines>(slic3r_tbb_filtermode::serial_in_order,
+            [&fan_mover = this->m_fan_mover, &config = this->config(), &writer = this->m_writer](GCodeLines in)->GCodeLines {
+        Trace::Span span("fan_mover", "gcode");
         CNumericLocalesSetter locales_setter;
 
         if (config.fan_speedup_time.value != 0 || config.fan_kickstart.value > 0) {
@@ -2820,18 +2946,18 @@ void GCode::process_layers(
 
     // The pipeline elements are joined using const references, thus no copying is performed.
     if (m_spiral_vase && m_pressure_equalizer)
-        tbb::parallel_pipeline(12, generator & spiral_mode & pressure_equalizer & cooling & fan_mover & output);
+        tbb::parallel_pipeline(pipeline_max_tokens(), layer_selector & grouping & generator & spiral_mode & tokenizer & pressure_equalizer & cooling & fan_mover & output);
     else if (m_spiral_vase)
-    	tbb::parallel_pipeline(12, generator & spiral_mode & cooling & fan_mover & output);
+    	tbb::parallel_pipeline(pipeline_max_tokens(), layer_selector & grouping & generator & spiral_mode & tokenizer & cooling & fan_mover & output);
     else if	(m_pressure_equalizer)
-        tbb::parallel_pipeline(12, generator & pressure_equalizer & cooling & fan_mover & pa_processor_filter & output);
+        tbb::parallel_pipeline(pipeline_max_tokens(), layer_selector & grouping & generator & tokenizer & pressure_equalizer & cooling & fan_mover & pa_processor_filter & output);
     else
-    	tbb::parallel_pipeline(12, generator & cooling & fan_mover & pa_processor_filter & output);
+    	tbb::parallel_pipeline(pipeline_max_tokens(), layer_selector & grouping & generator & tokenizer & cooling & fan_mover & pa_processor_filter & output);
 }
 
 // Process all layers of a single object instance (sequential mode) with a parallel pipeline:
-// Generate G-code, run the filters (vase mode, cooling buffer), run the G-code analyser
-// and export G-code into file.
+// Generate G-code, tokenize it, run the filters (vase mode, cooling buffer) over the tokenized lines,
+// run the G-code analyser and export G-code into file.
 void GCode::process_layers(
     const Print                             &print,
     const ToolOrdering                      &tool_ordering,
@@ -2842,26 +2968,54 @@ void GCode::process_layers(
     const bool                               prime_extruder)
 {
     // The pipeline is variable: The vase mode filter is optional.
+    // Extrusions of the layers are grouped by extruders in parallel, the G-code of the layers is generated sequentially
+    // as it depends on the state of the G-code generator left by the previous layer.
+    struct LayerToProcess {
+        // Index into layers_to_print, size_t(-1) for a NOP layer.
+        size_t                    idx { size_t(-1) };
+        std::vector<LayerToPrint> layers;
+        ObjectsByExtruder         by_extruder;
+        std::vector<std::shared_ptr<AvoidCrossingPerimeters::LayerBoundaries>> avoid_crossing_perimeters;
+    };
     size_t layer_to_print_idx = 0;
-    const auto generator = tbb::make_filter<void, LayerResult>(slic3r_tbb_filtermode::serial_in_order,
-        [this, &print, &tool_ordering, &layers_to_print, &layer_to_print_idx, single_object_idx, prime_extruder](tbb::flow_control& fc) -> LayerResult {
+    PipelineMemoryBudget memory_budget(m_pipeline_max_memory);
+    const auto layer_selector = tbb::make_filter<void, LayerToProcess>(slic3r_tbb_filtermode::serial_in_order,
+        [this, &layers_to_print, &layer_to_print_idx, &memory_budget](tbb::flow_control& fc) -> LayerToProcess {
+            memory_budget.wait();
             if (layer_to_print_idx >= layers_to_print.size()) {
-                if (layer_to_print_idx == layers_to_print.size() + (m_pressure_equalizer ? 1 : 0)) {
+                if (layer_to_print_idx == layers_to_print.size() + (m_pressure_equalizer ? 1 : 0))
                     fc.stop();
-                    return {};
-                } else {
+                else
                     // Pressure equalizer need insert empty input. Because it returns one layer back.
-                    // Insert NOP (no operation) layer;
                     ++layer_to_print_idx;
-                    return LayerResult::make_nop_layer_result();
-                }
+                return {};
+            }
+            size_t idx = layer_to_print_idx ++;
+            return { idx, { layers_to_print[idx] }, {}, {} };
+        });
+    const auto grouping = tbb::make_filter<LayerToProcess, LayerToProcess>(slic3r_tbb_filtermode::parallel,
+        [&print, &tool_ordering](LayerToProcess in) -> LayerToProcess {
+            Trace::Span span("grouping", "gcode");
+            if (in.idx != size_t(-1)) {
+                in.by_extruder = group_extrusions_by_extruder(print, in.layers, tool_ordering.tools_for_layer(in.layers.front().print_z()));
+                in.avoid_crossing_perimeters = prepare_avoid_crossing_perimeters(print, in.layers);
+            }
+            return in;
+        });
+    const auto generator = tbb::make_filter<LayerToProcess, LayerResult>(slic3r_tbb_filtermode::serial_in_order,
+        [this, &print, &tool_ordering, &layers_to_print, single_object_idx, prime_extruder](LayerToProcess in) -> LayerResult {
+            Trace::Span span("generator", "gcode");
+            if (in.idx == size_t(-1)) {
+                // Insert NOP (no operation) layer;
+                return LayerResult::make_nop_layer_result();
             } else {
-                LayerToPrint &layer = layers_to_print[layer_to_print_idx ++];
-                print.set_status(80, Slic3r::format(_(L("Generating G-code: layer %1%")), std::to_string(layer_to_print_idx)));
+                print.set_status(80, Slic3r::format(_(L("Generating G-code: layer %1%")), std::to_string(in.idx + 1)));
                 //BBS
                 check_placeholder_parser_failed();
                 print.throw_if_canceled();
-                return this->process_layer(print, { std::move(layer) }, tool_ordering.tools_for_layer(layer.print_z()), &layer == &layers_to_print.back(), nullptr, single_object_idx, prime_extruder);
+                m_avoid_crossing_perimeters.set_prepared_layers(std::move(in.avoid_crossing_perimeters));
+                return this->process_layer(print, in.layers, tool_ordering.tools_for_layer(in.layers.front().print_z()), in.idx + 1 == layers_to_print.size(),
+                    nullptr, single_object_idx, prime_extruder, &in.by_extruder);
             }
         });
     if (m_spiral_vase) {
@@ -2871,6 +3025,7 @@ void GCode::process_layers(
     }
     const auto spiral_mode = tbb::make_filter<LayerResult, LayerResult>(slic3r_tbb_filtermode::serial_in_order,
         [&spiral_mode = *this->m_spiral_vase.get(), &layers_to_print](LayerResult in)->LayerResult {
+            Trace::Span span("spiral_mode", "gcode");
             if (in.nop_layer_result)
                 return in;
             spiral_mode.enable(in.spiral_vase_enable);
@@ -2879,21 +3034,36 @@ void GCode::process_layers(
         });
     const auto pressure_equalizer = tbb::make_filter<LayerResult, LayerResult>(slic3r_tbb_filtermode::serial_in_order,
         [pressure_equalizer = this->m_pressure_equalizer.get()](LayerResult in) -> LayerResult {
+            Trace::Span span("pressure_equalizer", "gcode");
              return pressure_equalizer->process_layer(std::move(in));
         });
-    const auto cooling = tbb::make_filter<LayerResult, std::string>(slic3r_tbb_filtermode::serial_in_order,
-        [&cooling_buffer = *this->m_cooling_buffer.get()](LayerResult in)->std::string {
+    // The G-code of a layer is tokenized once, the following filters share the records of the lines.
+    const auto tokenizer = tbb::make_filter<LayerResult, LayerResult>(slic3r_tbb_filtermode::serial_in_order,
+        [&memory_budget](LayerResult in) -> LayerResult {
+            Trace::Span span("tokenizer", "gcode");
+            in.lines.append(in.gcode);
+            in.gcode = std::string();
+            memory_budget.acquire(in.lines.memory_used());
+            return in;
+        });
+    const auto cooling = tbb::make_filter<LayerResult, GCodeLines>(slic3r_tbb_filtermode::serial_in_order,
+        [&cooling_buffer = *this->m_cooling_buffer.get()](LayerResult in)->GCodeLines {
+            Trace::Span span("cooling", "gcode");
             if (in.nop_layer_result)
-                return in.gcode;
-            return cooling_buffer.process_layer(std::move(in.gcode), in.layer_id, in.cooling_buffer_flush);
+                return std::move(in.lines);
+            return cooling_buffer.process_layer(std::move(in.lines), in.layer_id, in.cooling_buffer_flush);
         });
-    const auto output = tbb::make_filter<std::string, void>(slic3r_tbb_filtermode::serial_in_order,
-        [&output_stream](std::string s) { output_stream.write(s); }
+    const auto output = tbb::make_filter<GCodeLines, void>(slic3r_tbb_filtermode::serial_in_order,
+        [&output_stream, &memory_budget](GCodeLines lines) {
+            Trace::Span span("output", "gcode");
+            output_stream.write(lines.gcode());
+            memory_budget.release();
+        }
     );
 
-    const auto fan_mover = tbb::make_filter<std::string, std::string>(slic3r_tbb_filtermode::serial_in_order,
-        [&fan_mover = this->m_fan_mover, &config = this->config(), &writer = this->m_writer](std::string in)->std::string {
-
+    const auto fan_mover = tbb::make_filter<GCodeLines, GCodeLines>(slic3r_tbb_filtermode::serial_in_order,
+        [&fan_mover = this->m_fan_mover, &config = this->config(), &writer = this->m_writer](GCodeLines in)->GCodeLines {
+        Trace::Span span("fan_mover", "gcode");
         if (config.fan_speedup_time.value != 0 || config.fan_kickstart.value > 0) {
             if (fan_mover.get() == nullptr)
                 fan_mover.reset(new Slic3r::FanMover(
@@ -2911,13 +3081,13 @@ void GCode::process_layers(
 
     // The pipeline elements are joined using const references, thus no copying is performed.
     if (m_spiral_vase && m_pressure_equalizer)
-        tbb::parallel_pipeline(12, generator & spiral_mode & pressure_equalizer & cooling & fan_mover & output);
+        tbb::parallel_pipeline(pipeline_max_tokens(), layer_selector & grouping & generator & spiral_mode & tokenizer & pressure_equalizer & cooling & fan_mover & output);
     else if (m_spiral_vase)
-    	tbb::parallel_pipeline(12, generator & spiral_mode & cooling & fan_mover & output);
+    	tbb::parallel_pipeline(pipeline_max_tokens(), layer_selector & grouping & generator & spiral_mode & tokenizer & cooling & fan_mover & output);
     else if	(m_pressure_equalizer)
-        tbb::parallel_pipeline(12, generator & pressure_equalizer & cooling & fan_mover & output);
+        tbb::parallel_pipeline(pipeline_max_tokens(), layer_selector & grouping & generator & tokenizer & pressure_equalizer & cooling & fan_mover & output);
     else
-    	tbb::parallel_pipeline(12, generator & cooling & fan_mover & output);
+    	tbb::parallel_pipeline(pipeline_max_tokens(), layer_selector & grouping & generator & tokenizer & cooling & fan_mover & output);
 }
 
 std::string GCode::placeholder_parser_process(const std::string &name, const std::string &templ, unsigned int current_extruder_id, const DynamicConfig *config_override)
@@ -3217,6 +3387,238 @@ inline std::vector<GCode::ObjectByExtruder::Island>& object_islands_by_extruder(
     return islands;
 }
 
+// Prepare the boundaries for avoiding crossing of perimeters by travels for the layers of a single print_z.
+// Only reads the Print, thus it may run for multiple layers in parallel.
+std::vector<std::shared_ptr<AvoidCrossingPerimeters::LayerBoundaries>> GCode::prepare_avoid_crossing_perimeters(
+    const Print                     &print,
+    const std::vector<LayerToPrint> &layers)
+{
+    std::vector<std::shared_ptr<AvoidCrossingPerimeters::LayerBoundaries>> out;
+    if (print.config().reduce_crossing_wall)
+        for (const LayerToPrint &layer_to_print : layers)
+            if (const Layer *layer = layer_to_print.layer(); layer != nullptr)
+                out.emplace_back(AvoidCrossingPerimeters::prepare_layer(*layer));
+    return out;
+}
+
+// Group extrusions of a single print_z by an extruder, then by an object, an island and a region.
+// Only reads the Print and the LayerTools of this print_z, thus it may run for multiple layers in parallel.
+GCode::ObjectsByExtruder GCode::group_extrusions_by_extruder(
+    const Print                     &print,
+    const std::vector<LayerToPrint> &layers,
+    const LayerTools                &layer_tools)
+{
+    ObjectsByExtruder by_extruder;
+    if (layer_tools.extruders.empty())
+        // Nothing to extrude.
+        return by_extruder;
+
+    const unsigned int first_extruder_id = layer_tools.extruders.front();
+    bool is_anything_overridden = const_cast<LayerTools&>(layer_tools).wiping_extrusions().is_anything_overridden();
+    for (const LayerToPrint &layer_to_print : layers) {
+        if (layer_to_print.support_layer != nullptr) {
+            const SupportLayer &support_layer = *layer_to_print.support_layer;
+            const PrintObject& object = *layer_to_print.original_object;
+            if (! support_layer.support_fills.entities.empty()) {
+                ExtrusionRole   role               = support_layer.support_fills.role();
+                bool            has_support        = role == erMixed || role == erSupportMaterial || role == erSupportTransition;
+                bool            has_interface      = role == erMixed || role == erSupportMaterialInterface;
+                // Extruder ID of the support base. -1 if "don't care".
+                unsigned int    support_extruder   = object.config().support_filament.value - 1;
+                // Shall the support be printed with the active extruder, preferably with non-soluble, to avoid tool changes?
+                bool            support_dontcare   = object.config().support_filament.value == 0;
+                // Extruder ID of the support interface. -1 if "don't care".
+                unsigned int    interface_extruder = object.config().support_interface_filament.value - 1;
+                // Shall the support interface be printed with the active extruder, preferably with non-soluble, to avoid tool changes?
+                bool            interface_dontcare = object.config().support_interface_filament.value == 0;
+
+                // BBS: apply wiping overridden extruders
+                WipingExtrusions& wiping_extrusions = const_cast<LayerTools&>(layer_tools).wiping_extrusions();
+                if (support_dontcare) {
+                    int extruder_override = wiping_extrusions.get_support_extruder_overrides(&object);
+                    if (extruder_override >= 0) {
+                        support_extruder = extruder_override;
+                        support_dontcare = false;
+                    }
+                }
+
+                if (interface_dontcare) {
+                    int extruder_override = wiping_extrusions.get_support_interface_extruder_overrides(&object);
+                    if (extruder_override >= 0) {
+                        interface_extruder = extruder_override;
+                        interface_dontcare = false;
+                    }
+                }
+
+                // BBS: try to print support base with a filament other than interface filament
+                if (support_dontcare && !interface_dontcare) {
+                    unsigned int dontcare_extruder = first_extruder_id;
+                    for (unsigned int extruder_id : layer_tools.extruders) {
+                        if (print.config().filament_soluble.get_at(extruder_id))
+                            continue;
+
+                        //BBS: now we don't consider interface filament used in other object
+                        if (extruder_id == interface_extruder)
+                            continue;
+
+                        dontcare_extruder = extruder_id;
+                        break;
+                    }
+                #if 0
+                    //BBS: not found a suitable extruder in current layer ,dontcare_extruider==first_extruder_id==interface_extruder
+                    if (dontcare_extruder == interface_extruder && (object.config().support_interface_not_for_body && object.config().support_interface_filament.value!=0)) {
+                        // BBS : get a suitable extruder from other layer
+                        auto all_extruders = print.extruders();
+                        dontcare_extruder = get_next_extruder(dontcare_extruder, all_extruders);
+                    }
+                #endif
+
+                    if (support_dontcare)
+                        support_extruder = dontcare_extruder;
+                }
+                else if (support_dontcare || interface_dontcare) {
+                    // Some support will be printed with "don't care" material, preferably non-soluble.
+                    // Is the current extruder assigned a soluble filament?
+                    unsigned int dontcare_extruder = first_extruder_id;
+                    if (print.config().filament_soluble.get_at(dontcare_extruder)) {
+                        // The last extruder printed on the previous layer extrudes soluble filament.
+                        // Try to find a non-soluble extruder on the same layer.
+                        for (unsigned int extruder_id : layer_tools.extruders)
+                            if (! print.config().filament_soluble.get_at(extruder_id)) {
+                                dontcare_extruder = extruder_id;
+                                break;
+                            }
+                    }
+                    if (support_dontcare)
+                        support_extruder = dontcare_extruder;
+                    if (interface_dontcare)
+                        interface_extruder = dontcare_extruder;
+                }
+                // Both the support and the support interface are printed with the same extruder, therefore
+                // the interface may be interleaved with the support base.
+                bool single_extruder = ! has_support || support_extruder == interface_extruder;
+                // Assign an extruder to the base.
+                ObjectByExtruder &obj = object_by_extruder(by_extruder, has_support ? support_extruder : interface_extruder, &layer_to_print - layers.data(), layers.size());
+                obj.support = &support_layer.support_fills;
+                obj.support_extrusion_role = single_extruder ? erMixed : erSupportMaterial;
+                if (! single_extruder && has_interface) {
+                    ObjectByExtruder &obj_interface = object_by_extruder(by_extruder, interface_extruder, &layer_to_print - layers.data(), layers.size());
+                    obj_interface.support = &support_layer.support_fills;
+                    obj_interface.support_extrusion_role = erSupportMaterialInterface;
+                }
+            }
+        }
+
+        if (layer_to_print.object_layer != nullptr) {
+            const Layer &layer = *layer_to_print.object_layer;
+            // We now define a strategy for building perimeters and fills. The separation
+            // between regions doesn't matter in terms of printing order, as we follow
+            // another logic instead:
+            // - we group all extrusions by extruder so that we minimize toolchanges
+            // - we start from the last used extruder
+            // - for each extruder, we group extrusions by island
+            // - for each island, we extrude perimeters first, unless user set the infill_first
+            //   option
+            // (Still, we have to keep track of regions because we need to apply their config)
+            size_t n_slices = layer.lslices.size();
+            const std::vector<BoundingBox> &layer_surface_bboxes = layer.lslices_bboxes;
+            // Traverse the slices in an increasing order of bounding box size, so that the islands inside another islands are tested first,
+            // so we can just test a point inside ExPolygon::contour and we may skip testing the holes.
+            std::vector<size_t> slices_test_order;
+            slices_test_order.reserve(n_slices);
+            for (size_t i = 0; i < n_slices; ++ i)
+                slices_test_order.emplace_back(i);
+            std::sort(slices_test_order.begin(), slices_test_order.end(), [&layer_surface_bboxes](size_t i, size_t j) {
+                const Vec2d s1 = layer_surface_bboxes[i].size().cast<double>();
+                const Vec2d s2 = layer_surface_bboxes[j].size().cast<double>();
+                return s1.x() * s1.y() < s2.x() * s2.y();
+            });
+            auto point_inside_surface = [&layer, &layer_surface_bboxes](const size_t i, const Point &point) {
+                const BoundingBox &bbox = layer_surface_bboxes[i];
+                return point(0) >= bbox.min(0) && point(0) < bbox.max(0) &&
+                       point(1) >= bbox.min(1) && point(1) < bbox.max(1) &&
+                       layer.lslices[i].contour.contains(point);
+            };
+
+            for (size_t region_id = 0; region_id < layer.regions().size(); ++ region_id) {
+                const LayerRegion *layerm = layer.regions()[region_id];
+                if (layerm == nullptr)
+                    continue;
+                // PrintObjects own the PrintRegions, thus the pointer to PrintRegion would be unique to a PrintObject, they would not
+                // identify the content of PrintRegion accross the whole print uniquely. Translate to a Print specific PrintRegion.
+                const PrintRegion &region = print.get_print_region(layerm->region().print_region_id());
+
+                // Now we must process perimeters and infills and create islands of extrusions in by_region std::map.
+                // It is also necessary to save which extrusions are part of MM wiping and which are not.
+                // The process is almost the same for perimeters and infills - we will do it in a cycle that repeats twice:
+                std::vector<unsigned int> printing_extruders;
+                for (const ObjectByExtruder::Island::Region::Type entity_type : { ObjectByExtruder::Island::Region::INFILL, ObjectByExtruder::Island::Region::PERIMETERS }) {
+                    for (const ExtrusionEntity *ee : (entity_type == ObjectByExtruder::Island::Region::INFILL) ? layerm->fills.entities : layerm->perimeters.entities) {
+                        // extrusions represents infill or perimeter extrusions of a single island.
+                        assert(dynamic_cast<const ExtrusionEntityCollection*>(ee) != nullptr);
+                        const auto *extrusions = static_cast<const ExtrusionEntityCollection*>(ee);
+                        if (extrusions->entities.empty()) // This shouldn't happen but first_point() would fail.
+                            continue;
+
+                        // This extrusion is part of certain Region, which tells us which extruder should be used for it:
+                        int correct_extruder_id = layer_tools.extruder(*extrusions, region);
+
+                        // Let's recover vector of extruder overrides:
+                        const WipingExtrusions::ExtruderPerCopy *entity_overrides = nullptr;
+                        if (! layer_tools.has_extruder(correct_extruder_id)) {
+                            // this entity is not overridden, but its extruder is not in layer_tools - we'll print it
+                            // by last extruder on this layer (could happen e.g. when a wiping object is taller than others - dontcare extruders are eradicated from layer_tools)
+                            correct_extruder_id = layer_tools.extruders.back();
+                        }
+                        printing_extruders.clear();
+                        if (is_anything_overridden) {
+                            entity_overrides = const_cast<LayerTools&>(layer_tools).wiping_extrusions().get_extruder_overrides(extrusions, layer_to_print.original_object, correct_extruder_id, layer_to_print.object()->instances().size());
+                            if (entity_overrides == nullptr) {
+                                printing_extruders.emplace_back(correct_extruder_id);
+                            } else {
+                                printing_extruders.reserve(entity_overrides->size());
+                                for (int extruder : *entity_overrides)
+                                    printing_extruders.emplace_back(extruder >= 0 ?
+                                        // at least one copy is overridden to use this extruder
+                                        extruder :
+                                        // at least one copy would normally be printed with this extruder (see get_extruder_overrides function for explanation)
+                                        static_cast<unsigned int>(- extruder - 1));
+                                Slic3r::sort_remove_duplicates(printing_extruders);
+                            }
+                        } else
+                            printing_extruders.emplace_back(correct_extruder_id);
+
+                        // Now we must add this extrusion into the by_extruder map, once for each extruder that will print it:
+                        for (unsigned int extruder : printing_extruders)
+                        {
+                            std::vector<ObjectByExtruder::Island> &islands = object_islands_by_extruder(
+                                by_extruder,
+                                extruder,
+                                &layer_to_print - layers.data(),
+                                layers.size(), n_slices+1);
+                            for (size_t i = 0; i <= n_slices; ++ i) {
+                                bool   last = i == n_slices;
+                                size_t island_idx = last ? n_slices : slices_test_order[i];
+                                if (// extrusions->first_point does not fit inside any slice
+                                    last ||
+                                    // extrusions->first_point fits inside ith slice
+                                    point_inside_surface(island_idx, extrusions->first_point())) {
+                                    if (islands[island_idx].by_region.empty())
+                                        islands[island_idx].by_region.assign(print.num_print_regions(), ObjectByExtruder::Island::Region());
+                                    islands[island_idx].by_region[region.print_region_id()].append(entity_type, extrusions, entity_overrides);
+                                    break;
+                                }
+                            }
+                        }
+                    }
+                }
+            } // for regions
+        }
+    } // for objects
+
+    return by_extruder;
+}
+
 std::vector<GCode::InstanceToPrint> GCode::sort_print_object_instances(
     std::vector<GCode::ObjectByExtruder> 		&objects_by_extruder,
     const std::vector<LayerToPrint> 			&layers,
@@ -3554,7 +3956,9 @@ LayerResult GCode::process_layer(
     // Otherwise print a single copy of a single object.
     const size_t                     		 single_object_instance_idx,
     // BBS
-    const bool                               prime_extruder)
+    const bool                               prime_extruder,
+    // Extrusions grouped by group_extrusions_by_extruder(), if already grouped by the caller.
+    ObjectsByExtruder                       *by_extruder_grouped)
 {
     assert(! layers.empty());
     // Either printing all copies of all objects, or just a single copy of a single object.
@@ -3618,6 +4022,8 @@ LayerResult GCode::process_layer(
     }
 
     std::string gcode;
+    // Successive layers produce G-code of a similar size, pre-size the layer buffer to avoid its repeated reallocation.
+    gcode.reserve(m_last_layer_gcode_size + m_last_layer_gcode_size / 4);
     assert(is_decimal_separator_point()); // for the sprintfs
 
     // add tag for processor
@@ -3821,209 +4227,15 @@ LayerResult GCode::process_layer(
         }
     }
 
-    // Group extrusions by an extruder, then by an object, an island and a region.
-    std::map<unsigned int, std::vector<ObjectByExtruder>> by_extruder;
+    // Group extrusions by an extruder, then by an object, an island and a region,
+    // unless the grouping was already done in parallel by the process_layers() pipeline.
+    ObjectsByExtruder by_extruder_local;
+    if (by_extruder_grouped == nullptr) {
+        by_extruder_local   = group_extrusions_by_extruder(print, layers, layer_tools);
+        by_extruder_grouped = &by_extruder_local;
+    }
+    ObjectsByExtruder &by_extruder = *by_extruder_grouped;
     bool is_anything_overridden = const_cast<LayerTools&>(layer_tools).wiping_extrusions().is_anything_overridden();
-    for (const LayerToPrint &layer_to_print : layers) {
-        if (layer_to_print.support_layer != nullptr) {
-            const SupportLayer &support_layer = *layer_to_print.support_layer;
-            const PrintObject& object = *layer_to_print.original_object;
-            if (! support_layer.support_fills.entities.empty()) {
-                ExtrusionRole   role               = support_layer.support_fills.role();
-                bool            has_support        = role == erMixed || role == erSupportMaterial || role == erSupportTransition;
-                bool            has_interface      = role == erMixed || role == erSupportMaterialInterface;
-                // Extruder ID of the support base. -1 if "don't care".
-                unsigned int    support_extruder   = object.config().support_filament.value - 1;
-                // Shall the support be printed with the active extruder, preferably with non-soluble, to avoid tool changes?
-                bool            support_dontcare   = object.config().support_filament.value == 0;
-                // Extruder ID of the support interface. -1 if "don't care".
-                unsigned int    interface_extruder = object.config().support_interface_filament.value - 1;
-                // Shall the support interface be printed with the active extruder, preferably with non-soluble, to avoid tool changes?
-                bool            interface_dontcare = object.config().support_interface_filament.value == 0;
-
-                // BBS: apply wiping overridden extruders
-                WipingExtrusions& wiping_extrusions = const_cast<LayerTools&>(layer_tools).wiping_extrusions();
-                if (support_dontcare) {
-                    int extruder_override = wiping_extrusions.get_support_extruder_overrides(&object);
-                    if (extruder_override >= 0) {
-                        support_extruder = extruder_override;
-                        support_dontcare = false;
-                    }
-                }
-
-                if (interface_dontcare) {
-                    int extruder_override = wiping_extrusions.get_support_interface_extruder_overrides(&object);
-                    if (extruder_override >= 0) {
-                        interface_extruder = extruder_override;
-                        interface_dontcare = false;
-                    }
-                }
-
-                // BBS: try to print support base with a filament other than interface filament
-                if (support_dontcare && !interface_dontcare) {
-                    unsigned int dontcare_extruder = first_extruder_id;
-                    for (unsigned int extruder_id : layer_tools.extruders) {
-                        if (print.config().filament_soluble.get_at(extruder_id))
-                            continue;
-
-                        //BBS: now we don't consider interface filament used in other object
-                        if (extruder_id == interface_extruder)
-                            continue;
-
-                        dontcare_extruder = extruder_id;
-                        break;
-                    }
-                #if 0
-                    //BBS: not found a suitable extruder in current layer ,dontcare_extruider==first_extruder_id==interface_extruder
-                    if (dontcare_extruder == interface_extruder && (object.config().support_interface_not_for_body && object.config().support_interface_filament.value!=0)) {
-                        // BBS : get a suitable extruder from other layer
-                        auto all_extruders = print.extruders();
-                        dontcare_extruder = get_next_extruder(dontcare_extruder, all_extruders);
-                    }
-                #endif
-
-                    if (support_dontcare)
-                        support_extruder = dontcare_extruder;
-                }
-                else if (support_dontcare || interface_dontcare) {
-                    // Some support will be printed with "don't care" material, preferably non-soluble.
-                    // Is the current extruder assigned a soluble filament?
-                    unsigned int dontcare_extruder = first_extruder_id;
-                    if (print.config().filament_soluble.get_at(dontcare_extruder)) {
-                        // The last extruder printed on the previous layer extrudes soluble filament.
-                        // Try to find a non-soluble extruder on the same layer.
-                        for (unsigned int extruder_id : layer_tools.extruders)
-                            if (! print.config().filament_soluble.get_at(extruder_id)) {
-                                dontcare_extruder = extruder_id;
-                                break;
-                            }
-                    }
-                    if (support_dontcare)
-                        support_extruder = dontcare_extruder;
-                    if (interface_dontcare)
-                        interface_extruder = dontcare_extruder;
-                }
-                // Both the support and the support interface are printed with the same extruder, therefore
-                // the interface may be interleaved with the support base.
-                bool single_extruder = ! has_support || support_extruder == interface_extruder;
-                // Assign an extruder to the base.
-                ObjectByExtruder &obj = object_by_extruder(by_extruder, has_support ? support_extruder : interface_extruder, &layer_to_print - layers.data(), layers.size());
-                obj.support = &support_layer.support_fills;
-                obj.support_extrusion_role = single_extruder ? erMixed : erSupportMaterial;
-                if (! single_extruder && has_interface) {
-                    ObjectByExtruder &obj_interface = object_by_extruder(by_extruder, interface_extruder, &layer_to_print - layers.data(), layers.size());
-                    obj_interface.support = &support_layer.support_fills;
-                    obj_interface.support_extrusion_role = erSupportMaterialInterface;
-                }
-            }
-        }
-
-        if (layer_to_print.object_layer != nullptr) {
-            const Layer &layer = *layer_to_print.object_layer;
-            // We now define a strategy for building perimeters and fills. The separation
-            // between regions doesn't matter in terms of printing order, as we follow
-            // another logic instead:
-            // - we group all extrusions by extruder so that we minimize toolchanges
-            // - we start from the last used extruder
-            // - for each extruder, we group extrusions by island
-            // - for each island, we extrude perimeters first, unless user set the infill_first
-            //   option
-            // (Still, we have to keep track of regions because we need to apply their config)
-            size_t n_slices = layer.lslices.size();
-            const std::vector<BoundingBox> &layer_surface_bboxes = layer.lslices_bboxes;
-            // Traverse the slices in an increasing order of bounding box size, so that the islands inside another islands are tested first,
-            // so we can just test a point inside ExPolygon::contour and we may skip testing the holes.
-            std::vector<size_t> slices_test_order;
-            slices_test_order.reserve(n_slices);
-            for (size_t i = 0; i < n_slices; ++ i)
-                slices_test_order.emplace_back(i);
-            std::sort(slices_test_order.begin(), slices_test_order.end(), [&layer_surface_bboxes](size_t i, size_t j) {
-                const Vec2d s1 = layer_surface_bboxes[i].size().cast<double>();
-                const Vec2d s2 = layer_surface_bboxes[j].size().cast<double>();
-                return s1.x() * s1.y() < s2.x() * s2.y();
-            });
-            auto point_inside_surface = [&layer, &layer_surface_bboxes](const size_t i, const Point &point) {
-                const BoundingBox &bbox = layer_surface_bboxes[i];
-                return point(0) >= bbox.min(0) && point(0) < bbox.max(0) &&
-                       point(1) >= bbox.min(1) && point(1) < bbox.max(1) &&
-                       layer.lslices[i].contour.contains(point);
-            };
-
-            for (size_t region_id = 0; region_id < layer.regions().size(); ++ region_id) {
-                const LayerRegion *layerm = layer.regions()[region_id];
-                if (layerm == nullptr)
-                    continue;
-                // PrintObjects own the PrintRegions, thus the pointer to PrintRegion would be unique to a PrintObject, they would not
-                // identify the content of PrintRegion accross the whole print uniquely. Translate to a Print specific PrintRegion.
-                const PrintRegion &region = print.get_print_region(layerm->region().print_region_id());
-
-                // Now we must process perimeters and infills and create islands of extrusions in by_region std::map.
-                // It is also necessary to save which extrusions are part of MM wiping and which are not.
-                // The process is almost the same for perimeters and infills - we will do it in a cycle that repeats twice:
-                std::vector<unsigned int> printing_extruders;
-                for (const ObjectByExtruder::Island::Region::Type entity_type : { ObjectByExtruder::Island::Region::INFILL, ObjectByExtruder::Island::Region::PERIMETERS }) {
-                    for (const ExtrusionEntity *ee : (entity_type == ObjectByExtruder::Island::Region::INFILL) ? layerm->fills.entities : layerm->perimeters.entities) {
-                        // extrusions represents infill or perimeter extrusions of a single island.
-                        assert(dynamic_cast<const ExtrusionEntityCollection*>(ee) != nullptr);
-                        const auto *extrusions = static_cast<const ExtrusionEntityCollection*>(ee);
-                        if (extrusions->entities.empty()) // This shouldn't happen but first_point() would fail.
-                            continue;
-
-                        // This extrusion is part of certain Region, which tells us which extruder should be used for it:
-                        int correct_extruder_id = layer_tools.extruder(*extrusions, region);
-
-                        // Let's recover vector of extruder overrides:
-                        const WipingExtrusions::ExtruderPerCopy *entity_overrides = nullptr;
-                        if (! layer_tools.has_extruder(correct_extruder_id)) {
-                            // this entity is not overridden, but its extruder is not in layer_tools - we'll print it
-                            // by last extruder on this layer (could happen e.g. when a wiping object is taller than others - dontcare extruders are eradicated from layer_tools)
-                            correct_extruder_id = layer_tools.extruders.back();
-                        }
-                        printing_extruders.clear();
-                        if (is_anything_overridden) {
-                            entity_overrides = const_cast<LayerTools&>(layer_tools).wiping_extrusions().get_extruder_overrides(extrusions, layer_to_print.original_object, correct_extruder_id, layer_to_print.object()->instances().size());
-                            if (entity_overrides == nullptr) {
-                                printing_extruders.emplace_back(correct_extruder_id);
-                            } else {
-                                printing_extruders.reserve(entity_overrides->size());
-                                for (int extruder : *entity_overrides)
-                                    printing_extruders.emplace_back(extruder >= 0 ?
-                                        // at least one copy is overridden to use this extruder
-                                        extruder :
-                                        // at least one copy would normally be printed with this extruder (see get_extruder_overrides function for explanation)
-                                        static_cast<unsigned int>(- extruder - 1));
-                                Slic3r::sort_remove_duplicates(printing_extruders);
-                            }
-                        } else
-                            printing_extruders.emplace_back(correct_extruder_id);
-
-                        // Now we must add this extrusion into the by_extruder map, once for each extruder that will print it:
-                        for (unsigned int extruder : printing_extruders)
-                        {
-                            std::vector<ObjectByExtruder::Island> &islands = object_islands_by_extruder(
-                                by_extruder,
-                                extruder,
-                                &layer_to_print - layers.data(),
-                                layers.size(), n_slices+1);
-                            for (size_t i = 0; i <= n_slices; ++ i) {
-                                bool   last = i == n_slices;
-                                size_t island_idx = last ? n_slices : slices_test_order[i];
-                                if (// extrusions->first_point does not fit inside any slice
-                                    last ||
-                                    // extrusions->first_point fits inside ith slice
-                                    point_inside_surface(island_idx, extrusions->first_point())) {
-                                    if (islands[island_idx].by_region.empty())
-                                        islands[island_idx].by_region.assign(print.num_print_regions(), ObjectByExtruder::Island::Region());
-                                    islands[island_idx].by_region[region.print_region_id()].append(entity_type, extrusions, entity_overrides);
-                                    break;
-                                }
-                            }
-                        }
-                    }
-                }
-            } // for regions
-        }
-    } // for objects
 
     if (m_wipe_tower)
         m_wipe_tower->set_is_first_print(true);
@@ -4385,6 +4597,7 @@ LayerResult GCode::process_layer(
         }
     }
 
+    m_last_layer_gcode_size = gcode.size();
     result.gcode = std::move(gcode);
     result.cooling_buffer_flush = object_layer || raft_layer || last_layer;
     return result;
@@ -5088,6 +5301,11 @@ double GCode::get_overhang_degree_corr_speed(float normal_speed, double path_deg
 std::string GCode::_extrude(const ExtrusionPath &path, std::string description, double speed)
 {
     std::string gcode;
+    // Per line copy of the description, reused for all lines of the path to avoid an allocation per G-code line.
+    // The writer drops the comment itself if full_gcode_comment is disabled.
+    std::string tempDescription;
+    // The path is exported line by line, reserve roughly the size of the resulting G-code.
+    gcode.reserve(40 * path.polyline.points.size());
 
     if (is_bridge(path.role()))
         description += " (bridge)";
@@ -5570,7 +5788,7 @@ std::string GCode::_extrude(const ExtrusionPath &path, std::string description,
             // ORCA: End of adaptive PA code segment
         }
         
-        gcode += m_writer.set_speed(F, "", comment);
+        m_writer.set_speed(gcode, F, "", comment);
         {
             if (m_enable_cooling_markers) {
                 if (enable_overhang_bridge_fan) {
@@ -5609,7 +5827,7 @@ std::string GCode::_extrude(const ExtrusionPath &path, std::string description,
                 double path_length = 0.;
                 double total_length = sloped == nullptr ? 0. : path.polyline.length() * SCALING_FACTOR;
                 for (const Line& line : path.polyline.lines()) {
-                    std::string tempDescription = description;
+                    tempDescription = description;
                     const double line_length = line.length() * SCALING_FACTOR;
                     if (line_length < EPSILON)
                         continue;
@@ -5626,26 +5844,26 @@ std::string GCode::_extrude(const ExtrusionPath &path, std::string description,
                     }
                     if (sloped == nullptr) {
                         // Normal extrusion
-                        gcode += m_writer.extrude_to_xy(
+                        m_writer.extrude_to_xy(gcode,
                             this->point_to_gcode(line.b),
                             dE,
-                            GCodeWriter::full_gcode_comment ? tempDescription : "", path.is_force_no_extrusion());
+                            tempDescription, path.is_force_no_extrusion());
                     } else {
                         // Sloped extrusion
                         const auto [z_ratio, e_ratio] = sloped->interpolate(path_length / total_length);
                         Vec2d dest2d = this->point_to_gcode(line.b);
                         Vec3d dest3d(dest2d(0), dest2d(1), get_sloped_z(z_ratio));
-                        gcode += m_writer.extrude_to_xyz(
+                        m_writer.extrude_to_xyz(gcode,
                             dest3d,
                             dE * e_ratio,
-                            GCodeWriter::full_gcode_comment ? tempDescription : "", path.is_force_no_extrusion());
+                            tempDescription, path.is_force_no_extrusion());
                     }
                 }
             } else {
                 // BBS: start to generate gcode from arc fitting data which includes line and arc
                 const std::vector<PathFittingData>& fitting_result = path.polyline.fitting_result;
                 for (size_t fitting_index = 0; fitting_index < fitting_result.size(); fitting_index++) {
-                    std::string tempDescription = description;
+                    tempDescription = description;
                     switch (fitting_result[fitting_index].path_type) {
                     case EMovePathType::Linear_move: {
                         size_t start_index = fitting_result[fitting_index].start_point_index;
@@ -5666,10 +5884,10 @@ std::string GCode::_extrude(const ExtrusionPath &path, std::string description,
                                     tempDescription += Slic3r::format(" | Old Flow Value: %0.5f Length: %0.5f",oldE, line_length);
                                 }
                             }
-                            gcode += m_writer.extrude_to_xy(
+                            m_writer.extrude_to_xy(gcode,
                                 this->point_to_gcode(line.b),
                                 dE,
-                                GCodeWriter::full_gcode_comment ? tempDescription : "", path.is_force_no_extrusion());
+                                tempDescription, path.is_force_no_extrusion());
                         }
                         break;
                     }
@@ -5690,12 +5908,12 @@ std::string GCode::_extrude(const ExtrusionPath &path, std::string description,
                                 tempDescription += Slic3r::format(" | Old Flow Value: %0.5f Length: %0.5f",oldE, arc_length);
                             }
                         }
-                        gcode += m_writer.extrude_arc_to_xy(
+                        m_writer.extrude_arc_to_xy(gcode,
                             this->point_to_gcode(arc.end_point),
                             center_offset,
                             dE,
                             arc.direction == ArcDirection::Arc_Dir_CCW,
-                            GCodeWriter::full_gcode_comment ? tempDescription : "", path.is_force_no_extrusion());
+                            tempDescription, path.is_force_no_extrusion());
                         break;
                     }
                     default:
@@ -5718,7 +5936,7 @@ std::string GCode::_extrude(const ExtrusionPath &path, std::string description,
             Polyline l(p);
             total_length = l.length() * SCALING_FACTOR;
         }
-        gcode += m_writer.set_speed(last_set_speed, "", comment);
+        m_writer.set_speed(gcode, last_set_speed, "", comment);
         Vec2d prev = this->point_to_gcode_quantized(new_points[0].p);
         bool pre_fan_enabled = false;
         bool cur_fan_enabled = false;
@@ -5727,7 +5945,7 @@ std::string GCode::_extrude(const ExtrusionPath &path, std::string description,
 
         double path_length = 0.;
         for (size_t i = 1; i < new_points.size(); i++) {
-            std::string tempDescription = description;
+            tempDescription = description;
             const ProcessedPoint &processed_point = new_points[i];
             const ProcessedPoint &pre_processed_point = new_points[i-1];
             Vec2d p = this->point_to_gcode_quantized(processed_point.p);
@@ -5813,10 +6031,10 @@ std::string GCode::_extrude(const ExtrusionPath &path, std::string description,
             // Ignore small speed variations - emit speed change if the delta between current and new is greater than 60mm/min / 1mm/sec
             // Reset speed to F if delta to F is less than 1mm/sec
             if ((std::abs(last_set_speed - new_speed) > 60)) {
-                gcode += m_writer.set_speed(new_speed, "", comment);
+                m_writer.set_speed(gcode, new_speed, "", comment);
                 last_set_speed = new_speed;
             } else if ((std::abs(F - new_speed) <= 60)) {
-                gcode += m_writer.set_speed(F, "", comment);
+                m_writer.set_speed(gcode, F, "", comment);
                 last_set_speed = F;
             }
             auto dE = e_per_mm * line_length;
@@ -5831,12 +6049,12 @@ std::string GCode::_extrude(const ExtrusionPath &path, std::string description,
             }
             if (sloped == nullptr) {
                 // Normal extrusion
-                gcode += m_writer.extrude_to_xy(p, dE, GCodeWriter::full_gcode_comment ? tempDescription : "");
+                m_writer.extrude_to_xy(gcode, p, dE, tempDescription);
             } else {
                 // Sloped extrusion
                 const auto [z_ratio, e_ratio] = sloped->interpolate(path_length / total_length);
                 Vec3d dest3d(p(0), p(1), get_sloped_z(z_ratio));
-                gcode += m_writer.extrude_to_xyz(dest3d, dE * e_ratio, GCodeWriter::full_gcode_comment ? tempDescription : "");
+                m_writer.extrude_to_xyz(gcode, dest3d, dE * e_ratio, tempDescription);
             }
 
             prev = p;
@@ -6006,14 +6224,14 @@ std::string GCode::travel_to(const Point& point, ExtrusionRole role, std::string
         if (m_spiral_vase) {
             // No lazy z lift for spiral vase mode
             for (size_t i = 1; i < travel.size(); ++i) {
-                gcode += m_writer.travel_to_xy(this->point_to_gcode(travel.points[i]), comment);
+                m_writer.travel_to_xy(gcode, this->point_to_gcode(travel.points[i]), comment);
             }
         } else {
             if (travel.size() == 2) {
                 // No extra movements emitted by avoid_crossing_perimeters, simply move to the end point with z change
                 const auto& dest2d = this->point_to_gcode(travel.points.back());
                 Vec3d dest3d(dest2d(0), dest2d(1), z == DBL_MAX ? m_nominal_z : z);
-                gcode += m_writer.travel_to_xyz(dest3d, comment, m_need_change_layer_lift_z);
+                m_writer.travel_to_xyz(gcode, dest3d, comment, m_need_change_layer_lift_z);
                 m_need_change_layer_lift_z = false;
             } else {
                 // Extra movements emitted by avoid_crossing_perimeters, lift the z to normal height at the beginning, then apply the z
@@ -6023,16 +6241,16 @@ std::string GCode::travel_to(const Point& point, ExtrusionRole role, std::string
                         // Lift to normal z at beginning
                         Vec2d dest2d = this->point_to_gcode(travel.points[i]);
                         Vec3d dest3d(dest2d(0), dest2d(1), m_nominal_z);
-                        gcode += m_writer.travel_to_xyz(dest3d, comment, m_need_change_layer_lift_z);
+                        m_writer.travel_to_xyz(gcode, dest3d, comment, m_need_change_layer_lift_z);
                         m_need_change_layer_lift_z = false;
                     } else if (z != DBL_MAX && i == travel.size() - 1) {
                         // Apply z_ratio for the very last point
                         Vec2d dest2d = this->point_to_gcode(travel.points[i]);
                         Vec3d dest3d(dest2d(0), dest2d(1), z);
-                        gcode += m_writer.travel_to_xyz(dest3d, comment);
+                        m_writer.travel_to_xyz(gcode, dest3d, comment);
                     } else {
                         // For all points in between, no z change
-                        gcode += m_writer.travel_to_xy(this->point_to_gcode(travel.points[i]), comment);
+                        m_writer.travel_to_xy(gcode, this->point_to_gcode(travel.points[i]), comment);
                     }
                 }
             }
@@ -6193,7 +6411,10 @@ std::string GCode::retract(bool toolchange, bool is_last_retraction, LiftType li
     // wipe (if it's enabled for this extruder and we have a stored wipe path and no-zero wipe distance)
     if (EXTRUDER_CONFIG(wipe) && m_wipe.has_path() && scale_(EXTRUDER_CONFIG(wipe_distance)) > SCALED_EPSILON) {
         Wipe::RetractionValues wipeRetractions = m_wipe.calculateWipeRetractionLengths(*this, toolchange);
-        gcode += toolchange ? m_writer.retract_for_toolchange(true,wipeRetractions.retractLengthBeforeWipe) : m_writer.retract(true, wipeRetractions.retractLengthBeforeWipe);
+        if (toolchange)
+            m_writer.retract_for_toolchange(gcode, true, wipeRetractions.retractLengthBeforeWipe);
+        else
+            m_writer.retract(gcode, true, wipeRetractions.retractLengthBeforeWipe);
         gcode += m_wipe.wipe(*this,wipeRetractions.retractLengthDuringWipe, toolchange, is_last_retraction);
     }
 
@@ -6201,7 +6422,10 @@ std::string GCode::retract(bool toolchange, bool is_last_retraction, LiftType li
         (the extruder might be already retracted fully or partially). We call these
         methods even if we performed wipe, since this will ensure the entire retraction
         length is honored in case wipe path was too short.  */
-    gcode += toolchange ? m_writer.retract_for_toolchange() : m_writer.retract();
+    if (toolchange)
+        m_writer.retract_for_toolchange(gcode);
+    else
+        m_writer.retract(gcode);
 
     gcode += m_writer.reset_e();
     // Orca: check if should + can lift (roughly from SuperSlicer)
@@ -6231,7 +6455,7 @@ std::string GCode::retract(bool toolchange, bool is_last_retraction, LiftType li
 
     if (needs_lift && can_lift) {
         size_t extruder_id = m_writer.extruder()->id();
-        gcode += m_writer.lift(!m_spiral_vase ? lift_type : LiftType::NormalLift);
+        m_writer.lift(gcode, !m_spiral_vase ? lift_type : LiftType::NormalLift);
     }
 
     return gcode;
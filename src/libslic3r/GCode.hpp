@@ -10,6 +10,7 @@
 #include "PrintConfig.hpp"
 #include "GCode/AvoidCrossingPerimeters.hpp"
 #include "GCode/CoolingBuffer.hpp"
+#include "GCode/GCodeLines.hpp"
 #include "GCode/FanMover.hpp"
 #include "GCode/RetractWhenCrossingPerimeters.hpp"
 #include "GCode/SpiralVase.hpp"
@@ -155,6 +156,8 @@ struct LayerResult {
 	// Is indicating if this LayerResult should be processed, or it is just inserted artificial LayerResult.
     // It is used for the pressure equalizer because it needs to buffer one layer back.
     bool        nop_layer_result { false };
+    // The G-code tokenized by the export pipeline for the post-processing filters, which take it over from gcode.
+    GCodeLines  lines;
 
     static LayerResult make_nop_layer_result() { return {"", std::numeric_limits<coord_t>::max(), false, false, true}; }
 };
@@ -196,6 +199,11 @@ public:
     //BBS: set offset for gcode writer
     void set_gcode_offset(double x, double y) { m_writer.set_xy_offset(x, y); m_processor.set_xy_offset(x, y);}
 
+    // Number of layers in flight in the G-code generation pipeline. Zero to derive it from the number of worker threads.
+    void set_pipeline_max_tokens(size_t max_tokens) { m_pipeline_max_tokens = max_tokens; }
+    // Soft limit of the memory held by the G-code of the layers in flight in the pipeline in bytes. Zero for no limit.
+    void set_pipeline_max_memory(size_t max_memory) { m_pipeline_max_memory = max_memory; }
+
     // Exported for the helper classes (OozePrevention, Wipe) and for the Perl binding for unit tests.
     const Vec2d&    origin() const { return m_origin; }
     void            set_origin(const Vec2d &pointf);
@@ -224,7 +232,7 @@ public:
     std::string     travel_to(const Point& point, ExtrusionRole role, std::string comment, double z = DBL_MAX);
     bool            needs_retraction(const Polyline& travel, ExtrusionRole role, LiftType& lift_type);
     std::string     retract(bool toolchange = false, bool is_last_retraction = false, LiftType lift_type = LiftType::NormalLift);
-    std::string     unretract() { return m_writer.unlift() + m_writer.unretract(); }
+    std::string     unretract() { std::string gcode; m_writer.unlift(gcode); m_writer.unretract(gcode); return gcode; }
     std::string     set_extruder(unsigned int extruder_id, double print_z, bool by_object=false);
     bool is_BBL_Printer();
 
@@ -315,6 +323,9 @@ private:
         const Layer& layer,
         unsigned int extruder_id);
 
+    struct ObjectByExtruder;
+    using ObjectsByExtruder = std::map<unsigned int, std::vector<ObjectByExtruder>>;
+
     LayerResult process_layer(
         const Print                     &print,
         // Set of object & print layers of the same PrintObject and with the same print_z.
@@ -327,7 +338,11 @@ private:
         // Otherwise print a single copy of a single object.
         const size_t                     single_object_idx = size_t(-1),
         // BBS
-        const bool                       prime_extruder = false);
+        const bool                       prime_extruder = false,
+        // Extrusions of layers grouped by group_extrusions_by_extruder(), if already grouped by the caller.
+        ObjectsByExtruder               *by_extruder = nullptr);
+    // Maximum number of layers in flight in the process_layers() pipelines.
+    size_t pipeline_max_tokens() const;
     // Process all layers of all objects (non-sequential mode) with a parallel pipeline:
     // Generate G-code, run the filters (vase mode, cooling buffer), run the G-code analyser
     // and export G-code into file.
@@ -420,6 +435,18 @@ private:
         std::vector<Island>         islands;
     };
 
+    // Prepare the boundaries of AvoidCrossingPerimeters for the layers of a single print_z.
+    static std::vector<std::shared_ptr<AvoidCrossingPerimeters::LayerBoundaries>> prepare_avoid_crossing_perimeters(
+        const Print                     &print,
+        // Set of object & print layers with the same print_z.
+        const std::vector<LayerToPrint> &layers);
+    // Group extrusions of a single print_z by an extruder, then by an object, an island and a region.
+    static ObjectsByExtruder group_extrusions_by_extruder(
+        const Print                     &print,
+        // Set of object & print layers with the same print_z.
+        const std::vector<LayerToPrint> &layers,
+        const LayerTools                &layer_tools);
+
 	struct InstanceToPrint
 	{
 		InstanceToPrint(ObjectByExtruder &object_by_extruder, size_t layer_id, const PrintObject &print_object, size_t instance_id, size_t label_object_id) :
@@ -541,6 +568,8 @@ private:
     float                               m_last_layer_z{ 0.0f };
     float                               m_max_layer_z{ 0.0f };
     float                               m_last_width{ 0.0f };
+    // Size of the G-code of the last processed layer, used to pre-size the buffer of the next layer.
+    size_t                              m_last_layer_gcode_size{ 0 };
 #if ENABLE_GCODE_VIEWER_DATA_CHECKING
     double                              m_last_mm3_per_mm;
 #endif // ENABLE_GCODE_VIEWER_DATA_CHECKING
@@ -588,6 +617,11 @@ private:
     //some post-processing on the file, with their data class
     std::unique_ptr<FanMover> m_fan_mover;
 
+    // See set_pipeline_max_tokens().
+    size_t m_pipeline_max_tokens { 0 };
+    // See set_pipeline_max_memory().
+    size_t m_pipeline_max_memory { 0 };
+
     // BBS
     Print* m_curr_print = nullptr;
     unsigned int m_toolchange_count;
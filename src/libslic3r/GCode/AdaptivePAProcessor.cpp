@@ -5,9 +5,11 @@
 
 #include "../GCode.hpp"
 #include "AdaptivePAProcessor.hpp"
+#include <boost/algorithm/string/predicate.hpp>
 #include <sstream>
 #include <iostream>
 #include <cmath>
+#include <cstdlib>
 
 namespace Slic3r {
 
@@ -54,43 +56,63 @@ AdaptivePAInterpolator* AdaptivePAProcessor::getInterpolator(unsigned int tool_i
     return nullptr;  // Handle the case where the tool_id is not found
 }
 
+void AdaptivePAProcessor::parse_lines(const GCodeLines &gcode) {
+    m_lines.assign(gcode.size(), LineRecord());
+    for (size_t line_idx = 0; line_idx < gcode.size(); ++ line_idx) {
+        const GCodeLines::Line &line = gcode[line_idx];
+        const std::string_view  text = gcode.line(line_idx);
+        LineRecord             &rec  = m_lines[line_idx];
+        rec.g1_xy      = line.cmd == GCodeLines::Cmd::G1 && line.has(X) && line.has(Y);
+        rec.has_e      = line.has(E);
+        rec.wipe       = text.find("WIPE") != std::string_view::npos;
+        rec.wipe_start = rec.wipe && text.find("WIPE_START") != std::string_view::npos;
+        rec.wipe_end   = rec.wipe && text.find("WIPE_END") != std::string_view::npos;
+        rec.pa_change  = boost::starts_with(text, "; PA_CHANGE");
+        if (rec.pa_change) {
+            std::size_t rc_pos = text.rfind("RC:");
+            // atoi() stops at the end of the line, the G-code text is terminated by a new line.
+            rec.role_change = rc_pos != std::string_view::npos && std::atoi(text.data() + rc_pos + 3) == 1;
+        }
+        rec.g1_f = line.cmd == GCodeLines::Cmd::G1 && line.has(F) && boost::starts_with(text, "G1 F");
+        if (rec.g1_f)
+            rec.feedrate = line.value(F) / 60.0; // Convert from mm/min to mm/s
+    }
+}
+
 /**
  * @brief Processes a layer of G-code and applies adaptive pressure advance.
  *
  * This method processes the G-code for a single layer, identifying the appropriate
  * pressure advance settings and applying them based on the current state and configurations.
  *
- * @param gcode A string containing the G-code for the layer.
- * @return A string containing the processed G-code with adaptive pressure advance applied.
+ * @param gcode The tokenized G-code lines of the layer.
+ * @return The processed G-code lines with adaptive pressure advance applied.
  */
-std::string AdaptivePAProcessor::process_layer(std::string &&gcode) {
-    std::istringstream stream(gcode);
-    std::string line;
-    std::ostringstream output;
+GCodeLines AdaptivePAProcessor::process_layer(GCodeLines &&gcode) {
+    this->parse_lines(gcode);
+    GCodeLines output;
     double mm3mm_value = 0.0;
     unsigned int accel_value = 0;
-    std::string pa_change_line;
     bool wipe_command = false;
 
     // Iterate through each line of the layer G-code
-    while (std::getline(stream, line)) {
+    for (size_t line_idx = 0; line_idx < m_lines.size(); ++ line_idx) {
+        const LineRecord &rec = m_lines[line_idx];
+        const std::string_view line = gcode.line(line_idx);
         
         // If a wipe start command is found, ignore all speed changes till the wipe end part is found
-        if (line.find("WIPE_START") != std::string::npos) {
+        if (rec.wipe_start) {
             wipe_command = true;
         }
                 
         // Update current feed rate (this is preceding an extrude or wipe command only). Ignore any speed changes that are emitted during a wipe move.
         // Travel feedrate is output as part of a G1 X Y (Z) F command
-        if ( (line.find("G1 F") == 0) && (!wipe_command) ) { // prune lines quickly before running pattern matching
-            std::size_t pos = line.find('F');
-            if (pos != std::string::npos){
-                m_current_feedrate = std::stod(line.substr(pos + 1)) / 60.0; // Convert from mm/min to mm/s
-            }
+        if (rec.g1_f && (!wipe_command)) {
+            m_current_feedrate = rec.feedrate;
         }
         
         // Wipe end found, continue searching for current feed rate.
-        if (line.find("WIPE_END") != std::string::npos) {
+        if (rec.wipe_end) {
             wipe_command = false;
         }
         
@@ -105,8 +127,8 @@ std::string AdaptivePAProcessor::process_layer(std::string &&gcode) {
         // as these are the only ones where the PA pattern is output
         // For a mixed extruder layer with both adaptive PA enabled and disabled when the new tool is selected
         // the PA for that material is set. As no tag below will be found for this extruder, the original PA is retained.
-        if (line.find("; PA_CHANGE") == 0) { // prune lines quickly before running regex check as regex is more expensive to run
-            if (std::regex_search(line, m_match, m_pa_change_pattern)) {
+        if (rec.pa_change) { // prune lines quickly before running regex check as regex is more expensive to run
+            if (std::regex_search(line.data(), line.data() + line.size(), m_match, m_pa_change_pattern)) {
                 int extruder_id = std::stoi(m_match[1].str());
                 mm3mm_value = std::stod(m_match[2].str());
                 accel_value = std::stod(m_match[3].str());
@@ -118,12 +140,7 @@ std::string AdaptivePAProcessor::process_layer(std::string &&gcode) {
                 bool extruder_changed = (extruder_id != m_last_extruder_id);
                 m_last_extruder_id = extruder_id;
                 
-                // Save the PA_CHANGE line to output later after finding feedrate
-                pa_change_line = line;
-                
                 // Look ahead for feedrate before any line containing both G and E commands
-                std::streampos current_pos = stream.tellg();
-                std::string next_line;
                 double temp_feed_rate = 0;
                 bool extrude_move_found = false;
                 int line_counter = 0;
@@ -132,13 +149,11 @@ std::string AdaptivePAProcessor::process_layer(std::string &&gcode) {
                 // If a G1 Fxxxx pattern is found, the new speed is identified
                 // Carry on searching for feedrates to find the maximum print speed
                 // until a feature change pattern or a wipe command is detected
-                while (std::getline(stream, next_line)) {
+                for (size_t next_idx = line_idx + 1; next_idx < m_lines.size(); ++ next_idx) {
+                    const LineRecord &next = m_lines[next_idx];
                     line_counter++;
                     // Found an extrude move, set extrude move found flag and move to the next line
-                    if ((!extrude_move_found) && next_line.find("G1 ") == 0 &&
-                        next_line.find('X') != std::string::npos &&
-                        next_line.find('Y') != std::string::npos &&
-                        next_line.find('E') != std::string::npos) {
+                    if ((!extrude_move_found) && next.g1_xy && next.has_e) {
                         // Pattern matched, break the loop
                         extrude_move_found = true;
                         continue;
@@ -146,11 +161,7 @@ std::string AdaptivePAProcessor::process_layer(std::string &&gcode) {
                     
                     // Found a travel move after we've found at least one extrude move
                     // We now need to stop searching for speeds as we're done printing this island
-                    if (next_line.find("G1 ") == 0 &&
-                        next_line.find('X') != std::string::npos && // X is present
-                        next_line.find('Y') != std::string::npos && // Y is present
-                        next_line.find('E') == std::string::npos && // no "E" present
-                        extrude_move_found) {                       // An extrude move has happened already
+                    if (next.g1_xy && ! next.has_e && extrude_move_found) {
                         // First travel move after extrude move found. Stop searching
                         break;
                     }
@@ -159,7 +170,7 @@ std::string AdaptivePAProcessor::process_layer(std::string &&gcode) {
                     // If we have a wipe command, usually the wipe speed is different (larger) than the max print speed
                     // for that feature. So stop searching if a wipe command is found because we do not want to overwrite the
                     // speed used for PA calculation by the Wipe speed.
-                    if (next_line.find("WIPE") != std::string::npos) {
+                    if (next.wipe) {
                         break; // Stop searching if wipe command is found
                     }
                     
@@ -167,33 +178,24 @@ std::string AdaptivePAProcessor::process_layer(std::string &&gcode) {
                     // If RC = 1, it means we have a role change, so stop trying to find the max speed for the feature.
                     // This is possibly redundant as a new feature would always have a travel move preceding it
                     // but check anyway. However check last so to not invoke it without reason...
-                    if (next_line.find("; PA_CHANGE") == 0) { // prune lines quickly before running pattern matching
-                        std::size_t rc_pos = next_line.rfind("RC:");
-                        if (rc_pos != std::string::npos) {
-                            int rc_value = std::stoi(next_line.substr(rc_pos + 3));
-                            if (rc_value == 1) {
-                                break; // Role change found, stop searching
-                            }
-                        }
+                    if (next.role_change) {
+                        break; // Role change found, stop searching
                     }
                     
                     // Found a Feedrate change command
                     // If the new feedrate is greater than any feedrate encountered so far after the PA change command, use that to calculate the PA value
                     // Also if this is the first feedrate we encounter, store it as the next feedrate.
-                    if (next_line.find("G1 F") == 0) { // prune lines quickly before running pattern matching
-                        std::size_t pos = next_line.find('F');
-                        if (pos != std::string::npos) {
-                            double feedrate = std::stod(next_line.substr(pos + 1)) / 60.0; // Convert from mm/min to mm/s
-                            if(line_counter==1){ // this is the first command after the PA change pattern, and hence before any extrusion has happened. Reset
-                                                // the current speed to this one
-                                m_current_feedrate = feedrate;
-                            }
-                            if (temp_feed_rate < feedrate) {
-                                temp_feed_rate = feedrate;
-                            }
-                            if(m_next_feedrate < EPSILON){ // This the first feedrate found after the PA Change command
-                                m_next_feedrate = feedrate;
-                            }
+                    if (next.g1_f) {
+                        double feedrate = next.feedrate;
+                        if(line_counter==1){ // this is the first command after the PA change pattern, and hence before any extrusion has happened. Reset
+                                            // the current speed to this one
+                            m_current_feedrate = feedrate;
+                        }
+                        if (temp_feed_rate < feedrate) {
+                            temp_feed_rate = feedrate;
+                        }
+                        if(m_next_feedrate < EPSILON){ // This the first feedrate found after the PA Change command
+                            m_next_feedrate = feedrate;
                         }
                         continue;
                     }
@@ -205,10 +207,6 @@ std::string AdaptivePAProcessor::process_layer(std::string &&gcode) {
                 } else // If we didnt find a new feedrate at all after the PA change command, use the current feedrate.
                     m_max_next_feedrate = m_current_feedrate;
                 
-                // Restore stream position
-                stream.clear();
-                stream.seekg(current_pos);
-                
                 // Calculate the predicted PA using the upcomming feature maximum feedrate
                 // Get the interpolator for the active tool
                 AdaptivePAInterpolator* interpolator = getInterpolator(m_last_extruder_id);
@@ -219,7 +217,7 @@ std::string AdaptivePAProcessor::process_layer(std::string &&gcode) {
                 if(!interpolator){ // Tool not found in the interpolator map
                     // Tool not found in the PA interpolator to tool map
                     predicted_pa = m_config.enable_pressure_advance.get_at(m_last_extruder_id) ? m_config.pressure_advance.get_at(m_last_extruder_id) : 0;
-                    if(m_config.gcode_comments) output << "; APA: Tool doesnt have APA enabled\n";
+                    if(m_config.gcode_comments) output.append("; APA: Tool doesnt have APA enabled\n");
                 } else if (!interpolator->isInitialised() || (!m_config.adaptive_pressure_advance.get_at(m_last_extruder_id)) )
                     // Check if the model is not initialised by the constructor for the active extruder
                     // Also check that adaptive PA is enabled for that extruder. This should not be needed
@@ -228,7 +226,7 @@ std::string AdaptivePAProcessor::process_layer(std::string &&gcode) {
                 {
                     // Model failed or adaptive pressure advance not enabled - use default value from m_config
                     predicted_pa = m_config.enable_pressure_advance.get_at(m_last_extruder_id) ? m_config.pressure_advance.get_at(m_last_extruder_id) : 0;
-                    if(m_config.gcode_comments) output << "; APA: Interpolator setup failed, using default pressure advance\n";
+                    if(m_config.gcode_comments) output.append("; APA: Interpolator setup failed, using default pressure advance\n");
                 } else { // Model setup succeeded
                     // Proceed to identify the print speed to use to calculate the adaptive PA value
                     if(isOverhang > 0){  // If we are in an overhang area, use the minimum between current print speed
@@ -253,33 +251,33 @@ std::string AdaptivePAProcessor::process_layer(std::string &&gcode) {
                     
                     if (predicted_pa < 0) { // If extrapolation fails, fall back to the default PA for the extruder.
                         predicted_pa = m_config.enable_pressure_advance.get_at(m_last_extruder_id) ? m_config.pressure_advance.get_at(m_last_extruder_id) : 0;
-                        if(m_config.gcode_comments) output << "; APA: Interpolation failed, using fallback pressure advance value\n";
+                        if(m_config.gcode_comments) output.append("; APA: Interpolation failed, using fallback pressure advance value\n");
                     }
                 }
                 if(m_config.gcode_comments) {
                     // Output debug GCode comments
-                    output << pa_change_line << '\n'; // Output PA change command tag
+                    output.append(gcode, line_idx); // Output PA change command tag
                     if(isBridge && m_config.adaptive_pressure_advance_bridges.get_at(m_last_extruder_id) > EPSILON)
-                        output << "; APA Model Override (bridge)\n";
-                    output << "; APA Current Speed: " << std::to_string(m_current_feedrate) << "\n";
-                    output << "; APA Next Speed: " << std::to_string(m_next_feedrate) << "\n";
-                    output << "; APA Max Next Speed: " << std::to_string(m_max_next_feedrate) << "\n";
-                    output << "; APA Speed Used: " << std::to_string(adaptive_PA_speed) << "\n";
-                    output << "; APA Flow rate: " << std::to_string(mm3mm_value * m_max_next_feedrate) << "\n";
-                    output << "; APA Prev PA: " << std::to_string(m_last_predicted_pa) << " New PA: " << std::to_string(predicted_pa) << "\n"; 
+                        output.append("; APA Model Override (bridge)\n");
+                    output.append("; APA Current Speed: " + std::to_string(m_current_feedrate) + "\n");
+                    output.append("; APA Next Speed: " + std::to_string(m_next_feedrate) + "\n");
+                    output.append("; APA Max Next Speed: " + std::to_string(m_max_next_feedrate) + "\n");
+                    output.append("; APA Speed Used: " + std::to_string(adaptive_PA_speed) + "\n");
+                    output.append("; APA Flow rate: " + std::to_string(mm3mm_value * m_max_next_feedrate) + "\n");
+                    output.append("; APA Prev PA: " + std::to_string(m_last_predicted_pa) + " New PA: " + std::to_string(predicted_pa) + "\n"); 
                 }
                 if (extruder_changed || std::fabs(predicted_pa - m_last_predicted_pa) > EPSILON) {
-                    output << m_gcodegen.writer().set_pressure_advance(predicted_pa); // Use m_writer to set pressure advance
+                    output.append(m_gcodegen.writer().set_pressure_advance(predicted_pa)); // Use m_writer to set pressure advance
                     m_last_predicted_pa = predicted_pa; // Update the last predicted PA value
                 }
             }
         }else {
-            // Output the current line as this isn't a PA change tag
-            output << line << '\n';
+            // Output the current line as this isn't a PA change tag, together with its record
+            output.append(gcode, line_idx);
         }
     }
 
-    return output.str();
+    return output;
 }
 
 } // namespace Slic3r
@@ -7,12 +7,14 @@
 #define ADAPTIVEPAPROCESSOR_H
 
 #include <string>
+#include <string_view>
 #include <sstream>
 #include <regex>
 #include <memory>
 #include <map>
 #include <vector>
 #include "AdaptivePAInterpolator.hpp"
+#include "GCodeLines.hpp"
 
 namespace Slic3r {
 
@@ -41,10 +43,10 @@ public:
      * This method processes the G-code for a single layer, identifying the appropriate
      * pressure advance settings and applying them based on the current state and configurations.
      *
-     * @param gcode A string containing the G-code for the layer.
-     * @return A string containing the processed G-code with adaptive pressure advance applied.
+     * @param gcode The tokenized G-code lines of the layer.
+     * @return The processed G-code lines with adaptive pressure advance applied.
      */
-    std::string process_layer(std::string &&gcode);
+    GCodeLines process_layer(GCodeLines &&gcode);
     
     /**
      * @brief Manually sets adaptive PA internal value.
@@ -66,7 +68,34 @@ private:
 
     std::regex m_pa_change_pattern; ///< Regular expression to detect PA_CHANGE pattern.
     std::regex m_g1_f_pattern; ///< Regular expression to detect G1 F pattern.
-    std::smatch m_match; ///< Match results for regular expressions.
+    std::cmatch m_match; ///< Match results for regular expressions.
+
+    /**
+     * @brief Classification of a single G-code line of the layer being processed.
+     *
+     * The flags are derived once per layer from the records shared by the stages of the G-code export pipeline,
+     * so that the look-ahead for the feedrates of the upcoming island does not inspect the same lines again
+     * for each PA change tag.
+     */
+    struct LineRecord {
+        bool g1_xy { false };       ///< G1 move with both X and Y present.
+        bool has_e { false };       ///< E axis is present.
+        bool wipe { false };        ///< Contains a WIPE tag.
+        bool wipe_start { false };  ///< Contains the WIPE_START tag.
+        bool wipe_end { false };    ///< Contains the WIPE_END tag.
+        bool pa_change { false };   ///< Starts with the PA_CHANGE tag.
+        bool role_change { false }; ///< PA_CHANGE tag with RC:1.
+        bool g1_f { false };        ///< Starts with G1 F.
+        double feedrate { 0. };     ///< Feedrate of a G1 F line in mm/s.
+    };
+    std::vector<LineRecord> m_lines; ///< Records of the lines of the layer, reused between layers.
+
+    /**
+     * @brief Classifies the tokenized layer G-code into m_lines.
+     *
+     * @param gcode The tokenized G-code lines of the layer.
+     */
+    void parse_lines(const GCodeLines &gcode);
 
     /**
      * @brief Get the PA interpolator attached to the specified tool ID.
@@ -1182,26 +1182,43 @@ Polyline AvoidCrossingPerimeters::travel_to(const GCode &gcodegen, const Point &
     Vec2d startf = start.cast<double>();
     Vec2d endf   = end  .cast<double>();
 
+    if (! m_layer_boundaries)
+        m_layer_boundaries = std::make_shared<LayerBoundaries>();
+    const LayerBoundaries &lb = *m_layer_boundaries;
+    // Plan the travel along the boundary, reuse the travel if it has already been planned for another instance.
+    auto plan_travel = [&startf, &endf, &gcodegen](Boundary &boundary, Polyline &result_pl) -> size_t {
+        auto [it, inserted] = boundary.travels.try_emplace({ gcodegen.layer(), startf.cast<coord_t>(), endf.cast<coord_t>() });
+        if (inserted)
+            it->second.second = avoid_perimeters(boundary, startf.cast<coord_t>(), endf.cast<coord_t>(), *gcodegen.layer(), it->second.first);
+        result_pl = it->second.first;
+        return it->second.second;
+    };
     bool is_support_layer = dynamic_cast<const SupportLayer *>(gcodegen.layer()) != nullptr;
-    if (!use_external && (is_support_layer || (!m_lslices_offset.empty() && !any_expolygon_contains(m_lslices_offset, m_lslices_offset_bboxes, m_grid_lslices_offset, travel)))) {
+    if (!use_external && (is_support_layer || (!lb.lslices_offset.empty() && !any_expolygon_contains(lb.lslices_offset, lb.lslices_offset_bboxes, lb.grid_lslices_offset, travel)))) {
         // Initialize m_internal only when it is necessary.
-        if (m_internal.boundaries.empty())
-            init_boundary(&m_internal, to_polygons(get_boundary(*gcodegen.layer())));
+        if (m_internal == nullptr) {
+            m_internal = &m_layer_boundaries->internal[gcodegen.layer()];
+            if (m_internal->boundaries.empty())
+                init_boundary(m_internal, to_polygons(get_boundary(*gcodegen.layer())));
+        }
 
         // Trim the travel line by the bounding box.
-        if (!m_internal.boundaries.empty() && Geometry::liang_barsky_line_clipping(startf, endf, m_internal.bbox)) {
-            travel_intersection_count = avoid_perimeters(m_internal, startf.cast<coord_t>(), endf.cast<coord_t>(), *gcodegen.layer(), result_pl);
+        if (!m_internal->boundaries.empty() && Geometry::liang_barsky_line_clipping(startf, endf, m_internal->bbox)) {
+            travel_intersection_count = plan_travel(*m_internal, result_pl);
             result_pl.points.front()  = start;
             result_pl.points.back()   = end;
         }
     } else if(use_external) {
         // Initialize m_external only when exist any external travel for the current layer.
-        if (m_external.boundaries.empty())
-            init_boundary(&m_external, get_boundary_external(*gcodegen.layer()));
+        if (m_external == nullptr) {
+            m_external = &m_layer_boundaries->external[gcodegen.layer()];
+            if (m_external->boundaries.empty())
+                init_boundary(m_external, get_boundary_external(*gcodegen.layer()));
+        }
 
         // Trim the travel line by the bounding box.
-        if (!m_external.boundaries.empty() && Geometry::liang_barsky_line_clipping(startf, endf, m_external.bbox)) {
-            travel_intersection_count = avoid_perimeters(m_external, startf.cast<coord_t>(), endf.cast<coord_t>(), *gcodegen.layer(), result_pl);
+        if (!m_external->boundaries.empty() && Geometry::liang_barsky_line_clipping(startf, endf, m_external->bbox)) {
+            travel_intersection_count = plan_travel(*m_external, result_pl);
             result_pl.points.front()  = start;
             result_pl.points.back()   = end;
         }
@@ -1233,32 +1250,46 @@ Polyline AvoidCrossingPerimeters::travel_to(const GCode &gcodegen, const Point &
     } else if (max_detour_length_exceeded) {
         *could_be_wipe_disabled = false;
     } else
-        *could_be_wipe_disabled = !need_wipe(gcodegen, m_lslices_offset, m_lslices_offset_bboxes, m_grid_lslices_offset, travel, result_pl, travel_intersection_count);
+        *could_be_wipe_disabled = !need_wipe(gcodegen, lb.lslices_offset, lb.lslices_offset_bboxes, lb.grid_lslices_offset, travel, result_pl, travel_intersection_count);
 
     return result_pl;
 }
 
 // ************************************* AvoidCrossingPerimeters::init_layer() *****************************************
 
-void AvoidCrossingPerimeters::init_layer(const Layer &layer)
+std::shared_ptr<AvoidCrossingPerimeters::LayerBoundaries> AvoidCrossingPerimeters::prepare_layer(const Layer &layer)
 {
-    m_internal.clear();
-    m_external.clear();
-    m_lslices_offset.clear();
-    m_lslices_offset_bboxes.clear();
+    auto out = std::make_shared<LayerBoundaries>();
+    out->layer = &layer;
 
     float perimeter_offset = -get_external_perimeter_width(layer) / float(2.);
-    m_lslices_offset        = offset_ex(layer.lslices, perimeter_offset);
+    out->lslices_offset    = offset_ex(layer.lslices, perimeter_offset);
 
-    m_lslices_offset_bboxes.reserve(m_lslices_offset.size());
-    for (const ExPolygon &ex_poly : m_lslices_offset)
-        m_lslices_offset_bboxes.emplace_back(get_extents(ex_poly));
+    out->lslices_offset_bboxes.reserve(out->lslices_offset.size());
+    for (const ExPolygon &ex_poly : out->lslices_offset)
+        out->lslices_offset_bboxes.emplace_back(get_extents(ex_poly));
 
     BoundingBox bbox_slice(get_extents(layer.lslices));
     bbox_slice.offset(SCALED_EPSILON);
 
-    m_grid_lslices_offset.set_bbox(bbox_slice);
-    m_grid_lslices_offset.create(m_lslices_offset, coord_t(scale_(1.)));
+    out->grid_lslices_offset.set_bbox(bbox_slice);
+    out->grid_lslices_offset.create(out->lslices_offset, coord_t(scale_(1.)));
+
+    // The boundary for travels inside the object is the most expensive to calculate and it is needed by most layers.
+    init_boundary(&out->internal[&layer], to_polygons(get_boundary(layer)));
+    return out;
+}
+
+void AvoidCrossingPerimeters::init_layer(const Layer &layer)
+{
+    m_internal = nullptr;
+    m_external = nullptr;
+    if (m_layer_boundaries && m_layer_boundaries->layer == &layer)
+        return;
+
+    auto it = std::find_if(m_prepared_layers.begin(), m_prepared_layers.end(),
+        [&layer](const std::shared_ptr<LayerBoundaries> &lb) { return lb->layer == &layer; });
+    m_layer_boundaries = it == m_prepared_layers.end() ? prepare_layer(layer) : *it;
 }
 
 #if 0
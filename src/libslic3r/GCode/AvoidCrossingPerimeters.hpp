@@ -5,6 +5,10 @@
 #include "../ExPolygon.hpp"
 #include "../EdgeGrid.hpp"
 
+#include <map>
+#include <memory>
+#include <tuple>
+
 namespace Slic3r {
 
 // Forward declarations.
@@ -23,6 +27,8 @@ public:
     bool        disabled_once() const   { return m_disabled_once; }
     void        reset_once_modifiers()  { m_use_external_mp_once = false; m_disabled_once = false; }
 
+    // Use the boundaries of the layer prepared by prepare_layer() if available, otherwise prepare them.
+    // The boundaries are kept if the layer did not change since the last call, for example when printing another instance.
     void        init_layer(const Layer &layer);
 
     Polyline    travel_to(const GCode& gcodegen, const Point& point)
@@ -42,14 +48,38 @@ public:
         std::vector<std::vector<float>> boundaries_params;
         // Used for detection of intersection between line and any polygon from boundaries
         EdgeGrid::Grid                  grid;
+        // Travels planned along these boundaries, indexed by the layer printed and by the travel line clipped by bbox,
+        // with the number of intersections of the travel with the boundaries.
+        // Instances of the same object request the same travels inside the object.
+        std::map<std::tuple<const Layer*, Point, Point>, std::pair<Polyline, size_t>> travels;
 
         void clear()
         {
             boundaries.clear();
             boundaries_params.clear();
+            travels.clear();
         }
     };
 
+    // Data of a single layer for planning the travels, shared by all instances and extruders printing the layer.
+    struct LayerBoundaries {
+        const Layer                            *layer { nullptr };
+        // Lslices offseted by half an external perimeter width. Used for detection if line or polyline is inside of any polygon.
+        ExPolygons                              lslices_offset;
+        std::vector<BoundingBox>                lslices_offset_bboxes;
+        // Used for detection of line or polyline is inside of any polygon.
+        EdgeGrid::Grid                          grid_lslices_offset;
+        // Boundaries for travels inside and outside of objects, created on demand for the layer being printed.
+        std::map<const Layer*, Boundary>        internal;
+        std::map<const Layer*, Boundary>        external;
+    };
+
+    // Prepare the boundaries of a layer for travels inside objects. Does not depend on the state of the G-code generator,
+    // thus multiple layers may be prepared in parallel ahead of the G-code generation.
+    static std::shared_ptr<LayerBoundaries> prepare_layer(const Layer &layer);
+    // Layers prepared by prepare_layer() to be picked up by init_layer().
+    void        set_prepared_layers(std::vector<std::shared_ptr<LayerBoundaries>> &&layers) { m_prepared_layers = std::move(layers); }
+
 private:
     bool           m_use_external_mp { false };
     // just for the next travel move
@@ -58,15 +88,13 @@ private:
     // we enable it by default for the first travel move in print
     bool           m_disabled_once { true };
 
-    // Lslices offseted by half an external perimeter width. Used for detection if line or polyline is inside of any polygon.
-    ExPolygons               m_lslices_offset;
-    std::vector<BoundingBox> m_lslices_offset_bboxes;
-    // Used for detection of line or polyline is inside of any polygon.
-    EdgeGrid::Grid           m_grid_lslices_offset;
-    // Store all needed data for travels inside object
-    Boundary m_internal;
-    // Store all needed data for travels outside object
-    Boundary m_external;
+    std::vector<std::shared_ptr<LayerBoundaries>> m_prepared_layers;
+    // Boundaries of the layer passed to init_layer().
+    std::shared_ptr<LayerBoundaries>              m_layer_boundaries;
+    // Store all needed data for travels inside object, an item of m_layer_boundaries->internal.
+    Boundary                                     *m_internal { nullptr };
+    // Store all needed data for travels outside object, an item of m_layer_boundaries->external.
+    Boundary                                     *m_external { nullptr };
 };
 
 } // namespace Slic3r
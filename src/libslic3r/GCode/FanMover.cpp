@@ -1,6 +1,6 @@
 #include "FanMover.hpp"
 
-#include "GCodeReader.hpp"
+#include <boost/algorithm/string/predicate.hpp>
 
 #include <iomanip>
 /*
@@ -19,26 +19,33 @@
 
 namespace Slic3r {
 
-const std::string& FanMover::process_gcode(const std::string& gcode, bool flush)
+GCodeLines FanMover::process_gcode(const GCodeLines& gcode, bool flush)
 {
-    m_process_output = "";
+    m_process_output.clear();
 
     // recompute buffer time to recover from rounding
     m_buffer_time_size = 0;
     for (auto& data : m_buffer) m_buffer_time_size += data.time;
 
-    if(!gcode.empty())
-        m_parser.parse_buffer(gcode,
-            [this](GCodeReader& reader, const GCodeReader::GCodeLine& line) { /*m_process_output += line.raw() + "\n";*/ this->_process_gcode_line(reader, line); });
+    for (size_t idx = 0; idx < gcode.size(); ++ idx)
+        this->_process_gcode_line(gcode, idx);
 
     if (flush) {
         while (!m_buffer.empty()) {
-            m_process_output += m_buffer.front().raw + "\n";
+            _write(m_buffer.front());
             remove_from_buffer(m_buffer.begin());
         }
     }
 
-    return m_process_output;
+    return std::move(m_process_output);
+}
+
+void FanMover::_write(const BufferData& data)
+{
+    if (data.parsed)
+        m_process_output.append(data.raw, data.record);
+    else
+        m_process_output.append(data.raw);
 }
 
 bool is_end_of_word(char c) {
@@ -108,6 +115,8 @@ void FanMover::_put_in_middle_G1(std::list<BufferData>::iterator item_to_split,
         && item_to_split->raw[0] == 'G' && item_to_split->raw[1] == '1' && item_to_split->raw[2] == ' ') {
         float percent = nb_sec_since_itemtosplit_start / item_to_split->time;
         BufferData before = *item_to_split;
+        // The first part of the split line is rewritten.
+        before.parsed = false;
         before.time *= percent;
         item_to_split->time *= (1-percent);
         if (item_to_split->dx != 0) {
@@ -134,6 +143,7 @@ void FanMover::_put_in_middle_G1(std::list<BufferData>::iterator item_to_split,
                 change_axis_value(before.raw, 'E', before.de, 5);
                 item_to_split->de = item_to_split->de * (1 - percent);
                 change_axis_value(item_to_split->raw, 'E', item_to_split->de, 5);
+                item_to_split->parsed = false;
             } else {
                 before.de = item_to_split->de * percent;
                 item_to_split->e += before.de;
@@ -154,13 +164,13 @@ void FanMover::_put_in_middle_G1(std::list<BufferData>::iterator item_to_split,
 void FanMover::_print_in_middle_G1(BufferData& line_to_split, float nb_sec, const std::string &line_to_write) {
     if (nb_sec < line_to_split.time * 0.1) {
         // doesn't really need to be split, print it after
-        m_process_output += line_to_split.raw + "\n";
-        m_process_output += line_to_write + (line_to_write.back() == '\n'?"":"\n");
+        _write(line_to_split);
+        m_process_output.append(line_to_write);
     } else if (nb_sec > line_to_split.time * 0.9) {
         // doesn't really need to be split, print it before
         //will also print before if line_to_split.time == 0
-        m_process_output += line_to_write + (line_to_write.back() == '\n' ? "" : "\n");
-        m_process_output += line_to_split.raw + "\n";
+        m_process_output.append(line_to_write);
+        _write(line_to_split);
     }else if(line_to_split.raw.size() > 2
         && line_to_split.raw[0] == 'G' && line_to_split.raw[1] == '1' && line_to_split.raw[2] == ' ') {
         float percent = nb_sec / line_to_split.time;
@@ -179,18 +189,19 @@ void FanMover::_print_in_middle_G1(BufferData& line_to_split, float nb_sec, cons
             if (relative_e) {
                 change_axis_value(before, 'E', line_to_split.de * percent, 5);
                 change_axis_value(after, 'E', line_to_split.de * (1 - percent), 5);
+                line_to_split.parsed = false;
             } else {
                 change_axis_value(before, 'E', line_to_split.e + line_to_split.de * percent, 5);
             }
         }
-        m_process_output += before + "\n";
-        m_process_output += line_to_write + (line_to_write.back() == '\n' ? "" : "\n");
-        m_process_output += line_to_split.raw + "\n";
+        m_process_output.append(before);
+        m_process_output.append(line_to_write);
+        _write(line_to_split);
 
     } else {
         //not a G1, print it before
-        m_process_output += line_to_write + (line_to_write.back() == '\n' ? "" : "\n");
-        m_process_output += line_to_split.raw + "\n";
+        m_process_output.append(line_to_write);
+        _write(line_to_split);
     }
 }
 
@@ -256,16 +267,20 @@ void FanMover::_process_T(const std::string_view command)
     }
 }
 
-void FanMover::_process_gcode_line(GCodeReader& reader, const GCodeReader::GCodeLine& line)
+void FanMover::_process_gcode_line(const GCodeLines& gcode, size_t idx)
 {
-    // processes 'normal' gcode lines
+    // processes 'normal' gcode lines, which were tokenized by the export pipeline
+    const GCodeLines::Line& line = gcode[idx];
+    const std::string_view  raw  = gcode.line(idx);
+    const std::string_view  cmd  = gcode.command(idx);
     bool need_flush = false;
-    std::string cmd(line.cmd());
     double time = 0;
     int16_t fan_speed = -1;
+    // Distance to the position set by this line.
+    auto dist = [this, &line](Axis axis) { return line.has(axis) ? line.value(axis) - m_pos[axis] : 0.f; };
     if (cmd.length() > 1) {
-        if (line.has_f())
-            m_current_speed = line.f() / 60.0f;
+        if (line.has(F))
+            m_current_speed = line.value(F) / 60.0f;
         switch (::toupper(cmd[0])) {
         case 'T':
         case 't':
@@ -273,10 +288,10 @@ void FanMover::_process_gcode_line(GCodeReader& reader, const GCodeReader::GCode
                 break;
         case 'G':
         {
-            if (::atoi(&cmd[1]) == 1 || ::atoi(&cmd[1]) == 0) {
-                double distx = line.dist_X(reader);
-                double disty = line.dist_Y(reader);
-                double distz = line.dist_Z(reader);
+            if (line.cmd == GCodeLines::Cmd::G1 || line.cmd == GCodeLines::Cmd::G0) {
+                double distx = dist(X);
+                double disty = dist(Y);
+                double distz = dist(Z);
                 double dist = distx * distx + disty * disty + distz * distz;
                 if (dist > 0) {
                     dist = std::sqrt(dist);
@@ -287,7 +302,7 @@ void FanMover::_process_gcode_line(GCodeReader& reader, const GCodeReader::GCode
         }
         case 'M':
         {
-            fan_speed = get_fan_speed(line.raw(), m_writer.config.gcode_flavor);
+            fan_speed = get_fan_speed(std::string(raw), m_writer.config.gcode_flavor);
             if (fan_speed >= 0) {
                 const auto fan_baseline = 255.0;
                 fan_speed = 100 * fan_speed / fan_baseline;
@@ -317,7 +332,7 @@ void FanMover::_process_gcode_line(GCodeReader& reader, const GCodeReader::GCode
                                     _print_in_middle_G1(m_buffer.front(), m_buffer_time_size - nb_seconds_delay, _set_fan(100));//m_writer.set_fan(100, true)); //FIXME extruder id (or use the gcode writer, but then you have to disable the multi-thread thing
                                     remove_from_buffer(m_buffer.begin());
                                 } else {
-                                    m_process_output += _set_fan(100);//m_writer.set_fan(100, true)); //FIXME extruder id (or use the gcode writer, but then you have to disable the multi-thread thing
+                                    m_process_output.append(_set_fan(100));//m_writer.set_fan(100, true)); //FIXME extruder id (or use the gcode writer, but then you have to disable the multi-thread thing
                                 }
                                 //write it in the queue if possible
                                 const float kickstart_duration = kickstart * float(fan_speed - m_front_buffer_fan_speed) / 100.f;
@@ -327,7 +342,7 @@ void FanMover::_process_gcode_line(GCodeReader& reader, const GCodeReader::GCode
                                     time_count -= it->time;
                                     if (time_count< 0) {
                                         //found something that is lower than us
-                                        _put_in_middle_G1(it, it->time + time_count, BufferData(std::string(line.raw()), 0, fan_speed, true));
+                                        _put_in_middle_G1(it, it->time + time_count, BufferData(std::string(raw), 0, fan_speed, true));
                                         //found, stop
                                         break;
                                     }
@@ -337,7 +352,7 @@ void FanMover::_process_gcode_line(GCodeReader& reader, const GCodeReader::GCode
                                     //can't place it in the buffer, use m_current_kickstart
                                     m_current_kickstart.fan_speed = fan_speed;
                                     m_current_kickstart.time = time_count;
-                                    m_current_kickstart.raw = line.raw();
+                                    m_current_kickstart.raw = raw;
                                 }
                                 m_front_buffer_fan_speed = fan_speed;
                             } else {
@@ -345,10 +360,10 @@ void FanMover::_process_gcode_line(GCodeReader& reader, const GCodeReader::GCode
                                 _remove_slow_fan(fan_speed, m_buffer_time_size + 1);
                                 // then write the fan command
                                 if (!m_buffer.empty() && (m_buffer_time_size - m_buffer.front().time * 0.1) > nb_seconds_delay) {
-                                    _print_in_middle_G1(m_buffer.front(), m_buffer_time_size - nb_seconds_delay, line.raw());
+                                    _print_in_middle_G1(m_buffer.front(), m_buffer_time_size - nb_seconds_delay, std::string(raw));
                                     remove_from_buffer(m_buffer.begin());
                                 } else {
-                                    m_process_output += line.raw() + "\n";
+                                    m_process_output.append(gcode, idx);
                                 }
                                 m_front_buffer_fan_speed = fan_speed;
                             }
@@ -367,7 +382,7 @@ void FanMover::_process_gcode_line(GCodeReader& reader, const GCodeReader::GCode
                                     float kickstart_duration = kickstart * float(fan_speed - m_back_buffer_fan_speed) / 100.f;
                                     m_current_kickstart.fan_speed = fan_speed;
                                     m_current_kickstart.time += kickstart_duration;
-                                    m_current_kickstart.raw = line.raw();
+                                    m_current_kickstart.raw = raw;
                                     //i'm printed by the m_current_kickstart
                                     time = -1;
                                 }
@@ -385,7 +400,7 @@ void FanMover::_process_gcode_line(GCodeReader& reader, const GCodeReader::GCode
                                 //add the normal speed line for the future
                                 m_current_kickstart.fan_speed = fan_speed;
                                 m_current_kickstart.time = kickstart_duration;
-                                m_current_kickstart.raw = line.raw();
+                                m_current_kickstart.raw = raw;
                             }
                         }
                     }
@@ -400,16 +415,16 @@ void FanMover::_process_gcode_line(GCodeReader& reader, const GCodeReader::GCode
         }
         }
     } else {
-        if(!line.raw().empty() && line.raw().front() == ';')
+        if(!raw.empty() && raw.front() == ';')
         {
-            if (line.raw().size() > 10 && line.raw().rfind(";TYPE:", 0) == 0) {
+            if (raw.size() > 10 && boost::starts_with(raw, ";TYPE:")) {
                 // get the type of the next extrusions
-                std::string extrusion_string = line.raw().substr(6, line.raw().size() - 6);
+                std::string extrusion_string(raw.substr(6));
                 current_role = ExtrusionEntity::string_to_role(extrusion_string);
             }
-            if (line.raw().size() > 16) {
-                if (line.raw().rfind("; custom gcode", 0) != std::string::npos)
-                    if (line.raw().rfind("; custom gcode end", 0) != std::string::npos)
+            if (raw.size() > 16) {
+                if (boost::starts_with(raw, "; custom gcode"))
+                    if (boost::starts_with(raw, "; custom gcode end"))
                         m_is_custom_gcode = false;
                     else
                         m_is_custom_gcode = true;
@@ -418,25 +433,29 @@ void FanMover::_process_gcode_line(GCodeReader& reader, const GCodeReader::GCode
     }
 
     if (time >= 0) {
-        BufferData& new_data = put_in_buffer(BufferData(line.raw(), time, fan_speed));
+        BufferData& new_data = put_in_buffer(BufferData(std::string(raw), time, fan_speed));
+        new_data.record = line;
+        new_data.parsed = true;
         if (line.has(Axis::X)) {
-            new_data.x = reader.x();
-            new_data.dx = line.dist_X(reader);
+            new_data.x = m_pos[X];
+            new_data.dx = dist(X);
         }
         if (line.has(Axis::Y)) {
-            new_data.y = reader.y();
-            new_data.dy = line.dist_Y(reader);
+            new_data.y = m_pos[Y];
+            new_data.dy = dist(Y);
         }
         if (line.has(Axis::Z)) {
-            new_data.z = reader.z();
-            new_data.dz = line.dist_Z(reader);
+            new_data.z = m_pos[Z];
+            new_data.dz = dist(Z);
         }
         if (line.has(Axis::E)) {
-            new_data.e = reader.e();
-            if (relative_e)
-                new_data.de = line.e();
-            else
-                new_data.de = line.dist_E(reader);
+            if (relative_e) {
+                new_data.e = 0.f;
+                new_data.de = line.value(E);
+            } else {
+                new_data.e = m_pos[E];
+                new_data.de = dist(E);
+            }
         }
 
         if (m_current_kickstart.time > 0 && time > 0) {
@@ -446,28 +465,7 @@ void FanMover::_process_gcode_line(GCodeReader& reader, const GCodeReader::GCode
                 _put_in_middle_G1(prev(m_buffer.end()), time + m_current_kickstart.time, BufferData{ m_current_kickstart.raw, 0, m_current_kickstart.fan_speed, true });
             }
         }
-    }/* else {
-        BufferData& new_data = put_in_buffer(BufferData("; del? "+line.raw(), 0, fan_speed));
-        if (line.has(Axis::X)) {
-            new_data.x = reader.x();
-            new_data.dx = line.dist_X(reader);
-        }
-        if (line.has(Axis::Y)) {
-            new_data.y = reader.y();
-            new_data.dy = line.dist_Y(reader);
-        }
-        if (line.has(Axis::Z)) {
-            new_data.z = reader.z();
-            new_data.dz = line.dist_Z(reader);
-        }
-        if (line.has(Axis::E)) {
-            new_data.e = reader.e();
-            if (relative_e)
-                new_data.de = line.e();
-            else
-                new_data.de = line.dist_E(reader);
-        }
-    }*/
+    }
     // puts the line back into the gcode
     //if buffer too big, flush it.
     if (time >= 0) {
@@ -476,11 +474,11 @@ void FanMover::_process_gcode_line(GCodeReader& reader, const GCodeReader::GCode
             if (frontdata.fan_speed < 0 || frontdata.fan_speed != m_front_buffer_fan_speed || frontdata.is_kickstart) {
                 if (frontdata.is_kickstart && frontdata.fan_speed < m_front_buffer_fan_speed) {
                     //you have to slow down! not kickstart! rewrite the fan speed.
-                    m_process_output += _set_fan(frontdata.fan_speed);//m_writer.set_fan(frontdata.fan_speed,true); //FIXME extruder id (or use the gcode writer, but then you have to disable the multi-thread thing
+                    m_process_output.append(_set_fan(frontdata.fan_speed));//m_writer.set_fan(frontdata.fan_speed,true); //FIXME extruder id (or use the gcode writer, but then you have to disable the multi-thread thing
                         
                     m_front_buffer_fan_speed = frontdata.fan_speed;
                 } else {
-                    m_process_output += frontdata.raw + "\n";
+                    _write(frontdata);
                     if (frontdata.fan_speed >= 0) {
                         //note that this is the only place where the fan_speed is set and we print from the buffer, as if the fan_speed >= 0 => time == 0
                         //and as this flush all time == 0 lines from the back of the queue...
@@ -491,6 +489,12 @@ void FanMover::_process_gcode_line(GCodeReader& reader, const GCodeReader::GCode
             remove_from_buffer(m_buffer.begin());
         }
     }
+    // Update the position the same way GCodeReader did: G0 to G3 and G92 set the axes present.
+    if (line.is_move() || line.cmd == GCodeLines::Cmd::G92)
+        for (int axis = X; axis <= E; ++ axis)
+            if (line.has(Axis(axis)))
+                m_pos[axis] = line.value(Axis(axis));
+
     double sum = 0;
     for (auto& data : m_buffer) sum += data.time;
     assert( std::abs(m_buffer_time_size - sum) < 0.01);
@@ -7,8 +7,8 @@
 #include "../ExtrusionEntity.hpp"
 
 #include "../Point.hpp"
-#include "../GCodeReader.hpp"
 #include "../GCodeWriter.hpp"
+#include "GCodeLines.hpp"
 #include <regex>
 
 namespace Slic3r {
@@ -16,6 +16,9 @@ namespace Slic3r {
 class BufferData {
 public:
     std::string raw;
+    // Record of raw tokenized by the export pipeline, valid if parsed is set. Cleared once raw is modified.
+    GCodeLines::Line record;
+    bool parsed = false;
     float time;
     int16_t fan_speed;
     bool is_kickstart;
@@ -23,7 +26,7 @@ public:
     float dx = 0, dy = 0, dz = 0, de = 0;
     BufferData(std::string line, float time = 0, int16_t fan_speed = 0, float is_kickstart = false) : raw(line), time(time), fan_speed(fan_speed), is_kickstart(is_kickstart){
         //avoid double \n
-        if(!line.empty() && line.back() == '\n') line.pop_back();
+        if(!raw.empty() && raw.back() == '\n') raw.pop_back();
     }
 };
 
@@ -37,8 +40,9 @@ private:
     const bool only_overhangs;
     const float kickstart;
 
-    GCodeReader m_parser{};
     const GCodeWriter& m_writer;
+    // X, Y, Z, E of the last processed line.
+    float m_pos[4] { 0.f, 0.f, 0.f, 0.f };
 
     //current value (at the back of the buffer), when parsing a new line
     ExtrusionRole current_role = ExtrusionRole::erCustom;
@@ -57,7 +61,7 @@ private:
     double m_buffer_time_size = 0;
 
     // The output of process_layer()
-    std::string m_process_output;
+    GCodeLines m_process_output;
 
 public:
     FanMover(const GCodeWriter& writer, const float nb_seconds_delay, const bool with_D_option, const bool relative_e,
@@ -67,8 +71,8 @@ public:
         with_D_option(with_D_option)
         , relative_e(relative_e), only_overhangs(only_overhangs), kickstart(kickstart), m_writer(writer){}
 
-    // Adds the gcode contained in the given string to the analysis and returns it after removing the workcodes
-    const std::string& process_gcode(const std::string& gcode, bool flush);
+    // Adds the gcode contained in the given lines to the analysis and returns it after removing the workcodes
+    GCodeLines process_gcode(const GCodeLines& gcode, bool flush);
 
 private:
     BufferData& put_in_buffer(BufferData&& data) {
@@ -81,12 +85,14 @@ private:
         return m_buffer.erase(data);
     }
     // Processes the given gcode line
-    void _process_gcode_line(GCodeReader& reader, const GCodeReader::GCodeLine& line);
+    void _process_gcode_line(const GCodeLines& gcode, size_t idx);
     void _process_T(const std::string_view command);
     void _put_in_middle_G1(std::list<BufferData>::iterator item_to_split, float nb_sec, BufferData&& line_to_write);
     void _print_in_middle_G1(BufferData& line_to_split, float nb_sec, const std::string& line_to_write);
     void _remove_slow_fan(int16_t min_speed, float past_sec);
     std::string _set_fan(int16_t speed);
+    // Output a buffered line, with its record if it was not modified.
+    void _write(const BufferData& data);
 };
 
 } // namespace Slic3r
@@ -0,0 +1,181 @@
+#include "GCodeLines.hpp"
+
+#include "fast_float/fast_float.h"
+
+#include <cassert>
+#include <cstring>
+
+namespace Slic3r {
+
+static inline bool is_whitespace(char c)        { return c == ' ' || c == '\t'; }
+static inline bool is_end_of_gcode_line(char c) { return c == ';' || c == '\r' || c == '\n'; }
+static inline bool is_end_of_word(char c)       { return is_whitespace(c) || is_end_of_gcode_line(c); }
+
+static inline const char* skip_whitespaces(const char *c, const char *end)
+{
+    for (; c != end && is_whitespace(*c); ++ c);
+    return c;
+}
+
+static inline const char* skip_word(const char *c, const char *end)
+{
+    for (; c != end && ! is_end_of_word(*c); ++ c);
+    return c;
+}
+
+static GCodeLines::Cmd parse_cmd(const char *c, const char *end)
+{
+    using Cmd = GCodeLines::Cmd;
+    switch (*c) {
+    case 'G': {
+        int code = 0;
+        const char *digit = c + 1;
+        if (digit == end)
+            return Cmd::Other;
+        for (; digit != end; ++ digit) {
+            if (*digit < '0' || *digit > '9')
+                return Cmd::Other;
+            code = code * 10 + (*digit - '0');
+        }
+        switch (code) {
+        case 0:  return Cmd::G0;
+        case 1:  return Cmd::G1;
+        case 2:  return Cmd::G2;
+        case 3:  return Cmd::G3;
+        case 4:  return Cmd::G4;
+        case 10: return Cmd::G10;
+        case 11: return Cmd::G11;
+        case 22: return Cmd::G22;
+        case 23: return Cmd::G23;
+        case 92: return Cmd::G92;
+        default: return Cmd::Other;
+        }
+    }
+    case 'M': return Cmd::M;
+    case 'T': return Cmd::T;
+    default:  return Cmd::Other;
+    }
+}
+
+GCodeLines::Line GCodeLines::parse_line(std::string_view sline)
+{
+    Line        line;
+    const char *begin = sline.data();
+    const char *end   = begin + sline.size();
+    line.length = uint32_t(sline.size());
+    line.comment = line.length;
+
+    const char *c = skip_whitespaces(begin, end);
+    if (c == end || *c == '\r') {
+        line.cmd = Cmd::Empty;
+    } else if (*c == ';') {
+        line.cmd     = Cmd::Comment;
+        line.comment = uint32_t(c - begin);
+    } else {
+        const char *cmd_end = skip_word(c, end);
+        line.cmd = parse_cmd(c, cmd_end);
+        c = cmd_end;
+        // Parse the axes up to the end of line or comment, skip the other words.
+        while (c != end && ! is_end_of_gcode_line(*c)) {
+            if (is_whitespace(*c)) {
+                ++ c;
+                continue;
+            }
+            int axis = -1;
+            switch (*c) {
+            case 'X': axis = X; break;
+            case 'Y': axis = Y; break;
+            case 'Z': axis = Z; break;
+            case 'E': axis = E; break;
+            case 'F': axis = F; break;
+            case 'I': axis = I; break;
+            case 'J': axis = J; break;
+            case 'P': axis = P; break;
+            default: break;
+            }
+            if (axis != -1) {
+                float v;
+                auto [pend, ec] = fast_float::from_chars(c + 1, end, v);
+                if (pend != c + 1 && ec == std::errc() && (pend == end || is_end_of_word(*pend))) {
+                    line.axis[axis] = v;
+                    line.mask |= uint8_t(1 << axis);
+                    c = pend;
+                    continue;
+                }
+            }
+            c = skip_word(c, end);
+        }
+        for (; c != end && *c != ';'; ++ c);
+        line.comment = uint32_t(c - begin);
+    }
+    return line;
+}
+
+std::string_view GCodeLines::command(size_t idx) const
+{
+    const std::string_view sline = this->line(idx);
+    const char *end = sline.data() + sline.size();
+    const char *c   = skip_whitespaces(sline.data(), end);
+    return { c, size_t(skip_word(c, end) - c) };
+}
+
+void GCodeLines::append(std::string_view gcode)
+{
+    size_t begin = m_gcode.size();
+    m_gcode.append(gcode.data(), gcode.size());
+    if (! gcode.empty() && gcode.back() != '\n')
+        m_gcode += '\n';
+    const char *text = m_gcode.data();
+    while (begin < m_gcode.size()) {
+        const char *line_end = static_cast<const char*>(memchr(text + begin, '\n', m_gcode.size() - begin));
+        assert(line_end != nullptr);
+        const size_t end = line_end - text;
+        Line &line = m_lines.emplace_back(parse_line({ text + begin, end - begin }));
+        line.begin = uint32_t(begin);
+        begin = end + 1;
+    }
+}
+
+void GCodeLines::append(std::string_view sline, const Line &record)
+{
+    assert(sline.size() == record.length);
+    assert(sline.find('\n') == std::string_view::npos);
+    Line &line = m_lines.emplace_back(record);
+    line.begin = uint32_t(m_gcode.size());
+    m_gcode.append(sline.data(), sline.size());
+    m_gcode += '\n';
+}
+
+void GCodeLines::append(const GCodeLines &src, size_t first, size_t last)
+{
+    assert(first <= last && last <= src.size());
+    if (first == last)
+        return;
+    // The lines are stored one after another, each of them followed by a new line.
+    const size_t src_begin = src.m_lines[first].begin;
+    const size_t src_end   = src.m_lines[last - 1].begin + src.m_lines[last - 1].length + 1;
+    const size_t begin     = m_gcode.size();
+    m_gcode.append(src.m_gcode, src_begin, src_end - src_begin);
+    m_lines.reserve(m_lines.size() + last - first);
+    for (size_t i = first; i < last; ++ i) {
+        Line &line = m_lines.emplace_back(src.m_lines[i]);
+        line.begin = uint32_t(line.begin - src_begin + begin);
+    }
+}
+
+void GCodeLines::append(GCodeLines &&src)
+{
+    if (this->empty())
+        *this = std::move(src);
+    else
+        this->append(src);
+}
+
+void GCodeLines::pop_back()
+{
+    assert(! m_lines.empty());
+    m_gcode.resize(m_lines.back().begin);
+    m_lines.pop_back();
+}
+
+} // namespace Slic3r
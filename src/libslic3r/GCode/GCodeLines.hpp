@@ -0,0 +1,103 @@
+#ifndef slic3r_GCode_GCodeLines_hpp_
+#define slic3r_GCode_GCodeLines_hpp_
+
+#include "../libslic3r.h"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Slic3r {
+
+// G-code of a layer split into lines, each line tokenized into a compact record.
+// The G-code export pipeline tokenizes the G-code of a layer once, then the post-processing filters
+// (pressure equalizer, cooling buffer, fan mover, adaptive pressure advance) work on the records.
+// A filter copies the lines it keeps together with their records, only the lines it modifies or inserts
+// are tokenized again. The text is kept ready to be written by the output filter.
+class GCodeLines
+{
+public:
+    // Commands interpreted by the post-processing filters, the other commands are Other.
+    enum class Cmd : uint8_t {
+        Empty,
+        Comment,
+        G0,
+        G1,
+        G2,
+        G3,
+        G4,
+        G10,
+        G11,
+        G22,
+        G23,
+        G92,
+        M,
+        T,
+        Other,
+    };
+
+    struct Line
+    {
+        bool  has(Axis axis) const { return (this->mask & (1 << int(axis))) != 0; }
+        float value(Axis axis) const { return this->axis[int(axis)]; }
+        bool  is_move() const { return this->cmd == Cmd::G0 || this->cmd == Cmd::G1 || this->cmd == Cmd::G2 || this->cmd == Cmd::G3; }
+
+        // Start of the line in the G-code text.
+        uint32_t begin   { 0 };
+        // Length of the line without the trailing new line.
+        uint32_t length  { 0 };
+        // Start of the comment relative to the start of the line, length if there is no comment.
+        uint32_t comment { 0 };
+        Cmd      cmd     { Cmd::Empty };
+        // Bit mask of the axes (X, Y, Z, E, F, I, J, P) parsed from the line.
+        uint8_t  mask    { 0 };
+        // Values of the axes as written on the line, valid if the axis is set in mask.
+        float    axis[NUM_AXES] { 0.f };
+    };
+
+    GCodeLines() = default;
+    explicit GCodeLines(std::string_view gcode) { this->append(gcode); }
+
+    // Tokenize one or more lines of G-code and append them. A missing new line at the end of the G-code is added.
+    void                append(std::string_view gcode);
+    // Append a line tokenized before, without the trailing new line.
+    void                append(std::string_view line, const Line &record);
+    // Append the lines <first, last) of another G-code with their records.
+    void                append(const GCodeLines &src, size_t first, size_t last);
+    void                append(const GCodeLines &src, size_t idx) { this->append(src, idx, idx + 1); }
+    void                append(const GCodeLines &src) { this->append(src, 0, src.size()); }
+    void                append(GCodeLines &&src);
+    // Remove the last line.
+    void                pop_back();
+    void                clear() { m_gcode.clear(); m_lines.clear(); }
+
+    bool                empty() const { return m_lines.empty(); }
+    size_t              size() const { return m_lines.size(); }
+    const Line&         operator[](size_t idx) const { return m_lines[idx]; }
+    const Line&         back() const { return m_lines.back(); }
+
+    // Line without the trailing new line.
+    std::string_view    line(size_t idx) const { const Line &l = m_lines[idx]; return { m_gcode.data() + l.begin, l.length }; }
+    // Comment of a line starting with ';', empty if there is no comment.
+    std::string_view    comment(size_t idx) const { return this->line(idx).substr(m_lines[idx].comment); }
+    // First word of a line, for example "G1", "M106" or "T1", empty for a comment.
+    std::string_view    command(size_t idx) const;
+
+    // The text of all the lines, each of them terminated by a new line.
+    const std::string&  gcode() const { return m_gcode; }
+    std::string         release() { std::string out = std::move(m_gcode); this->clear(); return out; }
+    // Memory held by the text and the records.
+    size_t              memory_used() const { return m_gcode.capacity() + m_lines.capacity() * sizeof(Line); }
+
+    // Tokenize a single line without the trailing new line. Line::begin is left at zero.
+    static Line         parse_line(std::string_view line);
+
+private:
+    std::string         m_gcode;
+    std::vector<Line>   m_lines;
+};
+
+} // namespace Slic3r
+
+#endif /* slic3r_GCode_GCodeLines_hpp_ */
@@ -102,7 +102,7 @@ const std::string GCodeProcessor::Flush_End_Tag = " FLUSH_END";
 const float GCodeProcessor::Wipe_Width = 0.05f;
 const float GCodeProcessor::Wipe_Height = 0.05f;
 
-bool GCodeProcessor::s_IsBBLPrinter = true;
+std::atomic<bool> GCodeProcessor::s_IsBBLPrinter { true };
 
 #if ENABLE_GCODE_VIEWER_DATA_CHECKING
 const std::string GCodeProcessor::Mm3_Per_Mm_Tag = "MM3_PER_MM:";
@@ -908,6 +908,7 @@ void GCodeProcessorResult::reset() {
     lock();
 
     moves = std::vector<GCodeProcessorResult::MoveVertex>();
+    arc_interpolations = std::vector<ArcInterpolation>();
     printable_area = Pointfs();
     //BBS: add bed exclude area
     bed_exclude_area = Pointfs();
@@ -935,6 +936,7 @@ void GCodeProcessorResult::reset() {
     lock();
 
     moves.clear();
+    arc_interpolations.clear();
     lines_ends.clear();
     printable_area = Pointfs();
     //BBS: add bed exclude area
@@ -1611,7 +1613,9 @@ void GCodeProcessor::process_file(const std::string& filename, std::function<voi
     // 1st move must be a dummy move
     m_result.moves.emplace_back(GCodeProcessorResult::MoveVertex());
     size_t parse_line_callback_cntr = 10000;
-    m_parser.parse_file(filename, [this, cancel_callback, &parse_line_callback_cntr](GCodeReader& reader, const GCodeReader::GCodeLine& line) {
+    // The G-code lines are tokenized in parallel, while the lines are processed sequentially as the processor's state machine
+    // (positions, extruder, units, time estimation) depends on all the previous lines.
+    m_parser.parse_file_parallel(filename, [this, cancel_callback, &parse_line_callback_cntr](GCodeReader& reader, const GCodeReader::GCodeLine& line) {
         if (-- parse_line_callback_cntr == 0) {
             // Don't call the cancel_callback() too often, do it every at every 10000'th line.
             parse_line_callback_cntr = 10000;
@@ -1629,6 +1633,8 @@ void GCodeProcessor::initialize(const std::string& filename)
 {
     assert(is_decimal_separator_point());
 
+    m_post_process_output.clear();
+
 #if ENABLE_GCODE_VIEWER_STATISTICS
     m_start_time = std::chrono::high_resolution_clock::now();
 #endif // ENABLE_GCODE_VIEWER_STATISTICS
@@ -3383,24 +3389,18 @@ void  GCodeProcessor::process_G2_G3(const GCodeReader::GCodeLine& line)
          float radius = ArcSegment::calc_arc_radius(start_pos, center_pos);
          //BBS: radius is too small to draw
          if (radius <= DRAW_ARC_TOLERANCE) {
-             m_interpolation_points.resize(0);
+             m_arc_interpolation_points_count = 0;
              return;
          }
          float radian_step = 2 * acos((radius - DRAW_ARC_TOLERANCE) / radius);
          float num = ArcSegment::calc_arc_radian(start_pos, end_pos, center_pos, is_ccw) / radian_step;
          float z_step = (num < 1)? end_pos.z() - start_pos.z() : (end_pos.z() - start_pos.z()) / num;
          radian_step = is_ccw ? radian_step : -radian_step;
-         int interpolation_num = floor(num);
-
-         m_interpolation_points.resize(interpolation_num, Vec3f::Zero());
-         Vec3f delta = start_pos - center_pos;
-         for (auto i = 0; i < interpolation_num; i++) {
-             float cos_val = cos((i+1) * radian_step);
-             float sin_val = sin((i+1) * radian_step);
-             m_interpolation_points[i] = Vec3f(center_pos.x() + delta.x() * cos_val - delta.y() * sin_val,
-                                               center_pos.y() + delta.x() * sin_val + delta.y() * cos_val,
-                                               start_pos.z() + (i + 1) * z_step);
-         }
+         //BBS: only the arc is stored, the interpolation points are calculated by GCodeProcessorResult::interpolation_points()
+         m_arc_interpolation_points_count = static_cast<unsigned int>(floor(num));
+         m_arc_interpolation.start        = start_pos;
+         m_arc_interpolation.radian_step  = radian_step;
+         m_arc_interpolation.z_step       = z_step;
      };
 
     ++m_g1_line_id;
@@ -4355,8 +4355,8 @@ void GCodeProcessor::run_post_process()
     if (in.f == nullptr)
         throw Slic3r::RuntimeError(std::string("GCode processor post process export failed.\nCannot open file for reading.\n"));
 
-    // temporary file to contain modified gcode
-    std::string out_path = m_result.filename + ".postprocess";
+    // temporary file to contain modified gcode, or the final destination when exporting from a spool file
+    std::string out_path = m_post_process_output.empty() ? m_result.filename + ".postprocess" : m_post_process_output;
     FilePtr out{ boost::nowide::fopen(out_path.c_str(), "wb") };
     if (out.f == nullptr)
         throw Slic3r::RuntimeError(std::string("GCode processor post process export failed.\nCannot open file for writing.\n"));
@@ -5058,6 +5058,12 @@ void GCodeProcessor::run_post_process()
     const std::string result_filename = m_result.filename;
     export_lines.synchronize_moves(m_result);
 
+    if (! m_post_process_output.empty()) {
+        boost::nowide::remove(result_filename.c_str());
+        m_result.filename = m_post_process_output;
+        return;
+    }
+
     if (rename_file(out_path, result_filename))
         throw Slic3r::RuntimeError(std::string("Failed to rename the output G-code file from ") + out_path + " to " + result_filename + '\n' +
             "Is " + out_path + " locked?" + '\n');
@@ -5069,15 +5075,20 @@ void GCodeProcessor::store_move_vertex(EMoveType type, EMovePathType path_type)
         m_line_id + 1 :
         ((type == EMoveType::Seam) ? m_last_line_id : m_line_id);
 
-    //BBS: apply plate's and extruder's offset to arc interpolation points
-    if (path_type == EMovePathType::Arc_move_cw ||
-        path_type == EMovePathType::Arc_move_ccw) {
-        for (size_t i = 0; i < m_interpolation_points.size(); i++)
-            m_interpolation_points[i] =
-                Vec3f(m_interpolation_points[i].x() + m_x_offset,
-                      m_interpolation_points[i].y() + m_y_offset,
-                      m_processing_start_custom_gcode ? m_first_layer_height : m_interpolation_points[i].z()) +
-                m_extruder_offsets[m_extruder_id];
+    //BBS: apply plate's and extruder's offset to the arc, which is tessellated when drawn
+    const unsigned int arc_interpolation_id       = static_cast<unsigned int>(m_result.arc_interpolations.size());
+    unsigned int       interpolation_points_count = 0;
+    if ((path_type == EMovePathType::Arc_move_cw ||
+         path_type == EMovePathType::Arc_move_ccw) && m_arc_interpolation_points_count > 0) {
+        interpolation_points_count = m_arc_interpolation_points_count;
+        const Vec3f &start = m_arc_interpolation.start;
+        m_result.arc_interpolations.push_back({
+            Vec3f(start.x() + m_x_offset,
+                  start.y() + m_y_offset,
+                  m_processing_start_custom_gcode ? m_first_layer_height : start.z()) +
+            m_extruder_offsets[m_extruder_id],
+            m_arc_interpolation.radian_step,
+            m_processing_start_custom_gcode ? 0.0f : m_arc_interpolation.z_step });
     }
 
     m_result.moves.push_back({
@@ -5100,7 +5111,8 @@ void GCodeProcessor::store_move_vertex(EMoveType type, EMovePathType path_type)
         //BBS: add arc move related data
         path_type,
         Vec3f(m_arc_center(0, 0) + m_x_offset, m_arc_center(1, 0) + m_y_offset, m_arc_center(2, 0)) + m_extruder_offsets[m_extruder_id],
-        m_interpolation_points,
+        arc_interpolation_id,
+        interpolation_points_count,
     });
 
     if (type == EMoveType::Seam) {
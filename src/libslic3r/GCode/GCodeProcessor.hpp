@@ -9,6 +9,7 @@
 
 #include <cstdint>
 #include <array>
+#include <atomic>
 #include <vector>
 #include <mutex>
 #include <string>
@@ -171,12 +172,15 @@ class Print;
             //BBS: arc move related data
             EMovePathType move_path_type{ EMovePathType::Noop_move };
             Vec3f arc_center_position{ Vec3f::Zero() };      // mm
-            std::vector<Vec3f> interpolation_points;     // interpolation points of arc for drawing
+            // Arc for drawing, stored in GCodeProcessorResult::arc_interpolations to keep MoveVertex small.
+            // Its interpolation points are tessellated on demand by GCodeProcessorResult::interpolation_points().
+            unsigned int arc_interpolation_id{ 0 };
+            unsigned int interpolation_points_count{ 0 };
 
             float volumetric_rate() const { return feedrate * mm3_per_mm; }
             //BBS: new function to support arc move
             bool is_arc_move_with_interpolation_points() const {
-                return (move_path_type == EMovePathType::Arc_move_ccw || move_path_type == EMovePathType::Arc_move_cw) && interpolation_points.size();
+                return (move_path_type == EMovePathType::Arc_move_ccw || move_path_type == EMovePathType::Arc_move_cw) && interpolation_points_count > 0;
             }
             bool is_arc_move() const {
                 return move_path_type == EMovePathType::Arc_move_ccw || move_path_type == EMovePathType::Arc_move_cw;
@@ -190,9 +194,61 @@ class Print;
             std::vector<std::string> params;    // extra msg info
         };
 
+        // Compact description of an arc move, from which its interpolation points are calculated.
+        struct ArcInterpolation
+        {
+            Vec3f start{ Vec3f::Zero() };  // mm, starting point of the arc including the plate's and extruder's offset
+            float radian_step{ 0.0f };     // rad, angle between two interpolation points, negative for CW arcs
+            float z_step{ 0.0f };          // mm
+        };
+
+        // Interpolation points of a single arc move, tessellated when accessed.
+        class InterpolationPoints
+        {
+        public:
+            class const_iterator
+            {
+            public:
+                const_iterator(const InterpolationPoints &points, size_t idx) : m_points(points), m_idx(idx) {}
+                Vec3f           operator*() const { return m_points[m_idx]; }
+                const_iterator& operator++() { ++ m_idx; return *this; }
+                bool            operator==(const const_iterator &rhs) const { return m_idx == rhs.m_idx; }
+                bool            operator!=(const const_iterator &rhs) const { return m_idx != rhs.m_idx; }
+            private:
+                const InterpolationPoints &m_points;
+                size_t                     m_idx;
+            };
+
+            InterpolationPoints() = default;
+            InterpolationPoints(const ArcInterpolation &arc, const Vec3f &center, size_t count) :
+                m_arc(arc), m_center(center), m_delta((arc.start - center).head<2>()), m_count(count) {}
+
+            size_t         size() const { return m_count; }
+            bool           empty() const { return m_count == 0; }
+            Vec3f          operator[](size_t idx) const {
+                assert(idx < m_count);
+                const float angle   = float(idx + 1) * m_arc.radian_step;
+                const float cos_val = ::cos(angle);
+                const float sin_val = ::sin(angle);
+                return Vec3f(m_center.x() + m_delta.x() * cos_val - m_delta.y() * sin_val,
+                             m_center.y() + m_delta.x() * sin_val + m_delta.y() * cos_val,
+                             m_arc.start.z() + float(idx + 1) * m_arc.z_step);
+            }
+            const_iterator begin() const { return { *this, 0 }; }
+            const_iterator end() const { return { *this, m_count }; }
+
+        private:
+            ArcInterpolation m_arc;
+            Vec3f            m_center{ Vec3f::Zero() };
+            Vec2f            m_delta{ Vec2f::Zero() };
+            size_t           m_count{ 0 };
+        };
+
         std::string filename;
         unsigned int id;
         std::vector<MoveVertex> moves;
+        // Arcs of all arc moves with interpolation points, referenced by MoveVertex::arc_interpolation_id.
+        std::vector<ArcInterpolation> arc_interpolations;
         // Positions of ends of lines of the final G-code this->filename after TimeProcessor::post_process() finalizes the G-code.
         std::vector<size_t> lines_ends;
         Pointfs printable_area;
@@ -229,6 +285,11 @@ class Print;
 #endif // ENABLE_GCODE_VIEWER_STATISTICS
         void reset();
 
+        InterpolationPoints interpolation_points(const MoveVertex &move) const {
+            return move.interpolation_points_count == 0 ? InterpolationPoints() :
+                InterpolationPoints(arc_interpolations[move.arc_interpolation_id], move.arc_center_position, move.interpolation_points_count);
+        }
+
         //BBS: add mutex for protection of gcode result
         mutable std::mutex result_mutex;
         GCodeProcessorResult& operator=(const GCodeProcessorResult &other)
@@ -236,6 +297,7 @@ class Print;
             filename = other.filename;
             id = other.id;
             moves = other.moves;
+            arc_interpolations = other.arc_interpolations;
             lines_ends = other.lines_ends;
             printable_area = other.printable_area;
             bed_exclude_area = other.bed_exclude_area;
@@ -308,7 +370,8 @@ class Print;
         static const float Wipe_Width;
         static const float Wipe_Height;
 
-        static bool s_IsBBLPrinter;
+        // Atomic, as the plates of the command line slicer may be exported concurrently.
+        static std::atomic<bool> s_IsBBLPrinter;
 
 #if ENABLE_GCODE_VIEWER_DATA_CHECKING
         static const std::string Mm3_Per_Mm_Tag;
@@ -698,7 +761,8 @@ class Print;
         //BBS: arc move related data
         EMovePathType m_move_path_type{ EMovePathType::Noop_move };
         Vec3f m_arc_center{ Vec3f::Zero() };    // mm
-        std::vector<Vec3f> m_interpolation_points;
+        GCodeProcessorResult::ArcInterpolation m_arc_interpolation;
+        unsigned int m_arc_interpolation_points_count{ 0 };
 
         unsigned int m_line_id;
         unsigned int m_last_line_id;
@@ -759,6 +823,8 @@ class Print;
         UsedFilaments m_used_filaments;
 
         Print* m_print{ nullptr };
+        // If set, the final post-processing pass writes the G-code to this file instead of replacing the processed file.
+        std::string m_post_process_output;
 
         GCodeProcessorResult m_result;
         static unsigned int s_result_id;
@@ -774,6 +840,9 @@ class Print;
 
         void apply_config(const PrintConfig& config);
         void set_print(Print* print) { m_print = print; }
+        // The G-code passed to initialize() is a local spool file: the last post-processing pass writes the final G-code
+        // to output_path and deletes the spool, so that a slow (network) destination only receives a single sequential write.
+        void set_post_process_output(const std::string &output_path) { m_post_process_output = output_path; }
         void enable_stealth_time_estimator(bool enabled);
         bool is_stealth_time_estimator_enabled() const {
             return m_time_processor.machines[static_cast<size_t>(PrintEstimatedStatistics::ETimeMode::Stealth)].enabled;
@@ -3,6 +3,7 @@
 #include <cstring>
 #include <cfloat>
 #include <algorithm>
+#include <charconv>
 
 #include "../libslic3r.h"
 #include "../PrintConfig.hpp"
@@ -10,7 +11,6 @@
 #include "../GCode.hpp"
 
 #include "PressureEqualizer.hpp"
-#include "fast_float/fast_float.h"
 #include "GCodeWriter.hpp"
 
 namespace Slic3r {
@@ -33,11 +33,6 @@ static constexpr long max_ignored_gap_between_extruding_segments = 3;
 
 PressureEqualizer::PressureEqualizer(const Slic3r::GCodeConfig &config) : m_use_relative_e_distances(config.use_relative_e_distances.value)
 {
-    // Preallocate some data, so that output_buffer.data() will return an empty string.
-    output_buffer.assign(32, 0);
-    output_buffer_length      = 0;
-    output_buffer_prev_length = 0;
-
     m_current_extruder = 0;
     // Zero the position of the XYZE axes + the current feed
     memset(m_current_pos, 0, sizeof(float) * 5);
@@ -86,24 +81,15 @@ PressureEqualizer::PressureEqualizer(const Slic3r::GCodeConfig &config) : m_use_
 #endif
 }
 
-void PressureEqualizer::process_layer(const std::string &gcode)
+void PressureEqualizer::process_layer(const GCodeLines &gcode)
 {
     if (!gcode.empty()) {
-        const char *gcode_begin = gcode.c_str();
-        while (*gcode_begin != 0) {
-            // Find end of the line.
-            const char *gcode_end = gcode_begin;
-            // Slic3r always generates end of lines in a Unix style.
-            for (; *gcode_end != 0 && *gcode_end != '\n'; ++gcode_end);
-
+        for (size_t idx = 0; idx < gcode.size(); ++ idx) {
             m_gcode_lines.emplace_back();
-            if (!this->process_line(gcode_begin, gcode_end, m_gcode_lines.back())) {
+            if (!this->process_line(gcode, idx, m_gcode_lines.back())) {
                 // The line has to be forgotten. It contains comment marks, which shall be filtered out of the target g-code.
                 m_gcode_lines.pop_back();
             }
-            gcode_begin = gcode_end;
-            if (*gcode_begin == '\n')
-                ++gcode_begin;
         }
         assert(!this->opened_extrude_set_speed_block);
     }
@@ -174,11 +160,13 @@ LayerResult PressureEqualizer::process_layer(LayerResult &&input)
 {
     const bool   is_first_layer       = m_layer_results.empty();
     const size_t next_layer_first_idx = m_gcode_lines.size();
+    const bool   nop_layer_result     = input.nop_layer_result;
 
     if (!input.nop_layer_result) {
-        this->process_layer(input.gcode);
-        input.gcode.clear(); // GCode is already processed, so it isn't needed to store it.
-        m_layer_results.emplace(new LayerResult(input));
+        // The parsed lines refer to the tokenized G-code of the layer, thus the layer is buffered until it is exported.
+        LayerResult *layer_result = new LayerResult(std::move(input));
+        m_layer_results.emplace(layer_result);
+        this->process_layer(layer_result->lines);
     }
 
     if (is_first_layer) // Buffer previous input result and output NOP.
@@ -188,74 +176,28 @@ LayerResult PressureEqualizer::process_layer(LayerResult &&input)
     LayerResult *prev_layer_result = m_layer_results.front();
     m_layer_results.pop();
 
-    output_buffer_length      = 0;
-    output_buffer_prev_length = 0;
+    m_output.clear();
     for (size_t line_idx = 0; line_idx < next_layer_first_idx; ++line_idx)
         output_gcode_line(line_idx);
     m_gcode_lines.erase(m_gcode_lines.begin(), m_gcode_lines.begin() + int(next_layer_first_idx));
 
-    if (output_buffer_length > 0)
-        prev_layer_result->gcode = std::string(output_buffer.data());
+    // The source lines of the previous layer are no longer referenced.
+    prev_layer_result->lines = std::move(m_output);
+    m_output.clear();
 
-    assert(!input.nop_layer_result || m_layer_results.empty());
-    LayerResult out = *prev_layer_result;
+    assert(!nop_layer_result || m_layer_results.empty());
+    LayerResult out = std::move(*prev_layer_result);
     delete prev_layer_result;
     return out;
 }
 
-// Is a white space?
-static inline bool is_ws(const char c) { return c == ' ' || c == '\t'; }
-// Is it an end of line? Consider a comment to be an end of line as well.
-static inline bool is_eol(const char c) { return c == 0 || c == '\r' || c == '\n' || c == ';'; }
-// Is it a white space or end of line?
-static inline bool is_ws_or_eol(const char c) { return is_ws(c) || is_eol(c); }
-
-// Eat whitespaces.
-static void eatws(const char *&line)
-{
-    while (is_ws(*line)) 
-        ++ line;
-}
-
-// Parse an int starting at the current position of a line.
-// If succeeded, the line pointer is advanced.
-static inline int parse_int(const char *&line)
+bool PressureEqualizer::process_line(const GCodeLines &gcode, size_t idx, GCodeLine &buf)
 {
-    char *endptr = nullptr;
-    long result = strtol(line, &endptr, 10);
-    if (endptr == nullptr || !is_ws_or_eol(*endptr))
-        throw Slic3r::InvalidArgument("PressureEqualizer: Error parsing an int");
-    line = endptr;
-    return int(result);
-}
-
-float string_to_float_decimal_point(const char *line, const size_t str_len, size_t* pos)
-{
-    float out;
-    size_t p = fast_float::from_chars(line, line + str_len, out).ptr - line;
-    if (pos)
-        *pos = p;
-    return out;
-}
-
-// Parse an int starting at the current position of a line.
-// If succeeded, the line pointer is advanced.
-static inline float parse_float(const char *&line, const size_t line_length)
-{
-    size_t endptr = 0;
-    auto   result = string_to_float_decimal_point(line, line_length, &endptr);
-    if (endptr == 0 || !is_ws_or_eol(*(line + endptr)))
-        throw Slic3r::RuntimeError("PressureEqualizer: Error parsing a float");
-    line = line + endptr;
-    return result;
-}
-
-bool PressureEqualizer::process_line(const char *line, const char *line_end, GCodeLine &buf)
-{
-    const size_t len = line_end - line;
-    if (strncmp(line, EXTRUSION_ROLE_TAG.data(), EXTRUSION_ROLE_TAG.length()) == 0) {
-        line += EXTRUSION_ROLE_TAG.length();
-        int role = atoi(line);
+    const GCodeLines::Line &line  = gcode[idx];
+    const std::string_view  sline = gcode.line(idx);
+    if (boost::starts_with(sline, EXTRUSION_ROLE_TAG)) {
+        // The line is terminated by a new line, thus atoi() stops at the end of the line.
+        int role = atoi(sline.data() + EXTRUSION_ROLE_TAG.length());
         m_current_extrusion_role = ExtrusionRole(role);
 #ifdef PRESSURE_EQUALIZER_DEBUG
         ++line_idx;
@@ -263,15 +205,11 @@ bool PressureEqualizer::process_line(const char *line, const char *line_end, GCo
         return false;
     }
 
-    // Set the type, copy the line to the buffer.
-    buf.type = GCODELINETYPE_OTHER;
-    buf.modified = false;
-    if (buf.raw.size() < len + 1)
-        buf.raw.assign(line, line + len + 1);
-    else
-        memcpy(buf.raw.data(), line, len);
-    buf.raw[len] = 0;
-    buf.raw_length = len;
+    // Set the type, refer to the source line.
+    buf.type      = GCODELINETYPE_OTHER;
+    buf.modified  = false;
+    buf.gcode     = &gcode;
+    buf.gcode_idx = idx;
 
     memcpy(buf.pos_start, m_current_pos, sizeof(float)*5);
     memcpy(buf.pos_end, m_current_pos, sizeof(float)*5);
@@ -284,9 +222,9 @@ bool PressureEqualizer::process_line(const char *line, const char *line_end, GCo
     buf.max_volumetric_extrusion_rate_slope_negative = 0.f;
 	buf.extrusion_role = m_current_extrusion_role;
 
-    std::string str_line(line, line_end);
-    const bool found_extrude_set_speed_tag = boost::contains(str_line, EXTRUDE_SET_SPEED_TAG);
-    const bool found_extrude_end_tag = boost::contains(str_line, EXTRUDE_END_TAG);
+    const std::string_view comment = gcode.comment(idx);
+    const bool found_extrude_set_speed_tag = boost::contains(comment, EXTRUDE_SET_SPEED_TAG);
+    const bool found_extrude_end_tag = boost::contains(comment, EXTRUDE_END_TAG);
     assert(!found_extrude_set_speed_tag || !found_extrude_end_tag);
 
     if (found_extrude_set_speed_tag)
@@ -294,158 +232,101 @@ bool PressureEqualizer::process_line(const char *line, const char *line_end, GCo
     else if (found_extrude_end_tag)
         this->opened_extrude_set_speed_block = false;
 
-    // Parse the G-code line, store the result into the buf.
-    switch (toupper(*line ++)) {
-    case 'G': {
-        int gcode = -1;
-        try {
-            gcode = parse_int(line);
-        } catch (Slic3r::InvalidArgument &) {
-            // Ignore invalid GCodes.
-            eatws(line);
-            break;
-        }
-
-        assert(gcode != -1);
-        eatws(line);
-        switch (gcode) {
-        case 0:
-        case 1:
-        {
-            // G0, G1: A FFF 3D printer does not make a difference between the two.
-            buf.adjustable_flow = this->opened_extrude_set_speed_block;
-            buf.extrude_set_speed_tag = found_extrude_set_speed_tag;
-            buf.extrude_end_tag = found_extrude_end_tag;
-            float new_pos[5];
-            memcpy(new_pos, m_current_pos, sizeof(float)*5);
-            bool  changed[5] = { false, false, false, false, false };
-            while (!is_eol(*line)) {
-                const char axis = toupper(*line++);
-                int  i = -1;
-                switch (axis) {
-                case 'X':
-                case 'Y':
-                case 'Z':
-                    i = axis - 'X';
-                    break;
-                case 'E':
-                    i = 3;
-                    break;
-                case 'F':
-                    i = 4;
-                    break;
-                default:
-                    break;
-                }
-                if (i != -1) {
-                    buf.pos_provided[i] = true;
-                    new_pos[i] = parse_float(line, line_end - line);
-                    if (i == 3 && m_use_relative_e_distances)
-                        new_pos[i] += m_current_pos[i];
-                    changed[i] = new_pos[i] != m_current_pos[i];
-                    eatws(line);
-                }
+    // Interpret the tokenized G-code line, store the result into the buf.
+    switch (line.cmd) {
+    case GCodeLines::Cmd::G0:
+    case GCodeLines::Cmd::G1:
+    {
+        // G0, G1: A FFF 3D printer does not make a difference between the two.
+        buf.adjustable_flow = this->opened_extrude_set_speed_block;
+        buf.extrude_set_speed_tag = found_extrude_set_speed_tag;
+        buf.extrude_end_tag = found_extrude_end_tag;
+        float new_pos[5];
+        memcpy(new_pos, m_current_pos, sizeof(float)*5);
+        bool  changed[5] = { false, false, false, false, false };
+        // X, Y, Z, E, F
+        for (int i = 0; i < 5; ++ i)
+            if (line.has(Axis(i))) {
+                buf.pos_provided[i] = true;
+                new_pos[i] = line.value(Axis(i));
+                if (i == 3 && m_use_relative_e_distances)
+                    new_pos[i] += m_current_pos[i];
+                changed[i] = new_pos[i] != m_current_pos[i];
             }
-            if (changed[3]) {
-                // Extrusion, retract or unretract.
-                float diff = new_pos[3] - m_current_pos[3];
-                if (diff < 0) {
-                    buf.type = GCODELINETYPE_RETRACT;
-                    m_retracted = true;
-                } else if (! changed[0] && ! changed[1] && ! changed[2]) {
-                    // assert(m_retracted);
-                    buf.type = GCODELINETYPE_UNRETRACT;
-                    m_retracted = false;
-                } else {
-                    assert(changed[0] || changed[1]);
-                    // Moving in XY plane.
-                    buf.type = GCODELINETYPE_EXTRUDE;
-                    // Calculate the volumetric extrusion rate.
-                    float diff[4];
-                    for (size_t i = 0; i < 4; ++ i)
-                        diff[i] = new_pos[i] - m_current_pos[i];
-                    // volumetric extrusion rate = A_filament * F_xyz * L_e / L_xyz [mm^3/min]
-                    float len2 = diff[0]*diff[0]+diff[1]*diff[1]+diff[2]*diff[2];
-                    float rate = m_filament_crossections[m_current_extruder] * new_pos[4] * sqrt((diff[3]*diff[3])/len2);
-                    buf.volumetric_extrusion_rate       = rate;
-                    buf.volumetric_extrusion_rate_start = rate;
-                    buf.volumetric_extrusion_rate_end   = rate;
+        if (changed[3]) {
+            // Extrusion, retract or unretract.
+            float diff = new_pos[3] - m_current_pos[3];
+            if (diff < 0) {
+                buf.type = GCODELINETYPE_RETRACT;
+                m_retracted = true;
+            } else if (! changed[0] && ! changed[1] && ! changed[2]) {
+                // assert(m_retracted);
+                buf.type = GCODELINETYPE_UNRETRACT;
+                m_retracted = false;
+            } else {
+                assert(changed[0] || changed[1]);
+                // Moving in XY plane.
+                buf.type = GCODELINETYPE_EXTRUDE;
+                // Calculate the volumetric extrusion rate.
+                float diff[4];
+                for (size_t i = 0; i < 4; ++ i)
+                    diff[i] = new_pos[i] - m_current_pos[i];
+                // volumetric extrusion rate = A_filament * F_xyz * L_e / L_xyz [mm^3/min]
+                float len2 = diff[0]*diff[0]+diff[1]*diff[1]+diff[2]*diff[2];
+                float rate = m_filament_crossections[m_current_extruder] * new_pos[4] * sqrt((diff[3]*diff[3])/len2);
+                buf.volumetric_extrusion_rate       = rate;
+                buf.volumetric_extrusion_rate_start = rate;
+                buf.volumetric_extrusion_rate_end   = rate;
 
 #ifdef PRESSURE_EQUALIZER_STATISTIC
-                    m_stat.update(rate, sqrt(len2));
+                m_stat.update(rate, sqrt(len2));
 #endif
 #ifdef PRESSURE_EQUALIZER_DEBUG
-                    if (rate < 40.f) {
-                        printf("Extremely low flow rate: %f. Line %d, Length: %f, extrusion: %f Old position: (%f, %f, %f), new position: (%f, %f, %f)\n",
-                               rate, int(line_idx), sqrt(len2), sqrt((diff[3] * diff[3]) / len2), m_current_pos[0], m_current_pos[1], m_current_pos[2],
-                               new_pos[0], new_pos[1], new_pos[2]);
-                    }
-#endif
-                }
-            } else if (changed[0] || changed[1] || changed[2]) {
-                // Moving without extrusion.
-                buf.type = GCODELINETYPE_MOVE;
-            }
-            memcpy(m_current_pos, new_pos, sizeof(float) * 5);
-            break;
-        }
-        case 92: 
-        {
-            // G92 : Set Position
-            // Set a logical coordinate position to a new value without actually moving the machine motors.
-            // Which axes to set?
-            while (!is_eol(*line)) {
-                const char axis = toupper(*line++);
-                switch (axis) {
-                case 'X':
-                case 'Y':
-                case 'Z':
-                    m_current_pos[axis - 'X'] = (!is_ws_or_eol(*line)) ? parse_float(line, line_end - line) : 0.f;
-                    break;
-                case 'E':
-                    m_current_pos[3] = (!is_ws_or_eol(*line)) ? parse_float(line, line_end - line) : 0.f;
-                    break;
-                default:
-                    break;
+                if (rate < 40.f) {
+                    printf("Extremely low flow rate: %f. Line %d, Length: %f, extrusion: %f Old position: (%f, %f, %f), new position: (%f, %f, %f)\n",
+                           rate, int(line_idx), sqrt(len2), sqrt((diff[3] * diff[3]) / len2), m_current_pos[0], m_current_pos[1], m_current_pos[2],
+                           new_pos[0], new_pos[1], new_pos[2]);
                 }
-                eatws(line);
+#endif
             }
-            break;
-        }
-        case 10:
-        case 22:
-            // Firmware retract.
-            buf.type = GCODELINETYPE_RETRACT;
-            m_retracted = true;
-            break;
-        case 11:
-        case 23:
-            // Firmware unretract.
-            buf.type = GCODELINETYPE_UNRETRACT;
-            m_retracted = false;
-            break;
-        default:
-            // Ignore the rest.
-        break;
+        } else if (changed[0] || changed[1] || changed[2]) {
+            // Moving without extrusion.
+            buf.type = GCODELINETYPE_MOVE;
         }
+        memcpy(m_current_pos, new_pos, sizeof(float) * 5);
         break;
     }
-    case 'M': {
-        eatws(line);
-        // Ignore the rest of the M-codes.
+    case GCodeLines::Cmd::G92:
+    {
+        // G92 : Set Position
+        // Set a logical coordinate position to a new value without actually moving the machine motors.
+        // X, Y, Z, E
+        for (int i = 0; i < 4; ++ i)
+            if (line.has(Axis(i)))
+                m_current_pos[i] = line.value(Axis(i));
         break;
     }
-    case 'T':
+    case GCodeLines::Cmd::G10:
+    case GCodeLines::Cmd::G22:
+        // Firmware retract.
+        buf.type = GCODELINETYPE_RETRACT;
+        m_retracted = true;
+        break;
+    case GCodeLines::Cmd::G11:
+    case GCodeLines::Cmd::G23:
+        // Firmware unretract.
+        buf.type = GCODELINETYPE_UNRETRACT;
+        m_retracted = false;
+        break;
+    case GCodeLines::Cmd::T:
     {
         // Activate an extruder head.
-        int new_extruder = -1;
-        try {
-            new_extruder = parse_int(line);
-        } catch (Slic3r::InvalidArgument &) {
+        const std::string_view command      = gcode.command(idx);
+        int                    new_extruder = -1;
+        if (auto [ptr, ec] = std::from_chars(command.data() + 1, command.data() + command.size(), new_extruder);
+            ec != std::errc() || ptr != command.data() + command.size())
             // Ignore invalid GCodes starting with T.
-            eatws(line);
             break;
-        }
         assert(new_extruder != -1);
 
         if (new_extruder != int(m_current_extruder)) {
@@ -457,6 +338,9 @@ bool PressureEqualizer::process_line(const char *line, const char *line_end, GCo
         }
         break;
     }
+    default:
+        // Ignore the rest.
+        break;
     }
 
     buf.extruder_id = m_current_extruder;
@@ -471,16 +355,13 @@ void PressureEqualizer::output_gcode_line(const size_t line_idx)
 {
     GCodeLine &line = m_gcode_lines[line_idx];
     if (!line.modified) {
-        push_to_output(line.raw.data(), line.raw_length, true);
+        m_output.append(*line.gcode, line.gcode_idx);
         return;
     }
 
     // The line was modified.
-    // Find the comment.
-    const char *comment = line.raw.data();
-    while (*comment != ';' && *comment != 0) ++comment;
-    if (*comment != ';')
-        comment = nullptr;
+    // Find the comment, empty if there is none.
+    std::string_view comment = line.gcode->comment(line.gcode_idx);
 
     // Emit the line with lowered extrusion rates.
     float l = line.dist_xyz();
@@ -536,7 +417,7 @@ void PressureEqualizer::output_gcode_line(const size_t line_idx)
                     line.pos_provided[i] = true;
                 }
                 push_line_to_output(line_idx, pos_start[4], comment);
-                comment = nullptr;
+                comment = {};
 
                 float new_pos_start_feedrate = pos_start[4];
 
@@ -556,7 +437,7 @@ void PressureEqualizer::output_gcode_line(const size_t line_idx)
             } 
             // Interpolate the feed rate at the center of the segment.
             push_line_to_output(line_idx, pos_start[4] + (pos_end[4] - pos_start[4]) * (float(i) - 0.5f) / float(nSegments), comment);
-            comment = nullptr;
+            comment = {};
             memcpy(line.pos_start, line.pos_end, sizeof(float)*5);
         }
 		if (l_steady > 0.f && accelerating) {
@@ -702,91 +583,33 @@ void PressureEqualizer::adjust_volumetric_rate(const size_t fist_line_idx, const
     }
 }
 
-inline void PressureEqualizer::push_to_output(GCodeG1Formatter &formatter)
-{
-    return this->push_to_output(formatter.string(), false);
-}
-
-inline void PressureEqualizer::push_to_output(const std::string &text, bool add_eol)
+// Is the line just setting the feed rate of an extrusion block, for example "G1 F1200 ;_EXTRUDE_SET_SPEED"?
+static inline bool is_just_line_with_extrude_set_speed_tag(const GCodeLines &gcode, size_t idx)
 {
-    return this->push_to_output(text.data(), text.size(), add_eol);
+    const GCodeLines::Line &line    = gcode[idx];
+    const std::string_view  comment = gcode.comment(idx);
+    return line.cmd == GCodeLines::Cmd::G1 && line.mask == (1 << F) && boost::starts_with(comment, EXTRUDE_SET_SPEED_TAG) &&
+           (comment.size() == EXTRUDE_SET_SPEED_TAG.size() || comment[EXTRUDE_SET_SPEED_TAG.size()] == ';');
 }
 
-inline void PressureEqualizer::push_to_output(const char *text, const size_t len, bool add_eol)
-{
-    // New length of the output buffer content.
-    size_t len_new = output_buffer_length + len + 1;
-    if (add_eol)
-        ++len_new;
-
-    // Resize the output buffer to a power of 2 higher than the required memory.
-    if (output_buffer.size() < len_new) {
-        size_t v = len_new;
-        // Compute the next highest power of 2 of 32-bit v
-        // http://graphics.stanford.edu/~seander/bithacks.html
-        v--;
-        v |= v >> 1;
-        v |= v >> 2;
-        v |= v >> 4;
-        v |= v >> 8;
-        v |= v >> 16;
-        v++;
-        output_buffer.resize(v);
-    }
-
-    // Copy the text to the output.
-    if (len != 0) {
-        memcpy(output_buffer.data() + output_buffer_length, text, len);
-        this->output_buffer_prev_length = this->output_buffer_length;
-        output_buffer_length += len;
-    }
-    if (add_eol)
-        output_buffer[output_buffer_length++] = '\n';
-    output_buffer[output_buffer_length] = 0;
-}
-
-inline bool is_just_line_with_extrude_set_speed_tag(const std::string &line)
-{
-    if (line.empty() && !boost::starts_with(line, "G1 ") && !boost::ends_with(line, EXTRUDE_SET_SPEED_TAG))
-        return false;
-
-    const char       *p_line   = line.data() + 3;
-    const char *const line_end = line.data() + line.length() - 1;
-    while (!is_eol(*p_line)) {
-        if (toupper(*p_line++) == 'F')
-            break;
-        else
-            return false;
-    }
-    parse_float(p_line, line_end - p_line);
-    eatws(p_line);
-    p_line += EXTRUDE_SET_SPEED_TAG.length();
-    return p_line <= line_end && is_eol(*p_line);
-}
-
-void PressureEqualizer::push_line_to_output(const size_t line_idx, float new_feedrate, const char *comment)
+void PressureEqualizer::push_line_to_output(const size_t line_idx, float new_feedrate, std::string_view comment)
 {
     // Orca: sanity check, 1 mm/s is the minimum feedrate.
     if (new_feedrate < 60)
         new_feedrate = 60;
     new_feedrate = std::round(new_feedrate);
     const GCodeLine &line = m_gcode_lines[line_idx];
-    if (line_idx > 0 && output_buffer_length > 0) {
-        const std::string prev_line_str = std::string(output_buffer.begin() + int(this->output_buffer_prev_length),
-                                                      output_buffer.begin() + int(this->output_buffer_length) + 1);
-        if (is_just_line_with_extrude_set_speed_tag(prev_line_str))
-            this->output_buffer_length = this->output_buffer_prev_length; // Remove the last line because it only sets the speed for an empty block of g-code lines, so it is useless.
-        else
-            push_to_output(EXTRUDE_END_TAG.data(), EXTRUDE_END_TAG.length(), true);
-    } else
-        push_to_output(EXTRUDE_END_TAG.data(), EXTRUDE_END_TAG.length(), true);
+    if (line_idx > 0 && !m_output.empty() && is_just_line_with_extrude_set_speed_tag(m_output, m_output.size() - 1))
+        m_output.pop_back(); // Remove the last line because it only sets the speed for an empty block of g-code lines, so it is useless.
+    else
+        m_output.append(EXTRUDE_END_TAG);
 
     GCodeG1Formatter feedrate_formatter;
     feedrate_formatter.emit_f(new_feedrate);
     feedrate_formatter.emit_string(std::string(EXTRUDE_SET_SPEED_TAG.data(), EXTRUDE_SET_SPEED_TAG.length()));
     if (line.extrusion_role == ExtrusionRole::erExternalPerimeter)
         feedrate_formatter.emit_string(std::string(EXTERNAL_PERIMETER_TAG.data(), EXTERNAL_PERIMETER_TAG.length()));
-    push_to_output(feedrate_formatter);
+    m_output.append(feedrate_formatter.string());
 
     GCodeG1Formatter extrusion_formatter;
     for (size_t axis_idx = 0; axis_idx < 3; ++axis_idx)
@@ -794,10 +617,10 @@ void PressureEqualizer::push_line_to_output(const size_t line_idx, float new_fee
             extrusion_formatter.emit_axis(char('X' + axis_idx), line.pos_end[axis_idx], GCodeFormatter::XYZF_EXPORT_DIGITS);
     extrusion_formatter.emit_axis('E', m_use_relative_e_distances ? (line.pos_end[3] - line.pos_start[3]) : line.pos_end[3], GCodeFormatter::E_EXPORT_DIGITS);
 
-    if (comment != nullptr)
-        extrusion_formatter.emit_string(std::string(comment));
+    if (!comment.empty())
+        extrusion_formatter.emit_string(comment);
 
-    push_to_output(extrusion_formatter);
+    m_output.append(extrusion_formatter.string());
 }
 
 } // namespace Slic3r
@@ -3,6 +3,7 @@
 
 #include "../libslic3r.h"
 #include "../PrintConfig.hpp"
+#include "GCodeLines.hpp"
 
 #include <queue>
 
@@ -30,7 +31,7 @@ public:
     LayerResult process_layer(LayerResult &&input);
 private:
 
-    void process_layer(const std::string &gcode);
+    void process_layer(const GCodeLines &gcode);
 
 #ifdef PRESSURE_EQUALIZER_STATISTIC
     struct Statistics
@@ -103,7 +104,6 @@ private:
     {
         GCodeLine() : 
             type(GCODELINETYPE_INVALID),
-            raw_length(0),
             modified(false),
             extruder_id(0), 
             volumetric_extrusion_rate(0.f), 
@@ -137,9 +137,9 @@ private:
 
         GCodeLineType type;
 
-        // We try to keep the string buffer once it has been allocated, so it will not be reallocated over and over.
-        std::vector<char>   raw;
-        size_t              raw_length;
+        // The source line in the tokenized G-code of a layer buffered in m_layer_results.
+        const GCodeLines   *gcode { nullptr };
+        size_t              gcode_idx { 0 };
         // If modified, the raw text has to be adapted by the new extrusion rate,
         // or maybe the line needs to be split into multiple lines.
         bool                modified;
@@ -173,17 +173,15 @@ private:
         bool        extrude_end_tag       = false;
     };
 
-    // Output buffer will only grow. It will not be reallocated over and over.
-    std::vector<char>               output_buffer;
-    size_t                          output_buffer_length;
-    size_t                          output_buffer_prev_length;
+    // G-code of the layer being exported.
+    GCodeLines                      m_output;
 
 #ifdef PRESSURE_EQUALIZER_DEBUG
     // For debugging purposes. Index of the G-code line processed.
     size_t                          line_idx;
 #endif
 
-    bool process_line(const char *line, const char *line_end, GCodeLine &buf);
+    bool process_line(const GCodeLines &gcode, size_t idx, GCodeLine &buf);
     long advance_segment_beyond_small_gap(long idx_cur_pos);
     void output_gcode_line(size_t line_idx);
 
@@ -191,12 +189,8 @@ private:
     // Then go forward and adjust the feedrate to decrease the slope of the extrusion rate changes.
     void adjust_volumetric_rate(size_t first_line_idx, size_t last_line_idx);
 
-    // Push the text to the end of the output_buffer.
-    inline void push_to_output(GCodeG1Formatter &formatter);
-    inline void push_to_output(const std::string &text, bool add_eol);
-    inline void push_to_output(const char *text, size_t len, bool add_eol = true);
     // Push a G-code line to the output.
-    void push_line_to_output(size_t line_idx, float new_feedrate, const char *comment);
+    void push_line_to_output(size_t line_idx, float new_feedrate, std::string_view comment);
 
 public:
     std::queue<LayerResult*> m_layer_results;
@@ -1002,7 +1002,7 @@ void pick_random_seam_point(const std::vector<SeamCandidate> &perimeter_points,
 // Store results in the SeamPlacer variables m_seam_per_object
 void SeamPlacer::gather_seam_candidates(const PrintObject *po, const SeamPlacerImpl::GlobalModelInfo &global_model_info) {
   using namespace SeamPlacerImpl;
-  PrintObjectSeamData &seam_data = m_seam_per_object.emplace(po, PrintObjectSeamData { }).first->second;
+  PrintObjectSeamData &seam_data = m_seam_per_object.at(po);
   seam_data.layers.resize(po->layer_count());
 
   tbb::parallel_for(tbb::blocked_range<size_t>(0, po->layers().size()),
@@ -1032,7 +1032,7 @@ void SeamPlacer::calculate_candidates_visibility(const PrintObject *po,
                                                  const SeamPlacerImpl::GlobalModelInfo &global_model_info) {
   using namespace SeamPlacerImpl;
 
-  std::vector<PrintObjectSeamData::LayerSeams> &layers = m_seam_per_object[po].layers;
+  std::vector<PrintObjectSeamData::LayerSeams> &layers = m_seam_per_object.at(po).layers;
   tbb::parallel_for(tbb::blocked_range<size_t>(0, layers.size()),
                     [&layers, &global_model_info](tbb::blocked_range<size_t> r) {
                       for (size_t layer_idx = r.begin(); layer_idx < r.end(); ++layer_idx) {
@@ -1048,7 +1048,7 @@ void SeamPlacer::calculate_overhangs_and_layer_embedding(const PrintObject *po)
   using namespace SeamPlacerImpl;
   using PerimeterDistancer = AABBTreeLines::LinesDistancer<Linef>;
 
-  std::vector<PrintObjectSeamData::LayerSeams> &layers = m_seam_per_object[po].layers;
+  std::vector<PrintObjectSeamData::LayerSeams> &layers = m_seam_per_object.at(po).layers;
   tbb::parallel_for(tbb::blocked_range<size_t>(0, layers.size()),
                     [po, &layers](tbb::blocked_range<size_t> r) {
                       std::unique_ptr<PerimeterDistancer> prev_layer_distancer;
@@ -1246,7 +1246,7 @@ void SeamPlacer::align_seam_points(const PrintObject *po, const SeamPlacerImpl::
 #endif
 
   //gather vector of all seams on the print_object - pair of layer_index and seam__index within that layer
-  const std::vector<PrintObjectSeamData::LayerSeams> &layers = m_seam_per_object[po].layers;
+  const std::vector<PrintObjectSeamData::LayerSeams> &layers = m_seam_per_object.at(po).layers;
   std::vector<std::pair<size_t, size_t>> seams;
   for (size_t layer_idx = 0; layer_idx < layers.size(); ++layer_idx) {
     const std::vector<SeamCandidate> &layer_perimeter_points = layers[layer_idx].points;
@@ -1417,73 +1417,88 @@ void SeamPlacer::init(const Print &print, std::function<void(void)> throw_if_can
   using namespace SeamPlacerImpl;
   m_seam_per_object.clear();
 
-  for (const PrintObject *po : print.objects()) {
-    throw_if_canceled_func();
-    SeamPosition configured_seam_preference = po->config().seam_position.value;
-    SeamComparator comparator { configured_seam_preference };
+  // PrintObjects sharing layers with another PrintObject are skipped: place_seam() looks up the seams by Layer::object(),
+  // which is the PrintObject owning the layers, thus the seams of identical objects are calculated just once.
+  std::vector<const PrintObject*> objects;
+  for (const PrintObject *po : print.objects())
+    if (po->get_shared_object() == nullptr) {
+      objects.emplace_back(po);
+      // Insert all the items before processing the objects in parallel, the map is only searched from now on.
+      m_seam_per_object.emplace(po, PrintObjectSeamData { });
+    }
 
-    {
-      GlobalModelInfo global_model_info { };
-      gather_enforcers_blockers(global_model_info, po);
-      throw_if_canceled_func();
-      if (configured_seam_preference == spAligned || configured_seam_preference == spNearest) {
-        compute_global_occlusion(global_model_info, po, throw_if_canceled_func);
-      }
-      throw_if_canceled_func();
-      BOOST_LOG_TRIVIAL(debug)
-          << "SeamPlacer: gather_seam_candidates: start";
-      gather_seam_candidates(po, global_model_info);
-      BOOST_LOG_TRIVIAL(debug)
-          << "SeamPlacer: gather_seam_candidates: end";
-      throw_if_canceled_func();
-      if (configured_seam_preference == spAligned || configured_seam_preference == spNearest) {
-        BOOST_LOG_TRIVIAL(debug)
-            << "SeamPlacer: calculate_candidates_visibility : start";
-        calculate_candidates_visibility(po, global_model_info);
-        BOOST_LOG_TRIVIAL(debug)
-            << "SeamPlacer: calculate_candidates_visibility : end";
-      }
-    } // destruction of global_model_info (large structure, no longer needed)
-    throw_if_canceled_func();
-    BOOST_LOG_TRIVIAL(debug)
-        << "SeamPlacer: calculate_overhangs and layer embdedding : start";
-    calculate_overhangs_and_layer_embedding(po);
-    BOOST_LOG_TRIVIAL(debug)
-        << "SeamPlacer: calculate_overhangs and layer embdedding: end";
-    throw_if_canceled_func();
-    if (configured_seam_preference != spNearest) { // For spNearest, the seam is picked in the place_seam method with actual nozzle position information
-      BOOST_LOG_TRIVIAL(debug)
-          << "SeamPlacer: pick_seam_point : start";
-      //pick seam point
-      std::vector<PrintObjectSeamData::LayerSeams> &layers = m_seam_per_object[po].layers;
-      tbb::parallel_for(tbb::blocked_range<size_t>(0, layers.size()),
-                        [&layers, configured_seam_preference, comparator](tbb::blocked_range<size_t> r) {
-                          for (size_t layer_idx = r.begin(); layer_idx < r.end(); ++layer_idx) {
-                            std::vector<SeamCandidate> &layer_perimeter_points = layers[layer_idx].points;
-                            for (size_t current = 0; current < layer_perimeter_points.size();
-                                 current = layer_perimeter_points[current].perimeter.end_index)
-                              if (configured_seam_preference == spRandom)
-                                pick_random_seam_point(layer_perimeter_points, current);
-                              else
-                                pick_seam_point(layer_perimeter_points, current, comparator);
+  // The objects are processed in parallel, each of the steps further splits its work by layers.
+  tbb::parallel_for(tbb::blocked_range<size_t>(0, objects.size(), 1),
+                    [this, &objects, &throw_if_canceled_func](tbb::blocked_range<size_t> object_range) {
+                      for (size_t object_idx = object_range.begin(); object_idx < object_range.end(); ++ object_idx) {
+                        const PrintObject *po = objects[object_idx];
+                        throw_if_canceled_func();
+                        SeamPosition configured_seam_preference = po->config().seam_position.value;
+                        SeamComparator comparator { configured_seam_preference };
+
+                        {
+                          GlobalModelInfo global_model_info { };
+                          gather_enforcers_blockers(global_model_info, po);
+                          throw_if_canceled_func();
+                          if (configured_seam_preference == spAligned || configured_seam_preference == spNearest) {
+                            compute_global_occlusion(global_model_info, po, throw_if_canceled_func);
                           }
-                        });
-      BOOST_LOG_TRIVIAL(debug)
-          << "SeamPlacer: pick_seam_point : end";
-    }
-    throw_if_canceled_func();
-    if (configured_seam_preference == spAligned || configured_seam_preference == spRear) {
-      BOOST_LOG_TRIVIAL(debug)
-          << "SeamPlacer: align_seam_points : start";
-      align_seam_points(po, comparator);
-      BOOST_LOG_TRIVIAL(debug)
-          << "SeamPlacer: align_seam_points : end";
-    }
+                          throw_if_canceled_func();
+                          BOOST_LOG_TRIVIAL(debug)
+                              << "SeamPlacer: gather_seam_candidates: start";
+                          gather_seam_candidates(po, global_model_info);
+                          BOOST_LOG_TRIVIAL(debug)
+                              << "SeamPlacer: gather_seam_candidates: end";
+                          throw_if_canceled_func();
+                          if (configured_seam_preference == spAligned || configured_seam_preference == spNearest) {
+                            BOOST_LOG_TRIVIAL(debug)
+                                << "SeamPlacer: calculate_candidates_visibility : start";
+                            calculate_candidates_visibility(po, global_model_info);
+                            BOOST_LOG_TRIVIAL(debug)
+                                << "SeamPlacer: calculate_candidates_visibility : end";
+                          }
+                        } // destruction of global_model_info (large structure, no longer needed)
+                        throw_if_canceled_func();
+                        BOOST_LOG_TRIVIAL(debug)
+                            << "SeamPlacer: calculate_overhangs and layer embdedding : start";
+                        calculate_overhangs_and_layer_embedding(po);
+                        BOOST_LOG_TRIVIAL(debug)
+                            << "SeamPlacer: calculate_overhangs and layer embdedding: end";
+                        throw_if_canceled_func();
+                        if (configured_seam_preference != spNearest) { // For spNearest, the seam is picked in the place_seam method with actual nozzle position information
+                          BOOST_LOG_TRIVIAL(debug)
+                              << "SeamPlacer: pick_seam_point : start";
+                          //pick seam point
+                          std::vector<PrintObjectSeamData::LayerSeams> &layers = m_seam_per_object.at(po).layers;
+                          tbb::parallel_for(tbb::blocked_range<size_t>(0, layers.size()),
+                                            [&layers, configured_seam_preference, comparator](tbb::blocked_range<size_t> r) {
+                                              for (size_t layer_idx = r.begin(); layer_idx < r.end(); ++layer_idx) {
+                                                std::vector<SeamCandidate> &layer_perimeter_points = layers[layer_idx].points;
+                                                for (size_t current = 0; current < layer_perimeter_points.size();
+                                                     current = layer_perimeter_points[current].perimeter.end_index)
+                                                  if (configured_seam_preference == spRandom)
+                                                    pick_random_seam_point(layer_perimeter_points, current);
+                                                  else
+                                                    pick_seam_point(layer_perimeter_points, current, comparator);
+                                              }
+                                            });
+                          BOOST_LOG_TRIVIAL(debug)
+                              << "SeamPlacer: pick_seam_point : end";
+                        }
+                        throw_if_canceled_func();
+                        if (configured_seam_preference == spAligned || configured_seam_preference == spRear) {
+                          BOOST_LOG_TRIVIAL(debug)
+                              << "SeamPlacer: align_seam_points : start";
+                          align_seam_points(po, comparator);
+                          BOOST_LOG_TRIVIAL(debug)
+                              << "SeamPlacer: align_seam_points : end";
+                        }
 
 #ifdef DEBUG_FILES
-    debug_export_points(m_seam_per_object[po].layers, po->bounding_box(), comparator);
+                        debug_export_points(m_seam_per_object.at(po).layers, po->bounding_box(), comparator);
 #endif
-  }
+                      }
+                    });
 }
 
 void SeamPlacer::place_seam(const Layer *layer, ExtrusionLoop &loop,
@@ -14,6 +14,21 @@
 #include <Shiny/Shiny.h>
 #include <fast_float/fast_float.h>
 
+#include <atomic>
+#include <memory>
+
+// Intel redesigned some TBB interface considerably when merging TBB with their oneAPI set of libraries, see GH #7332.
+#if ! defined(TBB_VERSION_MAJOR)
+    #include <tbb/version.h>
+#endif
+#if TBB_VERSION_MAJOR >= 2021
+    #include <tbb/parallel_pipeline.h>
+    using slic3r_tbb_filtermode = tbb::filter_mode;
+#else
+    #include <tbb/pipeline.h>
+    using slic3r_tbb_filtermode = tbb::filter;
+#endif
+
 namespace Slic3r {
 
 void GCodeReader::apply_config(const GCodeConfig &config)
@@ -83,9 +98,6 @@ const char* GCodeReader::parse_line_internal(const char *ptr, const char *end, G
         }
     }
     
-    if (gline.has(E) && m_config.use_relative_e_distances)
-        m_position[E] = 0;
-
     // Skip the rest of the line.
     for (; ! is_end_of_line(*c); ++ c);
 
@@ -101,10 +113,16 @@ const char* GCodeReader::parse_line_internal(const char *ptr, const char *end, G
 	if (*c == '\n')
 		++ c;
 
+    return c;
+}
+
+void GCodeReader::line_parsed(const GCodeLine &gline)
+{
+    if (gline.has(E) && m_config.use_relative_e_distances)
+        m_position[E] = 0;
+
     if (m_verbose)
         std::cout << gline.m_raw << std::endl;
-
-    return c;
 }
 
 void GCodeReader::update_coordinates(GCodeLine &gline, std::pair<const char*, const char*> &command)
@@ -215,6 +233,133 @@ bool GCodeReader::parse_file(const std::string &file, callback_t callback, std::
     return ret;
 }
 
+bool GCodeReader::parse_file_parallel(const std::string &file, callback_t callback, std::vector<size_t> &lines_ends)
+{
+    BOOST_LOG_TRIVIAL(info) << __FUNCTION__ << boost::format(":  before parse_file_parallel %1%") % file.c_str();
+
+    lines_ends.clear();
+    FilePtr in{ boost::nowide::fopen(file.c_str(), "rb") };
+    if (in.f == nullptr)
+        return false;
+
+    // Block of complete lines of the G-code file, tokenized by the parallel stage of the pipeline.
+    struct Block {
+        std::string            text;
+        size_t                 file_pos { 0 };
+        bool                   eof { false };
+        std::vector<GCodeLine> lines;
+        std::vector<size_t>    lines_ends;
+    };
+
+    // Read the input in 1MB blocks, each block being cut after the last end of line it contains.
+    // The remainder is moved to the start of the next block.
+    static constexpr const size_t block_size = 1024 * 1024;
+    std::string remainder;
+    size_t      file_pos   = 0;
+    bool        read_error = false;
+    bool        eof        = false;
+    m_parsing = true;
+    // Set by the sequential stage if the callback wishes to exit.
+    std::atomic<bool> quit { false };
+
+    const auto reader = tbb::make_filter<void, std::shared_ptr<Block>>(slic3r_tbb_filtermode::serial_in_order,
+        [&](tbb::flow_control &fc) -> std::shared_ptr<Block> {
+            if (eof || quit) {
+                fc.stop();
+                return {};
+            }
+            auto block = std::make_shared<Block>();
+            block->file_pos = file_pos;
+            block->text     = std::move(remainder);
+            remainder.clear();
+            for (;;) {
+                size_t old_size = block->text.size();
+                block->text.resize(old_size + block_size);
+                size_t cnt_read = ::fread(block->text.data() + old_size, 1, block_size, in.f);
+                block->text.resize(old_size + cnt_read);
+                if (::ferror(in.f)) {
+                    read_error = true;
+                    fc.stop();
+                    return {};
+                }
+                if (cnt_read == 0) {
+                    eof = block->eof = true;
+                    break;
+                }
+                // Cut after the last '\n'. Lone '\r' line ends are only taken into account if there is no '\n' in the block,
+                // and only if they are not the last character read, as the '\n' of "\r\n" may still follow.
+                size_t cut = block->text.rfind('\n');
+                if (cut == std::string::npos) {
+                    cut = block->text.rfind('\r');
+                    if (cut == block->text.size() - 1)
+                        cut = std::string::npos;
+                }
+                if (cut != std::string::npos) {
+                    remainder.assign(block->text.begin() + cut + 1, block->text.end());
+                    block->text.erase(cut + 1);
+                    break;
+                }
+            }
+            file_pos += block->text.size();
+            return block;
+        });
+
+    const auto tokenizer = tbb::make_filter<std::shared_ptr<Block>, std::shared_ptr<Block>>(slic3r_tbb_filtermode::parallel,
+        [](std::shared_ptr<Block> block) -> std::shared_ptr<Block> {
+            CNumericLocalesSetter locales_setter;
+            std::pair<const char*, const char*> cmd;
+            // The text is zero terminated, thus the parser stops at the end of the last line even if it is not terminated by end of line.
+            const char *ptr = block->text.c_str();
+            const char *end = ptr + block->text.size();
+            block->lines.reserve(std::count(ptr, end, '\n') + 1);
+            while (ptr != end) {
+                const char *line_end = ptr;
+                for (; line_end != end && *line_end != '\r' && *line_end != '\n'; ++ line_end) ;
+                // Skip the line number.
+                const char *begin = skip_whitespaces(ptr);
+                if (std::toupper(*begin) == 'N')
+                    begin = skip_word(begin);
+                begin = skip_whitespaces(begin);
+                block->lines.emplace_back();
+                parse_line_internal(begin, end, block->lines.back(), cmd);
+                // Skip end of line.
+                ptr = line_end;
+                if (ptr != end && *ptr == '\r')
+                    ++ ptr;
+                if (ptr != end && *ptr == '\n') {
+                    ++ ptr;
+                    block->lines_ends.emplace_back(block->file_pos + (ptr - block->text.c_str()));
+                }
+            }
+            return block;
+        });
+
+    const auto consumer = tbb::make_filter<std::shared_ptr<Block>, void>(slic3r_tbb_filtermode::serial_in_order,
+        [this, &callback, &lines_ends, &quit](std::shared_ptr<Block> block) {
+            if (quit)
+                return;
+            lines_ends.insert(lines_ends.end(), block->lines_ends.begin(), block->lines_ends.end());
+            for (GCodeLine &gline : block->lines) {
+                this->line_parsed(gline);
+                callback(*this, gline);
+                std::pair<const char*, const char*> cmd;
+                cmd.first  = skip_whitespaces(gline.m_raw.c_str());
+                cmd.second = skip_word(cmd.first);
+                this->update_coordinates(gline, cmd);
+                if (! m_parsing) {
+                    quit = true;
+                    return;
+                }
+            }
+        });
+
+    // Limit the number of blocks in flight to bound the memory consumption for large G-codes.
+    tbb::parallel_pipeline(16, reader & tokenizer & consumer);
+
+    BOOST_LOG_TRIVIAL(info) << __FUNCTION__ << boost::format(":  finished parse_file_parallel %1%") % file.c_str();
+    return ! read_error;
+}
+
 bool GCodeReader::parse_file_raw(const std::string &filename, raw_line_callback_t line_callback)
 {
     return this->parse_file_raw_internal(filename,
@@ -126,6 +126,7 @@ public:
     {
         std::pair<const char*, const char*> cmd;
         const char *line_end = parse_line_internal(ptr, end, gline, cmd);
+        this->line_parsed(gline);
         callback(*this, gline);
         update_coordinates(gline, cmd);
         return line_end;
@@ -140,6 +141,9 @@ public:
     // Collect positions of line ends in the binary G-code to be used by the G-code viewer when memory mapping and displaying section of G-code
     // as an overlay in the 3D scene.
     bool parse_file(const std::string &file, callback_t callback, std::vector<size_t> &lines_ends);
+    // Same as above, but the lines are tokenized in parallel in blocks of lines. The callback is still called sequentially for each line
+    // in the order of the file, thus the callback does not need to be thread safe. Returns false if reading the file failed.
+    bool parse_file_parallel(const std::string &file, callback_t callback, std::vector<size_t> &lines_ends);
     // Just read the G-code file line by line, calls callback (const char *begin, const char *end). Returns false if reading the file failed.
     bool parse_file_raw(const std::string &file, raw_line_callback_t callback);
 
@@ -168,7 +172,10 @@ private:
     template<typename ParseLineCallback, typename LineEndCallback>
     bool        parse_file_internal(const std::string &filename, ParseLineCallback parse_line_callback, LineEndCallback line_end_callback);
 
-    const char* parse_line_internal(const char *ptr, const char *end, GCodeLine &gline, std::pair<const char*, const char*> &command);
+    // Does not modify the state of the reader, thus it may be called from multiple threads.
+    static const char* parse_line_internal(const char *ptr, const char *end, GCodeLine &gline, std::pair<const char*, const char*> &command);
+    // Update the reader state after parse_line_internal(), before the callback is called.
+    void        line_parsed(const GCodeLine &gline);
     void        update_coordinates(GCodeLine &gline, std::pair<const char*, const char*> &command);
 
     static bool         is_whitespace(char c)           { return c == ' ' || c == '\t'; }
@@ -96,7 +96,7 @@ std::string GCodeWriter::set_temperature(unsigned int temperature, GCodeFlavor f
     if (wait && (flavor == gcfMakerWare || flavor == gcfSailfish))
         return "";
 
-    std::string code;
+    const char *code;
     if (wait && flavor != gcfTeacup && flavor != gcfRepRapFirmware) {
         code    = "M109";
         if(comment.empty())
@@ -111,27 +111,21 @@ std::string GCodeWriter::set_temperature(unsigned int temperature, GCodeFlavor f
             comment = "set nozzle temperature";
     }
 
-    std::ostringstream gcode;
-    gcode << code << " ";
-    if (flavor == gcfMach3 || flavor == gcfMachinekit) {
-        gcode << "P";
-    } else {
-        gcode << "S";
-    }
-    gcode << temperature;
+    GCodeFormatter w;
+    w.emit_string(code);
+    w.emit_string((flavor == gcfMach3 || flavor == gcfMachinekit) ? " P" : " S");
+    w.emit_int(temperature);
     if (tool != -1) {
-        if (flavor == gcfRepRapFirmware) {
-            gcode << " P" << tool;
-        } else {
-            gcode << " T" << tool;
-        }
+        w.emit_string(flavor == gcfRepRapFirmware ? " P" : " T");
+        w.emit_int(tool);
     }
-    gcode << " ; " << comment << "\n";
+    w.emit_comment(true, comment);
+    std::string gcode = w.string();
 
     if ((flavor == gcfTeacup || flavor == gcfRepRapFirmware) && wait)
-        gcode << "M116 ; wait for temperature to be reached\n";
+        gcode += "M116 ; wait for temperature to be reached\n";
 
-    return gcode.str();
+    return gcode;
 }
 
 std::string GCodeWriter::set_temperature(unsigned int temperature, bool wait, int tool) const
@@ -151,20 +145,11 @@ std::string GCodeWriter::set_bed_temperature(int temperature, bool wait)
     m_last_bed_temperature = temperature;
     m_last_bed_temperature_reached = wait;
 
-    std::string code, comment;
-    std::ostringstream gcode;
-
-    if (wait) {
-        code = "M190";
-        comment = "set bed temperature and wait for it to be reached";
-    }
-    else {
-        code = "M140";
-        comment = "set bed temperature";
-    }
-
-    gcode << code << " S" << temperature << " ; " << comment << "\n";
-    return gcode.str();
+    GCodeFormatter w;
+    w.emit_string(wait ? "M190 S" : "M140 S");
+    w.emit_int(temperature);
+    w.emit_comment(true, wait ? "set bed temperature and wait for it to be reached" : "set bed temperature");
+    return w.string();
 }
 
 std::string GCodeWriter::set_chamber_temperature(int temperature, bool wait)
@@ -208,26 +193,30 @@ std::string GCodeWriter::set_acceleration_internal(Acceleration type, unsigned i
     
     last_value = acceleration;
     
-    std::ostringstream gcode;
-    if (FLAVOR_IS(gcfRepetier))
-        gcode << (separate_travel ? "M202 X" : "M201 X") << acceleration << " Y" << acceleration;
-    else if (FLAVOR_IS(gcfRepRapFirmware) || FLAVOR_IS(gcfMarlinFirmware))
-        gcode << (separate_travel ? "M204 T" : "M204 P") << acceleration;
-    else if (FLAVOR_IS(gcfKlipper)) {
-        gcode << "SET_VELOCITY_LIMIT ACCEL=" << acceleration;
+    GCodeFormatter w;
+    if (FLAVOR_IS(gcfRepetier)) {
+        w.emit_string(separate_travel ? "M202 X" : "M201 X");
+        w.emit_int(acceleration);
+        w.emit_string(" Y");
+        w.emit_int(acceleration);
+    } else if (FLAVOR_IS(gcfRepRapFirmware) || FLAVOR_IS(gcfMarlinFirmware)) {
+        w.emit_string(separate_travel ? "M204 T" : "M204 P");
+        w.emit_int(acceleration);
+    } else if (FLAVOR_IS(gcfKlipper)) {
+        w.emit_string("SET_VELOCITY_LIMIT ACCEL=");
+        w.emit_int(acceleration);
         if (this->config.accel_to_decel_enable) {
-            gcode << " ACCEL_TO_DECEL=" << acceleration * this->config.accel_to_decel_factor / 100;
-            if (GCodeWriter::full_gcode_comment)
-                gcode << " ; adjust ACCEL_TO_DECEL";
+            w.emit_string(" ACCEL_TO_DECEL=");
+            w.emit_value(acceleration * this->config.accel_to_decel_factor / 100, GCodeFormatter::XYZF_EXPORT_DIGITS);
+            w.emit_comment(GCodeWriter::full_gcode_comment, "adjust ACCEL_TO_DECEL");
         }
+    } else {
+        w.emit_string("M204 S");
+        w.emit_int(acceleration);
     }
-    else
-        gcode << "M204 S" << acceleration;
 
-    if (GCodeWriter::full_gcode_comment) gcode << " ; adjust acceleration";
-    gcode << "\n";
-    
-    return gcode.str();
+    w.emit_comment(GCodeWriter::full_gcode_comment, "adjust acceleration");
+    return w.string();
 }
 
 std::string GCodeWriter::set_jerk_xy(double jerk)
@@ -348,12 +337,11 @@ std::string GCodeWriter::reset_e(bool force)
     }
 
     if (! this->config.use_relative_e_distances) {
-        std::ostringstream gcode;
-        gcode << "G92 E0";
+        GCodeFormatter w;
+        w.emit_string("G92 E0");
         //BBS
-        if (GCodeWriter::full_gcode_comment) gcode << " ; reset extrusion distance";
-        gcode << "\n";
-        return gcode.str();
+        w.emit_comment(GCodeWriter::full_gcode_comment, "reset extrusion distance");
+        return w.string();
     } else {
         return "";
     }
@@ -371,12 +359,12 @@ std::string GCodeWriter::update_progress(unsigned int num, unsigned int tot, boo
     unsigned int percent = (unsigned int)floor(100.0 * num / tot + 0.5);
     if (!allow_100) percent = std::min(percent, (unsigned int)99);
     
-    std::ostringstream gcode;
-    gcode << "M73 P" << percent;
+    GCodeFormatter w;
+    w.emit_string("M73 P");
+    w.emit_int(percent);
     //BBS
-    if (GCodeWriter::full_gcode_comment) gcode << " ; update progress";
-    gcode << "\n";
-    return gcode.str();
+    w.emit_comment(GCodeWriter::full_gcode_comment, "update progress");
+    return w.string();
 }
 
 std::string GCodeWriter::toolchange_prefix() const
@@ -395,19 +383,20 @@ std::string GCodeWriter::toolchange(unsigned int extruder_id)
 
     // return the toolchange command
     // if we are running a single-extruder setup, just set the extruder and return nothing
-    std::ostringstream gcode;
+    std::string gcode;
     if (this->multiple_extruders || (this->config.filament_diameter.values.size() > 1 && !is_bbl_printers())) {
-        gcode << this->toolchange_prefix() << extruder_id;
+        GCodeFormatter w;
+        w.emit_string(this->toolchange_prefix());
+        w.emit_int(extruder_id);
         //BBS
-        if (GCodeWriter::full_gcode_comment)
-            gcode << " ; change extruder";
-        gcode << "\n";
-        gcode << this->reset_e(true);
+        w.emit_comment(GCodeWriter::full_gcode_comment, "change extruder");
+        gcode = w.string();
+        gcode += this->reset_e(true);
     }
-    return gcode.str();
+    return gcode;
 }
 
-std::string GCodeWriter::set_speed(double F, const std::string &comment, const std::string &cooling_marker)
+void GCodeWriter::set_speed(std::string &out, double F, const std::string &comment, const std::string &cooling_marker)
 {
     assert(F > 0.);
     assert(F < 100000.);
@@ -418,10 +407,10 @@ std::string GCodeWriter::set_speed(double F, const std::string &comment, const s
     //BBS
     w.emit_comment(GCodeWriter::full_gcode_comment, comment);
     w.emit_string(cooling_marker);
-    return w.string();
+    w.append_to(out);
 }
 
-std::string GCodeWriter::travel_to_xy(const Vec2d &point, const std::string &comment)
+void GCodeWriter::travel_to_xy(std::string &out, const Vec2d &point, const std::string &comment)
 {
     m_pos(0) = point(0);
     m_pos(1) = point(1);
@@ -437,10 +426,10 @@ std::string GCodeWriter::travel_to_xy(const Vec2d &point, const std::string &com
     w.emit_f(speed * 60.0);
     //BBS
     w.emit_comment(GCodeWriter::full_gcode_comment, comment);
-    return w.string();
+    w.append_to(out);
 }
 
-std::string GCodeWriter::travel_to_xyz(const Vec3d &point, const std::string &comment, bool force_z)
+void GCodeWriter::travel_to_xyz(std::string &out, const Vec3d &point, const std::string &comment, bool force_z)
 {
     // FIXME: This function was not being used when travel_speed_z was separated (bd6badf).
     // Calculation of feedrate was not updated accordingly. If you want to use
@@ -468,7 +457,6 @@ std::string GCodeWriter::travel_to_xyz(const Vec3d &point, const std::string &co
         }
         m_to_lift = 0.;
 
-        std::string slop_move;
         //BBS: minus plate offset
         Vec3d source = { m_pos(0) - m_x_offset, m_pos(1) - m_y_offset, m_pos(2) };
         Vec3d target = { dest_point(0) - m_x_offset, dest_point(1) - m_y_offset, dest_point(2) };
@@ -483,7 +471,7 @@ std::string GCodeWriter::travel_to_xyz(const Vec3d &point, const std::string &co
                 double radius = delta(2) / (2 * PI * atan(this->extruder()->travel_slope()));
                 Vec2d ij_offset = radius * delta_no_z.normalized();
                 ij_offset = { -ij_offset(1), ij_offset(0) };
-                slop_move = this->_spiral_travel_to_z(target(2), ij_offset, "spiral lift Z");
+                this->_spiral_travel_to_z(out, target(2), ij_offset, "spiral lift Z");
             }
             //BBS: LazyLift
             else if (m_to_lift_type == LiftType::LazyLift &&
@@ -499,32 +487,32 @@ std::string GCodeWriter::travel_to_xyz(const Vec3d &point, const std::string &co
                 w0.emit_f(travel_speed * 60.0);
                 //BBS
                 w0.emit_comment(GCodeWriter::full_gcode_comment, comment);
-                slop_move = w0.string();
+                w0.append_to(out);
             }
             else if (m_to_lift_type == LiftType::NormalLift) {
-                slop_move = _travel_to_z(target.z(), "normal lift Z");
+                this->_travel_to_z(out, target.z(), "normal lift Z");
             }
         }
 
-        std::string xy_z_move;
         {
             GCodeG1Formatter w0;
             if (this->is_current_position_clear()) {
                 w0.emit_xyz(target);
                 w0.emit_f(travel_speed * 60.0);
                 w0.emit_comment(GCodeWriter::full_gcode_comment, comment);
-                xy_z_move = w0.string();
+                w0.append_to(out);
             }
             else {
                 w0.emit_xy(Vec2d(target.x(), target.y()));
                 w0.emit_f(travel_speed * 60.0);
                 w0.emit_comment(GCodeWriter::full_gcode_comment, comment);
-                xy_z_move = w0.string() + _travel_to_z(target.z(), comment);
+                w0.append_to(out);
+                this->_travel_to_z(out, target.z(), comment);
             }
         }
         m_pos = dest_point;
         this->set_current_position_clear(true);
-        return slop_move + xy_z_move;
+        return;
     }
     else if (!force_z && !this->will_move_z(point(2))) {
         double nominal_z = m_pos(2) - m_lifted;
@@ -535,7 +523,8 @@ std::string GCodeWriter::travel_to_xyz(const Vec3d &point, const std::string &co
             m_lifted = 0.;
         //BBS
         this->set_current_position_clear(true);
-        return this->travel_to_xy(to_2d(point));
+        this->travel_to_xy(out, to_2d(point));
+        return;
     }
     else {
         /*  In all the other cases, we perform an actual XYZ move and cancel
@@ -545,7 +534,6 @@ std::string GCodeWriter::travel_to_xyz(const Vec3d &point, const std::string &co
     
     //BBS: take plate offset into consider
     Vec3d point_on_plate = { dest_point(0) - m_x_offset, dest_point(1) - m_y_offset, dest_point(2) };
-    std::string out_string;
     GCodeG1Formatter w;
     if (!this->is_current_position_clear())
     {
@@ -553,21 +541,20 @@ std::string GCodeWriter::travel_to_xyz(const Vec3d &point, const std::string &co
         w.emit_xy(Vec2d(point_on_plate.x(), point_on_plate.y()));
         w.emit_f(this->config.travel_speed.value * 60.0);
         w.emit_comment(GCodeWriter::full_gcode_comment, comment);
-        out_string = w.string() + _travel_to_z(point_on_plate.z(), comment);
+        w.append_to(out);
+        this->_travel_to_z(out, point_on_plate.z(), comment);
     } else {
-        GCodeG1Formatter w;
         w.emit_xyz(point_on_plate);
         w.emit_f(this->config.travel_speed.value * 60.0);
         w.emit_comment(GCodeWriter::full_gcode_comment, comment);
-        out_string = w.string();
+        w.append_to(out);
     }
 
     m_pos = dest_point;
     this->set_current_position_clear(true);
-    return out_string;
 }
 
-std::string GCodeWriter::travel_to_z(double z, const std::string &comment)
+void GCodeWriter::travel_to_z(std::string &out, double z, const std::string &comment)
 {
     /*  If target Z is lower than current Z but higher than nominal Z
         we don't perform the move but we only adjust the nominal Z by
@@ -577,16 +564,16 @@ std::string GCodeWriter::travel_to_z(double z, const std::string &comment)
         m_lifted -= (z - nominal_z);
         if (std::abs(m_lifted) < EPSILON)
             m_lifted = 0.;
-        return "";
+        return;
     }
     
     /*  In all the other cases, we perform an actual Z move and cancel
         the lift. */
     m_lifted = 0;
-    return this->_travel_to_z(z, comment);
+    this->_travel_to_z(out, z, comment);
 }
 
-std::string GCodeWriter::_travel_to_z(double z, const std::string &comment)
+void GCodeWriter::_travel_to_z(std::string &out, double z, const std::string &comment)
 {
     m_pos(2) = z;
 
@@ -601,10 +588,10 @@ std::string GCodeWriter::_travel_to_z(double z, const std::string &comment)
     w.emit_f(speed * 60.0);
     //BBS
     w.emit_comment(GCodeWriter::full_gcode_comment, comment);
-    return w.string();
+    w.append_to(out);
 }
 
-std::string GCodeWriter::_spiral_travel_to_z(double z, const Vec2d &ij_offset, const std::string &comment)
+void GCodeWriter::_spiral_travel_to_z(std::string &out, double z, const Vec2d &ij_offset, const std::string &comment)
 {
     m_pos(2) = z;
 
@@ -614,14 +601,14 @@ std::string GCodeWriter::_spiral_travel_to_z(double z, const Vec2d &ij_offset, c
                                  : this->config.travel_speed.value;
     }
     
-    std::string output = "G17\n";
+    out += "G17\n";
     GCodeG2G3Formatter w(true);
     w.emit_z(z);
     w.emit_ij(ij_offset);
     w.emit_string(" P1 ");
     w.emit_f(speed * 60.0);
     w.emit_comment(GCodeWriter::full_gcode_comment, comment);
-    return output + w.string();
+    w.append_to(out);
 }
 
 bool GCodeWriter::will_move_z(double z) const
@@ -641,7 +628,7 @@ bool GCodeWriter::will_move_z(double z) const
     return true;
 }
 
-std::string GCodeWriter::extrude_to_xy(const Vec2d &point, double dE, const std::string &comment, bool force_no_extrusion)
+void GCodeWriter::extrude_to_xy(std::string &out, const Vec2d &point, double dE, const std::string &comment, bool force_no_extrusion)
 {
     m_pos(0) = point(0);
     m_pos(1) = point(1);
@@ -660,13 +647,13 @@ std::string GCodeWriter::extrude_to_xy(const Vec2d &point, double dE, const std:
         w.emit_e(m_extruder->E());
     //BBS
     w.emit_comment(GCodeWriter::full_gcode_comment, comment);
-    return w.string();
+    w.append_to(out);
 }
 
 //BBS: generate G2 or G3 extrude which moves by arc
 //point is end point which means X and Y axis
 //center_offset is I and J axis
-std::string GCodeWriter::extrude_arc_to_xy(const Vec2d& point, const Vec2d& center_offset, double dE, const bool is_ccw, const std::string& comment, bool force_no_extrusion)
+void GCodeWriter::extrude_arc_to_xy(std::string &out, const Vec2d& point, const Vec2d& center_offset, double dE, const bool is_ccw, const std::string& comment, bool force_no_extrusion)
 {
     m_pos(0) = point(0);
     m_pos(1) = point(1);
@@ -682,10 +669,10 @@ std::string GCodeWriter::extrude_arc_to_xy(const Vec2d& point, const Vec2d& cent
         w.emit_e(m_extruder->E());
     //BBS
     w.emit_comment(GCodeWriter::full_gcode_comment, comment);
-    return w.string();
+    w.append_to(out);
 }
 
-std::string GCodeWriter::extrude_to_xyz(const Vec3d &point, double dE, const std::string &comment, bool force_no_extrusion)
+void GCodeWriter::extrude_to_xyz(std::string &out, const Vec3d &point, double dE, const std::string &comment, bool force_no_extrusion)
 {
     m_pos = point;
     m_lifted = 0;
@@ -701,32 +688,32 @@ std::string GCodeWriter::extrude_to_xyz(const Vec3d &point, double dE, const std
         w.emit_e(m_extruder->E());
     //BBS
     w.emit_comment(GCodeWriter::full_gcode_comment, comment);
-    return w.string();
+    w.append_to(out);
 }
 
-std::string GCodeWriter::retract(bool before_wipe, double retract_length)
+void GCodeWriter::retract(std::string &out, bool before_wipe, double retract_length)
 {
     double factor = before_wipe ? m_extruder->retract_before_wipe() : 1.;
     assert(factor >= 0. && factor <= 1. + EPSILON);
-    return this->_retract(
+    this->_retract(out,
         retract_length > EPSILON ? retract_length : factor * m_extruder->retraction_length(),
         factor * m_extruder->retract_restart_extra(),
         "retract"
     );
 }
 
-std::string GCodeWriter::retract_for_toolchange(bool before_wipe, double retract_length)
+void GCodeWriter::retract_for_toolchange(std::string &out, bool before_wipe, double retract_length)
 {
     double factor = before_wipe ? m_extruder->retract_before_wipe() : 1.;
     assert(factor >= 0. && factor <= 1. + EPSILON);
-    return this->_retract(
+    this->_retract(out,
         retract_length > EPSILON ? retract_length : factor * m_extruder->retract_length_toolchange(),
         factor * m_extruder->retract_restart_extra_toolchange(),
         "retract for toolchange"
     );
 }
 
-std::string GCodeWriter::_retract(double length, double restart_extra, const std::string &comment)
+void GCodeWriter::_retract(std::string &out, double length, double restart_extra, const std::string &comment)
 {
     /*  If firmware retraction is enabled, we use a fake value of 1
     since we ignore the actual configured retract_length which
@@ -734,10 +721,9 @@ std::string GCodeWriter::_retract(double length, double restart_extra, const std
     if (this->config.use_firmware_retraction)
         length = 1;
 
-    std::string gcode;
     if (double dE = m_extruder->retract(length, restart_extra);  !is_zero(dE)) {
         if (this->config.use_firmware_retraction) {
-            gcode = FLAVOR_IS(gcfMachinekit) ? "G22 ; retract\n" : "G10 ; retract\n";
+            out += FLAVOR_IS(gcfMachinekit) ? "G22 ; retract\n" : "G10 ; retract\n";
         }
         else {
             // BBS
@@ -746,27 +732,23 @@ std::string GCodeWriter::_retract(double length, double restart_extra, const std
             w.emit_f(m_extruder->retract_speed() * 60.);
             // BBS
             w.emit_comment(GCodeWriter::full_gcode_comment, comment);
-            gcode = w.string();
+            w.append_to(out);
         }
     }
     
     if (FLAVOR_IS(gcfMakerWare))
-        gcode += "M103 ; extruder off\n";
-
-    return gcode;
+        out += "M103 ; extruder off\n";
 }
 
-std::string GCodeWriter::unretract()
+void GCodeWriter::unretract(std::string &out)
 {
-    std::string gcode;
-    
     if (FLAVOR_IS(gcfMakerWare))
-        gcode = "M101 ; extruder on\n";
+        out += "M101 ; extruder on\n";
     
     if (double dE = m_extruder->unretract(); !is_zero(dE)) {
         if (this->config.use_firmware_retraction) {
-            gcode += FLAVOR_IS(gcfMachinekit) ? "G23 ; unretract\n" : "G11 ; unretract\n";
-            gcode += this->reset_e();
+            out += FLAVOR_IS(gcfMachinekit) ? "G23 ; unretract\n" : "G11 ; unretract\n";
+            out += this->reset_e();
         }
         else {
             //BBS
@@ -776,17 +758,15 @@ std::string GCodeWriter::unretract()
             w.emit_f(m_extruder->deretract_speed() * 60.);
             //BBS
             w.emit_comment(GCodeWriter::full_gcode_comment, " ; unretract");
-            gcode += w.string();
+            w.append_to(out);
         }
     }
-    
-    return gcode;
 }
 
 /*  If this method is called more than once before calling unlift(),
     it will not perform subsequent lifts, even if Z was raised manually
     (i.e. with travel_to_z()) and thus _lifted was reduced. */
-std::string GCodeWriter::lift(LiftType lift_type, bool spiral_vase)
+void GCodeWriter::lift(std::string &out, LiftType lift_type, bool spiral_vase)
 {
     // check whether the above/below conditions are met
     double target_lift = 0;
@@ -800,59 +780,54 @@ std::string GCodeWriter::lift(LiftType lift_type, bool spiral_vase)
     if (m_lifted == 0 && m_to_lift == 0 && target_lift > 0) {
         if (spiral_vase) {
             m_lifted = target_lift;
-            return this->_travel_to_z(m_pos(2) + target_lift, "lift Z");
+            this->_travel_to_z(out, m_pos(2) + target_lift, "lift Z");
         }
         else {
             m_to_lift = target_lift;
             m_to_lift_type = lift_type;
         }
     }
-    return "";
 }
 
-std::string GCodeWriter::unlift()
+void GCodeWriter::unlift(std::string &out)
 {
-    std::string gcode;
     if (m_lifted > 0) {
-        gcode += this->_travel_to_z(m_pos(2) - m_lifted, "restore layer Z");
+        this->_travel_to_z(out, m_pos(2) - m_lifted, "restore layer Z");
         m_lifted = 0;
     }
     m_to_lift = 0.;
-    return gcode;
 }
 
 std::string GCodeWriter::set_fan(const GCodeFlavor gcode_flavor, unsigned int speed)
 {
-    std::ostringstream gcode;
+    GCodeFormatter w;
     if (speed == 0) {
         switch (gcode_flavor) {
         case gcfTeacup:
-            gcode << "M106 S0"; break;
+            w.emit_string("M106 S0"); break;
         case gcfMakerWare:
         case gcfSailfish:
-            gcode << "M127";    break;
+            w.emit_string("M127");    break;
         default:
-            gcode << "M106 S0";    break;
+            w.emit_string("M106 S0");    break;
         }
-        if (GCodeWriter::full_gcode_comment)
-            gcode << " ; disable fan";
-        gcode << "\n";
+        w.emit_comment(GCodeWriter::full_gcode_comment, "disable fan");
     } else {
         switch (gcode_flavor) {
         case gcfMakerWare:
         case gcfSailfish:
-            gcode << "M126";    break;
+            w.emit_string("M126");    break;
         case gcfMach3:
         case gcfMachinekit:
-            gcode << "M106 P" << static_cast<unsigned int>(255.5 * speed / 100.0); break;
+            w.emit_string("M106 P");
+            w.emit_int(static_cast<unsigned int>(255.5 * speed / 100.0)); break;
         default:
-            gcode << "M106 S" << static_cast<unsigned int>(255.5 * speed / 100.0); break;
+            w.emit_string("M106 S");
+            w.emit_int(static_cast<unsigned int>(255.5 * speed / 100.0)); break;
         }
-        if (GCodeWriter::full_gcode_comment) 
-            gcode << " ; enable fan";
-        gcode << "\n";
+        w.emit_comment(GCodeWriter::full_gcode_comment, "enable fan");
     }
-    return gcode.str();
+    return w.string();
 }
 
 std::string GCodeWriter::set_fan(unsigned int speed) const
@@ -914,11 +889,38 @@ void GCodeWriter::add_object_change_labels(std::string& gcode)
     add_object_start_labels(gcode);
 }
 
+void GCodeFormatter::grow(size_t n)
+{
+    const size_t len      = ptr_err.ptr - buf;
+    const size_t capacity = std::max(2 * size_t(buf_end - buf), len + n + 1);
+    std::unique_ptr<char[]> new_buf(new char[capacity]);
+    memcpy(new_buf.get(), buf, len);
+    buf_heap    = std::move(new_buf);
+    buf         = buf_heap.get();
+    buf_end     = buf + capacity;
+    ptr_err.ptr = buf + len;
+}
+
+void GCodeFormatter::emit_int(int64_t v) {
+    this->reserve(max_number_len);
+#ifdef __APPLE__
+    boost::spirit::karma::generate(this->ptr_err.ptr, boost::spirit::karma::int_generator<int64_t>(), v);
+#else
+    this->ptr_err = std::to_chars(this->ptr_err.ptr, this->buf_end - 1, v);
+#endif
+}
+
 void GCodeFormatter::emit_axis(const char axis, const double v, size_t digits) {
+    this->reserve(max_number_len + 2);
+    *ptr_err.ptr++ = ' '; *ptr_err.ptr++ = axis;
+    this->emit_value(v, digits);
+}
+
+void GCodeFormatter::emit_value(const double v, size_t digits) {
     assert(digits <= 9);
     static constexpr const std::array<int, 10> pow_10{1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000};
-    *ptr_err.ptr++ = ' '; *ptr_err.ptr++ = axis;
 
+    this->reserve(max_number_len);
     char *base_ptr = this->ptr_err.ptr;
     auto  v_int    = int64_t(std::round(v * pow_10[digits]));
     // Older stdlib on macOS doesn't support std::from_chars at all, so it is used boost::spirit::karma::generate instead of it.
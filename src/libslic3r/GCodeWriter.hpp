@@ -3,7 +3,9 @@
 
 #include "libslic3r.h"
 #include <string>
+#include <string_view>
 #include <charconv>
+#include <memory>
 #include "Extruder.hpp"
 #include "Point.hpp"
 #include "PrintConfig.hpp"
@@ -65,22 +67,46 @@ public:
     // printed with the same extruder.
     std::string toolchange_prefix() const;
     std::string toolchange(unsigned int extruder_id);
-    std::string set_speed(double F, const std::string &comment = std::string(), const std::string &cooling_marker = std::string());
+    std::string set_speed(double F, const std::string &comment = std::string(), const std::string &cooling_marker = std::string())
+        { std::string out; this->set_speed(out, F, comment, cooling_marker); return out; }
+    void        set_speed(std::string &out, double F, const std::string &comment = std::string(), const std::string &cooling_marker = std::string());
     // SoftFever NOTE: the returned speed is mm/minute
     double      get_current_speed() const { return m_current_speed;}
-    std::string travel_to_xy(const Vec2d &point, const std::string &comment = std::string());
-    std::string travel_to_xyz(const Vec3d &point, const std::string &comment = std::string(), bool force_z = false);
-    std::string travel_to_z(double z, const std::string &comment = std::string());
+    std::string travel_to_xy(const Vec2d &point, const std::string &comment = std::string())
+        { std::string out; this->travel_to_xy(out, point, comment); return out; }
+    void        travel_to_xy(std::string &out, const Vec2d &point, const std::string &comment = std::string());
+    std::string travel_to_xyz(const Vec3d &point, const std::string &comment = std::string(), bool force_z = false)
+        { std::string out; this->travel_to_xyz(out, point, comment, force_z); return out; }
+    void        travel_to_xyz(std::string &out, const Vec3d &point, const std::string &comment = std::string(), bool force_z = false);
+    std::string travel_to_z(double z, const std::string &comment = std::string())
+        { std::string out; this->travel_to_z(out, z, comment); return out; }
+    void        travel_to_z(std::string &out, double z, const std::string &comment = std::string());
     bool        will_move_z(double z) const;
-    std::string extrude_to_xy(const Vec2d &point, double dE, const std::string &comment = std::string(), bool force_no_extrusion = false);
+    std::string extrude_to_xy(const Vec2d &point, double dE, const std::string &comment = std::string(), bool force_no_extrusion = false)
+        { std::string out; this->extrude_to_xy(out, point, dE, comment, force_no_extrusion); return out; }
     //BBS: generate G2 or G3 extrude which moves by arc
-    std::string extrude_arc_to_xy(const Vec2d &point, const Vec2d &center_offset, double dE, const bool is_ccw, const std::string &comment = std::string(), bool force_no_extrusion = false);
-    std::string extrude_to_xyz(const Vec3d &point, double dE, const std::string &comment = std::string(), bool force_no_extrusion = false);
-    std::string retract(bool before_wipe = false, double retract_length = 0);
-    std::string retract_for_toolchange(bool before_wipe = false, double retract_length = 0);
-    std::string unretract();
-    std::string lift(LiftType lift_type = LiftType::NormalLift, bool spiral_vase = false);
-    std::string unlift();
+    std::string extrude_arc_to_xy(const Vec2d &point, const Vec2d &center_offset, double dE, const bool is_ccw, const std::string &comment = std::string(), bool force_no_extrusion = false)
+        { std::string out; this->extrude_arc_to_xy(out, point, center_offset, dE, is_ccw, comment, force_no_extrusion); return out; }
+    std::string extrude_to_xyz(const Vec3d &point, double dE, const std::string &comment = std::string(), bool force_no_extrusion = false)
+        { std::string out; this->extrude_to_xyz(out, point, dE, comment, force_no_extrusion); return out; }
+    // Variants of the move commands above appending the G-code line to out, used by the G-code generator to fill
+    // its per layer buffer without allocating a temporary string for each line.
+    void        extrude_to_xy(std::string &out, const Vec2d &point, double dE, const std::string &comment = std::string(), bool force_no_extrusion = false);
+    void        extrude_arc_to_xy(std::string &out, const Vec2d &point, const Vec2d &center_offset, double dE, const bool is_ccw, const std::string &comment = std::string(), bool force_no_extrusion = false);
+    void        extrude_to_xyz(std::string &out, const Vec3d &point, double dE, const std::string &comment = std::string(), bool force_no_extrusion = false);
+    std::string retract(bool before_wipe = false, double retract_length = 0)
+        { std::string out; this->retract(out, before_wipe, retract_length); return out; }
+    void        retract(std::string &out, bool before_wipe = false, double retract_length = 0);
+    std::string retract_for_toolchange(bool before_wipe = false, double retract_length = 0)
+        { std::string out; this->retract_for_toolchange(out, before_wipe, retract_length); return out; }
+    void        retract_for_toolchange(std::string &out, bool before_wipe = false, double retract_length = 0);
+    std::string unretract() { std::string out; this->unretract(out); return out; }
+    void        unretract(std::string &out);
+    std::string lift(LiftType lift_type = LiftType::NormalLift, bool spiral_vase = false)
+        { std::string out; this->lift(out, lift_type, spiral_vase); return out; }
+    void        lift(std::string &out, LiftType lift_type = LiftType::NormalLift, bool spiral_vase = false);
+    std::string unlift() { std::string out; this->unlift(out); return out; }
+    void        unlift(std::string &out);
     const Vec3d& get_position() const { return m_pos; }
     Vec3d&       get_position() { return m_pos; }
     void        set_position(const Vec3d& in) { m_pos = in; }
@@ -172,9 +198,9 @@ public:
         Print
     };
 
-    std::string _travel_to_z(double z, const std::string &comment);
-    std::string _spiral_travel_to_z(double z, const Vec2d &ij_offset, const std::string &comment);
-    std::string _retract(double length, double restart_extra, const std::string &comment);
+    void        _travel_to_z(std::string &out, double z, const std::string &comment);
+    void        _spiral_travel_to_z(std::string &out, double z, const Vec2d &ij_offset, const std::string &comment);
+    void        _retract(std::string &out, double length, double restart_extra, const std::string &comment);
     std::string set_acceleration_internal(Acceleration type, unsigned int acceleration);
 
 };
@@ -243,13 +269,19 @@ public:
         this->emit_axis('J', point.y(), XYZF_EXPORT_DIGITS);
     }
 
-    void emit_string(const std::string &s) {
-        strncpy(ptr_err.ptr, s.c_str(), s.size());
+    // Emit a number without the axis prefix, trailing zeros of the decimal part are trimmed.
+    void emit_value(const double v, size_t digits);
+    void emit_int(int64_t v);
+
+    void emit_string(const std::string_view s) {
+        this->reserve(s.size());
+        memcpy(ptr_err.ptr, s.data(), s.size());
         ptr_err.ptr += s.size();
     }
 
     void emit_comment(bool allow_comments, const std::string &comment) {
         if (allow_comments && ! comment.empty()) {
+            this->reserve(3);
             *ptr_err.ptr ++ = ' '; *ptr_err.ptr ++ = ';'; *ptr_err.ptr ++ = ' ';
             this->emit_string(comment);
         }
@@ -260,11 +292,29 @@ public:
         return std::string(this->buf, ptr_err.ptr - buf);
     }
 
+    // Append the line terminated by a newline to out.
+    void append_to(std::string &out) {
+        *ptr_err.ptr ++ = '\n';
+        out.append(this->buf, ptr_err.ptr - buf);
+    }
+
 protected:
+    // Make room for n more characters and the trailing newline. Lines longer than the fixed buffer,
+    // for example those with long comments, are moved to the heap.
+    void reserve(size_t n) {
+        if (size_t(buf_end - ptr_err.ptr) <= n)
+            this->grow(n);
+    }
+    void grow(size_t n);
+
+    // Upper bound of the length of a number written by emit_value() or emit_int() including the axis prefix.
+    static constexpr const size_t   max_number_len = 32;
     static constexpr const size_t   buflen = 256;
-    char                            buf[buflen];
+    char                            buf_fixed[buflen];
+    char                           *buf { buf_fixed };
     char* buf_end;
     std::to_chars_result            ptr_err;
+    std::unique_ptr<char[]>         buf_heap;
 };
 
 class GCodeG1Formatter : public GCodeFormatter {
@@ -3391,6 +3391,18 @@ bool FacetsAnnotation::equals(const FacetsAnnotation &other) const
     return (m_data == data);
 }
 
+size_t FacetsAnnotation::hash() const
+{
+    size_t seed = m_data.triangles_to_split.size();
+    for (const TriangleSelector::TriangleBitStreamMapping &mapping : m_data.triangles_to_split) {
+        boost::hash_combine(seed, mapping.triangle_idx);
+        boost::hash_combine(seed, mapping.bitstream_start_idx);
+    }
+    boost::hash_combine(seed, std::hash<std::vector<bool>>{}(m_data.bitstream));
+    boost::hash_combine(seed, std::hash<std::vector<bool>>{}(m_data.used_states));
+    return seed;
+}
+
 // Test whether the two models contain the same number of ModelObjects with the same set of IDs
 // ordered in the same order. In that case it is not necessary to kill the background processing.
 bool model_object_list_equal(const Model &model_old, const Model &model_new)
@@ -747,6 +747,9 @@ public:
     // After deserializing the last triangle, shrink data to fit.
     void shrink_to_fit() { m_data.triangles_to_split.shrink_to_fit(); m_data.bitstream.shrink_to_fit(); }
     bool equals(const FacetsAnnotation &other) const;
+    // Hash of the painted data. Equal data produce equal hashes, thus the hash may be used to quickly reject
+    // FacetsAnnotations that are not equal.
+    size_t hash() const;
 
 private:
     // Constructors to be only called by derived classes.
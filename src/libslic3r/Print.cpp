@@ -18,16 +18,19 @@
 #include "PrintConfig.hpp"
 #include "Model.hpp"
 #include "format.hpp"
+#include "libslic3r_version.h"
 #include <float.h>
 
 #include <algorithm>
 #include <limits>
+#include <unordered_map>
 #include <unordered_set>
 #include <boost/filesystem/path.hpp>
 #include <boost/format.hpp>
 #include <boost/log/trivial.hpp>
 #include <boost/regex.hpp>
 #include <boost/nowide/fstream.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
 
 #include <tbb/blocked_range.h>
 #include <tbb/parallel_for.h>
@@ -49,6 +52,36 @@ namespace Slic3r {
 template class PrintState<PrintStep, psCount>;
 template class PrintState<PrintObjectStep, posCount>;
 
+const char* print_step_name(PrintStep step)
+{
+    switch (step) {
+    case psWipeTower:       return "wipe_tower";
+    case psSkirtBrim:       return "skirt_brim";
+    case psGCodeExport:     return "gcode_export";
+    case psConflictCheck:   return "conflict_check";
+    default:                return "unknown";
+    }
+}
+
+const char* print_step_name(PrintObjectStep step)
+{
+    switch (step) {
+    case posSlice:                      return "slice";
+    case posPerimeters:                 return "perimeters";
+    case posEstimateCurledExtrusions:   return "estimate_curled_extrusions";
+    case posPrepareInfill:              return "prepare_infill";
+    case posInfill:                     return "infill";
+    case posIroning:                    return "ironing";
+    case posSupportMaterial:            return "support_material";
+    case posSimplifyPath:               return "simplify_path";
+    case posSimplifySupportPath:        return "simplify_support_path";
+    case posDetectOverhangsForLift:     return "detect_overhangs_for_lift";
+    case posSimplifyWall:               return "simplify_wall";
+    case posSimplifyInfill:             return "simplify_infill";
+    default:                            return "unknown";
+    }
+}
+
 PrintRegion::PrintRegion(const PrintRegionConfig &config) : PrintRegion(config, config.hash()) {}
 PrintRegion::PrintRegion(PrintRegionConfig &&config) : PrintRegion(std::move(config), config.hash()) {}
 
@@ -68,15 +101,10 @@ void Print::clear()
     m_model.clear_objects();
 }
 
-// Called by Print::apply().
-// This method only accepts PrintConfig option keys.
-bool Print::invalidate_state_by_config_options(const ConfigOptionResolver & /* new_config */, const std::vector<t_config_option_key> &opt_keys)
+// Cache the plenty of parameters, which influence the G-code generator only,
+// or they are only notes not influencing the generated G-code.
+static const std::unordered_set<std::string>& print_options_gcode_only()
 {
-    if (opt_keys.empty())
-        return false;
-
-    // Cache the plenty of parameters, which influence the G-code generator only,
-    // or they are only notes not influencing the generated G-code.
     static std::unordered_set<std::string> steps_gcode = {
         //BBS
         "additional_cooling_fan_speed",
@@ -204,7 +232,17 @@ bool Print::invalidate_state_by_config_options(const ConfigOptionResolver & /* n
         "filament_long_retractions_when_cut",
         "filament_retraction_distances_when_cut"
     };
+    return steps_gcode;
+}
+
+// Called by Print::apply().
+// This method only accepts PrintConfig option keys.
+bool Print::invalidate_state_by_config_options(const ConfigOptionResolver & /* new_config */, const std::vector<t_config_option_key> &opt_keys)
+{
+    if (opt_keys.empty())
+        return false;
 
+    const std::unordered_set<std::string> &steps_gcode = print_options_gcode_only();
     static std::unordered_set<std::string> steps_ignore;
 
     std::vector<PrintStep> steps;
@@ -1741,6 +1779,8 @@ void  PrintObject::clear_shared_object()
         m_shared_object = nullptr;
 
         invalidate_all_steps_without_cancel();
+        for (std::vector<std::pair<size_t, size_t>> &ranges : m_dirty_layer_ranges)
+            ranges.clear();
     }
 }
 
@@ -1884,22 +1924,70 @@ void Print::process(long long *time_cost_with_cache, bool use_cache)
             return false;
         return true;
     };
+    // Hash of the ModelObject data compared by is_print_object_the_same(), so that the objects are only compared
+    // with the objects of the same hash. The volume transformations are compared with a tolerance, thus they are left out.
+    auto model_object_hash = [](const ModelObject* model_object) -> size_t {
+        auto hash_config = [](size_t &seed, const ModelConfig &config) {
+            for (const std::string &key : config.keys()) {
+                boost::hash_combine(seed, key);
+                boost::hash_combine(seed, config.option(key)->hash());
+            }
+        };
+        size_t seed = model_object->volumes.size();
+        hash_config(seed, model_object->config);
+        for (const ModelVolume *model_volume : model_object->volumes) {
+            boost::hash_combine(seed, int(model_volume->type()));
+            boost::hash_combine(seed, model_volume->mesh_ptr().get());
+            hash_config(seed, model_volume->config);
+            boost::hash_combine(seed, model_volume->supported_facets.hash());
+            boost::hash_combine(seed, model_volume->seam_facets.hash());
+            boost::hash_combine(seed, model_volume->mmu_segmentation_facets.hash());
+        }
+        return seed;
+    };
     int object_count = m_objects.size();
     std::set<PrintObject*> need_slicing_objects;
     std::set<PrintObject*> re_slicing_objects;
+    // PrintObjects of the same ModelObject share its hash, which is calculated just once.
+    std::vector<const ModelObject*> model_objects;
+    for (const PrintObject *obj : m_objects)
+        model_objects.emplace_back(obj->model_object());
+    sort_remove_duplicates(model_objects);
+    std::vector<size_t> model_object_hashes(model_objects.size());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, model_objects.size()), [&model_objects, &model_object_hashes, &model_object_hash](const tbb::blocked_range<size_t> &range) {
+        for (size_t index = range.begin(); index < range.end(); ++ index)
+            model_object_hashes[index] = model_object_hash(model_objects[index]);
+    });
+    // The object transformations are compared exactly.
+    std::vector<size_t> object_hashes(object_count);
+    for (int index = 0; index < object_count; ++ index) {
+        const PrintObject *obj = m_objects[index];
+        size_t seed = model_object_hashes[std::lower_bound(model_objects.begin(), model_objects.end(), obj->model_object()) - model_objects.begin()];
+        for (int i = 0; i < 16; ++ i)
+            boost::hash_combine(seed, obj->trafo().matrix().data()[i]);
+        object_hashes[index] = seed;
+    }
+    // Objects to be sliced, indexed by their hashes.
+    std::unordered_multimap<size_t, PrintObject*> need_slicing_objects_by_hash;
+    auto add_need_slicing_object = [&need_slicing_objects, &need_slicing_objects_by_hash, &object_hashes](int index, PrintObject *obj) {
+        need_slicing_objects.insert(obj);
+        need_slicing_objects_by_hash.emplace(object_hashes[index], obj);
+    };
+    auto find_shared_object = [&need_slicing_objects_by_hash, &object_hashes, &is_print_object_the_same](int index, PrintObject *obj) -> PrintObject* {
+        auto [it_begin, it_end] = need_slicing_objects_by_hash.equal_range(object_hashes[index]);
+        for (auto it = it_begin; it != it_end; ++ it)
+            if (is_print_object_the_same(obj, it->second))
+                return it->second;
+        return nullptr;
+    };
     if (!use_cache) {
         for (int index = 0; index < object_count; index++)
         {
             PrintObject *obj =  m_objects[index];
-            for (PrintObject *slicing_obj : need_slicing_objects)
-            {
-                if (is_print_object_the_same(obj, slicing_obj)) {
-                    obj->set_shared_object(slicing_obj);
-                    break;
-                }
-            }
-            if (!obj->get_shared_object())
-                need_slicing_objects.insert(obj);
+            if (PrintObject *slicing_obj = find_shared_object(index, obj); slicing_obj != nullptr)
+                obj->set_shared_object(slicing_obj);
+            else
+                add_need_slicing_object(index, obj);
         }
     }
     else {
@@ -1907,20 +1995,16 @@ void Print::process(long long *time_cost_with_cache, bool use_cache)
         {
             PrintObject *obj =  m_objects[index];
             if (obj->layer_count() > 0)
-                need_slicing_objects.insert(obj);
+                add_need_slicing_object(index, obj);
         }
         for (int index = 0; index < object_count; index++)
         {
             PrintObject *obj =  m_objects[index];
             bool found_shared = false;
             if (need_slicing_objects.find(obj) == need_slicing_objects.end()) {
-                for (PrintObject *slicing_obj : need_slicing_objects)
-                {
-                    if (is_print_object_the_same(obj, slicing_obj)) {
-                        obj->set_shared_object(slicing_obj);
-                        found_shared = true;
-                        break;
-                    }
+                if (PrintObject *slicing_obj = find_shared_object(index, obj); slicing_obj != nullptr) {
+                    obj->set_shared_object(slicing_obj);
+                    found_shared = true;
                 }
                 if (!found_shared) {
                     BOOST_LOG_TRIVIAL(warning) << boost::format("Also can not find the shared object, identify_id %1%, maybe shared object is skipped")%obj->model_object()->instances[0]->loaded_id;
@@ -1936,100 +2020,55 @@ void Print::process(long long *time_cost_with_cache, bool use_cache)
 
     BOOST_LOG_TRIVIAL(info) << __FUNCTION__ << boost::format(": total object counts %1% in current print, need to slice %2%")%m_objects.size()%need_slicing_objects.size();
     BOOST_LOG_TRIVIAL(info) << "Starting the slicing process." << log_memory_info();
+    // Mark the object steps as done without running them. Used for the objects sharing their layers with another object
+    // and for the objects loaded from the slicing cache.
+    auto skip_object_steps = [](PrintObject *obj, std::initializer_list<PrintObjectStep> steps) {
+        for (PrintObjectStep step : steps)
+            if (obj->set_started(step))
+                obj->set_done(step);
+    };
+    // Each object walks through its own chain of PrintObjectSteps independently of the other objects, so that a plate
+    // of dissimilar objects does not wait for the slowest object at every step. The steps of a single object parallelize
+    // over layers internally, the nested parallel_for calls share the same TBB worker pool.
+    // The only true cross-object dependencies (tool ordering, wipe tower, skirt & brim) are joined below, once all the
+    // objects are processed.
     if (!use_cache) {
-        for (PrintObject *obj : m_objects) {
-            if (need_slicing_objects.count(obj) != 0) {
-                obj->make_perimeters();
-            }
-            else {
-                if (obj->set_started(posSlice))
-                    obj->set_done(posSlice);
-                if (obj->set_started(posPerimeters))
-                    obj->set_done(posPerimeters);
-            }
-        }
-        for (PrintObject *obj : m_objects) {
-            if (need_slicing_objects.count(obj) != 0) {
-                obj->estimate_curled_extrusions();
-            }
-            else {
-                if (obj->set_started(posEstimateCurledExtrusions))
-                    obj->set_done(posEstimateCurledExtrusions);
-            }
-        }
-        for (PrintObject *obj : m_objects) {
-            if (need_slicing_objects.count(obj) != 0) {
-                obj->infill();
-            }
-            else {
-                if (obj->set_started(posPrepareInfill))
-                    obj->set_done(posPrepareInfill);
-                if (obj->set_started(posInfill))
-                    obj->set_done(posInfill);
-            }
-        }
-        for (PrintObject *obj : m_objects) {
-            if (need_slicing_objects.count(obj) != 0) {
-                obj->ironing();
-            }
-            else {
-                if (obj->set_started(posIroning))
-                    obj->set_done(posIroning);
-            }
-        }
-
-        tbb::parallel_for(tbb::blocked_range<int>(0, int(m_objects.size())),
-            [this, need_slicing_objects](const tbb::blocked_range<int>& range) {
-                for (int i = range.begin(); i < range.end(); i++) {
-                    PrintObject* obj = m_objects[i];
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, m_objects.size(), 1),
+            [this, &need_slicing_objects, &skip_object_steps](const tbb::blocked_range<size_t>& range) {
+                for (size_t i = range.begin(); i < range.end(); ++ i) {
+                    PrintObject *obj = m_objects[i];
                     if (need_slicing_objects.count(obj) != 0) {
+                        this->make_perimeters_with_result_cache(obj);
+                        obj->estimate_curled_extrusions();
+                        obj->infill();
+                        obj->ironing();
                         obj->generate_support_material();
-                    }
-                    else {
-                        if (obj->set_started(posSupportMaterial))
-                            obj->set_done(posSupportMaterial);
+                        obj->detect_overhangs_for_lift();
+                    } else {
+                        skip_object_steps(obj, { posSlice, posPerimeters, posEstimateCurledExtrusions, posPrepareInfill, posInfill,
+                                                 posIroning, posSupportMaterial, posDetectOverhangsForLift });
                     }
                 }
-            }
-        );
-
-        for (PrintObject* obj : m_objects) {
-            if (need_slicing_objects.count(obj) != 0) {
-                obj->detect_overhangs_for_lift();
-            }
-            else {
-                if (obj->set_started(posDetectOverhangsForLift))
-                    obj->set_done(posDetectOverhangsForLift);
-            }
-        }
+            });
     }
     else {
-        for (PrintObject *obj : m_objects) {
-            if (re_slicing_objects.count(obj) == 0) {
-                if (obj->set_started(posSlice))
-                    obj->set_done(posSlice);
-                if (obj->set_started(posPerimeters))
-                    obj->set_done(posPerimeters);
-                if (obj->set_started(posPrepareInfill))
-                    obj->set_done(posPrepareInfill);
-                if (obj->set_started(posInfill))
-                    obj->set_done(posInfill);
-                if (obj->set_started(posIroning))
-                    obj->set_done(posIroning);
-                if (obj->set_started(posSupportMaterial))
-                    obj->set_done(posSupportMaterial);
-                if (obj->set_started(posDetectOverhangsForLift))
-                    obj->set_done(posDetectOverhangsForLift);
-            }
-            else {
-                obj->make_perimeters();
-                obj->infill();
-                obj->ironing();
-                obj->generate_support_material();
-                obj->detect_overhangs_for_lift();
-                obj->estimate_curled_extrusions();
-            }
-        }
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, m_objects.size(), 1),
+            [this, &re_slicing_objects, &skip_object_steps](const tbb::blocked_range<size_t>& range) {
+                for (size_t i = range.begin(); i < range.end(); ++ i) {
+                    PrintObject *obj = m_objects[i];
+                    if (re_slicing_objects.count(obj) == 0) {
+                        skip_object_steps(obj, { posSlice, posPerimeters, posPrepareInfill, posInfill, posIroning, posSupportMaterial,
+                                                 posDetectOverhangsForLift });
+                    } else {
+                        obj->make_perimeters();
+                        obj->infill();
+                        obj->ironing();
+                        obj->generate_support_material();
+                        obj->detect_overhangs_for_lift();
+                        obj->estimate_curled_extrusions();
+                    }
+                }
+            });
     }
 
     for (PrintObject *obj : m_objects)
@@ -2209,6 +2248,8 @@ std::string Print::export_gcode(const std::string& path_template, GCodeProcessor
 
     // The following line may die for multiple reasons.
     GCode gcode;
+    gcode.set_pipeline_max_tokens(m_gcode_pipeline_max_tokens);
+    gcode.set_pipeline_max_memory(m_gcode_pipeline_max_memory);
     //BBS: compute plate offset for gcode-generator
     const Vec3d origin = this->get_plate_origin();
     gcode.set_gcode_offset(origin(0), origin(1));
@@ -3828,6 +3869,814 @@ static void from_json(const json& j, groupedVolumeSlices& firstlayer_group)
     }
 }
 
+/* binary slicing cache, used by export_cached_data / load_cached_data */
+// Binary cache file of a single PrintObject, all values stored in the native (little endian) byte order:
+//   header:  magic, format version, identify_id, object name, layer count, support layer count,
+//            offset table (uint64 file offset of each layer followed by each support layer),
+//            file offset of the first layer groups section.
+//   layer:   id, height, print_z, slice_z, [interface_id, support_type], region config hashes, then the layer data.
+// Polygons are stored as a table of point counts followed by a flat array of points, thus each layer may be decoded
+// straight from the memory mapped file, independently of the other layers.
+// A file with a different magic or format version is ignored and the JSON cache file is loaded instead.
+static constexpr const char SLICE_CACHE_BINARY_MAGIC[8]    = { 'O', 'R', 'C', 'A', 'S', 'L', 'C', '\0' };
+static constexpr uint32_t   SLICE_CACHE_BINARY_VERSION     = 1;
+static constexpr const char SLICE_CACHE_BINARY_EXTENSION[] = ".bin";
+
+enum SliceCacheEntityType : uint8_t {
+    sceEntityPath,
+    sceEntityMultiPath,
+    sceEntityLoop,
+    sceEntityCollection
+};
+
+class SliceCacheWriter
+{
+public:
+    const std::string& data() const { return m_data; }
+    size_t             size() const { return m_data.size(); }
+
+    template<typename T> void write(const T value) {
+        static_assert(std::is_arithmetic<T>::value || std::is_enum<T>::value, "only scalar values may be written directly");
+        m_data.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+    template<typename T> void patch(size_t pos, const T value) { memcpy(&m_data[pos], &value, sizeof(T)); }
+    void append(const std::string &data) { m_data.append(data); }
+
+    void write_string(const std::string &str) {
+        this->write<uint32_t>(uint32_t(str.size()));
+        m_data.append(str);
+    }
+
+    void write_point(const Point &pt) {
+        this->write<coord_t>(pt.x());
+        this->write<coord_t>(pt.y());
+    }
+
+    void write_bbox(const BoundingBox &bbox) {
+        this->write_point(bbox.min);
+        this->write_point(bbox.max);
+        this->write<uint8_t>(bbox.defined);
+    }
+
+    void write_points(const Points &pts) {
+        static_assert(sizeof(Point) == 2 * sizeof(coord_t), "Point is expected to be stored as two packed coordinates");
+        m_data.append(reinterpret_cast<const char*>(pts.data()), pts.size() * sizeof(Point));
+    }
+
+    // Number of ExPolygons, number of polygons of each ExPolygon, number of points of each polygon, then all the points.
+    template<typename ExPolygonAt> void write_expolygons(size_t count, ExPolygonAt expolygon_at) {
+        this->write<uint32_t>(uint32_t(count));
+        for (size_t i = 0; i < count; ++ i)
+            this->write<uint32_t>(uint32_t(expolygon_at(i).holes.size() + 1));
+        for (size_t i = 0; i < count; ++ i) {
+            const ExPolygon &expoly = expolygon_at(i);
+            this->write<uint32_t>(uint32_t(expoly.contour.size()));
+            for (const Polygon &hole : expoly.holes)
+                this->write<uint32_t>(uint32_t(hole.size()));
+        }
+        for (size_t i = 0; i < count; ++ i) {
+            const ExPolygon &expoly = expolygon_at(i);
+            this->write_points(expoly.contour.points);
+            for (const Polygon &hole : expoly.holes)
+                this->write_points(hole.points);
+        }
+    }
+    void write_expolygons(const ExPolygons &expolys) {
+        this->write_expolygons(expolys.size(), [&expolys](size_t i) -> const ExPolygon& { return expolys[i]; });
+    }
+
+    void write_surfaces(const Surfaces &surfaces) {
+        this->write<uint32_t>(uint32_t(surfaces.size()));
+        for (const Surface &surf : surfaces) {
+            this->write<int32_t>(int32_t(surf.surface_type));
+            this->write<double>(surf.thickness);
+            this->write<uint16_t>(surf.thickness_layers);
+            this->write<double>(surf.bridge_angle);
+            this->write<uint16_t>(surf.extra_perimeters);
+        }
+        this->write_expolygons(surfaces.size(), [&surfaces](size_t i) -> const ExPolygon& { return surfaces[i].expolygon; });
+    }
+
+    void write_polyline(const Polyline &polyline) {
+        this->write<uint32_t>(uint32_t(polyline.points.size()));
+        this->write_points(polyline.points);
+        this->write<uint32_t>(uint32_t(polyline.fitting_result.size()));
+        for (const PathFittingData &fitting : polyline.fitting_result) {
+            this->write<uint64_t>(fitting.start_point_index);
+            this->write<uint64_t>(fitting.end_point_index);
+            this->write<EMovePathType>(fitting.path_type);
+            const ArcSegment &arc = fitting.arc_data;
+            this->write<uint8_t>(arc.is_arc);
+            if (arc.is_arc) {
+                this->write<double>(arc.length);
+                this->write<double>(arc.angle_radians);
+                this->write<double>(arc.polar_start_theta);
+                this->write<double>(arc.polar_end_theta);
+                this->write_point(arc.start_point);
+                this->write_point(arc.end_point);
+                this->write<ArcDirection>(arc.direction);
+                this->write<double>(arc.radius);
+                this->write_point(arc.center);
+            }
+        }
+    }
+
+    void write_extrusion_path(const ExtrusionPath &path) {
+        this->write_polyline(path.polyline);
+        this->write<double>(path.overhang_degree);
+        this->write<int32_t>(path.curve_degree);
+        this->write<double>(path.mm3_per_mm);
+        this->write<float>(path.width);
+        this->write<float>(path.height);
+        this->write<ExtrusionRole>(path.role());
+        this->write<uint8_t>(path.is_force_no_extrusion());
+    }
+
+    void write_extrusion_paths(const ExtrusionPaths &paths) {
+        this->write<uint32_t>(uint32_t(paths.size()));
+        for (const ExtrusionPath &path : paths)
+            this->write_extrusion_path(path);
+    }
+
+    void write_extrusion_collection(const ExtrusionEntityCollection &collection) {
+        this->write<uint8_t>(collection.no_sort);
+        // The number of entities is patched once the supported entities are written.
+        size_t   count_pos = m_data.size();
+        uint32_t count     = 0;
+        this->write<uint32_t>(0);
+        for (const ExtrusionEntity *entity : collection.entities)
+            if (this->write_extrusion_entity(entity))
+                ++ count;
+        this->patch<uint32_t>(count_pos, count);
+    }
+
+    bool write_extrusion_entity(const ExtrusionEntity *entity) {
+        if (const ExtrusionEntityCollection *collection = dynamic_cast<const ExtrusionEntityCollection*>(entity)) {
+            this->write<SliceCacheEntityType>(sceEntityCollection);
+            this->write_extrusion_collection(*collection);
+        } else if (const ExtrusionPath *path = dynamic_cast<const ExtrusionPath*>(entity)) {
+            this->write<SliceCacheEntityType>(sceEntityPath);
+            this->write_extrusion_path(*path);
+        } else if (const ExtrusionMultiPath *multipath = dynamic_cast<const ExtrusionMultiPath*>(entity)) {
+            this->write<SliceCacheEntityType>(sceEntityMultiPath);
+            this->write_extrusion_paths(multipath->paths);
+        } else if (const ExtrusionLoop *loop = dynamic_cast<const ExtrusionLoop*>(entity)) {
+            this->write<SliceCacheEntityType>(sceEntityLoop);
+            this->write<ExtrusionLoopRole>(loop->loop_role());
+            this->write_extrusion_paths(loop->paths);
+        } else {
+            BOOST_LOG_TRIVIAL(error) << __FUNCTION__ << boost::format(":invalid extrusion path type Found");
+            return false;
+        }
+        return true;
+    }
+
+    void write_layer_region(const LayerRegion &layer_region) {
+        this->write_surfaces(layer_region.slices.surfaces);
+        this->write_expolygons(layer_region.raw_slices);
+        this->write_extrusion_collection(layer_region.thin_fills);
+        this->write_expolygons(layer_region.fill_expolygons);
+        this->write_surfaces(layer_region.fill_surfaces.surfaces);
+        this->write_expolygons(layer_region.fill_no_overlap_expolygons);
+        this->write<uint32_t>(uint32_t(layer_region.unsupported_bridge_edges.size()));
+        for (const Polyline &polyline : layer_region.unsupported_bridge_edges)
+            this->write_polyline(polyline);
+        this->write_extrusion_collection(layer_region.perimeters);
+        this->write_extrusion_collection(layer_region.fills);
+    }
+
+    // Layer header (everything needed to create the layer and its regions) followed by the layer data.
+    // The regions of the layer are stored as region_key() of their printing regions.
+    void write_layer(const Layer &layer, const SupportLayer *support_layer, const std::function<size_t(const PrintRegion&)> &region_key) {
+        this->write<uint64_t>(layer.id());
+        this->write<double>(layer.height);
+        this->write<double>(layer.print_z);
+        this->write<double>(layer.slice_z);
+        if (support_layer) {
+            this->write<uint64_t>(support_layer->interface_id());
+            this->write<int32_t>(int32_t(support_layer->support_type));
+        }
+        this->write<uint32_t>(uint32_t(layer.region_count()));
+        for (const LayerRegion *layer_region : layer.regions())
+            this->write<uint64_t>(region_key(layer_region->region()));
+
+        this->write_expolygons(layer.lslices);
+        this->write<uint32_t>(uint32_t(layer.lslices_bboxes.size()));
+        for (const BoundingBox &bbox : layer.lslices_bboxes)
+            this->write_bbox(bbox);
+        this->write_expolygons(layer.loverhangs);
+        this->write_bbox(layer.loverhangs_bbox);
+        for (const LayerRegion *layer_region : layer.regions())
+            this->write_layer_region(*layer_region);
+
+        if (support_layer) {
+            this->write_expolygons(support_layer->support_islands);
+            this->write_extrusion_collection(support_layer->support_fills);
+        }
+    }
+
+private:
+    std::string m_data;
+};
+
+class SliceCacheReader
+{
+public:
+    SliceCacheReader(const char *begin, const char *end) : m_begin(begin), m_ptr(begin), m_end(end) {}
+
+    size_t position() const { return m_ptr - m_begin; }
+    void   seek(uint64_t pos) {
+        if (pos > uint64_t(m_end - m_begin))
+            throw Slic3r::FileIOError("Invalid offset in the binary slicing cache");
+        m_ptr = m_begin + pos;
+    }
+
+    template<typename T> T read() {
+        this->require(sizeof(T));
+        T value;
+        memcpy(&value, m_ptr, sizeof(T));
+        m_ptr += sizeof(T);
+        return value;
+    }
+
+    // Reads the number of the following elements, each taking at least min_size bytes of the file,
+    // thus a corrupted count is reported before the elements are allocated.
+    size_t read_count(size_t min_size) {
+        size_t count = this->read<uint32_t>();
+        this->require(count * min_size);
+        return count;
+    }
+
+    std::string read_string() {
+        uint32_t len = this->read<uint32_t>();
+        this->require(len);
+        std::string out(m_ptr, len);
+        m_ptr += len;
+        return out;
+    }
+
+    Point read_point() {
+        coord_t x = this->read<coord_t>();
+        coord_t y = this->read<coord_t>();
+        return { x, y };
+    }
+
+    BoundingBox read_bbox() {
+        BoundingBox bbox;
+        bbox.min     = this->read_point();
+        bbox.max     = this->read_point();
+        bbox.defined = this->read<uint8_t>() != 0;
+        return bbox;
+    }
+
+    void read_points(Points &pts, size_t count) {
+        this->require(count * sizeof(Point));
+        pts.resize(count);
+        memcpy(reinterpret_cast<char*>(pts.data()), m_ptr, count * sizeof(Point));
+        m_ptr += count * sizeof(Point);
+    }
+
+    template<typename ExPolygonAt> void read_expolygons(size_t count, ExPolygonAt expolygon_at) {
+        std::vector<uint32_t> num_polygons(count);
+        for (uint32_t &n : num_polygons)
+            n = this->read<uint32_t>();
+        std::vector<uint32_t> num_points;
+        for (size_t i = 0; i < count; ++ i) {
+            if (num_polygons[i] == 0)
+                throw Slic3r::FileIOError("Invalid ExPolygon in the binary slicing cache");
+            for (uint32_t j = 0; j < num_polygons[i]; ++ j)
+                num_points.emplace_back(this->read<uint32_t>());
+        }
+        for (size_t i = 0, k = 0; i < count; ++ i) {
+            ExPolygon &expoly = expolygon_at(i);
+            this->read_points(expoly.contour.points, num_points[k ++]);
+            expoly.holes.assign(num_polygons[i] - 1, Polygon());
+            for (Polygon &hole : expoly.holes)
+                this->read_points(hole.points, num_points[k ++]);
+        }
+    }
+    void read_expolygons(ExPolygons &expolys) {
+        size_t count = this->read_count(sizeof(uint32_t));
+        size_t first = expolys.size();
+        expolys.resize(first + count);
+        this->read_expolygons(count, [&expolys, first](size_t i) -> ExPolygon& { return expolys[first + i]; });
+    }
+
+    void read_surfaces(Surfaces &surfaces) {
+        size_t count = this->read_count(sizeof(int32_t) + 2 * sizeof(double) + 2 * sizeof(uint16_t));
+        size_t first = surfaces.size();
+        surfaces.resize(first + count);
+        for (size_t i = first; i < surfaces.size(); ++ i) {
+            Surface &surf = surfaces[i];
+            surf.surface_type     = SurfaceType(this->read<int32_t>());
+            surf.thickness        = this->read<double>();
+            surf.thickness_layers = this->read<uint16_t>();
+            surf.bridge_angle     = this->read<double>();
+            surf.extra_perimeters = this->read<uint16_t>();
+        }
+        if (this->read<uint32_t>() != count)
+            throw Slic3r::FileIOError("Invalid surfaces in the binary slicing cache");
+        this->read_expolygons(count, [&surfaces, first](size_t i) -> ExPolygon& { return surfaces[first + i].expolygon; });
+    }
+
+    void read_polyline(Polyline &polyline) {
+        this->read_points(polyline.points, this->read<uint32_t>());
+        polyline.fitting_result.resize(this->read_count(2 * sizeof(uint64_t) + sizeof(EMovePathType) + sizeof(uint8_t)));
+        for (PathFittingData &fitting : polyline.fitting_result) {
+            fitting.start_point_index = size_t(this->read<uint64_t>());
+            fitting.end_point_index   = size_t(this->read<uint64_t>());
+            fitting.path_type         = this->read<EMovePathType>();
+            ArcSegment &arc = fitting.arc_data;
+            arc.is_arc = this->read<uint8_t>() != 0;
+            if (arc.is_arc) {
+                arc.length            = this->read<double>();
+                arc.angle_radians     = this->read<double>();
+                arc.polar_start_theta = this->read<double>();
+                arc.polar_end_theta   = this->read<double>();
+                arc.start_point       = this->read_point();
+                arc.end_point         = this->read_point();
+                arc.direction         = this->read<ArcDirection>();
+                arc.radius            = this->read<double>();
+                arc.center            = this->read_point();
+            }
+        }
+    }
+
+    void read_extrusion_path(ExtrusionPath &path) {
+        this->read_polyline(path.polyline);
+        path.overhang_degree = this->read<double>();
+        path.curve_degree    = this->read<int32_t>();
+        path.mm3_per_mm      = this->read<double>();
+        path.width           = this->read<float>();
+        path.height          = this->read<float>();
+        path.set_extrusion_role(this->read<ExtrusionRole>());
+        path.set_force_no_extrusion(this->read<uint8_t>() != 0);
+    }
+
+    void read_extrusion_paths(ExtrusionPaths &paths) {
+        paths.resize(this->read_count(2 * sizeof(uint32_t)));
+        for (ExtrusionPath &path : paths)
+            this->read_extrusion_path(path);
+    }
+
+    void read_extrusion_collection(ExtrusionEntityCollection &collection) {
+        collection.no_sort = this->read<uint8_t>() != 0;
+        size_t count = this->read_count(sizeof(SliceCacheEntityType));
+        collection.entities.reserve(collection.entities.size() + count);
+        for (size_t i = 0; i < count; ++ i)
+            collection.entities.push_back(this->read_extrusion_entity());
+    }
+
+    ExtrusionEntity* read_extrusion_entity() {
+        switch (this->read<SliceCacheEntityType>()) {
+        case sceEntityPath: {
+            auto path = std::make_unique<ExtrusionPath>();
+            this->read_extrusion_path(*path);
+            return path.release();
+        }
+        case sceEntityMultiPath: {
+            auto multipath = std::make_unique<ExtrusionMultiPath>();
+            this->read_extrusion_paths(multipath->paths);
+            return multipath.release();
+        }
+        case sceEntityLoop: {
+            auto loop = std::make_unique<ExtrusionLoop>();
+            loop->set_loop_role(this->read<ExtrusionLoopRole>());
+            this->read_extrusion_paths(loop->paths);
+            return loop.release();
+        }
+        case sceEntityCollection: {
+            auto collection = std::make_unique<ExtrusionEntityCollection>();
+            this->read_extrusion_collection(*collection);
+            return collection.release();
+        }
+        default:
+            throw Slic3r::FileIOError("Unknown extrusion entity type in the binary slicing cache");
+        }
+    }
+
+    void read_layer_region(LayerRegion &layer_region) {
+        this->read_surfaces(layer_region.slices.surfaces);
+        this->read_expolygons(layer_region.raw_slices);
+        this->read_extrusion_collection(layer_region.thin_fills);
+        this->read_expolygons(layer_region.fill_expolygons);
+        this->read_surfaces(layer_region.fill_surfaces.surfaces);
+        this->read_expolygons(layer_region.fill_no_overlap_expolygons);
+        layer_region.unsupported_bridge_edges.resize(this->read_count(2 * sizeof(uint32_t)));
+        for (Polyline &polyline : layer_region.unsupported_bridge_edges)
+            this->read_polyline(polyline);
+        this->read_extrusion_collection(layer_region.perimeters);
+        this->read_extrusion_collection(layer_region.fills);
+    }
+
+    // Layer data following the layer header, the layer and its regions have already been created from the header.
+    void read_layer(Layer &layer, SupportLayer *support_layer) {
+        this->read_expolygons(layer.lslices);
+        layer.lslices_bboxes.resize(this->read_count(2 * sizeof(Point) + sizeof(uint8_t)));
+        for (BoundingBox &bbox : layer.lslices_bboxes)
+            bbox = this->read_bbox();
+        this->read_expolygons(layer.loverhangs);
+        layer.loverhangs_bbox = this->read_bbox();
+        for (size_t region_id = 0; region_id < layer.region_count(); ++ region_id)
+            this->read_layer_region(*layer.get_region(int(region_id)));
+
+        if (support_layer) {
+            this->read_expolygons(support_layer->support_islands);
+            this->read_extrusion_collection(support_layer->support_fills);
+        }
+    }
+
+private:
+    void require(size_t size) const {
+        if (size_t(m_end - m_ptr) < size)
+            throw Slic3r::FileIOError("Unexpected end of the binary slicing cache");
+    }
+
+    const char *m_begin;
+    const char *m_ptr;
+    const char *m_end;
+};
+
+static int export_object_cached_data_binary(const PrintObject *obj, const std::string &name, size_t identify_id, const std::string &file_name,
+    const std::function<size_t(const PrintRegion&)> &region_key)
+{
+    const size_t layer_count         = obj->layer_count();
+    const size_t support_layer_count = obj->support_layer_count();
+
+    // Serialize the layers in parallel, each into its own block.
+    std::vector<std::string> layer_blocks(layer_count + support_layer_count);
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, layer_blocks.size()),
+        [obj, layer_count, &layer_blocks, &region_key](const tbb::blocked_range<size_t>& range) {
+            for (size_t index = range.begin(); index < range.end(); ++ index) {
+                SliceCacheWriter writer;
+                if (index < layer_count) {
+                    writer.write_layer(*obj->get_layer(int(index)), nullptr, region_key);
+                } else {
+                    const SupportLayer *support_layer = obj->support_layers()[index - layer_count];
+                    writer.write_layer(*support_layer, support_layer, region_key);
+                }
+                layer_blocks[index] = writer.data();
+            }
+        }
+    );
+
+    SliceCacheWriter groups_writer;
+    const std::vector<groupedVolumeSlices> &first_layer_obj_groups = obj->firstLayerObjGroups();
+    const PrintObject     *shared_object = obj->get_shared_object() ? obj->get_shared_object() : obj;
+    const ModelVolumePtrs &volumes_ptr   = shared_object->model_object()->volumes;
+    groups_writer.write<uint32_t>(uint32_t(first_layer_obj_groups.size()));
+    for (const groupedVolumeSlices &group : first_layer_obj_groups) {
+        groups_writer.write<int32_t>(group.groupId);
+        groups_writer.write<uint32_t>(uint32_t(group.volume_ids.size()));
+        // Store the volume index instead of the volume ID, the IDs are not persistent.
+        for (const ObjectID &obj_id : group.volume_ids) {
+            auto it = std::find_if(volumes_ptr.begin(), volumes_ptr.end(), [&obj_id](const ModelVolume *volume) { return volume->id() == obj_id; });
+            groups_writer.write<uint64_t>(it == volumes_ptr.end() ? obj_id.id : size_t(it - volumes_ptr.begin()));
+        }
+        groups_writer.write_expolygons(group.slices);
+    }
+
+    SliceCacheWriter header;
+    header.append(std::string(SLICE_CACHE_BINARY_MAGIC, sizeof(SLICE_CACHE_BINARY_MAGIC)));
+    header.write<uint32_t>(SLICE_CACHE_BINARY_VERSION);
+    header.write<uint64_t>(identify_id);
+    header.write_string(name);
+    header.write<uint32_t>(uint32_t(layer_count));
+    header.write<uint32_t>(uint32_t(support_layer_count));
+    uint64_t offset = header.size() + (layer_blocks.size() + 1) * sizeof(uint64_t);
+    for (const std::string &block : layer_blocks) {
+        header.write<uint64_t>(offset);
+        offset += block.size();
+    }
+    header.write<uint64_t>(offset);
+
+    boost::nowide::ofstream c(file_name, std::ios::out | std::ios::trunc | std::ios::binary);
+    c.write(header.data().data(), header.size());
+    for (const std::string &block : layer_blocks)
+        c.write(block.data(), block.size());
+    c.write(groups_writer.data().data(), groups_writer.size());
+    c.close();
+    if (c.fail()) {
+        BOOST_LOG_TRIVIAL(error) << __FUNCTION__ << boost::format(": failed to write %1%") % file_name;
+        return CLI_EXPORT_CACHE_WRITE_FAILED;
+    }
+    return 0;
+}
+
+// Returns true if the file starts with a binary slicing cache header of the current format version.
+static bool is_valid_cached_data_binary(const std::string &file_name)
+{
+    char     magic[sizeof(SLICE_CACHE_BINARY_MAGIC)];
+    uint32_t version = 0;
+    boost::nowide::ifstream ifs(file_name, std::ios::in | std::ios::binary);
+    ifs.read(magic, sizeof(magic));
+    ifs.read(reinterpret_cast<char*>(&version), sizeof(version));
+    if (! ifs || memcmp(magic, SLICE_CACHE_BINARY_MAGIC, sizeof(magic)) != 0)
+        return false;
+    if (version != SLICE_CACHE_BINARY_VERSION) {
+        BOOST_LOG_TRIVIAL(warning) << __FUNCTION__ << boost::format(": %1% has format version %2%, expected %3%") % file_name % version % SLICE_CACHE_BINARY_VERSION;
+        return false;
+    }
+    return true;
+}
+
+static int load_object_cached_data_binary(PrintObject *obj, const std::string &file_name,
+    const std::function<const PrintRegion*(PrintObject*, size_t)> &find_region)
+{
+    boost::iostreams::mapped_file_source file{ boost::filesystem::path(file_name) };
+    SliceCacheReader reader(file.data(), file.data() + file.size());
+
+    reader.seek(sizeof(SLICE_CACHE_BINARY_MAGIC) + sizeof(uint32_t));
+    size_t      identify_id         = size_t(reader.read<uint64_t>());
+    std::string name                = reader.read_string();
+    size_t      layer_count         = reader.read<uint32_t>();
+    size_t      support_layer_count = reader.read<uint32_t>();
+    if ((layer_count + support_layer_count + 1) * sizeof(uint64_t) > file.size() - reader.position())
+        throw Slic3r::FileIOError("Unexpected end of the binary slicing cache");
+    std::vector<uint64_t> offsets(layer_count + support_layer_count + 1);
+    for (uint64_t &offset : offsets)
+        offset = reader.read<uint64_t>();
+    for (size_t index = 0; index < offsets.size(); ++ index)
+        if (offsets[index] > file.size() || (index > 0 && offsets[index] < offsets[index - 1]))
+            throw Slic3r::FileIOError("Invalid offset in the binary slicing cache");
+
+    BOOST_LOG_TRIVIAL(info) << __FUNCTION__ << boost::format(":will load %1%, identify_id %2%, layer_count %3%, support_layer_count %4%")
+        % name % identify_id % layer_count % support_layer_count;
+
+    // Create the layers and their regions from the layer headers, remember where the layer data starts.
+    std::vector<uint64_t> data_offsets(layer_count + support_layer_count);
+    Layer *previous_layer = nullptr;
+    for (size_t index = 0; index < offsets.size() - 1; ++ index) {
+        bool is_support = index >= layer_count;
+        if (index == layer_count)
+            previous_layer = nullptr;
+        reader.seek(offsets[index]);
+        int    id      = int(reader.read<uint64_t>());
+        double height  = reader.read<double>();
+        double print_z = reader.read<double>();
+        double slice_z = reader.read<double>();
+        Layer *new_layer = nullptr;
+        if (is_support) {
+            int interface_id = int(reader.read<uint64_t>());
+            SupportLayer *support_layer = obj->add_support_layer(id, interface_id, height, print_z);
+            if (support_layer)
+                support_layer->support_type = SupportInnerType(reader.read<int32_t>());
+            new_layer = support_layer;
+        } else
+            new_layer = obj->add_layer(id, height, print_z, slice_z);
+        if (! new_layer) {
+            BOOST_LOG_TRIVIAL(error) << __FUNCTION__ << boost::format(":create_layer failed, out of memory");
+            return CLI_OUT_OF_MEMORY;
+        }
+        if (previous_layer) {
+            previous_layer->upper_layer = new_layer;
+            new_layer->lower_layer = previous_layer;
+        }
+        previous_layer = new_layer;
+
+        size_t regions_count = reader.read_count(sizeof(uint64_t));
+        for (size_t region_index = 0; region_index < regions_count; ++ region_index) {
+            const PrintRegion *print_region = find_region(obj, size_t(reader.read<uint64_t>()));
+            if (! print_region) {
+                BOOST_LOG_TRIVIAL(error) << __FUNCTION__ << boost::format(":can not find print region of object %1%, layer %2%, print_z %3%, layer_region %4%")
+                    % name % index % print_z % region_index;
+                return CLI_IMPORT_CACHE_DATA_CAN_NOT_USE;
+            }
+            new_layer->add_region(print_region);
+        }
+        data_offsets[index] = reader.position();
+    }
+
+    // Decode the layer data in parallel, straight from the mapped file.
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, data_offsets.size()),
+        [obj, layer_count, &file, &data_offsets, &offsets](const tbb::blocked_range<size_t>& range) {
+            for (size_t index = range.begin(); index < range.end(); ++ index) {
+                SliceCacheReader layer_reader(file.data(), file.data() + offsets[index + 1]);
+                layer_reader.seek(data_offsets[index]);
+                if (index < layer_count)
+                    layer_reader.read_layer(*obj->get_layer(int(index)), nullptr);
+                else {
+                    SupportLayer *support_layer = obj->get_support_layer(int(index - layer_count));
+                    layer_reader.read_layer(*support_layer, support_layer);
+                }
+            }
+        }
+    );
+
+    reader.seek(offsets.back());
+    std::vector<groupedVolumeSlices> &firstlayer_objgroups = obj->firstLayerObjGroupsMod();
+    const ModelVolumePtrs            &volumes_ptr          = obj->model_object()->volumes;
+    size_t groups_count = reader.read_count(sizeof(int32_t) + sizeof(uint32_t));
+    for (size_t group_index = 0; group_index < groups_count; ++ group_index) {
+        groupedVolumeSlices firstlayer_group;
+        firstlayer_group.groupId = reader.read<int32_t>();
+        firstlayer_group.volume_ids.resize(reader.read_count(sizeof(uint64_t)));
+        for (ObjectID &obj_id : firstlayer_group.volume_ids) {
+            size_t volume_index = size_t(reader.read<uint64_t>());
+            if (volume_index >= volumes_ptr.size()) {
+                BOOST_LOG_TRIVIAL(error) << __FUNCTION__ << boost::format(": can not find volume_id %1% from object file %2% in firstlayer groups, volume_count %3%!")
+                    % volume_index % file_name % volumes_ptr.size();
+                return CLI_IMPORT_CACHE_LOAD_FAILED;
+            }
+            obj_id = volumes_ptr[volume_index]->id();
+        }
+        reader.read_expolygons(firstlayer_group.slices);
+        firstlayer_objgroups.push_back(std::move(firstlayer_group));
+    }
+    return 0;
+}
+
+static const PrintRegion* find_printing_region_by_config_hash(PrintObject* object, size_t config_hash)
+{
+    int regions_count = object->num_printing_regions();
+    for (int index = 0; index < regions_count; index++ )
+    {
+        const PrintRegion&  print_region = object->printing_region(index);
+        if (print_region.config_hash() == config_hash ) {
+            return &print_region;
+        }
+    }
+    return NULL;
+}
+
+/* persistent slicing result cache, see Print::set_slicing_result_cache_dir() */
+// PrintObjectConfig and PrintRegionConfig options, which PrintObject::steps_invalidated_by_config_option() maps to steps
+// following posPerimeters only, thus they are not a part of the slicing result cache key.
+// The options invalidating posSlice or posPerimeters conditionally (brim_type, enable_support, sparse_infill_density,
+// bridge_flow...) are a part of the key.
+static const std::unordered_set<std::string>& object_options_not_invalidating_perimeters()
+{
+    static const std::unordered_set<std::string> options = []() {
+        std::unordered_set<std::string> out;
+        for (const t_config_option_keys &keys : { PrintObjectConfig().keys(), PrintRegionConfig().keys() })
+            for (const std::string &opt_key : keys) {
+                std::vector<PrintObjectStep> steps;
+                std::vector<PrintStep>       print_steps;
+                if (PrintObject::steps_invalidated_by_config_option(opt_key, steps, steps, print_steps) &&
+                    std::find_if(steps.begin(), steps.end(), [](PrintObjectStep step) { return step == posSlice || step == posPerimeters; }) == steps.end())
+                    out.insert(opt_key);
+            }
+        return out;
+    }();
+    return options;
+}
+
+// The layer regions of the slicing result cache refer to the printing regions by their index. The cache key covers the configs
+// of all the printing regions in the order of their indices, however not the options excluded by object_options_not_invalidating_perimeters(),
+// thus the full config hashes of the regions would not match.
+static size_t printing_region_id(const PrintRegion &region)
+{
+    return size_t(region.print_object_region_id());
+}
+
+static const PrintRegion* find_printing_region_by_id(PrintObject* object, size_t region_id)
+{
+    return region_id < object->num_printing_regions() ? &object->printing_region(region_id) : nullptr;
+}
+
+// Key of the persistent slicing result cache: MD5 digest of everything the results of posSlice and posPerimeters
+// of the object depend on, that is the meshes, the transformations, the painted facets and the configuration
+// of the object, of its volumes and regions and of the print. The digest is independent of the ObjectIDs
+// and of the timestamps, thus it is the same for the same object loaded again by another process.
+static std::string slicing_result_cache_key(const PrintObject &obj)
+{
+    MD5_CTX ctx;
+    MD5_Init(&ctx);
+    auto update        = [&ctx](const void *data, size_t size) { MD5_Update(&ctx, data, size); };
+    auto update_size   = [&update](uint64_t size) { update(&size, sizeof(size)); };
+    auto update_string = [&update, &update_size](const std::string &str) { update_size(str.size()); update(str.data(), str.size()); };
+    auto update_matrix = [&update](const Transform3d &trafo) { update(trafo.matrix().data(), 16 * sizeof(double)); };
+    auto update_config = [&update_size, &update_string](const ConfigBase &config, const std::unordered_set<std::string> &ignored) {
+        t_config_option_keys keys = config.keys();
+        update_size(keys.size());
+        for (const std::string &key : keys)
+            if (ignored.find(key) == ignored.end()) {
+                update_string(key);
+                update_string(config.option(key)->serialize());
+            }
+    };
+    auto update_facets = [&update, &update_size](const FacetsAnnotation &facets) {
+        const TriangleSelector::TriangleSplittingData &data = facets.get_data();
+        update_size(data.triangles_to_split.size());
+        for (const TriangleSelector::TriangleBitStreamMapping &mapping : data.triangles_to_split) {
+            update(&mapping.triangle_idx, sizeof(mapping.triangle_idx));
+            update(&mapping.bitstream_start_idx, sizeof(mapping.bitstream_start_idx));
+        }
+        std::string bits;
+        bits.reserve(data.bitstream.size() + data.used_states.size());
+        for (bool bit : data.bitstream)
+            bits += bit ? '1' : '0';
+        for (bool bit : data.used_states)
+            bits += bit ? '1' : '0';
+        update(bits.data(), bits.size());
+    };
+
+    // Results of a different build or of a different cache format are never reused.
+    update_string(SLIC3R_VERSION);
+    update_size(SLICE_CACHE_BINARY_VERSION);
+
+    update_config(obj.print()->config(), print_options_gcode_only());
+    update_config(obj.config(), object_options_not_invalidating_perimeters());
+    update_size(obj.num_printing_regions());
+    for (size_t region_id = 0; region_id < obj.num_printing_regions(); ++ region_id)
+        update_config(obj.printing_region(region_id).config(), object_options_not_invalidating_perimeters());
+
+    const ModelObject *model_object = obj.model_object();
+    update_matrix(obj.trafo());
+    update(obj.center_offset().data(), 2 * sizeof(coord_t));
+    update_config(model_object->config.get(), {});
+    const std::vector<coordf_t> layer_height_profile = model_object->layer_height_profile.get();
+    update_size(layer_height_profile.size());
+    update(layer_height_profile.data(), layer_height_profile.size() * sizeof(coordf_t));
+    update_size(model_object->layer_config_ranges.size());
+    for (const auto &[range, config] : model_object->layer_config_ranges) {
+        update(&range.first, sizeof(range.first));
+        update(&range.second, sizeof(range.second));
+        update_config(config.get(), {});
+    }
+    update_size(model_object->volumes.size());
+    for (const ModelVolume *model_volume : model_object->volumes) {
+        const indexed_triangle_set &its = model_volume->mesh().its;
+        update_size(int(model_volume->type()));
+        update_size(its.vertices.size());
+        update(its.vertices.data(), its.vertices.size() * sizeof(stl_vertex));
+        update_size(its.indices.size());
+        update(its.indices.data(), its.indices.size() * sizeof(stl_triangle_vertex_indices));
+        update_matrix(model_volume->get_matrix());
+        update_config(model_volume->config.get(), {});
+        update_facets(model_volume->supported_facets);
+        update_facets(model_volume->seam_facets);
+        update_facets(model_volume->mmu_segmentation_facets);
+    }
+
+    unsigned char digest[16];
+    MD5_Final(digest, &ctx);
+    char digest_str[33];
+    for (int j = 0; j < 16; ++ j)
+        sprintf(&digest_str[j * 2], "%02x", (unsigned int)digest[j]);
+    return std::string(digest_str, 32);
+}
+
+// Runs posSlice and posPerimeters of the object, or loads their results from the persistent slicing result cache.
+// On a cache miss the results are stored into the cache once posPerimeters is done.
+void Print::make_perimeters_with_result_cache(PrintObject *obj)
+{
+    if (m_slicing_result_cache_dir.empty() || obj->is_step_done(posSlice)) {
+        obj->make_perimeters();
+        return;
+    }
+
+    const boost::filesystem::path cache_dir(m_slicing_result_cache_dir);
+    const std::string key       = slicing_result_cache_key(*obj);
+    const std::string file_name = (cache_dir / (key + SLICE_CACHE_BINARY_EXTENSION)).string();
+    auto clear_object = [obj]() {
+        obj->clear_layers();
+        obj->clear_support_layers();
+        obj->firstLayerObjGroupsMod().clear();
+    };
+
+    if (fs::exists(file_name) && is_valid_cached_data_binary(file_name)) {
+        int ret = CLI_IMPORT_CACHE_LOAD_FAILED;
+        clear_object();
+        try {
+            ret = load_object_cached_data_binary(obj, file_name, find_printing_region_by_id);
+        } catch (std::exception &err) {
+            BOOST_LOG_TRIVIAL(error) << __FUNCTION__ << ": load from " << file_name << " got a generic exception, reason = " << err.what();
+        }
+        if (ret == 0) {
+            BOOST_LOG_TRIVIAL(info) << __FUNCTION__ << boost::format(": object %1% loaded from the slicing result cache %2%") % obj->model_object()->name % file_name;
+            ++ m_slicing_result_cache_hits;
+            obj->m_typed_slices = false;
+            for (PrintObjectStep step : { posSlice, posPerimeters })
+                if (obj->set_started(step))
+                    obj->set_done(step);
+            return;
+        }
+        BOOST_LOG_TRIVIAL(warning) << __FUNCTION__ << boost::format(": slicing result cache %1% can not be used, ret=%2%, slicing again") % file_name % ret;
+        clear_object();
+    }
+
+    obj->make_perimeters();
+    if (! obj->is_step_done(posPerimeters))
+        return;
+
+    // Write into a temporary file first and rename it, so that another process sharing the cache never sees a partial file.
+    const boost::filesystem::path path_tmp = cache_dir / boost::filesystem::unique_path(key + ".%%%%-%%%%.tmp");
+    try {
+        boost::filesystem::create_directories(cache_dir);
+        if (export_object_cached_data_binary(obj, obj->model_object()->name, 0, path_tmp.string(), printing_region_id) == 0)
+            boost::filesystem::rename(path_tmp, file_name);
+        else
+            boost::filesystem::remove(path_tmp);
+    } catch (std::exception &err) {
+        BOOST_LOG_TRIVIAL(warning) << __FUNCTION__ << ": save to " << file_name << " got a generic exception, reason = " << err.what();
+        boost::system::error_code ec;
+        boost::filesystem::remove(path_tmp, ec);
+    }
+}
+
 int Print::export_cached_data(const std::string& directory, bool with_space)
 {
     int ret = 0;
@@ -3906,10 +4755,27 @@ int Print::export_cached_data(const std::string& directory, bool with_space)
         const PrintInstance &print_instance = obj->instances()[0];
         const ModelInstance *model_instance = print_instance.model_instance;
         size_t identify_id = (model_instance->loaded_id > 0)?model_instance->loaded_id: model_instance->id().id;
-        std::string file_name = directory +"/obj_"+std::to_string(identify_id)+".json";
+        // The human readable JSON is only written when requested for debugging, the binary cache is much faster to save and load.
+        std::string file_name = directory +"/obj_"+std::to_string(identify_id)+(with_space ? ".json" : SLICE_CACHE_BINARY_EXTENSION);
 
         BOOST_LOG_TRIVIAL(info) << boost::format("begin to dump object %1%, identify_id %2% to %3%")%model_obj->name %identify_id %file_name;
 
+        if (!with_space) {
+            try {
+                int obj_ret = export_object_cached_data_binary(obj, model_obj->name, identify_id, file_name,
+                    [](const PrintRegion &region) { return region.config_hash(); });
+                if (obj_ret)
+                    ret = obj_ret;
+                else
+                    count ++;
+            }
+            catch(std::exception &err) {
+                BOOST_LOG_TRIVIAL(error) << __FUNCTION__<< ": save to "<<file_name<<" got a generic exception, reason = " << err.what();
+                ret = CLI_EXPORT_CACHE_WRITE_FAILED;
+            }
+            continue;
+        }
+
         try {
             json root_json, layers_json = json::array(), support_layers_json = json::array(), first_layer_groups = json::array();
 
@@ -4106,20 +4972,10 @@ int Print::load_cached_data(const std::string& directory)
         return CLI_IMPORT_CACHE_NOT_FOUND;
     }
 
-    auto find_region = [this](PrintObject* object, size_t config_hash) -> const PrintRegion* {
-        int regions_count = object->num_printing_regions();
-        for (int index = 0; index < regions_count; index++ )
-        {
-            const PrintRegion&  print_region = object->printing_region(index);
-            if (print_region.config_hash() == config_hash ) {
-                return &print_region;
-            }
-        }
-        return NULL;
-    };
+    auto find_region = find_printing_region_by_config_hash;
 
     int count = 0;
-    std::vector<std::pair<std::string, PrintObject*>> object_filenames;
+    std::vector<std::pair<std::string, PrintObject*>> object_filenames, binary_filenames;
     for (PrintObject *obj : m_objects) {
         const ModelObject* model_obj = obj->model_object();
         const PrintInstance &print_instance = obj->instances()[0];
@@ -4135,8 +4991,16 @@ int Print::load_cached_data(const std::string& directory)
             BOOST_LOG_TRIVIAL(info) << __FUNCTION__<< boost::format(": object %1%'s loaded_id is 0, need to use the instance_id %2%")%model_obj->name %identify_id;
             //continue;
         }
-        std::string file_name = directory +"/obj_"+std::to_string(identify_id)+".json";
+        std::string file_name = directory +"/obj_"+std::to_string(identify_id);
 
+        if (fs::exists(file_name + SLICE_CACHE_BINARY_EXTENSION)) {
+            if (is_valid_cached_data_binary(file_name + SLICE_CACHE_BINARY_EXTENSION)) {
+                binary_filenames.push_back({file_name, obj});
+                continue;
+            }
+            BOOST_LOG_TRIVIAL(warning) << __FUNCTION__<<boost::format(": binary cache %1% can not be used, fall back to json")%file_name;
+        }
+        file_name += ".json";
         if (!fs::exists(file_name)) {
             BOOST_LOG_TRIVIAL(info) << __FUNCTION__<<boost::format(": file %1% not exist, maybe a shared object, skip it")%file_name;
             continue;
@@ -4144,6 +5008,35 @@ int Print::load_cached_data(const std::string& directory)
         object_filenames.push_back({file_name, obj});
     }
 
+    // The whole object is decoded at once: the layers are accessed directly by all the following steps, thus they can not be decoded on demand.
+    // A binary file failing to load, for example a truncated one, is replaced by the JSON file of the same object.
+    for (const std::pair<std::string, PrintObject*>& binary_filename : binary_filenames) {
+        const std::string file_name = binary_filename.first + SLICE_CACHE_BINARY_EXTENSION;
+        PrintObject      *obj       = binary_filename.second;
+        int               obj_ret   = CLI_IMPORT_CACHE_LOAD_FAILED;
+        try {
+            obj_ret = load_object_cached_data_binary(obj, file_name, find_region);
+        }
+        catch(std::exception &err) {
+            BOOST_LOG_TRIVIAL(error) << __FUNCTION__<< ": load from "<<file_name<<" got a generic exception, reason = " << err.what();
+        }
+        if (obj_ret == 0) {
+            count ++;
+            BOOST_LOG_TRIVIAL(info) << __FUNCTION__<< boost::format(": load object %1% from %2% successfully.")%count%file_name;
+            continue;
+        }
+        obj->clear_layers();
+        obj->clear_support_layers();
+        obj->firstLayerObjGroupsMod().clear();
+        const std::string json_file_name = binary_filename.first + ".json";
+        if (!fs::exists(json_file_name)) {
+            BOOST_LOG_TRIVIAL(error) << __FUNCTION__<< boost::format(": load from %1% failed, ret=%2%, no json file to fall back to")%file_name %obj_ret;
+            return obj_ret;
+        }
+        BOOST_LOG_TRIVIAL(warning) << __FUNCTION__<< boost::format(": load from %1% failed, ret=%2%, fall back to %3%")%file_name %obj_ret %json_file_name;
+        object_filenames.push_back({json_file_name, obj});
+    }
+
     boost::mutex mutex;
     std::vector<json> object_jsons(object_filenames.size());
     tbb::parallel_for(
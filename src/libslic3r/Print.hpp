@@ -45,6 +45,8 @@ struct VolumeSlices
     ObjectID                volume_id;
     std::vector<ExPolygons> slices;
 };
+// Slices of the volumes of a PrintObject retained from its last slicing, defined in PrintObjectSlice.cpp.
+struct VolumeSlicesCache;
 
 struct groupedVolumeSlices
 {
@@ -98,6 +100,10 @@ enum PrintObjectStep {
     posCount,
 };
 
+// Names of the steps as shown in the slicing trace.
+const char* print_step_name(PrintStep step);
+const char* print_step_name(PrintObjectStep step);
+
 // A PrintRegion object represents a group of volumes to print
 // sharing the same config (including the same assigned extruder(s))
 class PrintRegion
@@ -449,6 +455,12 @@ public:
     size_t get_id() const { return m_id; }
     void set_id(size_t id) { m_id = id; }
 
+    // Steps invalidated by a change of a PrintObjectConfig or PrintRegionConfig option: steps of the PrintObject, steps invalidated
+    // only by some changes of the value (resolved by invalidate_state_by_config_options()) and steps of the Print.
+    // Returns false if the option is not known, then all the steps are invalidated.
+    static bool  steps_invalidated_by_config_option(const t_config_option_key &opt_key,
+                 std::vector<PrintObjectStep> &steps, std::vector<PrintObjectStep> &conditional_steps, std::vector<PrintStep> &print_steps);
+
   private:
     // to be called from Print only.
     friend class Print;
@@ -463,10 +475,21 @@ public:
     bool                    invalidate_step(PrintObjectStep step);
     // Invalidates all PrintObject and Print steps.
     bool                    invalidate_all_steps();
+    // Invalidates the infill (posInfill, posIroning, posSimplifyInfill) of the layers <first_layer, last_layer) only,
+    // if the infill has been finished for the other layers. Otherwise the infill is invalidated for all layers.
+    // Only the infill is invalidated per layer, the other steps depend on the neighbor layers.
+    bool                    invalidate_infill_layers(size_t first_layer, size_t last_layer);
+    // Invalidates the infill of the layers containing the region only, see invalidate_infill_layers().
+    bool                    invalidate_infill_region(const PrintRegion &region);
     // Invalidate steps based on a set of parameters changed.
     // It may be called for both the PrintObjectConfig and PrintRegionConfig.
+    // If the region is provided, the PrintRegionConfig of this region was changed, which may allow to invalidate
+    // just the infill of the layers containing the region.
     bool                    invalidate_state_by_config_options(
-        const ConfigOptionResolver &old_config, const ConfigOptionResolver &new_config, const std::vector<t_config_option_key> &opt_keys);
+        const ConfigOptionResolver &old_config, const ConfigOptionResolver &new_config, const std::vector<t_config_option_key> &opt_keys,
+        const PrintRegion *region = nullptr);
+    // Indices of the layers to be processed by a step: all the layers, or the layers invalidated by invalidate_infill_layers().
+    std::vector<size_t>     layers_to_process(PrintObjectStep step) const;
     // If ! m_slicing_params.valid, recalculate.
     void                    update_slicing_parameters();
 
@@ -533,10 +556,15 @@ private:
     bool                    				m_typed_slices = false;
 
     std::pair<FillAdaptive::OctreePtr, FillAdaptive::OctreePtr> m_adaptive_fill_octrees;
+    // Spans of layers <first, last) to be processed by the infill steps after invalidate_infill_layers(),
+    // empty if the step is to process all layers. Always empty for the other steps.
+    std::vector<std::pair<size_t, size_t>> m_dirty_layer_ranges[posCount];
     FillLightning::GeneratorPtr m_lightning_generator;
 
     std::vector < VolumeSlices >            firstLayerObjSliceByVolume;
     std::vector<groupedVolumeSlices>        firstLayerObjSliceByGroups;
+    // Slices of the volumes at the Z positions of the last slicing, if PrintObject::retain_volume_slices is enabled.
+    std::shared_ptr<VolumeSlicesCache>      m_volume_slices_cache;
 
     // BBS: per object skirt
     ExtrusionEntityCollection               m_skirt;
@@ -556,6 +584,9 @@ private:
     // This was a per-object setting and now we default enable it.
     static bool clip_multipart_objects;
     static bool infill_only_where_needed;
+    // Retain the slices of the volumes after slicing, so that when the object is sliced again after a change of its layer height
+    // profile or of its layer ranges, only the layers at new Z positions are sliced. Trades memory for the interactive response.
+    static bool retain_volume_slices;
 };
 
 struct FakeWipeTower
@@ -845,6 +876,17 @@ public:
     //return 0 means successful
     int                 export_cached_data(const std::string& dir_path, bool with_space=false);
     int                 load_cached_data(const std::string& directory);
+    // Directory of the persistent slicing result cache. The results of posSlice and posPerimeters of each object are stored there
+    // keyed by the content of the object, and they are reused by the following slicing of the same object with the same settings,
+    // even by another process. Empty to disable the cache.
+    void                set_slicing_result_cache_dir(const std::string &dir) { m_slicing_result_cache_dir = dir; }
+    const std::string&  slicing_result_cache_dir() const { return m_slicing_result_cache_dir; }
+    // Maximum number of layers in flight in the G-code export pipeline, zero to derive it from the number of worker threads.
+    void                set_gcode_pipeline_max_tokens(size_t max_tokens) { m_gcode_pipeline_max_tokens = max_tokens; }
+    // Soft limit of the memory held by the layers in flight in the G-code export pipeline in bytes, zero for no limit.
+    void                set_gcode_pipeline_max_memory(size_t max_memory) { m_gcode_pipeline_max_memory = max_memory; }
+    // Number of objects loaded from the persistent slicing result cache instead of being sliced.
+    size_t              slicing_result_cache_hits() const { return m_slicing_result_cache_hits; }
 
     // methods for handling state
     bool                is_step_done(PrintStep step) const { return Inherited::is_step_done(step); }
@@ -1002,6 +1044,7 @@ private:
 
     void                _make_skirt();
     void                _make_wipe_tower();
+    void                make_perimeters_with_result_cache(PrintObject *obj);
     void                finalize_first_layer_convex_hull();
 
     // Islands of objects and their supports extruded at the 1st layer.
@@ -1048,6 +1091,12 @@ private:
     //SoftFever: calibration
     Calib_Params m_calib_params;
 
+    std::string       m_slicing_result_cache_dir;
+    size_t            m_gcode_pipeline_max_tokens { 0 };
+    size_t            m_gcode_pipeline_max_memory { 0 };
+    // The objects are processed in parallel.
+    std::atomic<size_t> m_slicing_result_cache_hits { 0 };
+
     // To allow GCode to set the Print's GCodeExport step status.
     friend class GCode;
     // Allow PrintObject to access m_mutex and m_cancel_callback.
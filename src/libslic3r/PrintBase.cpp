@@ -19,7 +19,7 @@ void PrintTryCancel::operator()()
     m_print->throw_if_canceled();
 }
 
-size_t PrintStateBase::g_last_timestamp = 0;
+std::atomic<size_t> PrintStateBase::g_last_timestamp { 0 };
 
 // Update "scale", "input_filename", "input_filename_base" placeholders from the current m_objects.
 void PrintBase::update_object_placeholders(DynamicConfig &config, const std::string &default_ext) const
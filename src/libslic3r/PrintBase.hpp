@@ -7,12 +7,14 @@
 #include <string>
 #include <functional>
 #include <atomic>
+#include <chrono>
 #include <mutex>
 
 #include "ObjectID.hpp"
 #include "Model.hpp"
 #include "PlaceholderParser.hpp"
 #include "PrintConfig.hpp"
+#include "Trace.hpp"
 
 namespace Slic3r {
 
@@ -69,9 +71,11 @@ public:
     // A new unique timestamp is being assigned to the step every time the step changes its state.
     struct StateWithTimeStamp
     {
-        StateWithTimeStamp() : state(INVALID), timestamp(0) {}
+        StateWithTimeStamp() : state(INVALID), timestamp(0), duration(0.) {}
         State       state;
         TimeStamp   timestamp;
+        // Wall clock time in seconds between the last set_started() and set_done() of the step.
+        double      duration;
     };
 
     struct Warning
@@ -97,10 +101,9 @@ public:
     };
 
 protected:
-    //FIXME last timestamp is shared between Print & SLAPrint,
-    // and if multiple Print or SLAPrint instances are executed in parallel, modification of g_last_timestamp
-    // is not synchronized!
-    static size_t g_last_timestamp;
+    // Last timestamp is shared between Print & SLAPrint. It is atomic, as multiple Print instances
+    // may be processed in parallel (the command line slicer processes plates concurrently).
+    static std::atomic<size_t> g_last_timestamp;
 };
 
 // To be instantiated over PrintStep or PrintObjectStep enums.
@@ -142,6 +145,11 @@ public:
         return this->state_with_timestamp_unguarded(step).state == DONE;
     }
 
+    // Time when the step was started last, to be called by the thread executing the step.
+    std::chrono::steady_clock::time_point time_started_unguarded(StepType step) const {
+        return m_time_started[step];
+    }
+
     // Set the step as started. Block on mutex while the Print / PrintObject / PrintRegion objects are being
     // modified by the UI thread.
     // This is necessary to block until the Print::apply() updates its state, which may
@@ -171,6 +179,7 @@ public:
         state.timestamp = ++ g_last_timestamp;
         state.mark_warnings_non_current();
         m_step_active = static_cast<int>(step);
+        m_time_started[step] = std::chrono::steady_clock::now();
         return true;
     }
 
@@ -189,6 +198,7 @@ public:
         PrintStateBase::StateWithWarnings &state = m_state[step];
         state.state = DONE;
         state.timestamp = ++ g_last_timestamp;
+        state.duration = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_time_started[step]).count();
         m_step_active = -1;
         // Remove all non-current warnings.
     	auto it = std::remove_if(state.warnings.begin(), state.warnings.end(), [](const auto &w) { return ! w.current; });
@@ -322,6 +332,7 @@ public:
 
 private:
     StateWithWarnings   m_state[COUNT];
+    std::chrono::steady_clock::time_point m_time_started[COUNT];
     // Active class StepType or -1 if none is active.
     // If the background processing is canceled, m_step_active may not be resetted
     // to -1, see the comment in this->set_started().
@@ -597,6 +608,9 @@ protected:
     bool            set_started(PrintStepEnum step) { return m_state.set_started(step, this->state_mutex(), [this](){ this->throw_if_canceled(); }); }
 	PrintStateBase::TimeStamp set_done(PrintStepEnum step) {
 		std::pair<PrintStateBase::TimeStamp, bool> status = m_state.set_done(step, this->state_mutex(), [this](){ this->throw_if_canceled(); });
+        if (Trace::enabled())
+            // print_step_name() is provided by the Print / SLAPrint for its step enums.
+            Trace::add_span(print_step_name(step), "PrintStep", m_state.time_started_unguarded(step), Trace::Clock::now());
         if (status.second)
             this->status_update_warnings(static_cast<int>(step), PrintStateBase::WarningLevel::NON_CRITICAL, std::string());
         return status.first;
@@ -638,6 +652,9 @@ protected:
         { return m_state.set_started(step, PrintObjectBase::state_mutex(m_print), [this](){ this->throw_if_canceled(); }); }
 	PrintStateBase::TimeStamp set_done(PrintObjectStepEnum step) {
 		std::pair<PrintStateBase::TimeStamp, bool> status = m_state.set_done(step, PrintObjectBase::state_mutex(m_print), [this](){ this->throw_if_canceled(); });
+        if (Trace::enabled())
+            Trace::add_span(print_step_name(step), "PrintObjectStep", m_state.time_started_unguarded(step), Trace::Clock::now(),
+                this->model_object()->name);
         if (status.second)
             this->status_update_warnings(m_print, static_cast<int>(step), PrintStateBase::WarningLevel::NON_CRITICAL, std::string());
         return status.first;
@@ -7323,6 +7323,50 @@ CLIMiscConfigDef::CLIMiscConfigDef()
     def->cli_params = "dir";
     def->set_default_value(new ConfigOptionString());
 
+    def = this->add("slicing_cache_dir", coString);
+    def->label = "Slicing result cache directory";
+    def->tooltip = "Store the sliced layers and walls of each object into this directory and reuse them "
+                   "when the same object is sliced again with the same settings.";
+    def->cli_params = "dir";
+    def->set_default_value(new ConfigOptionString());
+
+    def = this->add("daemon", coBool);
+    def->label = "Slicing daemon";
+    def->tooltip = "Keep running and slice the jobs read from the standard input, one JSON object per line. "
+                   "The loaded settings are reused by the following jobs.";
+    def->set_default_value(new ConfigOptionBool(false));
+
+    def = this->add("parallel_plates", coInt);
+    def->label = "Parallel plates";
+    def->tooltip = "Maximum number of plates processed concurrently when all the plates are sliced (--slice 0). "
+                   "The plates share a single pool of worker threads.";
+    def->min = 1;
+    def->cli_params = "count";
+    def->set_default_value(new ConfigOptionInt(1));
+
+    def = this->add("gcode_pipeline_tokens", coInt);
+    def->label = "G-code pipeline tokens";
+    def->tooltip = "Maximum number of layers in flight while exporting G-code. More layers keep more worker threads busy "
+                   "at the cost of memory. 0 to derive it from the number of worker threads.";
+    def->min = 0;
+    def->cli_params = "count";
+    def->set_default_value(new ConfigOptionInt(0));
+
+    def = this->add("gcode_pipeline_memory", coInt);
+    def->label = "G-code pipeline memory";
+    def->tooltip = "Soft limit of the memory held by the G-code of the layers in flight while exporting G-code, in megabytes. "
+                   "No new layer is started until the output catches up, the wait is bounded. 0 for no limit.";
+    def->min = 0;
+    def->cli_params = "MB";
+    def->set_default_value(new ConfigOptionInt(0));
+
+    def = this->add("trace_file", coString);
+    def->label = "Trace file";
+    def->tooltip = "Record the time spent in the slicing steps and G-code export stages and write it "
+                   "into this file in the Chrome trace format.";
+    def->cli_params = "trace.json";
+    def->set_default_value(new ConfigOptionString());
+
     def = this->add("debug", coInt);
     def->label = "Debug level";
     def->tooltip = "Sets debug logging level. 0:fatal, 1:error, 2:warning, 3:info, 4:debug, 5:trace\n";
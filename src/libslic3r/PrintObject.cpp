@@ -25,6 +25,7 @@
 #include <oneapi/tbb/blocked_range.h>
 #include <oneapi/tbb/concurrent_vector.h>
 #include <oneapi/tbb/parallel_for.h>
+#include <numeric>
 #include <string_view>
 #include <utility>
 
@@ -545,13 +546,14 @@ void PrintObject::infill()
         const auto& adaptive_fill_octree = this->m_adaptive_fill_octrees.first;
         const auto& support_fill_octree = this->m_adaptive_fill_octrees.second;
 
-        BOOST_LOG_TRIVIAL(debug) << "Filling layers in parallel - start";
+        const std::vector<size_t> layers = this->layers_to_process(posInfill);
+        BOOST_LOG_TRIVIAL(debug) << "Filling " << layers.size() << " layers in parallel - start";
         tbb::parallel_for(
-            tbb::blocked_range<size_t>(0, m_layers.size()),
-            [this, &adaptive_fill_octree = adaptive_fill_octree, &support_fill_octree = support_fill_octree](const tbb::blocked_range<size_t>& range) {
-                for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx) {
+            tbb::blocked_range<size_t>(0, layers.size()),
+            [this, &layers, &adaptive_fill_octree = adaptive_fill_octree, &support_fill_octree = support_fill_octree](const tbb::blocked_range<size_t>& range) {
+                for (size_t i = range.begin(); i < range.end(); ++ i) {
                     m_print->throw_if_canceled();
-                    m_layers[layer_idx]->make_fills(adaptive_fill_octree.get(), support_fill_octree.get(), this->m_lightning_generator.get());
+                    m_layers[layers[i]]->make_fills(adaptive_fill_octree.get(), support_fill_octree.get(), this->m_lightning_generator.get());
                 }
             }
         );
@@ -561,6 +563,7 @@ void PrintObject::infill()
         ### $_->fill_surfaces->clear for map @{$_->regions}, @{$object->layers};
         */
         this->set_done(posInfill);
+        m_dirty_layer_ranges[posInfill].clear();
     }
 }
 
@@ -568,19 +571,21 @@ void PrintObject::ironing()
 {
     if (this->set_started(posIroning)) {
         BOOST_LOG_TRIVIAL(debug) << "Ironing in parallel - start";
+        const std::vector<size_t> layers = this->layers_to_process(posIroning);
         tbb::parallel_for(
             // Ironing starting with layer 0 to support ironing all surfaces.
-            tbb::blocked_range<size_t>(0, m_layers.size()),
-            [this](const tbb::blocked_range<size_t>& range) {
-                for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx) {
+            tbb::blocked_range<size_t>(0, layers.size()),
+            [this, &layers](const tbb::blocked_range<size_t>& range) {
+                for (size_t i = range.begin(); i < range.end(); ++ i) {
                     m_print->throw_if_canceled();
-                    m_layers[layer_idx]->make_ironing();
+                    m_layers[layers[i]]->make_ironing();
                 }
             }
         );
         m_print->throw_if_canceled();
         BOOST_LOG_TRIVIAL(debug) << "Ironing in parallel - end";
         this->set_done(posIroning);
+        m_dirty_layer_ranges[posIroning].clear();
     }
 }
 
@@ -715,18 +720,20 @@ void PrintObject::simplify_extrusion_path()
         m_print->set_status(75, L("Optimizing toolpath"));
         BOOST_LOG_TRIVIAL(debug) << "Simplify infill extrusion path of object in parallel - start";
         //BBS: infills
+        const std::vector<size_t> layers = this->layers_to_process(posSimplifyInfill);
         tbb::parallel_for(
-            tbb::blocked_range<size_t>(0, m_layers.size()),
-            [this](const tbb::blocked_range<size_t>& range) {
-                for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++layer_idx) {
+            tbb::blocked_range<size_t>(0, layers.size()),
+            [this, &layers](const tbb::blocked_range<size_t>& range) {
+                for (size_t i = range.begin(); i < range.end(); ++i) {
                     m_print->throw_if_canceled();
-                    m_layers[layer_idx]->simplify_infill_extrusion_path();
+                    m_layers[layers[i]]->simplify_infill_extrusion_path();
                 }
             }
         );
         m_print->throw_if_canceled();
         BOOST_LOG_TRIVIAL(debug) << "Simplify infill extrusion path of object in parallel - end";
         this->set_done(posSimplifyInfill);
+        m_dirty_layer_ranges[posSimplifyInfill].clear();
     }
 
     if (this->set_started(posSimplifySupportPath)) {
@@ -873,63 +880,293 @@ SupportLayerPtrs::iterator PrintObject::insert_support_layer(SupportLayerPtrs::i
     return m_support_layers.insert(pos, new SupportLayer(id, interface_id, this, height, print_z, slice_z));
 }
 
+// This method only accepts PrintObjectConfig and PrintRegionConfig option keys.
+bool PrintObject::steps_invalidated_by_config_option(
+    const t_config_option_key &opt_key, std::vector<PrintObjectStep> &steps, std::vector<PrintObjectStep> &conditional_steps, std::vector<PrintStep> &print_steps)
+{
+    if (   opt_key == "brim_width"
+        || opt_key == "brim_object_gap"
+        || opt_key == "brim_type"
+        || opt_key == "brim_ears_max_angle"
+        || opt_key == "brim_ears_detection_length"
+        // BBS: brim generation depends on printing speed
+        || opt_key == "outer_wall_speed"
+        || opt_key == "small_perimeter_speed"
+        || opt_key == "small_perimeter_threshold"
+        || opt_key == "sparse_infill_speed"
+        || opt_key == "inner_wall_speed"
+        || opt_key == "support_speed"
+        || opt_key == "internal_solid_infill_speed"
+        || opt_key == "top_surface_speed") {
+        // Brim is printed below supports, support invalidates brim and skirt.
+        steps.emplace_back(posSupportMaterial);
+        if (opt_key == "brim_type")
+            conditional_steps.emplace_back(posPerimeters);
+    } else if (
+           opt_key == "wall_loops"
+        || opt_key == "alternate_extra_wall"
+        || opt_key == "top_one_wall_type"
+        || opt_key == "min_width_top_surface"
+        || opt_key == "only_one_wall_first_layer"
+        || opt_key == "extra_perimeters_on_overhangs"
+        || opt_key == "detect_overhang_wall"
+        || opt_key == "initial_layer_line_width"
+        || opt_key == "inner_wall_line_width"
+        || opt_key == "infill_wall_overlap"
+        || opt_key == "top_bottom_infill_wall_overlap"
+        || opt_key == "seam_gap"
+        || opt_key == "role_based_wipe_speed"
+        || opt_key == "wipe_on_loops"
+        || opt_key == "wipe_speed") {
+        steps.emplace_back(posPerimeters);
+    } else if (
+        opt_key == "small_area_infill_flow_compensation_model") {
+        steps.emplace_back(posSlice);
+    } else if (opt_key == "gap_infill_speed"
+        || opt_key == "filter_out_gap_fill" ) {
+        conditional_steps.emplace_back(posSlice);
+        steps.emplace_back(posPerimeters);
+    } else if (
+           opt_key == "layer_height"
+        || opt_key == "mmu_segmented_region_max_width"
+        || opt_key == "mmu_segmented_region_interlocking_depth"
+        || opt_key == "raft_layers"
+        || opt_key == "raft_contact_distance"
+        || opt_key == "slice_closing_radius"
+        || opt_key == "slicing_mode"
+        || opt_key == "slowdown_for_curled_perimeters"
+        || opt_key == "make_overhang_printable"
+        || opt_key == "make_overhang_printable_angle"
+        || opt_key == "make_overhang_printable_hole_size"
+        || opt_key == "interlocking_beam"
+        || opt_key == "interlocking_orientation"
+        || opt_key == "interlocking_beam_layer_count"
+        || opt_key == "interlocking_depth"
+        || opt_key == "interlocking_boundary_avoidance"
+        || opt_key == "interlocking_beam_width") {
+        steps.emplace_back(posSlice);
+    } else if (
+           opt_key == "elefant_foot_compensation"
+        || opt_key == "elefant_foot_compensation_layers"
+        || opt_key == "support_top_z_distance"
+        || opt_key == "support_bottom_z_distance"
+        || opt_key == "xy_hole_compensation"
+        || opt_key == "xy_contour_compensation"
+        //BBS: [Arthur] the following params affect bottomBridge surface type detection
+        || opt_key == "support_type"
+        || opt_key == "bridge_no_support"
+        || opt_key == "max_bridge_length"
+        || opt_key == "support_interface_top_layers"
+        || opt_key == "support_critical_regions_only"
+        || opt_key == "hole_to_polyhole"
+        || opt_key == "hole_to_polyhole_threshold"
+        || opt_key == "hole_to_polyhole_twisted"
+        ) {
+        steps.emplace_back(posSlice);
+    } else if (opt_key == "enable_support") {
+        steps.emplace_back(posSupportMaterial);
+        conditional_steps.emplace_back(posSlice);
+    } else if (
+    	   opt_key == "support_type"
+        || opt_key == "support_angle"
+        || opt_key == "support_on_build_plate_only"
+        || opt_key == "support_critical_regions_only"
+        || opt_key == "support_remove_small_overhang"
+        || opt_key == "enforce_support_layers"
+        || opt_key == "support_filament"
+        || opt_key == "support_line_width"
+        || opt_key == "support_interface_top_layers"
+        || opt_key == "support_interface_bottom_layers"
+        || opt_key == "support_interface_pattern"
+        || opt_key == "support_interface_loop_pattern"
+        || opt_key == "support_interface_filament"
+        || opt_key == "support_interface_not_for_body"
+        || opt_key == "support_interface_spacing"
+        || opt_key == "support_bottom_interface_spacing" //BBS
+        || opt_key == "support_base_pattern"
+        || opt_key == "support_style"
+        || opt_key == "support_object_xy_distance"
+        || opt_key == "support_base_pattern_spacing"
+        || opt_key == "support_expansion"
+        //|| opt_key == "independent_support_layer_height" // BBS
+        || opt_key == "support_threshold_angle"
+        || opt_key == "raft_expansion"
+        || opt_key == "raft_first_layer_density"
+        || opt_key == "raft_first_layer_expansion"
+        || opt_key == "bridge_no_support"
+        || opt_key == "max_bridge_length"
+        || opt_key == "initial_layer_line_width"
+        || opt_key == "tree_support_adaptive_layer_height"
+        || opt_key == "tree_support_auto_brim"
+        || opt_key == "tree_support_brim_width"
+        || opt_key == "tree_support_top_rate"
+        || opt_key == "tree_support_branch_distance"
+        || opt_key == "tree_support_branch_distance_organic"
+        || opt_key == "tree_support_tip_diameter"
+        || opt_key == "tree_support_branch_diameter"
+        || opt_key == "tree_support_branch_diameter_organic"
+        || opt_key == "tree_support_branch_diameter_angle"
+        || opt_key == "tree_support_branch_diameter_double_wall"
+        || opt_key == "tree_support_branch_angle"
+        || opt_key == "tree_support_branch_angle_organic"
+        || opt_key == "tree_support_angle_slow"
+        || opt_key == "tree_support_wall_count") {
+        steps.emplace_back(posSupportMaterial);
+    } else if (
+           opt_key == "bottom_shell_layers"
+        || opt_key == "top_shell_layers") {
+
+        steps.emplace_back(posSlice);
+#if (0)
+        const auto *old_shell_layers = old_config.option<ConfigOptionInt>(opt_key);
+        const auto *new_shell_layers = new_config.option<ConfigOptionInt>(opt_key);
+        assert(old_shell_layers && new_shell_layers);
+
+        bool value_changed = (old_shell_layers->value == 0 && new_shell_layers->value > 0) ||
+                             (old_shell_layers->value > 0 && new_shell_layers->value == 0);
+
+        if (value_changed && this->object_extruders().size() > 1) {
+            steps.emplace_back(posSlice);
+        }
+        else if (m_print->config().spiral_mode && opt_key == "bottom_shell_layers") {
+            // Changing the number of bottom layers when a spiral vase is enabled requires re-slicing the object again.
+            // Otherwise, holes in the bottom layers could be filled, as is reported in GH #5528.
+            steps.emplace_back(posSlice);
+        }
+#endif
+    } else if (
+           opt_key == "interface_shells"
+        || opt_key == "infill_combination"
+        || opt_key == "infill_combination_max_layer_height"
+        || opt_key == "bottom_shell_thickness"
+        || opt_key == "top_shell_thickness"
+        || opt_key == "minimum_sparse_infill_area"
+        || opt_key == "sparse_infill_filament"
+        || opt_key == "solid_infill_filament"
+        || opt_key == "sparse_infill_line_width"
+        || opt_key == "infill_direction"
+        || opt_key == "solid_infill_direction"
+        || opt_key == "rotate_solid_infill_direction"
+        || opt_key == "ensure_vertical_shell_thickness"
+        || opt_key == "bridge_angle"
+        //BBS
+        || opt_key == "bridge_density") {
+        steps.emplace_back(posPrepareInfill);
+    } else if (
+           opt_key == "top_surface_pattern"
+        || opt_key == "bottom_surface_pattern"
+        || opt_key == "internal_solid_infill_pattern"
+        || opt_key == "external_fill_link_max_length"
+        || opt_key == "infill_anchor"
+        || opt_key == "infill_anchor_max"
+        || opt_key == "top_surface_line_width"
+        || opt_key == "initial_layer_line_width"
+        || opt_key == "small_area_infill_flow_compensation") {
+        steps.emplace_back(posInfill);
+    } else if (opt_key == "sparse_infill_pattern") {
+        steps.emplace_back(posPrepareInfill);
+    } else if (opt_key == "sparse_infill_density") {
+        conditional_steps.emplace_back(posPerimeters);
+        steps.emplace_back(posPrepareInfill);
+    } else if (opt_key == "internal_solid_infill_line_width") {
+        // This value is used for calculating perimeter - infill overlap, thus perimeters need to be recalculated.
+        steps.emplace_back(posPerimeters);
+        steps.emplace_back(posPrepareInfill);
+    } else if (
+           opt_key == "outer_wall_line_width"
+        || opt_key == "wall_filament"
+        || opt_key == "fuzzy_skin"
+        || opt_key == "fuzzy_skin_thickness"
+        || opt_key == "fuzzy_skin_point_distance"
+        || opt_key == "fuzzy_skin_first_layer"
+        || opt_key == "detect_overhang_wall"
+        || opt_key == "overhang_reverse"
+        || opt_key == "overhang_reverse_internal_only"
+        || opt_key == "overhang_reverse_threshold"
+        || opt_key == "wall_direction"
+        //BBS
+        || opt_key == "enable_overhang_speed"
+        || opt_key == "detect_thin_wall"
+        || opt_key == "precise_outer_wall"
+        || opt_key == "overhang_speed_classic") {
+        steps.emplace_back(posPerimeters);
+        steps.emplace_back(posSupportMaterial);
+    } else if (opt_key == "bridge_flow" || opt_key == "internal_bridge_flow") {
+        conditional_steps.emplace_back(posPerimeters);
+        conditional_steps.emplace_back(posInfill);
+        conditional_steps.emplace_back(posSupportMaterial);
+    } else if (
+            opt_key == "wall_generator"
+        || opt_key == "wall_transition_length"
+        || opt_key == "wall_transition_filter_deviation"
+        || opt_key == "wall_transition_angle"
+        || opt_key == "wall_distribution_count"
+        || opt_key == "min_feature_size"
+        || opt_key == "min_length_factor"
+        || opt_key == "min_bead_width") {
+        steps.emplace_back(posSlice);
+    } else if (
+           opt_key == "seam_position"
+        || opt_key == "seam_slope_type"
+        || opt_key == "seam_slope_conditional"
+        || opt_key == "scarf_angle_threshold"
+        || opt_key == "scarf_overhang_threshold"
+        || opt_key == "scarf_joint_speed"
+        || opt_key == "scarf_joint_flow_ratio"
+        || opt_key == "seam_slope_start_height"
+        || opt_key == "seam_slope_entire_loop"
+        || opt_key == "seam_slope_min_length"
+        || opt_key == "seam_slope_steps"
+        || opt_key == "seam_slope_inner_walls"
+        || opt_key == "support_speed"
+        || opt_key == "support_interface_speed"
+        || opt_key == "overhang_1_4_speed"
+        || opt_key == "overhang_2_4_speed"
+        || opt_key == "overhang_3_4_speed"
+        || opt_key == "overhang_4_4_speed"
+        || opt_key == "bridge_speed"
+        || opt_key == "internal_bridge_speed"
+        || opt_key == "outer_wall_speed"
+        || opt_key == "small_perimeter_speed"
+        || opt_key == "small_perimeter_threshold"
+        || opt_key == "sparse_infill_speed"
+        || opt_key == "inner_wall_speed"
+        || opt_key == "internal_solid_infill_speed"
+        || opt_key == "top_surface_speed"
+        || opt_key == "bed_mesh_min"
+        || opt_key == "bed_mesh_max"
+        || opt_key == "adaptive_bed_mesh_margin"
+        || opt_key == "bed_mesh_probe_distance") {
+        print_steps.emplace_back(psGCodeExport);
+    } else if (
+           opt_key == "flush_into_infill"
+        || opt_key == "flush_into_objects"
+        || opt_key == "flush_into_support") {
+        print_steps.emplace_back(psWipeTower);
+        print_steps.emplace_back(psGCodeExport);
+    } else
+        return false;
+    return true;
+}
+
 // Called by Print::apply().
 // This method only accepts PrintObjectConfig and PrintRegionConfig option keys.
 bool PrintObject::invalidate_state_by_config_options(
-    const ConfigOptionResolver &old_config, const ConfigOptionResolver &new_config, const std::vector<t_config_option_key> &opt_keys)
+    const ConfigOptionResolver &old_config, const ConfigOptionResolver &new_config, const std::vector<t_config_option_key> &opt_keys,
+    const PrintRegion *region)
 {
     if (opt_keys.empty())
         return false;
 
-    std::vector<PrintObjectStep> steps;
-    bool invalidated = false;
-    for (const t_config_option_key &opt_key : opt_keys) {
-        if (   opt_key == "brim_width"
-            || opt_key == "brim_object_gap"
-            || opt_key == "brim_type"
-            || opt_key == "brim_ears_max_angle"
-            || opt_key == "brim_ears_detection_length"
-            // BBS: brim generation depends on printing speed
-            || opt_key == "outer_wall_speed"
-            || opt_key == "small_perimeter_speed"
-            || opt_key == "small_perimeter_threshold"
-            || opt_key == "sparse_infill_speed"
-            || opt_key == "inner_wall_speed"
-            || opt_key == "support_speed"
-            || opt_key == "internal_solid_infill_speed"
-            || opt_key == "top_surface_speed") {
-            // Brim is printed below supports, support invalidates brim and skirt.
-            steps.emplace_back(posSupportMaterial);
-            if (opt_key == "brim_type") {
-                const auto* old_brim_type = old_config.option<ConfigOptionEnum<BrimType>>(opt_key);
-                const auto* new_brim_type = new_config.option<ConfigOptionEnum<BrimType>>(opt_key);
-                //BBS: When switch to manual brim, the object must have brim, then re-generate perimeter
-                //to make the wall order of first layer to be outer-first
-                if (old_brim_type->value == btOuterOnly || new_brim_type->value == btOuterOnly)
-                    steps.emplace_back(posPerimeters);
-            }
-        } else if (
-               opt_key == "wall_loops"
-            || opt_key == "alternate_extra_wall"
-            || opt_key == "top_one_wall_type"
-            || opt_key == "min_width_top_surface"
-            || opt_key == "only_one_wall_first_layer"
-            || opt_key == "extra_perimeters_on_overhangs"
-            || opt_key == "detect_overhang_wall"
-            || opt_key == "initial_layer_line_width"
-            || opt_key == "inner_wall_line_width"
-            || opt_key == "infill_wall_overlap"
-            || opt_key == "top_bottom_infill_wall_overlap"
-            || opt_key == "seam_gap"
-            || opt_key == "role_based_wipe_speed"
-            || opt_key == "wipe_on_loops"
-            || opt_key == "wipe_speed") {
-            steps.emplace_back(posPerimeters);
-        } else if (
-            opt_key == "small_area_infill_flow_compensation_model") {
-            steps.emplace_back(posSlice);
-        } else if (opt_key == "gap_infill_speed"
-            || opt_key == "filter_out_gap_fill" ) {
+    // Are the conditional steps of steps_invalidated_by_config_option() invalidated by the change of the option?
+    auto conditional_steps_invalidated = [this, &old_config, &new_config](const t_config_option_key &opt_key) -> bool {
+        if (opt_key == "brim_type") {
+            const auto* old_brim_type = old_config.option<ConfigOptionEnum<BrimType>>(opt_key);
+            const auto* new_brim_type = new_config.option<ConfigOptionEnum<BrimType>>(opt_key);
+            //BBS: When switch to manual brim, the object must have brim, then re-generate perimeter
+            //to make the wall order of first layer to be outer-first
+            return old_brim_type->value == btOuterOnly || new_brim_type->value == btOuterOnly;
+        } else if (opt_key == "gap_infill_speed" || opt_key == "filter_out_gap_fill") {
             // Return true if gap-fill speed has changed from zero value to non-zero or from non-zero value to zero.
             auto is_gap_fill_changed_state_due_to_speed = [&opt_key, &old_config, &new_config]() -> bool {
                 if (opt_key == "gap_infill_speed") {
@@ -945,154 +1182,13 @@ bool PrintObject::invalidate_state_by_config_options(
             // Filtering of unprintable regions in multi-material segmentation depends on if gap-fill is enabled or not.
             // So step posSlice is invalidated when gap-fill was enabled/disabled by option "filter_out_gap_fill" or by
             // changing "gap_infill_speed" to force recomputation of the multi-material segmentation.
-            if (this->is_mm_painted() && (opt_key == "filter_out_gap_fill" && (opt_key == "gap_infill_speed" && is_gap_fill_changed_state_due_to_speed())))
-                steps.emplace_back(posSlice);
-            steps.emplace_back(posPerimeters);
-        } else if (
-               opt_key == "layer_height"
-            || opt_key == "mmu_segmented_region_max_width"
-            || opt_key == "mmu_segmented_region_interlocking_depth"
-            || opt_key == "raft_layers"
-            || opt_key == "raft_contact_distance"
-            || opt_key == "slice_closing_radius"
-            || opt_key == "slicing_mode"
-            || opt_key == "slowdown_for_curled_perimeters"
-            || opt_key == "make_overhang_printable"
-            || opt_key == "make_overhang_printable_angle"
-            || opt_key == "make_overhang_printable_hole_size"
-            || opt_key == "interlocking_beam"
-            || opt_key == "interlocking_orientation"
-            || opt_key == "interlocking_beam_layer_count"
-            || opt_key == "interlocking_depth"
-            || opt_key == "interlocking_boundary_avoidance"
-            || opt_key == "interlocking_beam_width") {
-            steps.emplace_back(posSlice);
-		} else if (
-               opt_key == "elefant_foot_compensation"
-            || opt_key == "elefant_foot_compensation_layers"
-            || opt_key == "support_top_z_distance"
-            || opt_key == "support_bottom_z_distance"
-            || opt_key == "xy_hole_compensation"
-            || opt_key == "xy_contour_compensation"
-            //BBS: [Arthur] the following params affect bottomBridge surface type detection
-            || opt_key == "support_type"
-            || opt_key == "bridge_no_support"
-            || opt_key == "max_bridge_length"
-            || opt_key == "support_interface_top_layers"
-            || opt_key == "support_critical_regions_only"
-            || opt_key == "hole_to_polyhole"
-            || opt_key == "hole_to_polyhole_threshold"
-            || opt_key == "hole_to_polyhole_twisted"
-            ) {
-            steps.emplace_back(posSlice);
+            return this->is_mm_painted() && (opt_key == "filter_out_gap_fill" && (opt_key == "gap_infill_speed" && is_gap_fill_changed_state_due_to_speed()));
         } else if (opt_key == "enable_support") {
-            steps.emplace_back(posSupportMaterial);
-            if (m_config.support_top_z_distance == 0.) {
-            	// Enabling / disabling supports while soluble support interface is enabled.
-            	// This changes the bridging logic (bridging enabled without supports, disabled with supports).
-            	// Reset everything.
-            	// See GH #1482 for details.
-	            steps.emplace_back(posSlice);
-	        }
-        } else if (
-        	   opt_key == "support_type"
-            || opt_key == "support_angle"
-            || opt_key == "support_on_build_plate_only"
-            || opt_key == "support_critical_regions_only"
-            || opt_key == "support_remove_small_overhang"
-            || opt_key == "enforce_support_layers"
-            || opt_key == "support_filament"
-            || opt_key == "support_line_width"
-            || opt_key == "support_interface_top_layers"
-            || opt_key == "support_interface_bottom_layers"
-            || opt_key == "support_interface_pattern"
-            || opt_key == "support_interface_loop_pattern"
-            || opt_key == "support_interface_filament"
-            || opt_key == "support_interface_not_for_body"
-            || opt_key == "support_interface_spacing"
-            || opt_key == "support_bottom_interface_spacing" //BBS
-            || opt_key == "support_base_pattern"
-            || opt_key == "support_style"
-            || opt_key == "support_object_xy_distance"
-            || opt_key == "support_base_pattern_spacing"
-            || opt_key == "support_expansion"
-            //|| opt_key == "independent_support_layer_height" // BBS
-            || opt_key == "support_threshold_angle"
-            || opt_key == "raft_expansion"
-            || opt_key == "raft_first_layer_density"
-            || opt_key == "raft_first_layer_expansion"
-            || opt_key == "bridge_no_support"
-            || opt_key == "max_bridge_length"
-            || opt_key == "initial_layer_line_width"
-            || opt_key == "tree_support_adaptive_layer_height"
-            || opt_key == "tree_support_auto_brim"
-            || opt_key == "tree_support_brim_width"
-            || opt_key == "tree_support_top_rate"
-            || opt_key == "tree_support_branch_distance"
-            || opt_key == "tree_support_branch_distance_organic"
-            || opt_key == "tree_support_tip_diameter"
-            || opt_key == "tree_support_branch_diameter"
-            || opt_key == "tree_support_branch_diameter_organic"
-            || opt_key == "tree_support_branch_diameter_angle"
-            || opt_key == "tree_support_branch_diameter_double_wall"
-            || opt_key == "tree_support_branch_angle"
-            || opt_key == "tree_support_branch_angle_organic"
-            || opt_key == "tree_support_angle_slow"
-            || opt_key == "tree_support_wall_count") {
-            steps.emplace_back(posSupportMaterial);
-        } else if (
-               opt_key == "bottom_shell_layers"
-            || opt_key == "top_shell_layers") {
-
-            steps.emplace_back(posSlice);
-#if (0)
-            const auto *old_shell_layers = old_config.option<ConfigOptionInt>(opt_key);
-            const auto *new_shell_layers = new_config.option<ConfigOptionInt>(opt_key);
-            assert(old_shell_layers && new_shell_layers);
-
-            bool value_changed = (old_shell_layers->value == 0 && new_shell_layers->value > 0) ||
-                                 (old_shell_layers->value > 0 && new_shell_layers->value == 0);
-
-            if (value_changed && this->object_extruders().size() > 1) {
-                steps.emplace_back(posSlice);
-            }
-            else if (m_print->config().spiral_mode && opt_key == "bottom_shell_layers") {
-                // Changing the number of bottom layers when a spiral vase is enabled requires re-slicing the object again.
-                // Otherwise, holes in the bottom layers could be filled, as is reported in GH #5528.
-                steps.emplace_back(posSlice);
-            }
-#endif
-        } else if (
-               opt_key == "interface_shells"
-            || opt_key == "infill_combination"
-            || opt_key == "infill_combination_max_layer_height"
-            || opt_key == "bottom_shell_thickness"
-            || opt_key == "top_shell_thickness"
-            || opt_key == "minimum_sparse_infill_area"
-            || opt_key == "sparse_infill_filament"
-            || opt_key == "solid_infill_filament"
-            || opt_key == "sparse_infill_line_width"
-            || opt_key == "infill_direction"
-            || opt_key == "solid_infill_direction"
-            || opt_key == "rotate_solid_infill_direction"
-            || opt_key == "ensure_vertical_shell_thickness"
-            || opt_key == "bridge_angle"
-            //BBS
-            || opt_key == "bridge_density") {
-            steps.emplace_back(posPrepareInfill);
-        } else if (
-               opt_key == "top_surface_pattern"
-            || opt_key == "bottom_surface_pattern"
-            || opt_key == "internal_solid_infill_pattern"
-            || opt_key == "external_fill_link_max_length"
-            || opt_key == "infill_anchor"
-            || opt_key == "infill_anchor_max"
-            || opt_key == "top_surface_line_width"
-            || opt_key == "initial_layer_line_width"
-            || opt_key == "small_area_infill_flow_compensation") {
-            steps.emplace_back(posInfill);
-        } else if (opt_key == "sparse_infill_pattern") {
-            steps.emplace_back(posPrepareInfill);
+            // Enabling / disabling supports while soluble support interface is enabled.
+            // This changes the bridging logic (bridging enabled without supports, disabled with supports).
+            // Reset everything.
+            // See GH #1482 for details.
+            return m_config.support_top_z_distance == 0.;
         } else if (opt_key == "sparse_infill_density") {
             // One likely wants to reslice only when switching between zero infill to simulate boolean difference (subtracting volumes),
             // normal infill and 100% (solid) infill.
@@ -1100,100 +1196,40 @@ bool PrintObject::invalidate_state_by_config_options(
             const auto *new_density = new_config.option<ConfigOptionPercent>(opt_key);
             assert(old_density && new_density);
             //FIXME Vojtech is not quite sure about the 100% here, maybe it is not needed.
-            if (is_approx(old_density->value, 0.) || is_approx(old_density->value, 100.) ||
-                is_approx(new_density->value, 0.) || is_approx(new_density->value, 100.))
-                steps.emplace_back(posPerimeters);
-            steps.emplace_back(posPrepareInfill);
-        } else if (opt_key == "internal_solid_infill_line_width") {
-            // This value is used for calculating perimeter - infill overlap, thus perimeters need to be recalculated.
-            steps.emplace_back(posPerimeters);
-            steps.emplace_back(posPrepareInfill);
-        } else if (
-               opt_key == "outer_wall_line_width"
-            || opt_key == "wall_filament"
-            || opt_key == "fuzzy_skin"
-            || opt_key == "fuzzy_skin_thickness"
-            || opt_key == "fuzzy_skin_point_distance"
-            || opt_key == "fuzzy_skin_first_layer"
-            || opt_key == "detect_overhang_wall"
-            || opt_key == "overhang_reverse"
-            || opt_key == "overhang_reverse_internal_only"
-            || opt_key == "overhang_reverse_threshold"
-            || opt_key == "wall_direction"
-            //BBS
-            || opt_key == "enable_overhang_speed"
-            || opt_key == "detect_thin_wall"
-            || opt_key == "precise_outer_wall"
-            || opt_key == "overhang_speed_classic") {
-            steps.emplace_back(posPerimeters);
-            steps.emplace_back(posSupportMaterial);
+            return is_approx(old_density->value, 0.) || is_approx(old_density->value, 100.) ||
+                   is_approx(new_density->value, 0.) || is_approx(new_density->value, 100.);
         } else if (opt_key == "bridge_flow" || opt_key == "internal_bridge_flow") {
-            if (m_config.support_top_z_distance > 0.) {
-            	// Only invalidate due to bridging if bridging is enabled.
-            	// If later "support_top_z_distance" is modified, the complete PrintObject is invalidated anyway.
-            	steps.emplace_back(posPerimeters);
-            	steps.emplace_back(posInfill);
-	            steps.emplace_back(posSupportMaterial);
-	        }
-        } else if (
-                opt_key == "wall_generator"
-            || opt_key == "wall_transition_length"
-            || opt_key == "wall_transition_filter_deviation"
-            || opt_key == "wall_transition_angle"
-            || opt_key == "wall_distribution_count"
-            || opt_key == "min_feature_size"
-            || opt_key == "min_length_factor"
-            || opt_key == "min_bead_width") {
-            steps.emplace_back(posSlice);
-        } else if (
-               opt_key == "seam_position"
-            || opt_key == "seam_slope_type"
-            || opt_key == "seam_slope_conditional"
-            || opt_key == "scarf_angle_threshold"
-            || opt_key == "scarf_overhang_threshold"
-            || opt_key == "scarf_joint_speed"
-            || opt_key == "scarf_joint_flow_ratio"
-            || opt_key == "seam_slope_start_height"
-            || opt_key == "seam_slope_entire_loop"
-            || opt_key == "seam_slope_min_length"
-            || opt_key == "seam_slope_steps"
-            || opt_key == "seam_slope_inner_walls"
-            || opt_key == "support_speed"
-            || opt_key == "support_interface_speed"
-            || opt_key == "overhang_1_4_speed"
-            || opt_key == "overhang_2_4_speed"
-            || opt_key == "overhang_3_4_speed"
-            || opt_key == "overhang_4_4_speed"
-            || opt_key == "bridge_speed"
-            || opt_key == "internal_bridge_speed"
-            || opt_key == "outer_wall_speed"
-            || opt_key == "small_perimeter_speed"
-            || opt_key == "small_perimeter_threshold"
-            || opt_key == "sparse_infill_speed"
-            || opt_key == "inner_wall_speed"
-            || opt_key == "internal_solid_infill_speed"
-            || opt_key == "top_surface_speed"
-            || opt_key == "bed_mesh_min"
-            || opt_key == "bed_mesh_max"
-            || opt_key == "adaptive_bed_mesh_margin"
-            || opt_key == "bed_mesh_probe_distance") {
-            invalidated |= m_print->invalidate_step(psGCodeExport);
-        } else if (
-               opt_key == "flush_into_infill"
-            || opt_key == "flush_into_objects"
-            || opt_key == "flush_into_support") {
-            invalidated |= m_print->invalidate_step(psWipeTower);
-            invalidated |= m_print->invalidate_step(psGCodeExport);
-        } else {
+            // Only invalidate due to bridging if bridging is enabled.
+            // If later "support_top_z_distance" is modified, the complete PrintObject is invalidated anyway.
+            return m_config.support_top_z_distance > 0.;
+        }
+        return true;
+    };
+
+    std::vector<PrintObjectStep> steps;
+    bool invalidated = false;
+    for (const t_config_option_key &opt_key : opt_keys) {
+        std::vector<PrintObjectStep> conditional_steps;
+        std::vector<PrintStep>       print_steps;
+        if (! steps_invalidated_by_config_option(opt_key, steps, conditional_steps, print_steps)) {
             // for legacy, if we can't handle this option let's invalidate all steps
             this->invalidate_all_steps();
             invalidated = true;
+            continue;
         }
+        if (! conditional_steps.empty() && conditional_steps_invalidated(opt_key))
+            append(steps, conditional_steps);
+        for (PrintStep step : print_steps)
+            invalidated |= m_print->invalidate_step(step);
     }
 
     sort_remove_duplicates(steps);
-    for (PrintObjectStep step : steps)
-        invalidated |= this->invalidate_step(step);
+    if (region != nullptr && steps.size() == 1 && steps.front() == posInfill)
+        // Just the infill of a single region changed, fill again only the layers containing the region.
+        invalidated |= this->invalidate_infill_region(*region);
+    else
+        for (PrintObjectStep step : steps)
+            invalidated |= this->invalidate_step(step);
     return invalidated;
 }
 
@@ -1201,6 +1237,12 @@ bool PrintObject::invalidate_step(PrintObjectStep step)
 {
 	bool invalidated = Inherited::invalidate_step(step);
 
+    // The step and the steps depending on it will process all layers.
+    m_dirty_layer_ranges[step].clear();
+    if (step == posSlice || step == posPerimeters || step == posPrepareInfill || step == posInfill)
+        for (PrintObjectStep s : { posInfill, posIroning, posSimplifyInfill })
+            m_dirty_layer_ranges[s].clear();
+
     // propagate to dependent steps
     if (step == posPerimeters) {
 		invalidated |= this->invalidate_steps({ posPrepareInfill, posInfill, posIroning, posSimplifyPath, posSimplifyInfill });
@@ -1235,9 +1277,64 @@ bool PrintObject::invalidate_all_steps()
     bool result = Inherited::invalidate_all_steps() | m_print->invalidate_all_steps();
 	// Then reset some of the depending values.
 	m_slicing_params.valid = false;
+    for (std::vector<std::pair<size_t, size_t>> &ranges : m_dirty_layer_ranges)
+        ranges.clear();
 	return result;
 }
 
+bool PrintObject::invalidate_infill_layers(size_t first_layer, size_t last_layer)
+{
+    // Only the infill and the steps depending on it process each layer independently of the other layers.
+    // Each of these steps has to be finished or partially invalidated already, as a step processing all layers
+    // would not regenerate the infill of the other layers, while the ironing would be added to their infill twice.
+    static constexpr PrintObjectStep steps[] = { posInfill, posIroning, posSimplifyInfill };
+    bool partial = first_layer < last_layer &&
+        std::all_of(std::begin(steps), std::end(steps), [this](PrintObjectStep s) { return this->is_step_done_unguarded(s) || ! m_dirty_layer_ranges[s].empty(); });
+    std::vector<std::pair<size_t, size_t>> ranges[std::size(steps)];
+    if (partial)
+        for (size_t i = 0; i < std::size(steps); ++ i) {
+            ranges[i] = m_dirty_layer_ranges[steps[i]];
+            ranges[i].emplace_back(first_layer, last_layer);
+        }
+    bool invalidated = this->invalidate_step(posInfill);
+    if (partial)
+        for (size_t i = 0; i < std::size(steps); ++ i)
+            m_dirty_layer_ranges[steps[i]] = std::move(ranges[i]);
+    return invalidated;
+}
+
+bool PrintObject::invalidate_infill_region(const PrintRegion &region)
+{
+    size_t first_layer = m_layers.size();
+    size_t last_layer  = 0;
+    // The region slices are only stable once the infill regions were prepared.
+    if (int region_id = region.print_object_region_id(); region_id >= 0 && this->is_step_done_unguarded(posPrepareInfill))
+        for (size_t layer_id = 0; layer_id < m_layers.size(); ++ layer_id)
+            if (const Layer *layer = m_layers[layer_id]; region_id < int(layer->region_count()) && ! layer->get_region(region_id)->slices.empty()) {
+                first_layer = std::min(first_layer, layer_id);
+                last_layer  = layer_id + 1;
+            }
+    if (first_layer >= last_layer)
+        return this->invalidate_step(posInfill);
+    // The infill of a layer is generated from the fill surfaces of that layer only, thus the neighbor layers are kept.
+    return this->invalidate_infill_layers(first_layer, last_layer);
+}
+
+std::vector<size_t> PrintObject::layers_to_process(PrintObjectStep step) const
+{
+    std::vector<size_t> out;
+    if (m_dirty_layer_ranges[step].empty()) {
+        out.assign(m_layers.size(), 0);
+        std::iota(out.begin(), out.end(), 0);
+    } else {
+        for (const std::pair<size_t, size_t> &range : m_dirty_layer_ranges[step])
+            for (size_t layer_id = range.first; layer_id < std::min(range.second, m_layers.size()); ++ layer_id)
+                out.emplace_back(layer_id);
+        sort_remove_duplicates(out);
+    }
+    return out;
+}
+
 // This function analyzes slices of a region (SurfaceCollection slices).
 // Each region slice (instance of Surface) is analyzed, whether it is supported or whether it is the top surface.
 // Initially all slices are of type stInternal.
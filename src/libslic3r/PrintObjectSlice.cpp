@@ -7,6 +7,7 @@
 #include "Interlocking/InterlockingGenerator.hpp"
 //BBS
 #include "ShortestPath.hpp"
+#include "Trace.hpp"
 
 #include <boost/log/trivial.hpp>
 
@@ -19,6 +20,31 @@ namespace Slic3r {
 
 bool PrintObject::clip_multipart_objects = true;
 bool PrintObject::infill_only_where_needed = false;
+bool PrintObject::retain_volume_slices = true;
+
+// Slices of a single ModelVolume produced by the last slicing of a PrintObject, together with the mesh and the slicing
+// parameters they were produced with. Each layer is sliced independently, thus after a change of the layer height profile
+// only the layers at new Z positions need to be sliced again.
+struct VolumeSlicesCacheEntry
+{
+    std::shared_ptr<const TriangleMesh> mesh;
+    MeshSlicingParamsEx                 params;
+    // Sorted Z positions and their slices.
+    std::vector<float>                  zs;
+    std::vector<ExPolygons>             slices;
+};
+
+struct VolumeSlicesCache
+{
+    std::map<ObjectID, VolumeSlicesCacheEntry> volumes;
+};
+
+static inline bool slicing_params_equal(const MeshSlicingParamsEx &l, const MeshSlicingParamsEx &r)
+{
+    return l.mode == r.mode && l.mode_below == r.mode_below && l.slicing_mode_normal_below_layer == r.slicing_mode_normal_below_layer &&
+           l.closing_radius == r.closing_radius && l.extra_offset == r.extra_offset && l.resolution == r.resolution &&
+           l.trafo.matrix() == r.trafo.matrix();
+}
 
 LayerPtrs new_layers(
     PrintObject                 *print_object,
@@ -46,23 +72,55 @@ LayerPtrs new_layers(
 }
 
 // Slice single triangle mesh.
+// If cache is provided, the slices at Z positions already sliced with the same mesh and parameters are reused,
+// and the cache is updated with the new slices.
 static std::vector<ExPolygons> slice_volume(
     const ModelVolume             &volume,
     const std::vector<float>      &zs,
     const MeshSlicingParamsEx     &params,
-    const std::function<void()>   &throw_on_cancel_callback)
+    const std::function<void()>   &throw_on_cancel_callback,
+    VolumeSlicesCacheEntry        *cache = nullptr)
 {
     std::vector<ExPolygons> layers;
     if (! zs.empty()) {
-        indexed_triangle_set its = volume.mesh().its;
-        if (its.indices.size() > 0) {
-            MeshSlicingParamsEx params2 { params };
-            params2.trafo = params2.trafo * volume.get_matrix();
-            if (params2.trafo.rotation().determinant() < 0.)
-                its_flip_triangles(its);
-            layers = slice_mesh_ex(its, zs, params2, throw_on_cancel_callback);
-            throw_on_cancel_callback();
+        MeshSlicingParamsEx params2 { params };
+        params2.trafo = params2.trafo * volume.get_matrix();
+        // With slicing_mode_normal_below_layer set, the slicing mode depends on the layer index, not on its Z position.
+        const bool cacheable = cache != nullptr && params2.slicing_mode_normal_below_layer == 0;
+        std::vector<float>  zs_missing;
+        std::vector<size_t> idx_missing;
+        const bool reuse = cacheable && cache->mesh == volume.mesh_ptr() && slicing_params_equal(cache->params, params2);
+        if (reuse) {
+            layers.assign(zs.size(), ExPolygons());
+            for (size_t i = 0; i < zs.size(); ++ i)
+                if (auto it = std::lower_bound(cache->zs.begin(), cache->zs.end(), zs[i]); it != cache->zs.end() && *it == zs[i])
+                    layers[i] = cache->slices[it - cache->zs.begin()];
+                else {
+                    zs_missing.emplace_back(zs[i]);
+                    idx_missing.emplace_back(i);
+                }
+        }
+        if (! reuse || ! zs_missing.empty()) {
+            indexed_triangle_set its = volume.mesh().its;
+            if (its.indices.size() > 0) {
+                if (params2.trafo.rotation().determinant() < 0.)
+                    its_flip_triangles(its);
+                std::vector<ExPolygons> sliced = slice_mesh_ex(its, reuse ? zs_missing : zs, params2, throw_on_cancel_callback);
+                throw_on_cancel_callback();
+                if (reuse) {
+                    for (size_t i = 0; i < sliced.size(); ++ i)
+                        layers[idx_missing[i]] = std::move(sliced[i]);
+                } else
+                    layers = std::move(sliced);
+            }
         }
+        if (cacheable && layers.size() == zs.size()) {
+            cache->mesh   = volume.mesh_ptr();
+            cache->params = params2;
+            cache->zs     = zs;
+            cache->slices = layers;
+        } else if (cache)
+            *cache = {};
     }
     return layers;
 }
@@ -74,13 +132,14 @@ static std::vector<ExPolygons> slice_volume(
     const std::vector<float>                    &z,
     const std::vector<t_layer_height_range>     &ranges,
     const MeshSlicingParamsEx                   &params,
-    const std::function<void()>                 &throw_on_cancel_callback)
+    const std::function<void()>                 &throw_on_cancel_callback,
+    VolumeSlicesCacheEntry                      *cache = nullptr)
 {
     std::vector<ExPolygons> out;
     if (! z.empty() && ! ranges.empty()) {
         if (ranges.size() == 1 && z.front() >= ranges.front().first && z.back() < ranges.front().second) {
             // All layers fit into a single range.
-            out = slice_volume(volume, z, params, throw_on_cancel_callback);
+            out = slice_volume(volume, z, params, throw_on_cancel_callback, cache);
         } else {
             std::vector<float>                     z_filtered;
             std::vector<std::pair<size_t, size_t>> n_filtered;
@@ -96,7 +155,7 @@ static std::vector<ExPolygons> slice_volume(
                     n_filtered.emplace_back(std::make_pair(first, i));
             }
             if (! n_filtered.empty()) {
-                std::vector<ExPolygons> layers = slice_volume(volume, z_filtered, params, throw_on_cancel_callback);
+                std::vector<ExPolygons> layers = slice_volume(volume, z_filtered, params, throw_on_cancel_callback, cache);
                 out.assign(z.size(), ExPolygons());
                 i = 0;
                 for (const std::pair<size_t, size_t> &span : n_filtered)
@@ -117,6 +176,7 @@ static inline bool model_volume_needs_slicing(const ModelVolume &mv)
 // Apply closing radius.
 // Apply positive XY compensation to ModelVolumeType::MODEL_PART and ModelVolumeType::PARAMETER_MODIFIER, not to ModelVolumeType::NEGATIVE_VOLUME.
 // Apply contour simplification.
+// If cache is provided, slices of the previous slicing are reused and the cache is updated.
 static std::vector<VolumeSlices> slice_volumes_inner(
     const PrintConfig                                        &print_config,
     const PrintObjectConfig                                  &print_object_config,
@@ -124,10 +184,20 @@ static std::vector<VolumeSlices> slice_volumes_inner(
     ModelVolumePtrs                                           model_volumes,
     const std::vector<PrintObjectRegions::LayerRangeRegions> &layer_ranges,
     const std::vector<float>                                 &zs,
-    const std::function<void()>                              &throw_on_cancel_callback)
+    const std::function<void()>                              &throw_on_cancel_callback,
+    VolumeSlicesCache                                        *cache = nullptr)
 {
     model_volumes_sort_by_id(model_volumes);
 
+    // Drop the cached slices of volumes, which were deleted or which are not sliced anymore.
+    if (cache)
+        for (auto it = cache->volumes.begin(); it != cache->volumes.end();)
+            if (std::any_of(model_volumes.cbegin(), model_volumes.cend(),
+                    [id = it->first](const ModelVolume *mv) { return mv->id() == id && model_volume_needs_slicing(*mv); }))
+                ++ it;
+            else
+                it = cache->volumes.erase(it);
+
     std::vector<VolumeSlices> out;
     out.reserve(model_volumes.size());
 
@@ -160,9 +230,11 @@ static std::vector<VolumeSlices> slice_volumes_inner(
 
     for (const ModelVolume *model_volume : model_volumes)
         if (model_volume_needs_slicing(*model_volume)) {
+            Trace::Span span("slice_volume", "slicing", model_volume->name);
             MeshSlicingParamsEx params { params_base };
             if (! model_volume->is_negative_volume())
                 params.extra_offset = extra_offset;
+            VolumeSlicesCacheEntry *cache_entry = cache ? &cache->volumes[model_volume->id()] : nullptr;
             if (layer_ranges.size() == 1) {
                 if (const PrintObjectRegions::LayerRangeRegions &layer_range = layer_ranges.front(); layer_range.has_volume(model_volume->id())) {
                     if (model_volume->is_model_part() && print_config.spiral_mode) {
@@ -178,7 +250,7 @@ static std::vector<VolumeSlices> slice_volumes_inner(
                     }
                     out.push_back({
                         model_volume->id(),
-                        slice_volume(*model_volume, zs, params, throw_on_cancel_callback)
+                        slice_volume(*model_volume, zs, params, throw_on_cancel_callback, cache_entry)
                     });
                 }
             } else {
@@ -190,7 +262,7 @@ static std::vector<VolumeSlices> slice_volumes_inner(
                 if (! slicing_ranges.empty())
                     out.push_back({
                         model_volume->id(),
-                        slice_volume(*model_volume, zs, slicing_ranges, params, throw_on_cancel_callback)
+                        slice_volume(*model_volume, zs, slicing_ranges, params, throw_on_cancel_callback, cache_entry)
                     });
             }
             if (! out.empty() && out.back().slices.empty())
@@ -318,6 +390,7 @@ static std::vector<std::vector<ExPolygons>> slices_to_regions(
             tbb::blocked_range<size_t>(0, zs_complex.size()),
             [&slices_by_region, &print_object_regions, &zs_complex, &layer_ranges_regions_to_slices, clip_multipart_objects, &throw_on_cancel_callback]
                 (const tbb::blocked_range<size_t> &range) {
+                Trace::Span span("slices_to_regions", "slicing");
                 float z              = zs_complex[range.begin()].second;
                 auto  it_layer_range = layer_range_first(print_object_regions.layer_ranges, z);
                 // Per volume_regions slices at this Z height.
@@ -824,6 +897,7 @@ void PrintObject::slice()
     tbb::parallel_for(
         tbb::blocked_range<size_t>(0, m_layers.size()),
         [this](const tbb::blocked_range<size_t>& range) {
+            Trace::Span span("update_lslices", "slicing");
             for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx) {
                 m_print->throw_if_canceled();
                 Layer &layer = *m_layers[layer_idx];
@@ -850,6 +924,7 @@ static inline void apply_mm_segmentation(PrintObject &print_object, ThrowOnCance
     tbb::parallel_for(
         tbb::blocked_range<size_t>(0, segmentation.size(), std::max(segmentation.size() / 128, size_t(1))),
         [&print_object, &segmentation, throw_on_cancel](const tbb::blocked_range<size_t> &range) {
+            Trace::Span span("apply_mm_segmentation", "slicing");
             const auto  &layer_ranges   = print_object.shared_regions()->layer_ranges;
             double       z              = print_object.get_layer(range.begin())->slice_z;
             auto         it_layer_range = layer_range_first(layer_ranges, z);
@@ -999,10 +1074,15 @@ void PrintObject::slice_volumes()
 
     std::vector<float>                   slice_zs      = zs_from_layers(m_layers);
     std::vector<VolumeSlices> objSliceByVolume;
+    if (! PrintObject::retain_volume_slices)
+        m_volume_slices_cache.reset();
+    else if (! m_volume_slices_cache)
+        m_volume_slices_cache = std::make_shared<VolumeSlicesCache>();
     if (!slice_zs.empty()) {
         objSliceByVolume = slice_volumes_inner(
             print->config(), this->config(), this->trafo_centered(),
-            this->model_object()->volumes, m_shared_regions->layer_ranges, slice_zs, throw_on_cancel_callback);
+            this->model_object()->volumes, m_shared_regions->layer_ranges, slice_zs, throw_on_cancel_callback,
+            m_volume_slices_cache.get());
     }
 
     //BBS: "model_part" volumes are grouded according to their connections
@@ -1078,6 +1158,7 @@ void PrintObject::slice_volumes()
 	    tbb::parallel_for(
 	        tbb::blocked_range<size_t>(0, m_layers.size()),
 			[this, xy_hole_scaled, xy_contour_scaled, elephant_foot_compensation_scaled, &lslices_elfoot_uncompensated](const tbb::blocked_range<size_t>& range) {
+	            Trace::Span span("size_compensation", "slicing");
 	            for (size_t layer_id = range.begin(); layer_id < range.end(); ++ layer_id) {
 	                m_print->throw_if_canceled();
 	                Layer *layer = m_layers[layer_id];
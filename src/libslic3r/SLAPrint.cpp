@@ -27,6 +27,28 @@
 
 namespace Slic3r {
 
+const char* print_step_name(SLAPrintStep step)
+{
+    switch (step) {
+    case slapsMergeSlicesAndEval:   return "merge_slices_and_eval";
+    case slapsRasterize:            return "rasterize";
+    default:                        return "unknown";
+    }
+}
+
+const char* print_step_name(SLAPrintObjectStep step)
+{
+    switch (step) {
+    case slaposHollowing:       return "hollowing";
+    case slaposDrillHoles:      return "drill_holes";
+    case slaposObjectSlice:     return "object_slice";
+    case slaposSupportPoints:   return "support_points";
+    case slaposSupportTree:     return "support_tree";
+    case slaposPad:             return "pad";
+    case slaposSliceSupports:   return "slice_supports";
+    default:                    return "unknown";
+    }
+}
 
 bool is_zero_elevation(const SLAPrintObjectConfig &c)
 {
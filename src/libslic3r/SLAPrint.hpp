@@ -30,6 +30,10 @@ enum SLAPrintObjectStep : unsigned int {
 	slaposCount
 };
 
+// Names of the steps as shown in the slicing trace.
+const char* print_step_name(SLAPrintStep step);
+const char* print_step_name(SLAPrintObjectStep step);
+
 class SLAPrint;
 class GLCanvas;
 
@@ -0,0 +1,178 @@
+#include "Trace.hpp"
+#include "Thread.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+#include <boost/log/trivial.hpp>
+#include <boost/nowide/fstream.hpp>
+
+namespace Slic3r {
+namespace Trace {
+
+namespace detail {
+    std::atomic<bool> g_enabled { false };
+}
+
+namespace {
+
+struct Event
+{
+    const char  *name;
+    const char  *category;
+    TimePoint    start;
+    TimePoint    end;
+    std::string  detail;
+};
+
+struct ThreadBuffer
+{
+    // Only locked by the owning thread when recording and by export_chrome_trace() / clear().
+    std::mutex          mutex;
+    size_t              thread_id;
+    std::string         thread_name;
+    std::vector<Event>  events;
+};
+
+struct Registry
+{
+    std::mutex                                  mutex;
+    std::vector<std::shared_ptr<ThreadBuffer>>  buffers;
+    // Time stamps of the exported trace are relative to the first use of the trace.
+    TimePoint                                   epoch { Clock::now() };
+};
+
+Registry& registry()
+{
+    static Registry s_registry;
+    return s_registry;
+}
+
+ThreadBuffer& thread_buffer()
+{
+    // The buffer is shared with the registry, so that the spans of the threads already finished are exported as well.
+    thread_local std::shared_ptr<ThreadBuffer> buffer = []() {
+        auto out = std::make_shared<ThreadBuffer>();
+        if (std::optional<std::string> name = get_current_thread_name(); name)
+            out->thread_name = *name;
+        Registry &reg = registry();
+        std::scoped_lock<std::mutex> lock(reg.mutex);
+        out->thread_id = reg.buffers.size() + 1;
+        reg.buffers.emplace_back(out);
+        return out;
+    }();
+    return *buffer;
+}
+
+void append_json_string(std::string &out, const std::string_view str)
+{
+    out += '"';
+    for (char c : str) {
+        switch (c) {
+        case '"':  out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n";  break;
+        case '\t': out += "\\t";  break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                char buf[8];
+                snprintf(buf, sizeof(buf), "\\u%04x", int(c));
+                out += buf;
+            } else
+                out += c;
+        }
+    }
+    out += '"';
+}
+
+} // anonymous namespace
+
+void enable(bool enable)
+{
+    // Make sure the epoch is set before the first span is recorded.
+    registry();
+    detail::g_enabled.store(enable, std::memory_order_relaxed);
+}
+
+void clear()
+{
+    Registry &reg = registry();
+    std::scoped_lock<std::mutex> lock(reg.mutex);
+    for (std::shared_ptr<ThreadBuffer> &buffer : reg.buffers) {
+        std::scoped_lock<std::mutex> buffer_lock(buffer->mutex);
+        buffer->events.clear();
+    }
+}
+
+void add_span(const char *name, const char *category, TimePoint start, TimePoint end, std::string detail)
+{
+    ThreadBuffer &buffer = thread_buffer();
+    std::scoped_lock<std::mutex> lock(buffer.mutex);
+    buffer.events.push_back({ name, category, start, end, std::move(detail) });
+}
+
+bool export_chrome_trace(const std::string &path)
+{
+    auto to_us = [epoch = registry().epoch](TimePoint t) {
+        return std::chrono::duration_cast<std::chrono::microseconds>(t - epoch).count();
+    };
+
+    std::string out = "{\"traceEvents\":[\n";
+    bool        first = true;
+    {
+        Registry &reg = registry();
+        std::scoped_lock<std::mutex> lock(reg.mutex);
+        for (const std::shared_ptr<ThreadBuffer> &buffer : reg.buffers) {
+            std::scoped_lock<std::mutex> buffer_lock(buffer->mutex);
+            if (buffer->events.empty())
+                continue;
+            const std::string tid = std::to_string(buffer->thread_id);
+            if (! buffer->thread_name.empty()) {
+                out += first ? "" : ",\n";
+                first = false;
+                out += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" + tid + ",\"args\":{\"name\":";
+                append_json_string(out, buffer->thread_name);
+                out += "}}";
+            }
+            for (const Event &event : buffer->events) {
+                out += first ? "" : ",\n";
+                first = false;
+                out += "{\"name\":";
+                append_json_string(out, event.name);
+                out += ",\"cat\":";
+                append_json_string(out, event.category);
+                out += ",\"ph\":\"X\",\"pid\":1,\"tid\":" + tid +
+                       ",\"ts\":" + std::to_string(to_us(event.start)) +
+                       ",\"dur\":" + std::to_string(to_us(event.end) - to_us(event.start));
+                if (! event.detail.empty()) {
+                    out += ",\"args\":{\"detail\":";
+                    append_json_string(out, event.detail);
+                    out += '}';
+                }
+                out += '}';
+            }
+        }
+    }
+    out += "\n]}\n";
+
+    boost::nowide::ofstream file(path, std::ios::binary);
+    if (! file.is_open()) {
+        BOOST_LOG_TRIVIAL(error) << "Failed to open the trace file " << path;
+        return false;
+    }
+    file.write(out.data(), out.size());
+    file.close();
+    if (file.fail()) {
+        BOOST_LOG_TRIVIAL(error) << "Failed to write the trace file " << path;
+        return false;
+    }
+    BOOST_LOG_TRIVIAL(info) << "Exported the slicing trace to " << path;
+    return true;
+}
+
+} // namespace Trace
+} // namespace Slic3r
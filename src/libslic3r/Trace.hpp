@@ -0,0 +1,65 @@
+#ifndef slic3r_Trace_hpp_
+#define slic3r_Trace_hpp_
+
+#include <atomic>
+#include <chrono>
+#include <string>
+
+namespace Slic3r {
+
+// Tracing of the slicing pipeline: the PrintSteps, PrintObjectSteps, slicing tasks and G-code export filters
+// record their spans, which are exported in the Chrome trace format (chrome://tracing, ui.perfetto.dev).
+// Tracing is disabled by default, then a Span costs just a relaxed load of an atomic flag.
+// Spans are collected into per-thread buffers, thus the TBB worker threads do not contend when recording.
+namespace Trace {
+
+using Clock     = std::chrono::steady_clock;
+using TimePoint = Clock::time_point;
+
+namespace detail {
+    extern std::atomic<bool> g_enabled;
+}
+
+inline bool enabled() { return detail::g_enabled.load(std::memory_order_relaxed); }
+// Start or stop recording. The spans recorded so far are kept until clear() is called.
+void        enable(bool enable);
+// Drop all the recorded spans.
+void        clear();
+// Record a finished span. Name and category have to be string literals or otherwise outlive the recorded trace.
+// Detail is an optional text shown as an argument of the span.
+void        add_span(const char *name, const char *category, TimePoint start, TimePoint end, std::string detail = std::string());
+// Write the recorded spans into a Chrome trace JSON file. Returns false if the file could not be written.
+bool        export_chrome_trace(const std::string &path);
+
+// Records the life time of a scope as a span.
+class Span
+{
+public:
+    Span(const char *name, const char *category) : m_name(name), m_category(category), m_active(enabled()) {
+        if (m_active)
+            m_start = Clock::now();
+    }
+    Span(const char *name, const char *category, std::string detail) : Span(name, category) {
+        if (m_active)
+            m_detail = std::move(detail);
+    }
+    ~Span() {
+        if (m_active)
+            add_span(m_name, m_category, m_start, Clock::now(), std::move(m_detail));
+    }
+
+private:
+    Span(const Span&) = delete;
+    Span& operator=(const Span&) = delete;
+
+    const char  *m_name;
+    const char  *m_category;
+    bool         m_active;
+    TimePoint    m_start;
+    std::string  m_detail;
+};
+
+} // namespace Trace
+} // namespace Slic3r
+
+#endif // slic3r_Trace_hpp_
@@ -211,6 +211,13 @@ bool TriangleMesh::from_stl(stl_file& stl, bool repair)
 
 bool TriangleMesh::ReadSTLFile(const char *input_file, bool repair, ImportstlProgressFn stlFn, int custom_header_length)
 {
+    if (! repair) {
+        // The facets of stl_file are only needed by the repair, load the indexed triangle set directly.
+        if (! its_read_stl(this->its, input_file, stlFn, custom_header_length))
+            return false;
+        fill_initial_stats(this->its, m_stats);
+        return true;
+    }
     stl_file stl;
     if (!stl_open(&stl, input_file, stlFn, custom_header_length))
         return false;
@@ -18,6 +18,10 @@
 
 #include <tbb/parallel_for.h>
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#endif
+
 #ifndef NDEBUG
 //    #define EXPENSIVE_DEBUG_CHECKS
 #endif // NDEBUG
@@ -472,6 +476,106 @@ static FacetSliceType slice_facet_for_cut_mesh(
     return FacetSliceType::NoSlice;
 }
 
+// Number of slice planes intersected with a facet at once by slice_facet_at_zs().
+static constexpr size_t slice_facet_batch_size = 8;
+// Facets crossing up to this number of slice planes are sliced plane by plane, the batch setup does not pay off.
+static constexpr size_t slice_facet_batch_min_planes = 3;
+
+// Facet edge, its end points sorted by the vertex index, so that the intersection points are calculated
+// exactly the same way slice_facet() calculates them.
+struct SliceFacetEdge {
+    double a[3];
+    double b[3];
+    float  min_z;
+    float  max_z;
+    int    edge_id;
+};
+
+using SliceFacetBatch = double[3][slice_facet_batch_size];
+
+// Intersect the three edges of a facet with a batch of planes: the parameter t of the intersection along each edge
+// and the intersection point rounded the same way slice_facet() rounds it. The compiler does not vectorize the division
+// and floor() reliably, thus the SSE4.1 and AVX variants below are written with intrinsics and selected at runtime.
+// They perform the same operations in the same order as this reference implementation, thus their results are bit identical.
+static void slice_facet_batch_generic(const SliceFacetEdge *edges, const float *zs, SliceFacetBatch &t, SliceFacetBatch &x, SliceFacetBatch &y)
+{
+    for (int j = 0; j < 3; ++ j) {
+        const SliceFacetEdge &edge = edges[j];
+        const double          dz   = edge.a[2] - edge.b[2];
+        for (size_t i = 0; i < slice_facet_batch_size; ++ i) {
+            t[j][i] = (double(zs[i]) - edge.b[2]) / dz;
+            x[j][i] = floor(edge.b[0] + (edge.a[0] - edge.b[0]) * t[j][i] + 0.5);
+            y[j][i] = floor(edge.b[1] + (edge.a[1] - edge.b[1]) * t[j][i] + 0.5);
+        }
+    }
+}
+
+using SliceFacetBatchFn = void (*)(const SliceFacetEdge *edges, const float *zs, SliceFacetBatch &t, SliceFacetBatch &x, SliceFacetBatch &y);
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SLIC3R_SLICE_FACET_BATCH_DISPATCH
+
+__attribute__((target("sse4.1")))
+static void slice_facet_batch_sse41(const SliceFacetEdge *edges, const float *zs, SliceFacetBatch &t, SliceFacetBatch &x, SliceFacetBatch &y)
+{
+    const __m128d half = _mm_set1_pd(0.5);
+    for (int j = 0; j < 3; ++ j) {
+        const SliceFacetEdge &edge = edges[j];
+        const __m128d bx = _mm_set1_pd(edge.b[0]);
+        const __m128d by = _mm_set1_pd(edge.b[1]);
+        const __m128d bz = _mm_set1_pd(edge.b[2]);
+        const __m128d dx = _mm_set1_pd(edge.a[0] - edge.b[0]);
+        const __m128d dy = _mm_set1_pd(edge.a[1] - edge.b[1]);
+        const __m128d dz = _mm_set1_pd(edge.a[2] - edge.b[2]);
+        for (size_t i = 0; i < slice_facet_batch_size; i += 2) {
+            const __m128d ti = _mm_div_pd(_mm_sub_pd(_mm_set_pd(double(zs[i + 1]), double(zs[i])), bz), dz);
+            _mm_storeu_pd(&t[j][i], ti);
+            _mm_storeu_pd(&x[j][i], _mm_floor_pd(_mm_add_pd(_mm_add_pd(bx, _mm_mul_pd(dx, ti)), half)));
+            _mm_storeu_pd(&y[j][i], _mm_floor_pd(_mm_add_pd(_mm_add_pd(by, _mm_mul_pd(dy, ti)), half)));
+        }
+    }
+}
+
+__attribute__((target("avx")))
+static void slice_facet_batch_avx(const SliceFacetEdge *edges, const float *zs, SliceFacetBatch &t, SliceFacetBatch &x, SliceFacetBatch &y)
+{
+    const __m256d half = _mm256_set1_pd(0.5);
+    for (int j = 0; j < 3; ++ j) {
+        const SliceFacetEdge &edge = edges[j];
+        const __m256d bx = _mm256_set1_pd(edge.b[0]);
+        const __m256d by = _mm256_set1_pd(edge.b[1]);
+        const __m256d bz = _mm256_set1_pd(edge.b[2]);
+        const __m256d dx = _mm256_set1_pd(edge.a[0] - edge.b[0]);
+        const __m256d dy = _mm256_set1_pd(edge.a[1] - edge.b[1]);
+        const __m256d dz = _mm256_set1_pd(edge.a[2] - edge.b[2]);
+        for (size_t i = 0; i < slice_facet_batch_size; i += 4) {
+            const __m256d ti = _mm256_div_pd(_mm256_sub_pd(_mm256_cvtps_pd(_mm_loadu_ps(zs + i)), bz), dz);
+            _mm256_storeu_pd(&t[j][i], ti);
+            _mm256_storeu_pd(&x[j][i], _mm256_floor_pd(_mm256_add_pd(_mm256_add_pd(bx, _mm256_mul_pd(dx, ti)), half)));
+            _mm256_storeu_pd(&y[j][i], _mm256_floor_pd(_mm256_add_pd(_mm256_add_pd(by, _mm256_mul_pd(dy, ti)), half)));
+        }
+    }
+}
+#endif // SLIC3R_SLICE_FACET_BATCH_DISPATCH
+
+// Select the fastest variant of slice_facet_batch_generic() supported by the CPU.
+static SliceFacetBatchFn slice_facet_batch_fn()
+{
+#ifdef SLIC3R_SLICE_FACET_BATCH_DISPATCH
+    static const SliceFacetBatchFn fn = []() -> SliceFacetBatchFn {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx"))
+            return slice_facet_batch_avx;
+        if (__builtin_cpu_supports("sse4.1"))
+            return slice_facet_batch_sse41;
+        return slice_facet_batch_generic;
+    }();
+    return fn;
+#else
+    return slice_facet_batch_generic;
+#endif
+}
+
 template<typename TransformVertex>
 void slice_facet_at_zs(
     // Scaled or unscaled vertices. transform_vertex_fn may scale zs.
@@ -489,21 +593,81 @@ void slice_facet_at_zs(
     // find facet extents
     const float min_z = fminf(vertices[0].z(), fminf(vertices[1].z(), vertices[2].z()));
     const float max_z = fmaxf(vertices[0].z(), fmaxf(vertices[1].z(), vertices[2].z()));
+    // Ignore horizontal triangles. Any valid horizontal triangle must have a vertical triangle connected, otherwise the part has zero volume.
+    if (min_z == max_z)
+        return;
 
     // find layer extents
     auto min_layer = std::lower_bound(zs.begin(), zs.end(), min_z); // first layer whose slice_z is >= min_z
     auto max_layer = std::upper_bound(min_layer, zs.end(), max_z); // first layer whose slice_z is > max_z
     int  idx_vertex_lowest = (vertices[1].z() == min_z) ? 1 : ((vertices[2].z() == min_z) ? 2 : 0);
 
-    for (auto it = min_layer; it != max_layer; ++ it) {
-        IntersectionLine il;
-        // Ignore horizontal triangles. Any valid horizontal triangle must have a vertical triangle connected, otherwise the part has zero volume.
-        if (min_z != max_z && slice_facet(*it, vertices, indices, edge_ids, idx_vertex_lowest, false, il) == FacetSliceType::Slicing) {
-            assert(il.edge_type != IntersectionLine::FacetEdgeType::Horizontal);
-            size_t slice_id = it - zs.begin();
-            boost::lock_guard<std::mutex> l(lines_mutex[slice_id % lines_mutex.size()]);
-            lines[slice_id].emplace_back(il);
+    auto emit = [&lines, &lines_mutex](size_t slice_id, const IntersectionLine &il) {
+        assert(il.edge_type != IntersectionLine::FacetEdgeType::Horizontal);
+        boost::lock_guard<std::mutex> l(lines_mutex[slice_id % lines_mutex.size()]);
+        lines[slice_id].emplace_back(il);
+    };
+
+    if (size_t(max_layer - min_layer) < slice_facet_batch_min_planes) {
+        // Most facets of a finely tesselated mesh cross one or two planes only, slice them plane by plane.
+        for (auto it = min_layer; it != max_layer; ++ it) {
+            IntersectionLine il;
+            if (slice_facet(*it, vertices, indices, edge_ids, idx_vertex_lowest, false, il) == FacetSliceType::Slicing)
+                emit(it - zs.begin(), il);
+        }
+        return;
+    }
+
+    // Facet edges in the order slice_facet() traverses them.
+    SliceFacetEdge edges[3];
+    for (int j = 0; j < 3; ++ j) {
+        int             k = (idx_vertex_lowest + j) % 3;
+        int             l = (k + 1) % 3;
+        SliceFacetEdge &edge = edges[j];
+        edge.edge_id = edge_ids(k);
+        if (indices[k] > indices[l])
+            std::swap(k, l);
+        for (int i = 0; i < 3; ++ i) {
+            edge.a[i] = double(vertices[k](i));
+            edge.b[i] = double(vertices[l](i));
+        }
+        edge.min_z = std::min(vertices[k].z(), vertices[l].z());
+        edge.max_z = std::max(vertices[k].z(), vertices[l].z());
+    }
+
+    // Intersect all three edges with a batch of planes at once. Planes touching a vertex
+    // or producing a degenerate intersection are resolved by slice_facet().
+    const SliceFacetBatchFn batch_fn = slice_facet_batch_fn();
+    SliceFacetBatch         t, x, y;
+    float                   batch_zs[slice_facet_batch_size];
+    for (auto it_batch = min_layer; it_batch != max_layer;) {
+        const size_t batch_size = std::min(slice_facet_batch_size, size_t(max_layer - it_batch));
+        // The last batch is padded with its last plane, so that the kernel always runs the full batch.
+        for (size_t i = 0; i < slice_facet_batch_size; ++ i)
+            batch_zs[i] = it_batch[std::min(i, batch_size - 1)];
+        batch_fn(edges, batch_zs, t, x, y);
+        for (size_t i = 0; i < batch_size; ++ i) {
+            const float      slice_z  = it_batch[i];
+            const size_t     slice_id = it_batch + i - zs.begin();
+            IntersectionLine il;
+            int              crossed[3];
+            int              num_crossed = 0;
+            if (slice_z != vertices[0].z() && slice_z != vertices[1].z() && slice_z != vertices[2].z())
+                for (int j = 0; j < 3; ++ j)
+                    if (edges[j].min_z < slice_z && slice_z < edges[j].max_z && t[j][i] > 0. && t[j][i] < 1.)
+                        crossed[num_crossed ++] = j;
+            if (num_crossed == 2) {
+                // General position, the plane crosses two edges of the facet.
+                il.edge_type = IntersectionLine::FacetEdgeType::General;
+                il.a         = Point(coord_t(x[crossed[1]][i]), coord_t(y[crossed[1]][i]));
+                il.b         = Point(coord_t(x[crossed[0]][i]), coord_t(y[crossed[0]][i]));
+                il.edge_a_id = edges[crossed[1]].edge_id;
+                il.edge_b_id = edges[crossed[0]].edge_id;
+            } else if (slice_facet(slice_z, vertices, indices, edge_ids, idx_vertex_lowest, false, il) != FacetSliceType::Slicing)
+                continue;
+            emit(slice_id, il);
         }
+        it_batch += batch_size;
     }
 }
 
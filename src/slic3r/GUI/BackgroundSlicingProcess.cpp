@@ -22,6 +22,7 @@
 #include "libslic3r/GCode/PostProcessor.hpp"
 #include "libslic3r/Format/SL1.hpp"
 #include "libslic3r/Thread.hpp"
+#include "libslic3r/Trace.hpp"
 #include "libslic3r/libslic3r.h"
 
 #include <cassert>
@@ -433,6 +434,12 @@ void BackgroundSlicingProcess::call_process_seh_throw(std::exception_ptr &ex) th
 
 void BackgroundSlicingProcess::call_process(std::exception_ptr &ex) throw()
 {
+	// Record the spans of each slicing into a Chrome trace file, if the ORCA_TRACE_FILE environment variable points to one.
+	const char *trace_file = std::getenv("ORCA_TRACE_FILE");
+	if (trace_file != nullptr && *trace_file != 0) {
+		Trace::clear();
+		Trace::enable(true);
+	}
 	try {
 		assert(m_print != nullptr);
 		switch (m_print->technology()) {
@@ -449,6 +456,8 @@ void BackgroundSlicingProcess::call_process(std::exception_ptr &ex) throw()
 		ex = std::current_exception();
 		BOOST_LOG_TRIVIAL(error) << __FUNCTION__ << ":got other exception" << std::endl;
 	}
+	if (trace_file != nullptr && *trace_file != 0)
+		Trace::export_chrome_trace(trace_file);
 }
 
 #ifdef _WIN32
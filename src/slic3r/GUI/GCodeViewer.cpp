@@ -2032,7 +2032,7 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
     };
 
     // format data into the buffers to be rendered as lines
-    auto add_vertices_as_line = [](const GCodeProcessorResult::MoveVertex& prev, const GCodeProcessorResult::MoveVertex& curr, VertexBuffer& vertices) {
+    auto add_vertices_as_line = [&gcode_result](const GCodeProcessorResult::MoveVertex& prev, const GCodeProcessorResult::MoveVertex& curr, VertexBuffer& vertices) {
         auto add_vertex = [&vertices](const Vec3f& position) {
             // add position
             vertices.push_back(position.x());
@@ -2041,10 +2041,11 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
         };
         // x component of the normal to the current segment (the normal is parallel to the XY plane)
         //BBS: Has modified a lot for this function to support arc move
-        size_t loop_num = curr.is_arc_move_with_interpolation_points() ? curr.interpolation_points.size() : 0;
+        const GCodeProcessorResult::InterpolationPoints interpolation_points = gcode_result.interpolation_points(curr);
+        size_t loop_num = curr.is_arc_move_with_interpolation_points() ? curr.interpolation_points_count : 0;
         for (size_t i = 0; i < loop_num + 1; i++) {
-            const Vec3f &previous = (i == 0? prev.position : curr.interpolation_points[i-1]);
-            const Vec3f &current = (i == loop_num? curr.position : curr.interpolation_points[i]);
+            const Vec3f &previous = (i == 0? prev.position : interpolation_points[i-1]);
+            const Vec3f &current = (i == loop_num? curr.position : interpolation_points[i]);
             // add previous vertex
             add_vertex(previous);
             // add current vertex
@@ -2061,7 +2062,7 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
             }
 
             Path& last_path = buffer.paths.back();
-            size_t loop_num = curr.is_arc_move_with_interpolation_points() ? curr.interpolation_points.size() : 0;
+            size_t loop_num = curr.is_arc_move_with_interpolation_points() ? curr.interpolation_points_count : 0;
             for (size_t i = 0; i < loop_num + 1; i++) {
                 //BBS: add previous index
                 indices.push_back(static_cast<IBufferType>(indices.size()));
@@ -2073,7 +2074,7 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
     };
 
     // format data into the buffers to be rendered as solid.
-    auto add_vertices_as_solid = [](const GCodeProcessorResult::MoveVertex& prev, const GCodeProcessorResult::MoveVertex& curr, TBuffer& buffer, unsigned int vbuffer_id, VertexBuffer& vertices, size_t move_id) {
+    auto add_vertices_as_solid = [&gcode_result](const GCodeProcessorResult::MoveVertex& prev, const GCodeProcessorResult::MoveVertex& curr, TBuffer& buffer, unsigned int vbuffer_id, VertexBuffer& vertices, size_t move_id) {
         auto store_vertex = [](VertexBuffer& vertices, const Vec3f& position, const Vec3f& normal) {
             // append position
             vertices.push_back(position.x());
@@ -2092,10 +2093,11 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
 
         Path& last_path = buffer.paths.back();
         //BBS: Has modified a lot for this function to support arc move
-        size_t loop_num = curr.is_arc_move_with_interpolation_points() ? curr.interpolation_points.size() : 0;
+        const GCodeProcessorResult::InterpolationPoints interpolation_points = gcode_result.interpolation_points(curr);
+        size_t loop_num = curr.is_arc_move_with_interpolation_points() ? curr.interpolation_points_count : 0;
         for (size_t i = 0; i < loop_num + 1; i++) {
-            const Vec3f &prev_position = (i == 0? prev.position : curr.interpolation_points[i-1]);
-            const Vec3f &curr_position = (i == loop_num? curr.position : curr.interpolation_points[i]);
+            const Vec3f &prev_position = (i == 0? prev.position : interpolation_points[i-1]);
+            const Vec3f &curr_position = (i == loop_num? curr.position : interpolation_points[i]);
 
             const Vec3f dir = (curr_position - prev_position).normalized();
             const Vec3f right = Vec3f(dir.y(), -dir.x(), 0.0f).normalized();
@@ -2186,10 +2188,11 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
             std::array<IBufferType, 8> first_seg_v_offsets = convert_vertices_offset(vbuffer_size, { 0, 1, 2, 3, 4, 5, 6, 7 });
             std::array<IBufferType, 8> non_first_seg_v_offsets = convert_vertices_offset(vbuffer_size, { -4, 0, -2, 1, 2, 3, 4, 5 });
 
-            size_t loop_num = curr.is_arc_move_with_interpolation_points() ? curr.interpolation_points.size() : 0;
+            const GCodeProcessorResult::InterpolationPoints interpolation_points = gcode_result.interpolation_points(curr);
+            size_t loop_num = curr.is_arc_move_with_interpolation_points() ? curr.interpolation_points_count : 0;
             for (size_t i = 0; i < loop_num + 1; i++) {
-                const Vec3f &prev_position = (i == 0? prev.position : curr.interpolation_points[i-1]);
-                const Vec3f &curr_position = (i == loop_num? curr.position : curr.interpolation_points[i]);
+                const Vec3f &prev_position = (i == 0? prev.position : interpolation_points[i-1]);
+                const Vec3f &curr_position = (i == loop_num? curr.position : interpolation_points[i]);
 
                 const Vec3f dir = (curr_position - prev_position).normalized();
                 const Vec3f right = Vec3f(dir.y(), -dir.x(), 0.0f).normalized();
@@ -2376,10 +2379,10 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
         //        m_paths_bounding_box.merge(move.interpolation_points[i].cast<double>());
         //else {
             if (move.type == EMoveType::Extrude && move.width != 0.0f && move.height != 0.0f)
-                for (int i = 0; i < move.interpolation_points.size(); i++) {
-                    m_paths_bounding_box.merge(move.interpolation_points[i].cast<double>());
+                for (const Vec3f &pt : gcode_result.interpolation_points(move)) {
+                    m_paths_bounding_box.merge(pt.cast<double>());
                     //BBS: use convex_hull for toolpath outside check
-                    pts.emplace_back(Point(scale_(move.interpolation_points[i].x()), scale_(move.interpolation_points[i].y())));
+                    pts.emplace_back(Point(scale_(pt.x()), scale_(pt.y())));
                 }
         //}
     }
@@ -2479,7 +2482,7 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
         // if adding the vertices for the current segment exceeds the threshold size of the current vertex buffer
         // add another vertex buffer
         // BBS: get the point number and then judge whether the remaining buffer is enough
-        size_t points_num = curr.is_arc_move_with_interpolation_points() ? curr.interpolation_points.size() + 1 : 1;
+        size_t points_num = curr.is_arc_move_with_interpolation_points() ? curr.interpolation_points_count + 1 : 1;
         size_t vertices_size_to_add = (t_buffer.render_primitive_type == TBuffer::ERenderPrimitiveType::BatchedModel) ? t_buffer.model.data.vertices_size_bytes() : points_num * t_buffer.max_vertices_per_segment_size_bytes();
         if (v_multibuffer.back().size() * sizeof(float) > t_buffer.vertices.max_size_bytes() - vertices_size_to_add) {
             v_multibuffer.push_back(VertexBuffer());
@@ -2566,11 +2569,11 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
                 size_t temp_offset = prev_sub_path.last.s_id - curr_s_id;
                 for (size_t i = prev_sub_path.last.s_id; i > curr_s_id; i--) {
                     size_t move_id = m_ssid_to_moveid_map[i];
-                    temp_offset += (gcode_result.moves[move_id].is_arc_move() ? gcode_result.moves[move_id].interpolation_points.size() : 0);
+                    temp_offset += (gcode_result.moves[move_id].is_arc_move() ? gcode_result.moves[move_id].interpolation_points_count : 0);
                 }
                 if (is_internal_point) {
                     size_t move_id = m_ssid_to_moveid_map[curr_s_id];
-                    temp_offset += (gcode_result.moves[move_id].interpolation_points.size() - interpolation_point_id);
+                    temp_offset += (gcode_result.moves[move_id].interpolation_points_count - interpolation_point_id);
                 }
                 const size_t next_1st_offset = temp_offset * 6 * vertex_size_floats;
                 // offset into the vertex buffer of the right vertex of the previous segment
@@ -2608,11 +2611,11 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
                 size_t temp_offset = prev_sub_path.last.s_id - curr_s_id;
                 for (size_t i = prev_sub_path.last.s_id; i > curr_s_id; i--) {
                     size_t move_id = m_ssid_to_moveid_map[i];
-                    temp_offset += (gcode_result.moves[move_id].is_arc_move() ? gcode_result.moves[move_id].interpolation_points.size() : 0);
+                    temp_offset += (gcode_result.moves[move_id].is_arc_move() ? gcode_result.moves[move_id].interpolation_points_count : 0);
                 }
                 if (is_internal_point) {
                     size_t move_id = m_ssid_to_moveid_map[curr_s_id];
-                    temp_offset += (gcode_result.moves[move_id].interpolation_points.size() - interpolation_point_id);
+                    temp_offset += (gcode_result.moves[move_id].interpolation_points_count - interpolation_point_id);
                 }
                 const size_t next_1st_offset = temp_offset * 6 * vertex_size_floats;
                 // offset into the vertex buffer of the left vertex of the previous segment
@@ -2655,8 +2658,9 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
                 size_t curr_s_id = path.sub_paths.front().first.s_id + j;
                 size_t move_id = m_ssid_to_moveid_map[curr_s_id];
                 int interpolation_points_num = gcode_result.moves[move_id].is_arc_move_with_interpolation_points()?
-                                                    gcode_result.moves[move_id].interpolation_points.size() : 0;
+                                                    gcode_result.moves[move_id].interpolation_points_count : 0;
                 int loop_num = interpolation_points_num;
+                const GCodeProcessorResult::InterpolationPoints interpolation_points = gcode_result.interpolation_points(gcode_result.moves[move_id]);
                 //BBS: select the subpaths which contains the previous/next segments
                 if (!path.sub_paths[prev_sub_path_id].contains(curr_s_id))
                     ++prev_sub_path_id;
@@ -2676,15 +2680,15 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
                 for (int k = 0; k <= loop_num; k++) {
                     const Vec3f& prev = k==0?
                                         gcode_result.moves[move_id - 1].position :
-                                        gcode_result.moves[move_id].interpolation_points[k-1];
+                                        interpolation_points[k-1];
                     const Vec3f& curr = k==interpolation_points_num?
                                         gcode_result.moves[move_id].position :
-                                        gcode_result.moves[move_id].interpolation_points[k];
+                                        interpolation_points[k];
                     const Vec3f& next = k < interpolation_points_num - 1?
-                                        gcode_result.moves[move_id].interpolation_points[k+1]:
+                                        interpolation_points[k+1]:
                                         (k == interpolation_points_num - 1? gcode_result.moves[move_id].position :
                                         (gcode_result.moves[move_id + 1].is_arc_move_with_interpolation_points()?
-                                        gcode_result.moves[move_id + 1].interpolation_points[0] :
+                                        gcode_result.interpolation_points(gcode_result.moves[move_id + 1])[0] :
                                         gcode_result.moves[move_id + 1].position));
 
                     const Vec3f prev_dir = (curr - prev).normalized();
@@ -2876,7 +2880,7 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
         // if adding the indices for the current segment exceeds the threshold size of the current index buffer
         // create another index buffer
         // BBS: get the point number and then judge whether the remaining buffer is enough
-        size_t points_num = curr.is_arc_move_with_interpolation_points() ? curr.interpolation_points.size() + 1 : 1;
+        size_t points_num = curr.is_arc_move_with_interpolation_points() ? curr.interpolation_points_count + 1 : 1;
         size_t indiced_size_to_add = (t_buffer.render_primitive_type == TBuffer::ERenderPrimitiveType::BatchedModel) ? t_buffer.model.data.indices_size_bytes() : points_num * t_buffer.max_indices_per_segment_size_bytes();
         if (i_multibuffer.back().size() * sizeof(IBufferType) >= IBUFFER_THRESHOLD_BYTES - indiced_size_to_add) {
             i_multibuffer.push_back(IndexBuffer());
@@ -3402,7 +3406,7 @@ m_no_render_path = false;
                                     size_t move_id = m_ssid_to_moveid_map[i];
                                     const GCodeProcessorResult::MoveVertex& curr = m_gcode_result->moves[move_id];
                                     if (curr.is_arc_move()) {
-                                        offset += curr.interpolation_points.size();
+                                        offset += curr.interpolation_points_count;
                                     }
                                 }
                                 offset = 2 * offset - 1;
@@ -3414,7 +3418,7 @@ m_no_render_path = false;
                                     size_t move_id = m_ssid_to_moveid_map[i];
                                     const GCodeProcessorResult::MoveVertex& curr = m_gcode_result->moves[move_id];
                                     if (curr.is_arc_move()) {
-                                        offset += curr.interpolation_points.size();
+                                        offset += curr.interpolation_points_count;
                                     }
                                 }
                                 offset = indices_count * (offset - 1) + (indices_count - 2);
@@ -3512,7 +3516,7 @@ m_no_render_path = false;
                 size_t move_id = m_ssid_to_moveid_map[i];
                 const GCodeProcessorResult::MoveVertex& curr = m_gcode_result->moves[move_id];
                 if (curr.is_arc_move()) {
-                    segments_count += curr.interpolation_points.size();
+                    segments_count += curr.interpolation_points_count;
                 }
             }
             size_in_indices = buffer.indices_per_segment() * segments_count;
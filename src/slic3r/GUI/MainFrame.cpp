@@ -509,6 +509,7 @@ DPIFrame(NULL, wxID_ANY, "", wxDefaultPosition, wxDefaultSize, BORDERLESS_FRAME_
             if (!wxGetApp().app_config->get("app", "backup_interval", backup_interval))
                 backup_interval = "10";
             Slic3r::set_backup_interval(boost::lexical_cast<long>(backup_interval));
+            Slic3r::set_backup_compression_level(std::atoi(wxGetApp().app_config->get("backup_compression_level").c_str()));
         } else {
             Slic3r::set_backup_interval(0);
         }
@@ -0,0 +1,335 @@
+// Benchmark of the FFF slicing pipeline.
+//
+// Slices a set of representative models (the test meshes, the models of tests/data and a few large synthetic meshes)
+// and reports for each of them the wall time of each PrintObjectStep and PrintStep, the wall time of Print::process()
+// and of the G-code export, the peak resident memory and the number of heap allocations.
+// The results are printed as a table and optionally saved as JSON for regression tracking.
+//
+// Usage: fff_print_bench [--repeat N] [--json results.json] [case_name ...]
+//   --repeat N  slice each case N times and report the fastest run (default 1)
+//   --json      save the results into a JSON file
+//   case_name   only run the named cases (default all)
+
+#include "libslic3r/libslic3r.h"
+#include "libslic3r/Print.hpp"
+#include "libslic3r/Layer.hpp"
+#include "libslic3r/TriangleMesh.hpp"
+#include "libslic3r/Format/OBJ.hpp"
+
+#include "test_data.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+#include <boost/format.hpp>
+#include <boost/log/core.hpp>
+#include <boost/log/trivial.hpp>
+#include <boost/log/expressions.hpp>
+
+#include <tbb/task_arena.h>
+
+#include "nlohmann/json.hpp"
+
+#ifdef _WIN32
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+    #include <psapi.h>
+#else
+    #include <sys/resource.h>
+#endif
+
+// Count the heap allocations of the whole process. Over-aligned allocations are not counted.
+static std::atomic<size_t> g_num_allocations { 0 };
+static std::atomic<size_t> g_allocated_bytes { 0 };
+
+static void* counted_malloc(std::size_t size)
+{
+    ++ g_num_allocations;
+    g_allocated_bytes += size;
+    if (void *ptr = std::malloc(size == 0 ? 1 : size))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size) { return counted_malloc(size); }
+void* operator new[](std::size_t size) { return counted_malloc(size); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { try { return counted_malloc(size); } catch (...) { return nullptr; } }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { try { return counted_malloc(size); } catch (...) { return nullptr; } }
+void  operator delete(void *ptr) noexcept { std::free(ptr); }
+void  operator delete[](void *ptr) noexcept { std::free(ptr); }
+void  operator delete(void *ptr, std::size_t) noexcept { std::free(ptr); }
+void  operator delete[](void *ptr, std::size_t) noexcept { std::free(ptr); }
+
+using namespace Slic3r;
+using namespace Slic3r::Test;
+using json = nlohmann::json;
+
+namespace {
+
+// Names of the steps as reported, indexed by PrintObjectStep / PrintStep.
+const char* const object_step_names[posCount] = {
+    "slice", "perimeters", "estimate_curled_extrusions", "prepare_infill", "infill", "ironing", "support_material",
+    "simplify_path", "simplify_support_path", "detect_overhangs_for_lift", "simplify_wall", "simplify_infill"
+};
+const char* const print_step_names[psCount] = { "wipe_tower", "skirt_brim", "gcode_export", "conflict_check" };
+
+// Peak resident memory of the process in bytes.
+size_t peak_rss()
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS pmc;
+    return GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)) ? size_t(pmc.PeakWorkingSetSize) : 0;
+#else
+#ifdef __linux__
+    // VmHWM is reset by reset_peak_rss(), while ru_maxrss of getrusage() is the peak of the whole process.
+    if (FILE *f = fopen("/proc/self/status", "r")) {
+        char   line[256];
+        size_t kb = 0;
+        bool   found = false;
+        while (! found && fgets(line, sizeof(line), f))
+            found = sscanf(line, "VmHWM: %zu kB", &kb) == 1;
+        fclose(f);
+        if (found)
+            return kb * 1024;
+    }
+#endif
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+#ifdef __APPLE__
+    // Bytes on macOS.
+    return size_t(usage.ru_maxrss);
+#else
+    // Kilobytes on Linux.
+    return size_t(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+
+// Reset the peak resident memory (VmHWM), so that it is measured per case. Only supported on Linux,
+// elsewhere the reported peak is the peak of the process up to the end of the case.
+void reset_peak_rss()
+{
+#ifdef __linux__
+    if (FILE *f = fopen("/proc/self/clear_refs", "w")) {
+        fputs("5", f);
+        fclose(f);
+    }
+#endif
+}
+
+struct BenchCase
+{
+    std::string                                      name;
+    std::function<std::vector<TriangleMesh>()>       meshes;
+    std::vector<ConfigBase::SetDeserializeItem>      config;
+};
+
+struct BenchResult
+{
+    std::string         name;
+    size_t              triangles       { 0 };
+    size_t              layers          { 0 };
+    double              process_time    { 0. };
+    double              export_time     { 0. };
+    size_t              peak_rss        { 0 };
+    size_t              allocations     { 0 };
+    size_t              allocated_bytes { 0 };
+    // Sum over all objects and maximum over all objects of the wall time of each PrintObjectStep.
+    std::vector<double> object_step_sum  = std::vector<double>(posCount, 0.);
+    std::vector<double> object_step_max  = std::vector<double>(posCount, 0.);
+    std::vector<double> print_step       = std::vector<double>(psCount, 0.);
+
+    double total_time() const { return process_time + export_time; }
+};
+
+std::vector<TriangleMesh> load_test_data_obj(const std::string &file_name)
+{
+    const std::string path = std::string(TEST_DATA_DIR) + "/" + file_name;
+    TriangleMesh mesh;
+    ObjInfo      obj_info;
+    std::string  message;
+    if (! load_obj(path.c_str(), &mesh, obj_info, message))
+        throw Slic3r::RuntimeError("Failed to load " + path + ": " + message);
+    return { std::move(mesh) };
+}
+
+// A grid of n x n cylinders, thus many islands per layer.
+std::vector<TriangleMesh> cylinder_grid(int n)
+{
+    TriangleMesh grid;
+    for (int i = 0; i < n; ++ i)
+        for (int j = 0; j < n; ++ j) {
+            TriangleMesh cylinder = make_cylinder(2.5, 30., 2. * PI / 64.);
+            cylinder.translate(8.f * float(i), 8.f * float(j), 0.f);
+            grid.merge(cylinder);
+        }
+    return { std::move(grid) };
+}
+
+std::vector<BenchCase> bench_cases()
+{
+    return {
+        { "cube_20x20x20",        []() { return std::vector<TriangleMesh>{ mesh(TestMesh::cube_20x20x20) }; }, {} },
+        { "overhang_support",     []() { return std::vector<TriangleMesh>{ mesh(TestMesh::overhang) }; }, { { "enable_support", true } } },
+        { "ipadstand",            []() { return std::vector<TriangleMesh>{ mesh(TestMesh::ipadstand) }; }, {} },
+        { "extruder_idler",       []() { return load_test_data_obj("extruder_idler.obj"); }, {} },
+        { "frog_legs",            []() { return load_test_data_obj("frog_legs.obj"); }, {} },
+        { "cube_with_hole_x16",   []() { return std::vector<TriangleMesh>(16, mesh(TestMesh::cube_with_hole)); }, {} },
+        { "sphere_fine_support",  []() { return std::vector<TriangleMesh>{ TriangleMesh(its_make_sphere(40., PI / 360.)) }; },
+                                  { { "enable_support", true } } },
+        { "cylinder_grid_12x12",  []() { return cylinder_grid(12); }, {} },
+    };
+}
+
+BenchResult run_case(const BenchCase &bench_case)
+{
+    BenchResult result;
+    result.name = bench_case.name;
+
+    std::vector<TriangleMesh> meshes = bench_case.meshes();
+    for (const TriangleMesh &mesh : meshes)
+        result.triangles += mesh.facets_count();
+
+    DynamicPrintConfig config = DynamicPrintConfig::full_print_config();
+    for (const ConfigBase::SetDeserializeItem &item : bench_case.config)
+        config.set_deserialize_strict(item.opt_key, item.opt_value, item.append);
+
+    reset_peak_rss();
+    const size_t allocations_start     = g_num_allocations;
+    const size_t allocated_bytes_start = g_allocated_bytes;
+    {
+        Print print;
+        Model model;
+        init_print(std::move(meshes), print, model, config);
+
+        auto t0 = std::chrono::steady_clock::now();
+        print.process();
+        auto t1 = std::chrono::steady_clock::now();
+        const boost::filesystem::path gcode_path = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("fff_print_bench.%%%%-%%%%.gcode");
+        print.export_gcode(gcode_path.string(), nullptr, nullptr);
+        auto t2 = std::chrono::steady_clock::now();
+        boost::system::error_code ec;
+        boost::filesystem::remove(gcode_path, ec);
+
+        result.process_time = std::chrono::duration<double>(t1 - t0).count();
+        result.export_time  = std::chrono::duration<double>(t2 - t1).count();
+        for (const PrintObject *object : print.objects()) {
+            result.layers += object->layer_count();
+            for (size_t step = 0; step < posCount; ++ step) {
+                double duration = object->step_state_with_timestamp(PrintObjectStep(step)).duration;
+                result.object_step_sum[step] += duration;
+                result.object_step_max[step]  = std::max(result.object_step_max[step], duration);
+            }
+        }
+        for (size_t step = 0; step < psCount; ++ step)
+            result.print_step[step] = print.step_state_with_timestamp(PrintStep(step)).duration;
+    }
+    result.allocations     = g_num_allocations - allocations_start;
+    result.allocated_bytes = g_allocated_bytes - allocated_bytes_start;
+    result.peak_rss        = peak_rss();
+    return result;
+}
+
+json to_json(const BenchResult &result)
+{
+    json j;
+    j["name"]            = result.name;
+    j["triangles"]       = result.triangles;
+    j["layers"]          = result.layers;
+    j["process_s"]       = result.process_time;
+    j["export_s"]        = result.export_time;
+    j["total_s"]         = result.total_time();
+    j["peak_rss_bytes"]  = result.peak_rss;
+    j["allocations"]     = result.allocations;
+    j["allocated_bytes"] = result.allocated_bytes;
+    json object_steps, print_steps;
+    for (size_t step = 0; step < posCount; ++ step)
+        object_steps[object_step_names[step]] = { { "sum_s", result.object_step_sum[step] }, { "max_s", result.object_step_max[step] } };
+    for (size_t step = 0; step < psCount; ++ step)
+        print_steps[print_step_names[step]] = result.print_step[step];
+    j["object_steps"] = std::move(object_steps);
+    j["print_steps"]  = std::move(print_steps);
+    return j;
+}
+
+void print_result(const BenchResult &result)
+{
+    std::cout << boost::format("%-24s %9d triangles %6d layers  process %8.3f s  export %8.3f s  peak RSS %8.1f MB  %10d allocations\n")
+        % result.name % result.triangles % result.layers % result.process_time % result.export_time
+        % (double(result.peak_rss) / (1024. * 1024.)) % result.allocations;
+    for (size_t step = 0; step < posCount; ++ step)
+        if (result.object_step_sum[step] > 0.)
+            std::cout << boost::format("    %-28s %8.3f s (slowest object %8.3f s)\n") % object_step_names[step] % result.object_step_sum[step] % result.object_step_max[step];
+    for (size_t step = 0; step < psCount; ++ step)
+        if (result.print_step[step] > 0.)
+            std::cout << boost::format("    %-28s %8.3f s\n") % print_step_names[step] % result.print_step[step];
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    boost::log::core::get()->set_filter(boost::log::trivial::severity >= boost::log::trivial::warning);
+
+    size_t                   repeat = 1;
+    std::string              json_path;
+    std::vector<std::string> selected;
+    for (int i = 1; i < argc; ++ i) {
+        std::string arg = argv[i];
+        if (arg == "--repeat" && i + 1 < argc)
+            repeat = std::max(1, atoi(argv[++ i]));
+        else if (arg == "--json" && i + 1 < argc)
+            json_path = argv[++ i];
+        else if (arg == "--help" || arg == "-h") {
+            std::cout << "Usage: fff_print_bench [--repeat N] [--json results.json] [case_name ...]\n";
+            return 0;
+        } else
+            selected.emplace_back(std::move(arg));
+    }
+
+    json results = json::array();
+    for (const BenchCase &bench_case : bench_cases()) {
+        if (! selected.empty() && std::find(selected.begin(), selected.end(), bench_case.name) == selected.end())
+            continue;
+        try {
+            BenchResult best;
+            for (size_t i = 0; i < repeat; ++ i) {
+                BenchResult result = run_case(bench_case);
+                if (i == 0 || result.total_time() < best.total_time())
+                    best = std::move(result);
+            }
+            print_result(best);
+            results.push_back(to_json(best));
+        } catch (const std::exception &ex) {
+            std::cerr << bench_case.name << " failed: " << ex.what() << std::endl;
+            return 1;
+        }
+    }
+
+    if (! json_path.empty()) {
+        json root;
+        root["threads"] = tbb::this_task_arena::max_concurrency();
+        root["repeat"]  = repeat;
+        root["cases"]   = std::move(results);
+        std::ofstream out(json_path);
+        out << root.dump(4) << std::endl;
+        if (! out) {
+            std::cerr << "Failed to write " << json_path << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
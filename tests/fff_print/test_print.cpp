@@ -126,3 +126,50 @@ SCENARIO("Print: Brim generation", "[Print]") {
         }
     }
 }
+
+SCENARIO("Print: Slicing cache round trip", "[Print]") {
+    GIVEN("sliced 20mm cube") {
+        Slic3r::Print print;
+        Slic3r::Test::init_and_process_print({TestMesh::cube_20x20x20}, print, { { "fill_density", 0 } });
+        boost::filesystem::path temp = boost::filesystem::unique_path();
+        std::vector<size_t> perimeters_before;
+        for (const Layer *layer : print.objects().front()->layers())
+            perimeters_before.emplace_back(layer->regions().front()->perimeters.items_count());
+        WHEN("the binary cache is exported and loaded back") {
+            REQUIRE(print.export_cached_data(temp.string()) == 0);
+            REQUIRE(boost::filesystem::exists(temp));
+            REQUIRE(print.load_cached_data(temp.string()) == 0);
+            THEN("the layers and their perimeters are restored") {
+                const PrintObject &object = *print.objects().front();
+                REQUIRE(object.layers().size() == perimeters_before.size());
+                for (size_t i = 0; i < object.layers().size(); ++ i) {
+                    REQUIRE(object.layers()[i]->lslices.size() == 1);
+                    REQUIRE(object.layers()[i]->regions().front()->perimeters.items_count() == perimeters_before[i]);
+                }
+            }
+            boost::filesystem::remove_all(temp);
+        }
+        WHEN("a truncated binary cache is loaded") {
+            boost::filesystem::path temp_json = boost::filesystem::unique_path();
+            REQUIRE(print.export_cached_data(temp_json.string(), true) == 0);
+            REQUIRE(print.export_cached_data(temp.string()) == 0);
+            for (boost::filesystem::directory_iterator it(temp), end; it != end; ++ it)
+                boost::filesystem::resize_file(it->path(), boost::filesystem::file_size(it->path()) / 2);
+            THEN("loading fails without a JSON file of the same object") {
+                REQUIRE(print.load_cached_data(temp.string()) != 0);
+                REQUIRE(print.objects().front()->layers().empty());
+            }
+            THEN("the JSON file of the same object is loaded instead") {
+                for (boost::filesystem::directory_iterator it(temp), end; it != end; ++ it)
+                    boost::filesystem::copy_file(it->path(), temp_json / it->path().filename());
+                REQUIRE(print.load_cached_data(temp_json.string()) == 0);
+                const PrintObject &object = *print.objects().front();
+                REQUIRE(object.layers().size() == perimeters_before.size());
+                for (size_t i = 0; i < object.layers().size(); ++ i)
+                    REQUIRE(object.layers()[i]->regions().front()->perimeters.items_count() == perimeters_before[i]);
+            }
+            boost::filesystem::remove_all(temp);
+            boost::filesystem::remove_all(temp_json);
+        }
+    }
+}
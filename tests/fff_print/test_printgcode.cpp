@@ -2,10 +2,13 @@
 
 #include "libslic3r/libslic3r.h"
 #include "libslic3r/GCodeReader.hpp"
+#include "libslic3r/Utils.hpp"
 
 #include "test_data.hpp"
 
 #include <algorithm>
+#include <boost/filesystem.hpp>
+#include <boost/nowide/fstream.hpp>
 #include <boost/regex.hpp>
 
 using namespace Slic3r;
@@ -269,3 +272,100 @@ SCENARIO( "PrintGCode basic functionality", "[PrintGCode]") {
         }
     }
 }
+
+SCENARIO("PrintGCode export through a spool file", "[PrintGCode]") {
+    GIVEN("20mm cube, an output directory and a different temporary directory") {
+        namespace fs = boost::filesystem;
+        const fs::path    output_dir = fs::temp_directory_path() / fs::unique_path();
+        const fs::path    spool_dir  = fs::temp_directory_path() / fs::unique_path();
+        fs::create_directories(output_dir);
+        fs::create_directories(spool_dir);
+        const std::string temporary_dir_old = temporary_dir();
+        // Number of files in a directory.
+        auto num_files = [](const fs::path &dir) { return std::distance(fs::directory_iterator(dir), fs::directory_iterator()); };
+        // G-code without the line with the time stamp of the export.
+        auto read_gcode = [](const fs::path &path) {
+            boost::nowide::ifstream file(path.string());
+            std::string out, line;
+            while (std::getline(file, line))
+                if (line.find("; generated by") == std::string::npos)
+                    out += line + "\n";
+            return out;
+        };
+        // A G-code export step is finished once, thus each export slices the cube again.
+        auto export_gcode = [](const fs::path &path) {
+            Print print;
+            Model model;
+            init_print({TestMesh::cube_20x20x20}, print, model, { { "layer_height", 0.2 }, { "initial_layer_print_height", 0.2 } });
+            print.set_status_silent();
+            print.process();
+            GCodeProcessorResult result;
+            print.export_gcode(path.string(), &result, nullptr);
+        };
+        // Reference G-code exported into the temporary directory, thus without the spool file.
+        set_temporary_dir(output_dir.string());
+        export_gcode(output_dir / "reference.gcode");
+        const std::string reference = read_gcode(output_dir / "reference.gcode");
+        fs::remove(output_dir / "reference.gcode");
+        set_temporary_dir(spool_dir.string());
+        WHEN("the G-code is exported to the output directory") {
+            export_gcode(output_dir / "out.gcode");
+            THEN("the output matches the G-code exported without the spool file") {
+                REQUIRE(! reference.empty());
+                REQUIRE(read_gcode(output_dir / "out.gcode") == reference);
+            }
+            THEN("only the G-code is left in the output directory and the spool file is deleted") {
+                REQUIRE(num_files(output_dir) == 1);
+                REQUIRE(num_files(spool_dir) == 0);
+            }
+        }
+        WHEN("the post-processing fails to write the output") {
+            // A directory in place of the temporary output file makes the last post-processing pass fail.
+            fs::create_directories(output_dir / "out.gcode.tmp");
+            REQUIRE_THROWS(export_gcode(output_dir / "out.gcode"));
+            THEN("the spool file is deleted") {
+                REQUIRE(num_files(spool_dir) == 0);
+            }
+        }
+        set_temporary_dir(temporary_dir_old);
+        fs::remove_all(output_dir);
+        fs::remove_all(spool_dir);
+    }
+}
+
+SCENARIO("GCodeReader parallel file parsing", "[PrintGCode]") {
+    GIVEN("A G-code file larger than a single parser block") {
+        boost::filesystem::path temp = boost::filesystem::unique_path();
+        {
+            boost::nowide::ofstream out(temp.string(), std::ios::binary);
+            for (int i = 0; i < 100000; ++ i)
+                out << "G1 X" << i % 200 << " Y" << i % 100 << ".5 E0.0" << i % 10 << " F1800 ; line " << i << (i < 10 ? "\r\n" : "\n");
+            out << "\nN10 G1 Z0.3\nG1 X1 Y1";
+        }
+        WHEN("the file is parsed serially and in parallel") {
+            std::vector<std::string> serial_lines, parallel_lines;
+            std::vector<size_t>      serial_ends, parallel_ends;
+            GCodeReader serial_reader;
+            serial_reader.parse_file(temp.string(), [&serial_lines](GCodeReader &, const GCodeReader::GCodeLine &line) {
+                serial_lines.emplace_back(line.raw());
+            }, serial_ends);
+            GCodeReader parallel_reader;
+            parallel_reader.parse_file_parallel(temp.string(), [&parallel_lines](GCodeReader &, const GCodeReader::GCodeLine &line) {
+                parallel_lines.emplace_back(line.raw());
+            }, parallel_ends);
+            boost::filesystem::remove(temp);
+            THEN("the same lines are reported in the same order") {
+                REQUIRE(parallel_lines.size() == 100003);
+                REQUIRE(parallel_lines == serial_lines);
+                REQUIRE(parallel_lines[100001] == "G1 Z0.3");
+            }
+            THEN("the same line ends are reported") {
+                REQUIRE(parallel_ends == serial_ends);
+            }
+            THEN("the final position matches") {
+                REQUIRE(parallel_reader.x() == Approx(serial_reader.x()));
+                REQUIRE(parallel_reader.z() == Approx(0.3));
+            }
+        }
+    }
+}
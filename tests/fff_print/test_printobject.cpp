@@ -87,3 +87,145 @@ SCENARIO("PrintObject: object layer heights", "[PrintObject]") {
 #endif
     }
 }
+
+SCENARIO("PrintObject: infill of a layer range filled again", "[PrintObject]") {
+    GIVEN("20mm cube with a height range modifier at its top") {
+        DynamicPrintConfig config = DynamicPrintConfig::full_print_config();
+        config.set_deserialize_strict({ { "layer_height", 0.2 }, { "initial_layer_print_height", 0.2 }, { "sparse_infill_density", "20%" } });
+        auto slice = [&config](Print &print, Model &model, InfillPattern top_surface_pattern) {
+            init_print({TestMesh::cube_20x20x20}, print, model, config);
+            // The range keeps the layer height of the object, so that the layer ranges are not considered modified.
+            ModelConfig &range = model.objects.front()->layer_config_ranges[{ 15., 25. }];
+            range.set_key_value("layer_height", new ConfigOptionFloat(0.2));
+            range.set_key_value("top_surface_pattern", new ConfigOptionEnum<InfillPattern>(top_surface_pattern));
+            print.apply(model, config);
+            print.process();
+        };
+        // Number of extrusions and their volume per layer.
+        auto fills = [](const PrintObject &object) {
+            std::vector<std::pair<size_t, double>> out;
+            for (const Layer *layer : object.layers()) {
+                std::pair<size_t, double> &layer_fills = out.emplace_back(0, 0.);
+                for (const LayerRegion *layerm : layer->regions()) {
+                    layer_fills.first  += layerm->fills.items_count();
+                    layer_fills.second += layerm->fills.total_volume();
+                }
+            }
+            return out;
+        };
+        Print print;
+        Model model;
+        slice(print, model, ipMonotonic);
+        PrintObject &object = *print.get_object(0);
+        const std::vector<std::pair<size_t, double>> fills_before = fills(object);
+        WHEN("the top surface pattern of the range is changed") {
+            // Drop the infill of all the layers, the layers filled again are those with infill after processing.
+            for (Layer *layer : object.layers())
+                for (size_t region_id = 0; region_id < layer->region_count(); ++ region_id)
+                    layer->get_region(int(region_id))->fills.clear();
+            model.objects.front()->layer_config_ranges.begin()->second.set_key_value("top_surface_pattern", new ConfigOptionEnum<InfillPattern>(ipConcentric));
+            print.apply(model, config);
+            print.process();
+            const std::vector<std::pair<size_t, double>> fills_after = fills(object);
+
+            Print print_full;
+            Model model_full;
+            slice(print_full, model_full, ipConcentric);
+            const std::vector<std::pair<size_t, double>> fills_full = fills(*print_full.objects().front());
+
+            THEN("only the layers of the range are filled again, the same way as by slicing from scratch") {
+                REQUIRE(fills_after.size() == fills_full.size());
+                size_t num_filled  = 0;
+                bool   top_changed = false;
+                for (size_t i = 0; i < fills_after.size(); ++ i) {
+                    const LayerRegionPtrs &regions = object.layers()[i]->regions();
+                    bool in_range = std::any_of(regions.begin(), regions.end(), [](const LayerRegion *layerm) {
+                        return layerm->region().config().top_surface_pattern == ipConcentric && ! layerm->slices.empty(); });
+                    if (in_range) {
+                        ++ num_filled;
+                        REQUIRE(fills_after[i].first == fills_full[i].first);
+                        REQUIRE(fills_after[i].second == Approx(fills_full[i].second));
+                        top_changed |= fills_before[i].second != Approx(fills_full[i].second);
+                    } else {
+                        REQUIRE(fills_after[i].first == 0);
+                        REQUIRE(fills_before[i].first == fills_full[i].first);
+                        REQUIRE(fills_before[i].second == Approx(fills_full[i].second));
+                    }
+                }
+                REQUIRE(num_filled > 0);
+                REQUIRE(num_filled < fills_after.size());
+                REQUIRE(top_changed);
+            }
+        }
+    }
+}
+
+SCENARIO("PrintObject: slicing result cache", "[PrintObject]") {
+    GIVEN("20mm cube and an empty slicing result cache directory") {
+        const boost::filesystem::path cache_dir = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+        auto slice = [&cache_dir](Print &print, Model &model, std::initializer_list<ConfigBase::SetDeserializeItem> config) {
+            init_print({TestMesh::cube_20x20x20}, print, model, config);
+            print.set_slicing_result_cache_dir(cache_dir.string());
+            print.set_status_silent();
+            print.process();
+        };
+        auto num_cached = [&cache_dir]() {
+            size_t num = 0;
+            for (const boost::filesystem::directory_entry &entry : boost::filesystem::directory_iterator(cache_dir))
+                if (entry.path().extension() == ".bin")
+                    ++ num;
+            return num;
+        };
+        auto same_walls = [](const Print &print1, const Print &print2) {
+            const PrintObject &object1 = *print1.objects().front();
+            const PrintObject &object2 = *print2.objects().front();
+            REQUIRE(object1.layers().size() == object2.layers().size());
+            for (size_t i = 0; i < object1.layers().size(); ++ i) {
+                const Layer &layer1 = *object1.layers()[i];
+                const Layer &layer2 = *object2.layers()[i];
+                REQUIRE(layer1.print_z == Approx(layer2.print_z));
+                REQUIRE(layer1.lslices == layer2.lslices);
+                REQUIRE(layer1.regions().front()->perimeters.items_count() == layer2.regions().front()->perimeters.items_count());
+            }
+        };
+        Print print1;
+        Model model1;
+        slice(print1, model1, { { "sparse_infill_density", "20%" } });
+        THEN("the first Print slices the object and stores it into the cache") {
+            REQUIRE(print1.slicing_result_cache_hits() == 0);
+            REQUIRE(num_cached() == 1);
+        }
+        WHEN("the cube is sliced again with the same settings") {
+            Print print2;
+            Model model2;
+            slice(print2, model2, { { "sparse_infill_density", "20%" } });
+            THEN("the object is loaded from the cache with the same layers, walls and infill") {
+                REQUIRE(print2.slicing_result_cache_hits() == 1);
+                same_walls(print1, print2);
+                for (size_t i = 0; i < print1.objects().front()->layers().size(); ++ i)
+                    REQUIRE(print1.objects().front()->layers()[i]->regions().front()->fills.items_count() ==
+                            print2.objects().front()->layers()[i]->regions().front()->fills.items_count());
+            }
+        }
+        WHEN("the cube is sliced again with a different sparse infill pattern") {
+            Print print2;
+            Model model2;
+            slice(print2, model2, { { "sparse_infill_density", "20%" }, { "sparse_infill_pattern", "grid" } });
+            THEN("the option does not invalidate the walls, the object is loaded from the cache") {
+                REQUIRE(print2.slicing_result_cache_hits() == 1);
+                REQUIRE(num_cached() == 1);
+                same_walls(print1, print2);
+            }
+        }
+        WHEN("the cube is sliced again with a different number of walls") {
+            Print print2;
+            Model model2;
+            slice(print2, model2, { { "sparse_infill_density", "20%" }, { "wall_loops", 4 } });
+            THEN("the object is sliced again and stored as another entry") {
+                REQUIRE(print2.slicing_result_cache_hits() == 0);
+                REQUIRE(num_cached() == 2);
+            }
+        }
+        boost::filesystem::remove_all(cache_dir);
+    }
+}
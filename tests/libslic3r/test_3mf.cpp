@@ -2,10 +2,15 @@
 
 #include "libslic3r/Model.hpp"
 #include "libslic3r/Format/3mf.hpp"
+#include "libslic3r/Format/bbs_3mf.hpp"
+#include "libslic3r/Format/3mf_mesh_parser.hpp"
 #include "libslic3r/Format/STL.hpp"
 
 #include <boost/filesystem/operations.hpp>
 
+#include <algorithm>
+#include <random>
+
 using namespace Slic3r;
 
 SCENARIO("Reading 3mf file", "[3mf]") {
@@ -80,6 +85,61 @@ SCENARIO("Export+Import geometry to/from 3mf file cycle", "[3mf]") {
     }
 }
 
+SCENARIO("Export+Import of a project with several objects to/from 3mf file", "[3mf]") {
+    GIVEN("objects with meshes compressed in parallel, some of them in several blocks") {
+        Model src_model;
+        load_stl((std::string(TEST_DATA_DIR) + "/test_3mf/Prusa.stl").c_str(), &src_model);
+        src_model.objects.front()->name = "prusa";
+        for (const auto &[name, mesh] : { std::make_pair("sphere", make_sphere(20., 2. * PI / 360.)),
+                                          std::make_pair("cylinder", make_cylinder(10., 30., 2. * PI / 720.)),
+                                          std::make_pair("cube", make_cube(10., 20., 30.)) }) {
+            ModelObject *object = src_model.add_object(name, "", mesh);
+            object->volumes.front()->set_offset({ 1., 2., 3. });
+        }
+        src_model.add_default_instances();
+        // Best compression for the backups, the project files are deflated with the default level.
+        set_backup_compression_level(10);
+
+        for (SaveStrategy strategy : { SaveStrategy::Silence, SaveStrategy::Silence | SaveStrategy::SplitModel }) {
+            WHEN(std::string("the project is saved+loaded to/from 3mf file, ") + ((strategy & SaveStrategy::SplitModel) ? "one file per object" : "single model file")) {
+                const std::string test_file = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("%%%%-%%%%.3mf")).string();
+                DynamicPrintConfig src_config = DynamicPrintConfig::full_print_config();
+                StoreParams        store_params;
+                store_params.path     = test_file.c_str();
+                store_params.model    = &src_model;
+                store_params.config   = &src_config;
+                store_params.strategy = strategy | SaveStrategy::Zip64;
+                bool stored = store_bbs_3mf(store_params);
+
+                Model                     dst_model;
+                DynamicPrintConfig        dst_config;
+                ConfigSubstitutionContext ctxt{ ForwardCompatibilitySubstitutionRule::Enable };
+                PlateDataPtrs             plate_data;
+                std::vector<Preset*>      project_presets;
+                bool                      is_bbl_3mf = false;
+                Semver                    file_version;
+                bool loaded = stored && load_bbs_3mf(test_file.c_str(), &dst_config, &ctxt, &dst_model, &plate_data, &project_presets, &is_bbl_3mf, &file_version,
+                                                     nullptr, LoadStrategy::LoadModel);
+                release_PlateData_list(plate_data);
+                boost::filesystem::remove(test_file);
+
+                THEN("the meshes of all the objects are loaded back") {
+                    REQUIRE(stored);
+                    REQUIRE(loaded);
+                    REQUIRE(dst_model.objects.size() == src_model.objects.size());
+                    for (size_t i = 0; i < src_model.objects.size(); ++ i) {
+                        TriangleMesh src_mesh = src_model.objects[i]->raw_mesh();
+                        TriangleMesh dst_mesh = dst_model.objects[i]->raw_mesh();
+                        REQUIRE(dst_mesh.its.indices.size() == src_mesh.its.indices.size());
+                        REQUIRE(dst_mesh.volume() == Approx(src_mesh.volume()));
+                        REQUIRE(dst_mesh.bounding_box().size().isApprox(src_mesh.bounding_box().size(), 1e-4));
+                    }
+                }
+            }
+        }
+    }
+}
+
 SCENARIO("2D convex hull of sinking object", "[3mf]") {
     GIVEN("model") {
         // load a model
@@ -131,3 +191,150 @@ SCENARIO("2D convex hull of sinking object", "[3mf]") {
     }
 }
 
+
+// Collects the mesh of a model file either from the expat callbacks only or with the MeshXMLStreamParser.
+struct MeshCollector
+{
+    bool                        use_mesh_parser;
+    XML_Parser                  parser;
+    MeshXMLStreamParser         mesh_parser;
+    std::vector<Vec3f>          vertices;
+    std::vector<Vec3i32>        triangles;
+    std::vector<std::string>    colors;
+    size_t                      num_callbacks { 0 };
+
+    static const char* attribute(const char **attributes, const char *key) {
+        for (; *attributes != nullptr; attributes += 2)
+            if (::strcmp(*attributes, key) == 0)
+                return attributes[1];
+        return nullptr;
+    }
+
+    static void XMLCALL start_element(void *user_data, const char *name, const char **attributes) {
+        auto &self = *static_cast<MeshCollector*>(user_data);
+        if (::strcmp(name, "vertices") == 0) {
+            if (self.use_mesh_parser)
+                self.mesh_parser.parse_vertices(self.vertices, 0.5f);
+        } else if (::strcmp(name, "triangles") == 0) {
+            if (self.use_mesh_parser)
+                self.mesh_parser.parse_triangles(self.triangles, { { "paint_color", &self.colors } });
+        } else if (::strcmp(name, "vertex") == 0) {
+            ++ self.num_callbacks;
+            Vec3f v = Vec3f::Zero();
+            for (int i = 0; i < 3; ++ i)
+                if (const char *value = attribute(attributes, std::string(1, char('x' + i)).c_str()); value)
+                    v(i) = 0.5f * std::stof(value);
+            self.vertices.emplace_back(v);
+        } else if (::strcmp(name, "triangle") == 0) {
+            ++ self.num_callbacks;
+            Vec3i32 t = Vec3i32::Zero();
+            for (int i = 0; i < 3; ++ i)
+                if (const char *value = attribute(attributes, ("v" + std::to_string(i + 1)).c_str()); value)
+                    t(i) = std::atoi(value);
+            self.triangles.emplace_back(t);
+            const char *color = attribute(attributes, "paint_color");
+            self.colors.emplace_back(color ? color : "");
+        }
+    }
+
+    // Parse the file split at the given offsets.
+    bool parse(const std::string &xml, const std::vector<size_t> &splits) {
+        parser = XML_ParserCreate(nullptr);
+        XML_SetUserData(parser, this);
+        XML_SetElementHandler(parser, start_element, nullptr);
+        mesh_parser.reset(parser);
+        bool ok = true;
+        for (size_t i = 0; ok && i <= splits.size(); ++ i) {
+            size_t begin    = i == 0 ? 0 : splits[i - 1];
+            size_t size     = (i == splits.size() ? xml.size() : splits[i]) - begin;
+            bool   is_final = i == splits.size();
+            ok = use_mesh_parser ? mesh_parser.parse(xml.data() + begin, size, is_final) :
+                                   XML_Parse(parser, xml.data() + begin, int(size), is_final) != XML_STATUS_ERROR;
+        }
+        XML_ParserFree(parser);
+        return ok;
+    }
+
+    bool parse(const std::string &xml, size_t block_size) {
+        std::vector<size_t> splits;
+        for (size_t i = block_size; i < xml.size(); i += block_size)
+            splits.emplace_back(i);
+        return this->parse(xml, splits);
+    }
+};
+
+SCENARIO("Vertices and triangles parsed bypassing expat", "[3mf]") {
+    GIVEN("Model files") {
+        const std::string plain =
+            "<model><resources><object id=\"1\"><mesh>\n"
+            "<vertices>\n  <vertex x=\"1.5\" y=\"-2\" z=\"3e1\"/>\n  <vertex x='4' y = \"5\" z=\"6\" />\n  <vertex z=\"1\"/>\n</vertices>\n"
+            "<triangles>\n  <triangle v1=\"0\" v2=\"1\" v3=\"2\" paint_color=\"4C\"/>\n  <triangle v3=\"0\" v1=\"2\" v2=\"1\" pid=\"1\"/>\n</triangles>\n"
+            "</mesh></object></resources></model>\n";
+        const std::string unusual =
+            "<model><vertices><vertex x=\"1\" y=\"2\" z=\"3\"/><!-- comment --><vertex x=\"4\" y=\"5\" z=\"6\"></vertex></vertices>"
+            "<triangles><triangle v1=\"+1\" v2=\"0\" v3=\"1\"/><triangle v1=\"1\" v2=\"0\" v3=\"1\" paint_color=\"&#x34;C\"/></triangles>"
+            "<vertices/><triangles></triangles></model>";
+        for (const std::string &xml : { plain, unusual })
+            for (size_t block_size : { size_t(1), size_t(3), size_t(17), xml.size() }) {
+                MeshCollector expat { false };
+                MeshCollector fast  { true };
+                WHEN("parsed in blocks of " + std::to_string(block_size) + " bytes") {
+                    REQUIRE(expat.parse(xml, block_size));
+                    REQUIRE(fast.parse(xml, block_size));
+                    THEN("the mesh parser delivers the same mesh as expat") {
+                        REQUIRE(fast.vertices == expat.vertices);
+                        REQUIRE(fast.triangles == expat.triangles);
+                        REQUIRE(fast.colors == expat.colors);
+                    }
+                    if (&xml == &plain)
+                        THEN("expat callbacks are bypassed") {
+                            REQUIRE(fast.num_callbacks == 0);
+                        }
+                }
+            }
+    }
+    GIVEN("A model file with empty sections followed by start tags split between blocks") {
+        const std::string xml =
+            "<model><resources><object id=\"1\" type=\"model\"><mesh><vertices/><triangles/></mesh></object>"
+            "<object id=\"2\" type=\"model\"><mesh><vertices>\n <vertex x=\"1\" y=\"2\" z=\"3\"/>\n</vertices>"
+            "<triangles>\n <triangle v1=\"0\" v2=\"0\" v3=\"0\"/>\n</triangles></mesh></object></resources></model>";
+        MeshCollector expat { false };
+        REQUIRE(expat.parse(xml, xml.size()));
+        // Split the file into two blocks at every position, including inside the start tag following the empty sections.
+        for (size_t split = 1; split < xml.size(); ++ split) {
+            MeshCollector fast { true };
+            INFO("split at " << split);
+            REQUIRE(fast.parse(xml, std::vector<size_t>{ split }));
+            REQUIRE(fast.vertices == expat.vertices);
+            REQUIRE(fast.triangles == expat.triangles);
+        }
+    }
+    GIVEN("A model file split at random positions") {
+        const std::string xml =
+            "<model><resources><object id=\"1\"><mesh><vertices/><triangles>\n</triangles></mesh></object>"
+            "<object id=\"2\"><mesh><vertices  >\n<vertex x=\"1\" y=\"2\" z=\"3\"/><vertex x=\"4\" y=\"5\" z=\"6\"/></vertices >"
+            "<triangles\n><triangle v1=\"1\" v2=\"0\" v3=\"1\" paint_color=\"8\"/><!-- c --><triangle v1=\"0\" v2=\"1\" v3=\"0\"/></triangles>"
+            "<vertices/></mesh></object></resources></model>";
+        MeshCollector expat { false };
+        REQUIRE(expat.parse(xml, xml.size()));
+        std::mt19937 rng(0);
+        for (int i = 0; i < 500; ++ i) {
+            std::vector<size_t> splits(std::uniform_int_distribution<size_t>(1, 8)(rng));
+            for (size_t &split : splits)
+                split = std::uniform_int_distribution<size_t>(0, xml.size())(rng);
+            std::sort(splits.begin(), splits.end());
+            MeshCollector fast { true };
+            REQUIRE(fast.parse(xml, splits));
+            REQUIRE(fast.vertices == expat.vertices);
+            REQUIRE(fast.triangles == expat.triangles);
+            REQUIRE(fast.colors == expat.colors);
+        }
+    }
+    GIVEN("A truncated model file") {
+        const std::string xml = "<model><vertices><vertex x=\"1\" y=\"2\" z=\"3\"/><vertex x=\"1\" y=";
+        MeshCollector fast { true };
+        THEN("parsing fails") {
+            REQUIRE(! fast.parse(xml, 5));
+        }
+    }
+}
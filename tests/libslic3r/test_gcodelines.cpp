@@ -0,0 +1,70 @@
+#include <catch2/catch.hpp>
+
+#include "libslic3r/GCode/GCodeLines.hpp"
+
+using namespace Slic3r;
+
+SCENARIO("G-code lines are tokenized once", "[GCodeLines]") {
+    GIVEN("The G-code of a layer") {
+        GCodeLines gcode(
+            "G1 X10.5 Y-2 E.1 F1800 ;_EXTRUDE_SET_SPEED\n"
+            ";TYPE:Outer wall\n"
+            "\n"
+            "G92 E0\n"
+            "M106 S255\n"
+            "G4 P500\n"
+            "G1 X1 Y2");
+        WHEN("it is tokenized") {
+            THEN("each line gets a record") {
+                REQUIRE(gcode.size() == 7);
+                REQUIRE(gcode.gcode().back() == '\n');
+                REQUIRE(gcode.line(6) == "G1 X1 Y2");
+            }
+            THEN("the axes of a move are parsed") {
+                const GCodeLines::Line &line = gcode[0];
+                REQUIRE(line.cmd == GCodeLines::Cmd::G1);
+                REQUIRE(line.has(X));
+                REQUIRE(line.has(Y));
+                REQUIRE(line.has(E));
+                REQUIRE(line.has(F));
+                REQUIRE(! line.has(Z));
+                REQUIRE(line.value(X) == Approx(10.5));
+                REQUIRE(line.value(Y) == Approx(-2.));
+                REQUIRE(line.value(E) == Approx(0.1));
+                REQUIRE(line.value(F) == Approx(1800.));
+                REQUIRE(gcode.comment(0) == ";_EXTRUDE_SET_SPEED");
+            }
+            THEN("the other lines are classified") {
+                REQUIRE(gcode[1].cmd == GCodeLines::Cmd::Comment);
+                REQUIRE(gcode.comment(1) == ";TYPE:Outer wall");
+                REQUIRE(gcode[2].cmd == GCodeLines::Cmd::Empty);
+                REQUIRE(gcode[3].cmd == GCodeLines::Cmd::G92);
+                REQUIRE(gcode[3].has(E));
+                REQUIRE(gcode[4].cmd == GCodeLines::Cmd::M);
+                REQUIRE(gcode.command(4) == "M106");
+                REQUIRE(gcode[5].cmd == GCodeLines::Cmd::G4);
+                REQUIRE(gcode[5].value(P) == Approx(500.));
+            }
+        }
+        WHEN("lines are copied into another G-code") {
+            GCodeLines out;
+            out.append(gcode, 1, 3);
+            out.append(gcode, 0);
+            out.append("M107\n");
+            out.append(gcode.line(6), gcode[6]);
+            THEN("the text and the records are kept") {
+                REQUIRE(out.gcode() == ";TYPE:Outer wall\n\nG1 X10.5 Y-2 E.1 F1800 ;_EXTRUDE_SET_SPEED\nM107\nG1 X1 Y2\n");
+                REQUIRE(out.size() == 5);
+                REQUIRE(out[2].value(F) == Approx(1800.));
+                REQUIRE(out.comment(2) == ";_EXTRUDE_SET_SPEED");
+                REQUIRE(out[3].cmd == GCodeLines::Cmd::M);
+                REQUIRE(out.line(4) == "G1 X1 Y2");
+            }
+            THEN("the last line may be removed") {
+                out.pop_back();
+                REQUIRE(out.size() == 4);
+                REQUIRE(out.gcode() == ";TYPE:Outer wall\n\nG1 X10.5 Y-2 E.1 F1800 ;_EXTRUDE_SET_SPEED\nM107\n");
+            }
+        }
+    }
+}
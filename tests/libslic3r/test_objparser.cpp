@@ -0,0 +1,113 @@
+#include <catch2/catch.hpp>
+
+#include "libslic3r/Format/objparser.hpp"
+
+#include <boost/filesystem.hpp>
+#include <boost/nowide/fstream.hpp>
+
+using namespace ObjParser;
+
+// Relative indices, materials, objects and groups, which refer to the data preceding them. Each line ends up
+// in a block of its own when parsed in blocks of a few bytes. The last line is not terminated.
+static const char *obj_file =
+    "mtllib test.mtl\n"
+    "o first\n"
+    "v 0 0 0\n"
+    "v 1 0 0\r\n"
+    "v 0 1 0\n"
+    "v 1 1 0\n"
+    "vt 0 0\n"
+    "vt 1 0\n"
+    "vt 0 1\n"
+    "vn 0 0 1\n"
+    "f 1/1/1 2/2/1 3/3/1\n"
+    "g group\n"
+    "usemtl red\n"
+    "f -4/-3/-1 -3/-2/-1 -2/-1/-1\n"
+    "f 2 4 3\n"
+    "s 1\n"
+    "o second\n"
+    "v 0 0 1\n"
+    "v 1 0 1\n"
+    "v 0 1 1\n"
+    "vt 0.5 0.5\n"
+    "f -3//-1 -2//-1 -1//-1\n"
+    "usemtl blue\n"
+    "f -1/-1 -2/-2 -3/-3 -4/-4\n"
+    "  usemtl red\n"
+    "f 1 2 3\n"
+    "f 5 6 7";
+
+static bool parse_obj(const std::string &content, ObjData &data, size_t block_size)
+{
+    const boost::filesystem::path path = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("%%%%-%%%%.obj");
+    {
+        boost::nowide::ofstream file(path.string(), std::ios::binary);
+        file << content;
+    }
+    bool ok = objparse(path.string().c_str(), data, block_size);
+    boost::filesystem::remove(path);
+    return ok;
+}
+
+// Faces of data.vertices, each face without its delimiter.
+static std::vector<std::vector<ObjVertex>> faces(const ObjData &data)
+{
+    std::vector<std::vector<ObjVertex>> out(1);
+    for (const ObjVertex &vertex : data.vertices)
+        if (vertex.coordIdx == -1)
+            out.emplace_back();
+        else
+            out.back().emplace_back(vertex);
+    out.pop_back();
+    return out;
+}
+
+SCENARIO("OBJ parser", "[objparser]") {
+    GIVEN("OBJ file with relative indices and materials") {
+        ObjData data;
+        REQUIRE(parse_obj(obj_file, data, 4 * 1024 * 1024));
+        const std::vector<std::vector<ObjVertex>> data_faces = faces(data);
+        THEN("all the lines are parsed, including the last one not terminated by a line end") {
+            REQUIRE(data.coordinates.size() == 7 * OBJ_VERTEX_LENGTH);
+            REQUIRE(data.textureCoordinates.size() == 4 * 2);
+            REQUIRE(data_faces.size() == 7);
+            REQUIRE(data_faces.back() == std::vector<ObjVertex>{ { 4, -1, -1 }, { 5, -1, -1 }, { 6, -1, -1 } });
+        }
+        THEN("relative indices are resolved against the preceding data") {
+            REQUIRE(data_faces[1] == std::vector<ObjVertex>{ { 0, 0, 0 }, { 1, 1, 0 }, { 2, 2, 0 } });
+            REQUIRE(data_faces[3] == std::vector<ObjVertex>{ { 4, -1, 0 }, { 5, -1, 0 }, { 6, -1, 0 } });
+        }
+        THEN("relative texture coordinate indices count two floats per texture coordinate") {
+            REQUIRE(data_faces[4] == std::vector<ObjVertex>{ { 6, 3, -1 }, { 5, 2, -1 }, { 4, 1, -1 }, { 3, 0, -1 } });
+        }
+        THEN("materials cover the following faces") {
+            REQUIRE(data.usemtls.size() == 3);
+            REQUIRE(data.usemtls[0].name == "red");
+            REQUIRE(data.usemtls[0].face_start == 0);
+            REQUIRE(data.usemtls[0].face_end == 2);
+            REQUIRE(data.usemtls[1].name == "blue");
+            REQUIRE(data.usemtls[1].face_start == 3);
+            REQUIRE(data.usemtls[1].face_end == 4);
+            REQUIRE(data.usemtls[2].face_end == 6);
+            // The end of the last material excludes the delimiter of the last face.
+            REQUIRE(data.usemtls[2].vertexIdxEnd == int(data.vertices.size()) - 1);
+        }
+        WHEN("the file is parsed in blocks of a few bytes") {
+            for (size_t block_size : { 1, 2, 5, 16, 37, 100 }) {
+                ObjData data_blocks;
+                REQUIRE(parse_obj(obj_file, data_blocks, block_size));
+                THEN("the result is the same as if parsed in a single block, block size " + std::to_string(block_size)) {
+                    REQUIRE(objequal(data, data_blocks));
+                    REQUIRE(data.usemtls.size() == data_blocks.usemtls.size());
+                    for (size_t i = 0; i < data.usemtls.size(); ++ i) {
+                        REQUIRE(data.usemtls[i].vertexIdxEnd == data_blocks.usemtls[i].vertexIdxEnd);
+                        REQUIRE(data.usemtls[i].face_start == data_blocks.usemtls[i].face_start);
+                        REQUIRE(data.usemtls[i].face_end == data_blocks.usemtls[i].face_end);
+                    }
+                    REQUIRE(data.smoothingGroups == data_blocks.smoothingGroups);
+                }
+            }
+        }
+    }
+}
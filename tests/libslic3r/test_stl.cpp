@@ -2,6 +2,7 @@
 
 #include "libslic3r/Model.hpp"
 #include "libslic3r/Format/STL.hpp"
+#include "libslic3r/TriangleMesh.hpp"
 
 using namespace Slic3r;
 
@@ -55,3 +56,20 @@ SCENARIO("Reading an STL file", "[stl]") {
 		}
 	}
 }
+
+SCENARIO("Reading an STL file without repair", "[stl]") {
+	for (const char *path : { "Geräte/20mmbox-čřšřěá.stl", "ASCII/20mmbox-LF.stl" }) {
+		GIVEN(path) {
+			TriangleMesh repaired;
+			TriangleMesh mesh;
+			REQUIRE(repaired.ReadSTLFile(stl_path(path).c_str(), true));
+			REQUIRE(mesh.ReadSTLFile(stl_path(path).c_str(), false));
+			THEN("the vertices of the same coordinates are merged as by the repair") {
+				REQUIRE(mesh.its.indices.size() == repaired.its.indices.size());
+				REQUIRE(mesh.its.vertices.size() == repaired.its.vertices.size());
+				REQUIRE(is_approx(mesh.size(), Vec3d(20, 20, 20)));
+				REQUIRE(mesh.stats().open_edges == 0);
+			}
+		}
+	}
+}
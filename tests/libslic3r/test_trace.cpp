@@ -0,0 +1,50 @@
+#include <catch2/catch.hpp>
+
+#include "libslic3r/Trace.hpp"
+
+#include <boost/filesystem.hpp>
+#include <boost/nowide/fstream.hpp>
+#include <sstream>
+#include <thread>
+
+using namespace Slic3r;
+
+static std::string export_trace()
+{
+    boost::filesystem::path path = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("trace-%%%%-%%%%.json");
+    REQUIRE(Trace::export_chrome_trace(path.string()));
+    boost::nowide::ifstream     file(path.string());
+    std::stringstream           ss;
+    ss << file.rdbuf();
+    file.close();
+    boost::filesystem::remove(path);
+    return ss.str();
+}
+
+SCENARIO("Spans are exported as a Chrome trace", "[Trace]") {
+    GIVEN("Tracing disabled") {
+        Trace::clear();
+        Trace::enable(false);
+        { Trace::Span span("disabled_span", "test"); }
+        THEN("No span is recorded") {
+            REQUIRE(export_trace().find("disabled_span") == std::string::npos);
+        }
+    }
+    GIVEN("Tracing enabled") {
+        Trace::clear();
+        Trace::enable(true);
+        { Trace::Span span("main_span", "test", "quoted \"detail\""); }
+        std::thread([]() { Trace::Span span("worker_span", "test"); }).join();
+        Trace::enable(false);
+        std::string trace = export_trace();
+        THEN("Spans of all threads are exported") {
+            REQUIRE(trace.find("{\"traceEvents\":[") == 0);
+            REQUIRE(trace.find("\"name\":\"main_span\",\"cat\":\"test\",\"ph\":\"X\"") != std::string::npos);
+            REQUIRE(trace.find("\"name\":\"worker_span\"") != std::string::npos);
+        }
+        THEN("Details are escaped") {
+            REQUIRE(trace.find("\"args\":{\"detail\":\"quoted \\\"detail\\\"\"}") != std::string::npos);
+        }
+        Trace::clear();
+    }
+}